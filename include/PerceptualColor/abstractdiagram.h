@@ -40,6 +40,12 @@ namespace PerceptualColor
  * Provides some elements that are common for all LCh diagrams in this
  * library.
  *
+ * To find out why a diagram feels laggy, set the environment variable
+ * <tt>PERCEPTUALCOLOR_PERFORMANCE_HUD</tt> to <tt>1</tt> before starting
+ * the application. All diagrams will then show an overlay with their
+ * paint times. This environment variable is the only switch for this
+ * overlay; there is no API to toggle it.
+ *
  * @internal
  *
  * @note Qt provides some possibilities to declare that a certain widget
@@ -74,6 +80,8 @@ public:
     virtual ~AbstractDiagram() noexcept override;
 
 protected:
+    virtual void changeEvent(QEvent *event) override;
+    virtual bool event(QEvent *event) override;
     QColor focusIndicatorColor() const;
     int gradientMinimumLength() const;
     int gradientThickness() const;
@@ -102,6 +110,9 @@ private:
 
     /** @internal @brief Only for unit tests. */
     friend class TestAbstractDiagram;
+    /** @internal @brief Needs access to the overlay of the private
+     * implementation. */
+    friend class PerformanceHud;
 };
 
 } // namespace PerceptualColor
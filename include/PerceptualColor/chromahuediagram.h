@@ -34,6 +34,8 @@
 #include "PerceptualColor/abstractdiagram.h"
 #include "PerceptualColor/lchdouble.h"
 
+#include <QByteArray>
+
 namespace PerceptualColor
 {
 class RgbColorSpace;
@@ -136,7 +138,11 @@ public:
     /** @brief Getter for property @ref currentColor
      *  @returns the property @ref currentColor */
     LchDouble currentColor() const;
+    QByteArray displayProfile() const;
     virtual QSize minimumSizeHint() const override;
+    QSharedPointer<PerceptualColor::RgbColorSpace> outlineColorSpace() const;
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
+    void setOutlineColorSpace(const QSharedPointer<PerceptualColor::RgbColorSpace> &newOutlineColorSpace);
     virtual QSize sizeHint() const override;
 
 public Q_SLOTS:
@@ -381,6 +381,7 @@ public:
     /** @brief Getter for property @ref layoutDimensions
      *  @returns the property @ref layoutDimensions */
     ColorDialog::DialogLayoutDimensions layoutDimensions() const;
+    bool loadPalette(const QString &fileName);
     // Make sure not to override the base class’s “open“ function:
     using QDialog::open;
     Q_INVOKABLE void open(QObject *receiver, const char *member);
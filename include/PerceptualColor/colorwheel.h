@@ -29,6 +29,7 @@
 
 #include "PerceptualColor/perceptualcolorglobal.h"
 
+#include <QByteArray>
 #include <QWidget>
 
 #include "PerceptualColor/abstractdiagram.h"
@@ -103,10 +104,12 @@ class PERCEPTUALCOLOR_IMPORTEXPORT ColorWheel : public AbstractDiagram
 public:
     Q_INVOKABLE explicit ColorWheel(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QWidget *parent = nullptr);
     virtual ~ColorWheel() noexcept override;
+    QByteArray displayProfile() const;
     /** @brief Getter for property @ref hue
      *  @returns the property @ref hue */
     qreal hue() const;
     virtual QSize minimumSizeHint() const override;
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
     virtual QSize sizeHint() const override;
 
 Q_SIGNALS:
@@ -0,0 +1,139 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DIAGRAMIMAGEPROVIDER_H
+#define DIAGRAMIMAGEPROVIDER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QByteArray>
+#include <QQuickAsyncImageProvider>
+#include <QSharedPointer>
+
+#include "PerceptualColor/constpropagatinguniquepointer.h"
+
+namespace PerceptualColor
+{
+class DiagramImageResponse;
+class RgbColorSpace;
+
+/** @brief Provides the diagram images of this library to Qt Quick.
+ *
+ * This class is only available if the library has been built with the
+ * CMake option <tt>PERCEPTUALCOLOR_QUICK</tt>. It lives in a separate
+ * library that depends on QtQuick; the core library depends only on
+ * QtCore, QtGui and LittleCMS.
+ *
+ * Register the provider at the QML engine:
+ * @code
+ * engine.addImageProvider(
+ *     QStringLiteral("perceptualcolor"),
+ *     new PerceptualColor::DiagramImageProvider(
+ *         PerceptualColor::RgbColorSpaceFactory::createSrgb()));
+ * @endcode
+ * The engine takes ownership of the provider. Then, images can be used
+ * in QML like this:
+ * @code{.qml}
+ * Image {
+ *     source: "image://perceptualcolor/chromahue?lightness=50"
+ *     sourceSize: Qt.size(256, 256)
+ * }
+ * @endcode
+ *
+ * The image identifier is the diagram type, optionally followed by
+ * parameters in URL query syntax. Available diagram types and their
+ * parameters:
+ * - <tt>chromahue</tt>: A chroma-hue plane.
+ *   <tt>lightness</tt> (default 50), <tt>border</tt> (default 0),
+ *   <tt>model</tt> (<tt>cielch</tt> or <tt>oklch</tt>, default
+ *   <tt>cielch</tt>). The image is a square.
+ * - <tt>chromalightness</tt>: A chroma-lightness plane.
+ *   <tt>hue</tt> (default 0), <tt>model</tt>.
+ * - <tt>colorwheel</tt>: A hue wheel.
+ *   <tt>thickness</tt> (default 20), <tt>border</tt> (default 0).
+ *   The image is a square.
+ * - <tt>gradient</tt>: A horizontal gradient.
+ *   <tt>first</tt> and <tt>second</tt> (CSS colors like
+ *   <tt>lch(50 30 120)</tt> or <tt>%23FF0000</tt>, default black and
+ *   white).
+ *
+ * All types accept <tt>dpr</tt>, the device pixel ratio (default 1). The
+ * image size is taken from the <tt>sourceSize</tt> of the QML
+ * <tt>Image</tt>; if it is not set, from the parameters <tt>width</tt> and
+ * <tt>height</tt>; and otherwise a default size is used.
+ *
+ * Images are rendered asynchronously on a thread pool that belongs to the
+ * provider, so the GUI thread is never blocked. Rendered images are kept
+ * in a cache that belongs to the color space, and that is shared by all
+ * providers and widgets that use this color space. When a QML
+ * <tt>Image</tt> changes its source while the old image has not yet been
+ * rendered, the outdated request is canceled: If it has not started yet,
+ * it does not render at all, and its result is never cached.
+ *
+ * The same diagram is often shown at several sizes. For diagrams whose
+ * rendering scales with the image size (<tt>chromalightness</tt>, and
+ * <tt>chromahue</tt> without border), only the biggest size is rendered.
+ * Smaller sizes with the same aspect ratio are derived from it by
+ * high-quality downsampling, which is much faster than a new rendering,
+ * but differs slightly in the anti-aliasing at the gamut boundary. The
+ * parameter <tt>exact=1</tt> forces a direct rendering at the
+ * requested size.
+ *
+ * By default, the RGB values of the color space are used, which Qt Quick
+ * shows as if they were sRGB. See @ref setDisplayProfile() for
+ * color-managed images on calibrated monitors. */
+class PERCEPTUALCOLOR_IMPORTEXPORT DiagramImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    explicit DiagramImageProvider(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    virtual ~DiagramImageProvider() noexcept override;
+    QByteArray displayProfile() const;
+    virtual QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
+
+private:
+    Q_DISABLE_COPY(DiagramImageProvider)
+
+    class DiagramImageProviderPrivate;
+    /** @internal
+     * @brief Declare the private implementation as friend class.
+     *
+     * This allows the private class to access the protected members and
+     * functions of instances of <em>this</em> class. */
+    friend class DiagramImageProviderPrivate;
+    /** @internal @brief The responses access the cache of the private
+     * implementation. */
+    friend class DiagramImageResponse;
+    /** @brief Pointer to implementation (pimpl) */
+    ConstPropagatingUniquePointer<DiagramImageProviderPrivate> d_pointer;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestDiagramImageProvider;
+};
+
+} // namespace PerceptualColor
+
+#endif // DIAGRAMIMAGEPROVIDER_H
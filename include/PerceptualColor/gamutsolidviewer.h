@@ -0,0 +1,134 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GAMUTSOLIDVIEWER_H
+#define GAMUTSOLIDVIEWER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QWidget>
+
+#include "PerceptualColor/abstractdiagram.h"
+#include "PerceptualColor/constpropagatinguniquepointer.h"
+
+namespace PerceptualColor
+{
+class RgbColorSpace;
+
+/** @brief A three-dimensional view of the gamut of a color space.
+ *
+ * This widget shows the body of all colors of an RGB color space within
+ * the CIELab color space: The gray axis (lightness) is vertical, chroma
+ * is the distance from the gray axis, and hue is the angle around it.
+ *
+ * The user can rotate the view by dragging with the mouse, or with the
+ * arrow keys (<tt>Page Up</tt> and <tt>Page Down</tt> rotate faster).
+ *
+ * The view is rendered in software on all available processor cores, so
+ * no graphics hardware is necessary. While the user rotates the view, a
+ * faster preview with reduced resolution is shown. Shortly after the
+ * rotation stops, the view is rendered again in full resolution. */
+class PERCEPTUALCOLOR_IMPORTEXPORT GamutSolidViewer : public AbstractDiagram
+{
+    Q_OBJECT
+
+    /** @brief The rotation of the view around the gray axis.
+     *
+     * Measured in degree. At <tt>0</tt>, the view looks from the positive
+     * <em>a</em> axis (from red) to the gray axis.
+     *
+     * Valid range: [0°, 360°[. Other values are normalized.
+     *
+     * @sa READ @ref azimuth() const
+     * @sa WRITE @ref setAzimuth()
+     * @sa NOTIFY @ref azimuthChanged() */
+    Q_PROPERTY(qreal azimuth READ azimuth WRITE setAzimuth NOTIFY azimuthChanged)
+
+    /** @brief The angle of the view above the chroma-hue plane.
+     *
+     * Measured in degree. <tt>90</tt> looks from above (from white),
+     * <tt>-90</tt> from below (from black).
+     *
+     * Valid range: [-90°, 90°]. Other values are bound to this range.
+     *
+     * @sa READ @ref elevation() const
+     * @sa WRITE @ref setElevation()
+     * @sa NOTIFY @ref elevationChanged() */
+    Q_PROPERTY(qreal elevation READ elevation WRITE setElevation NOTIFY elevationChanged)
+
+public:
+    Q_INVOKABLE explicit GamutSolidViewer(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QWidget *parent = nullptr);
+    virtual ~GamutSolidViewer() noexcept override;
+    /** @brief Getter for property @ref azimuth
+     *  @returns the property @ref azimuth */
+    qreal azimuth() const;
+    /** @brief Getter for property @ref elevation
+     *  @returns the property @ref elevation */
+    qreal elevation() const;
+    virtual QSize minimumSizeHint() const override;
+    virtual QSize sizeHint() const override;
+
+Q_SIGNALS:
+    /** @brief Notify signal for property @ref azimuth.
+     * @param newAzimuth the new azimuth */
+    void azimuthChanged(const qreal newAzimuth);
+    /** @brief Notify signal for property @ref elevation.
+     * @param newElevation the new elevation */
+    void elevationChanged(const qreal newElevation);
+
+public Q_SLOTS:
+    void setAzimuth(const qreal newAzimuth);
+    void setElevation(const qreal newElevation);
+
+protected:
+    virtual void keyPressEvent(QKeyEvent *event) override;
+    virtual void mouseMoveEvent(QMouseEvent *event) override;
+    virtual void mousePressEvent(QMouseEvent *event) override;
+    virtual void mouseReleaseEvent(QMouseEvent *event) override;
+    virtual void paintEvent(QPaintEvent *event) override;
+    virtual void resizeEvent(QResizeEvent *event) override;
+
+private:
+    Q_DISABLE_COPY(GamutSolidViewer)
+
+    class GamutSolidViewerPrivate;
+    /** @internal
+     *
+     * @brief Declare the private implementation as friend class.
+     *
+     * This allows the private class to access the protected members and
+     * functions of instances of <em>this</em> class. */
+    friend class GamutSolidViewerPrivate;
+    /** @brief Pointer to implementation (pimpl) */
+    ConstPropagatingUniquePointer<GamutSolidViewerPrivate> d_pointer;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestGamutSolidViewer;
+};
+
+} // namespace PerceptualColor
+
+#endif // GAMUTSOLIDVIEWER_H
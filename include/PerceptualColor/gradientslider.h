@@ -32,8 +32,11 @@
 #include "PerceptualColor/constpropagatinguniquepointer.h"
 
 #include <PerceptualColor/abstractdiagram.h>
+#include <PerceptualColor/gradientstop.h>
 #include <PerceptualColor/lchadouble.h>
 
+#include <QVector>
+
 namespace PerceptualColor
 {
 class RgbColorSpace;
@@ -76,6 +79,11 @@ class RgbColorSpace;
  *   on the right of the widget in LRT layout. In RTL layout it is the
  *   other way round.
  *
+ * Instead of two colors, the gradient can also have an arbitrary number
+ * of stops, each with its own hue interpolation (see @ref setStops()).
+ * Then, @ref firstColor is the color of the first stop and
+ * @ref secondColor the color of the last stop.
+ *
  * @internal
  *
  * @todo A better handle for the slider. Currently, the handle is just a
@@ -201,6 +209,7 @@ public:
      *  @returns the property */
     qreal singleStep() const;
     virtual QSize sizeHint() const override;
+    QVector<PerceptualColor::GradientStop> stops() const;
     /** @brief Getter for property @ref value
      *  @returns the property */
     qreal value() const;
@@ -232,6 +241,7 @@ public Q_SLOTS:
     void setPageStep(const qreal newPageStep);
     void setSecondColor(const PerceptualColor::LchaDouble &newSecondColor);
     void setSingleStep(const qreal newSingleStep);
+    void setStops(const QVector<PerceptualColor::GradientStop> &newStops);
     void setValue(const qreal newValue);
 
 protected:
@@ -0,0 +1,74 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GRADIENTSTOP_H
+#define GRADIENTSTOP_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include "PerceptualColor/lchadouble.h"
+
+namespace PerceptualColor
+{
+/** @brief How the hue is interpolated between two stops of a gradient.
+ *
+ * As the hue is a circular property, there exist two ways to go from one
+ * hue to another (clockwise or counter-clockwise). The names correspond
+ * to the hue interpolation methods of CSS Color Module Level 4.
+ *
+ * @sa @ref GradientStop */
+enum class HueInterpolation {
+    Shorter,   /**< Takes the shorter way. The hue difference is within
+                    <tt>[-180°, 180°]</tt>. This is the default. */
+    Longer,    /**< Takes the longer way. The hue difference is outside
+                    of <tt>]-180°, 180°[</tt>, except when both hues are
+                    identical. */
+    Increasing, /**< The hue always increases. The hue difference is
+                     within <tt>[0°, 360°[</tt>. */
+    Decreasing /**< The hue always decreases. The hue difference is
+                    within <tt>]-360°, 0°]</tt>. */
+};
+
+/** @brief A stop of a multi-stop gradient.
+ *
+ * @sa @ref GradientSlider::setStops() */
+struct GradientStop {
+    /** @brief The position of the stop within the gradient.
+     *
+     * Range: <tt>[0, 1]</tt> */
+    qreal position = 0;
+    /** @brief The color at this stop. */
+    LchaDouble color {0, 0, 0, 1};
+    /** @brief How the hue is interpolated on the way from the
+     * <em>previous</em> stop to this stop.
+     *
+     * Ignored for the first stop. */
+    HueInterpolation hueInterpolation = HueInterpolation::Shorter;
+};
+
+} // namespace PerceptualColor
+
+#endif // GRADIENTSTOP_H
@@ -0,0 +1,101 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PALETTEGENERATOR_H
+#define PALETTEGENERATOR_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+#include "PerceptualColor/lchdouble.h"
+
+namespace PerceptualColor
+{
+class RgbColorSpace;
+
+/** @brief Generates gamut-constrained palettes, like for UI themes.
+ *
+ * - A <em>lightness ramp</em> has a fixed hue and equally spaced
+ *   lightnesses. Each step has the highest in-gamut chroma.
+ * - A <em>hue set</em> has a fixed lightness and equally spaced hues.
+ *   Each step has the requested chroma, or the highest in-gamut chroma
+ *   if the requested chroma is out-of-gamut.
+ *
+ * The color space is the same that is used for the widgets of this
+ * library, so the generated colors can be passed to them directly.
+ * Usage example:
+ *
+ * @snippet test/testpalettegenerator.cpp PaletteGenerator Ramps
+ *
+ * @note All functions are thread-safe. They block until the result is
+ * available; big requests like @ref lightnessRamps() use multiple threads
+ * internally.
+ *
+ * @internal
+ *
+ * Calling @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma for
+ * each step separately would be slow for big design systems. Instead:
+ * - If the gamut boundary is already cached (see
+ *   @ref RgbColorSpace::cachedChromaLightnessBoundary() and
+ *   @ref RgbColorSpace::cachedChromaHueBoundary()), the bisection of each
+ *   step starts at an upper estimate from the boundary, which is close
+ *   to the result, instead of at the maximum chroma of human perception.
+ *   The boundary is never calculated only for this purpose: For a
+ *   single ramp or hue set, this would cost more than it saves.
+ * - All steps are corrected together with the batch version of
+ *   @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma, which
+ *   advances all bisections in lockstep.
+ * - @ref lightnessRamps() calculates the ramps of different hues in
+ *   parallel.
+ *
+ * The results are identical (within the gamut search precision) to the
+ * results of the scalar search. */
+class PERCEPTUALCOLOR_IMPORTEXPORT PaletteGenerator final
+{
+public:
+    static QVector<LchDouble> hueSet(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, qreal lightness, qreal chroma, qreal firstHue, int count);
+    static QVector<LchDouble> lightnessRamp(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, qreal hue, qreal firstLightness, qreal lastLightness, int count);
+    static QVector<QVector<LchDouble>> lightnessRamps(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, const QVector<qreal> &hues, qreal firstLightness, qreal lastLightness, int count);
+
+private:
+    /** @internal
+     *
+     * @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    PaletteGenerator() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestPaletteGenerator;
+
+    static QVector<LchDouble> reduceChroma(const RgbColorSpace &colorSpace, const QVector<LchDouble> &colors);
+    static QVector<LchDouble> reduceChroma(const RgbColorSpace &colorSpace, const QVector<LchDouble> &colors, const QVector<qreal> &chromaEstimates);
+};
+
+} // namespace PerceptualColor
+
+#endif // PALETTEGENERATOR_H
@@ -55,6 +55,7 @@ public:
     // No Q_INVOKABLE here because the class does not inherit QObject:
     static QSharedPointer<PerceptualColor::RgbColorSpace> createSrgb();
     static QSharedPointer<PerceptualColor::RgbColorSpace> createFromFile(const QString &fileName);
+    static void setDeviceLinkCacheDirectory(const QString &directory);
 
 private:
     /** @internal
@@ -34,6 +34,8 @@
 #include "PerceptualColor/abstractdiagram.h"
 #include "PerceptualColor/lchdouble.h"
 
+#include <QByteArray>
+
 namespace PerceptualColor
 {
 class RgbColorSpace;
@@ -78,8 +80,10 @@ public:
     /** @brief Getter for property @ref currentColor
      *  @returns the property @ref currentColor */
     PerceptualColor::LchDouble currentColor() const;
+    QByteArray displayProfile() const;
     virtual QSize minimumSizeHint() const override;
     void setCurrentColor(const PerceptualColor::LchDouble &newCurrentColor);
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
     virtual QSize sizeHint() const override;
 
 Q_SIGNALS:
@@ -36,6 +36,7 @@
 #include <cmath>
 
 #include <QApplication>
+#include <QEvent>
 #include <QPainter>
 #include <QStyle>
 #include <QStyleOption>
@@ -49,6 +50,7 @@ namespace PerceptualColor
  * to the base class’s constructor. */
 AbstractDiagram::AbstractDiagram(QWidget *parent)
     : QWidget(parent)
+    , d_pointer(new AbstractDiagramPrivate)
 {
 }
 
@@ -57,6 +59,71 @@ AbstractDiagram::~AbstractDiagram() noexcept
 {
 }
 
+/** @brief Handle state changes
+ *
+ * Reimplemented from base class.
+ *
+ * @param event The event to process
+ *
+ * @internal
+ *
+ * Invalidates the cached style metrics on changes that might affect them.
+ * Child classes that reimplement this function have to call the base
+ * class’s implementation. */
+void AbstractDiagram::changeEvent(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+        d_pointer->invalidateStyleMetricsCache();
+        // Layouts are informed by the base class’s implementation.
+        break;
+    default:
+        break;
+    }
+    QWidget::changeEvent(event);
+}
+
+/** @brief Handle events
+ *
+ * Reimplemented from base class.
+ *
+ * @param event The event to process
+ * @returns The result of the base class’s implementation.
+ *
+ * @internal
+ *
+ * If the @ref PerformanceHud is enabled, the paint events are measured
+ * and the overlay is painted on top of them. Otherwise, the events are
+ * just forwarded to the base class. */
+bool AbstractDiagram::event(QEvent *event)
+{
+    if (!PerformanceHud::isEnabled()) {
+        return QWidget::event(event);
+    }
+    if (!d_pointer->m_performanceHud) {
+        d_pointer->m_performanceHud.reset(new PerformanceHud);
+    }
+    if (event->type() != QEvent::Paint) {
+        d_pointer->m_performanceHud->countEvent(event);
+        return QWidget::event(event);
+    }
+    d_pointer->m_performanceHud->beginPaint();
+    const bool result = QWidget::event(event);
+    // Still within the paint event, so the overlay can be painted
+    // on top of what the child class has painted.
+    d_pointer->m_performanceHud->endPaint(this);
+    return result;
+}
+
+/** @brief Invalidates the cache of @ref gradientThickness() and
+ * @ref gradientMinimumLength(). */
+void AbstractDiagram::AbstractDiagramPrivate::invalidateStyleMetricsCache()
+{
+    m_gradientMinimumLengthCache = -1;
+    m_gradientThicknessCache = -1;
+}
+
 /** @brief The color for painting focus indicators
  * @returns The color for painting focus indicators. This color is based on
  * the current widget style at the moment this function is called. The value
@@ -205,10 +272,19 @@ qreal AbstractDiagram::handleRadius() const
  * @returns The thickness of a slider or a color wheel, measured in
  * <em>device-independant pixels</em>.
  *
- * @sa @ref gradientMinimumLength() */
+ * @sa @ref gradientMinimumLength()
+ *
+ * @internal
+ *
+ * The value is cached, because it is queried by the size hints, which
+ * the layout system calls very often. The cache is invalidated on
+ * style changes and font changes. */
 int AbstractDiagram::gradientThickness() const
 {
     ensurePolished();
+    if (d_pointer->m_gradientThicknessCache >= 0) {
+        return d_pointer->m_gradientThicknessCache;
+    }
     int result = 0;
     QStyleOptionSlider styleOption;
     styleOption.initFrom(this); // Sets also QStyle::State_MouseOver
@@ -222,6 +298,7 @@ int AbstractDiagram::gradientThickness() const
     result = qMax(result, QApplication::globalStrut().width());
     result = qMax(result, QApplication::globalStrut().height());
     // No supplementary space for ticks is added.
+    d_pointer->m_gradientThicknessCache = result;
     return result;
 }
 
@@ -234,13 +311,20 @@ int AbstractDiagram::gradientThickness() const
  * @returns The length of a gradient, measured in
  * <em>device-independant pixels</em>.
  *
- * @sa @ref gradientThickness() */
+ * @sa @ref gradientThickness()
+ *
+ * @internal
+ *
+ * The value is cached like @ref gradientThickness(). */
 int AbstractDiagram::gradientMinimumLength() const
 {
     ensurePolished();
+    if (d_pointer->m_gradientMinimumLengthCache >= 0) {
+        return d_pointer->m_gradientMinimumLengthCache;
+    }
     QStyleOptionSlider option;
     option.initFrom(this);
-    return qMax(
+    d_pointer->m_gradientMinimumLengthCache = qMax(
         // Parameter: style-based value:
         qMax(
             // Similar to QSlider sizeHint():
@@ -249,6 +333,7 @@ int AbstractDiagram::gradientMinimumLength() const
             style()->pixelMetric(QStyle::PM_SliderLength, &option, this)),
         // Parameter: (Considers implicitly QApplication::globalStrut)
         gradientThickness());
+    return d_pointer->m_gradientMinimumLengthCache;
 }
 
 /** @brief The empty space around diagrams reserverd for the focus indicator.
@@ -33,6 +33,10 @@
 // Include the header of the public class of this private implementation.
 #include "PerceptualColor/abstractdiagram.h"
 
+#include <memory>
+
+#include "performancehud.h"
+
 namespace PerceptualColor
 {
 /** @internal
@@ -50,6 +54,24 @@ public:
      * the class as a whole is <tt>final</tt>. */
     ~AbstractDiagramPrivate() noexcept = default;
 
+    /** @brief Cache for @ref gradientMinimumLength().
+     *
+     * <tt>-1</tt> if the cache is invalid. */
+    mutable int m_gradientMinimumLengthCache = -1;
+    /** @brief Cache for @ref gradientThickness().
+     *
+     * <tt>-1</tt> if the cache is invalid. */
+    mutable int m_gradientThicknessCache = -1;
+    /** @brief The performance overlay.
+     *
+     * Created on the first event after the overlay has been enabled;
+     * <tt>nullptr</tt> as long as the overlay has never been enabled.
+     *
+     * @sa @ref PerformanceHud::isEnabled() */
+    std::unique_ptr<PerformanceHud> m_performanceHud;
+
+    void invalidateStyleMetricsCache();
+
 private:
     Q_DISABLE_COPY(AbstractDiagramPrivate)
 };
@@ -0,0 +1,73 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "chromahueboundary.h"
+
+#include "polarpointf.h"
+
+#include <QtMath>
+
+namespace PerceptualColor
+{
+/** @brief The hue of a column.
+ *
+ * @param column The column index, within <tt>[0, @ref columnCount[</tt>
+ * @returns The hue of this column, within <tt>[0, 360[</tt>. */
+qreal ChromaHueBoundary::columnHue(int column)
+{
+    return column * 360.0 / columnCount;
+}
+
+/** @brief An upper estimate of the maximum in-gamut chroma.
+ *
+ * Uses the maximum of the two neighboring columns plus
+ * @ref estimateTolerance. Near sharp corners of the gamut, the
+ * boundary between two columns might nevertheless reach beyond the
+ * estimate, so callers must be prepared for this.
+ *
+ * @param hue The hue. Is normalized.
+ * @returns The estimate. Negative if the gray is out-of-gamut. */
+qreal ChromaHueBoundary::maximumChromaEstimate(qreal hue) const
+{
+    if ((maximumChroma.count() != columnCount) || !qIsFinite(hue)) {
+        return -1;
+    }
+    const qreal position = PolarPointF::normalizedAngleDegree(hue) * columnCount / 360.0;
+    const int lowerColumn = qBound(0, qFloor(position), columnCount - 1);
+    const int upperColumn = (lowerColumn + 1) % columnCount;
+    const qreal result = qMax(maximumChroma.at(lowerColumn), maximumChroma.at(upperColumn));
+    if (result < 0) {
+        return -1;
+    }
+    return result + estimateTolerance;
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,85 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CHROMAHUEBOUNDARY_H
+#define CHROMAHUEBOUNDARY_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QVector>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The gamut boundary within a chroma-hue plane.
+ *
+ * For a given lightness, this stores the maximum in-gamut chroma for
+ * @ref columnCount hues that are equally distributed from <tt>0</tt>
+ * (column <tt>0</tt>) to just below <tt>360</tt>.
+ *
+ * It is calculated once per lightness by
+ * @ref RgbColorSpace::chromaHueBoundary(). This is the counterpart to
+ * @ref ChromaLightnessBoundary, and allows to draw the gamut outline of
+ * a color space as a closed polygon without rendering the whole
+ * chroma-hue plane.
+ *
+ * For each hue, the in-gamut range is supposed to go from chroma
+ * <tt>0</tt> up to the maximum chroma of the column. */
+struct ChromaHueBoundary {
+public:
+    static qreal columnHue(int column);
+    qreal maximumChromaEstimate(qreal hue) const;
+
+    /** @brief Number of hue columns. */
+    static constexpr int columnCount = 360;
+    /** @brief Recommended spacing of the lightnesses for which boundaries
+     * are requested.
+     *
+     * Equals the row spacing of @ref ChromaLightnessBoundary. Callers that
+     * follow a continuously changing lightness (like a drag) should
+     * request only multiples of this value and interpolate between them.
+     * Otherwise, each new lightness would be a cache miss in
+     * @ref RgbColorSpace::chromaHueBoundary(). */
+    static constexpr qreal lightnessStep = 0.25;
+    /** @brief Safety margin of @ref maximumChromaEstimate(), measured
+     * in chroma. */
+    static constexpr qreal estimateTolerance = 2;
+
+    /** @brief The lightness. */
+    qreal lightness;
+    /** @brief The maximum in-gamut chroma for each column.
+     *
+     * Negative for all columns if the gray of this lightness is
+     * out-of-gamut (which means it is below the blackpoint or above
+     * the whitepoint). */
+    QVector<qreal> maximumChroma;
+};
+
+} // namespace PerceptualColor
+
+#endif // CHROMAHUEBOUNDARY_H
@@ -33,15 +33,20 @@
 // Second, the private implementation.
 #include "chromahuediagram_p.h"
 
+#include "chromahueboundary.h"
 #include "helper.h"
 #include "lchvalues.h"
+#include "performancehud.h"
 #include "polarpointf.h"
+#include "rgbcolorspace.h"
 
 #include <QApplication>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QStyle>
 
+#include <cmath>
+
 namespace PerceptualColor
 {
 /** @brief The constructor.
@@ -129,8 +134,9 @@ void ChromaHueDiagram::mousePressEvent(QMouseEvent *event)
         // cursor is made invisible. Its function is taken over by the
         // handle itself within the displayed gamut.
         setCursor(Qt::BlankCursor);
-        // Set the color property
-        d_pointer->setColorFromWidgetPixelPosition(event->pos());
+        // Set the color property. While the mouse button is pressed,
+        // a precision of about one physical pixel is enough.
+        d_pointer->setColorFromWidgetPixelPosition(event->pos(), d_pointer->interactionGamutPrecision());
         // Schedule a paint event, so that the wheel handle will show. It’s
         // not enough to hope setColorFromWidgetCoordinates() would do this,
         // because setColorFromWidgetCoordinates() would not update the
@@ -173,7 +179,7 @@ void ChromaHueDiagram::mouseMoveEvent(QMouseEvent *event)
         } else {
             unsetCursor();
         }
-        d_pointer->setColorFromWidgetPixelPosition(event->pos());
+        d_pointer->setColorFromWidgetPixelPosition(event->pos(), d_pointer->interactionGamutPrecision());
     } else {
         // Make sure default behavior like drag-window in KDE’s
         // Breeze widget style works.
@@ -210,7 +216,8 @@ void ChromaHueDiagram::mouseReleaseEvent(QMouseEvent *event)
         event->accept();
         unsetCursor();
         d_pointer->m_isMouseEventActive = false;
-        d_pointer->setColorFromWidgetPixelPosition(event->pos());
+        // This is the final, committed value, so use full precision.
+        d_pointer->setColorFromWidgetPixelPosition(event->pos(), gamutPrecision);
         // Schedule a paint event, so that the wheel handle will be hidden.
         // It’s not enough to hope setColorFromWidgetCoordinates() would do
         // this, because setColorFromWidgetCoordinates() would not update the
@@ -460,14 +467,143 @@ void ChromaHueDiagram::resizeEvent(QResizeEvent *event)
  * and expressed as widget coordinate point.
  * @sa @ref ChromaHueMeasurement "Measurement details" */
 QPointF ChromaHueDiagram::ChromaHueDiagramPrivate::widgetCoordinatesFromCurrentColor() const
+{
+    return widgetCoordinatesFromChromaHue(m_currentColor.c, m_currentColor.h);
+}
+
+/** @brief Widget coordinate point corresponding to a chroma and a hue
+ * @param chroma The chroma
+ * @param hue The hue
+ * @returns Widget coordinate point corresponding to the given chroma and
+ * hue. The lightness is irrelevant for this widget.
+ * @sa @ref ChromaHueMeasurement "Measurement details" */
+QPointF ChromaHueDiagram::ChromaHueDiagramPrivate::widgetCoordinatesFromChromaHue(qreal chroma, qreal hue) const
 {
     const qreal scaleFactor = (q_pointer->maximumWidgetSquareSize() - 2.0 * diagramBorder()) / (2.0 * m_rgbColorSpace->maximumChroma());
-    QPointF currentColor = PolarPointF(m_currentColor.c, m_currentColor.h).toCartesian();
+    QPointF cartesian = PolarPointF(chroma, hue).toCartesian();
     return QPointF(
         // x:
-        currentColor.x() * scaleFactor + diagramOffset(),
+        cartesian.x() * scaleFactor + diagramOffset(),
         // y:
-        diagramOffset() - currentColor.y() * scaleFactor);
+        diagramOffset() - cartesian.y() * scaleFactor);
+}
+
+/** @brief The gamut outline of @ref outlineColorSpace() at the
+ * lightness of @ref currentColor.
+ *
+ * The outline comes from the cached
+ * @ref RgbColorSpace::chromaHueBoundary(). Only the lightnesses of the
+ * grid of @ref ChromaHueBoundary::lightnessStep are requested, and
+ * the outline is interpolated linearly between the two neighboring
+ * ones. So it is cheap even when the lightness changes continuously:
+ * Most paint events hit the cache.
+ *
+ * @returns The outline as closed polygon in widget coordinate points.
+ * Empty if there is no @ref outlineColorSpace(), or if its gamut has no
+ * colors at this lightness. */
+QPolygonF ChromaHueDiagram::ChromaHueDiagramPrivate::outlinePolygon() const
+{
+    QPolygonF result;
+    if (m_outlineColorSpace.isNull()) {
+        return result;
+    }
+    const qreal position = m_currentColor.l / ChromaHueBoundary::lightnessStep;
+    if (!qIsFinite(position)) {
+        return result;
+    }
+    const qreal lowerPosition = std::floor(position);
+    const qreal fraction = position - lowerPosition;
+    const QSharedPointer<const ChromaHueBoundary> lower = //
+        m_outlineColorSpace->chromaHueBoundary(lowerPosition * ChromaHueBoundary::lightnessStep);
+    const QSharedPointer<const ChromaHueBoundary> upper = (fraction > 0) //
+        ? m_outlineColorSpace->chromaHueBoundary((lowerPosition + 1) * ChromaHueBoundary::lightnessStep)
+        : lower;
+    const qreal lowerGray = lower->maximumChroma.value(0, -1);
+    const qreal upperGray = upper->maximumChroma.value(0, -1);
+    if ((lowerGray < 0) && (upperGray < 0)) {
+        return result;
+    }
+    result.reserve(ChromaHueBoundary::columnCount);
+    for (int column = 0; column < ChromaHueBoundary::columnCount; ++column) {
+        // A slice with out-of-gamut gray contributes chroma 0.
+        const qreal lowerChroma = qMax<qreal>(0, lower->maximumChroma.at(column));
+        const qreal upperChroma = qMax<qreal>(0, upper->maximumChroma.at(column));
+        result.append(widgetCoordinatesFromChromaHue( //
+            lowerChroma + fraction * (upperChroma - lowerChroma),
+            ChromaHueBoundary::columnHue(column)));
+    }
+    return result;
+}
+
+/** @brief The ICC profile of the monitor.
+ *
+ * @returns The raw data of the ICC profile of the monitor, or an empty
+ * byte array if none has been set. Default value is an empty byte array.
+ *
+ * @sa @ref setDisplayProfile() */
+QByteArray ChromaHueDiagram::displayProfile() const
+{
+    return d_pointer->m_displayProfile;
+}
+
+/** @brief Sets the ICC profile of the monitor.
+ *
+ * Qt shows the RGB values of images as if they were sRGB. On
+ * calibrated wide-gamut monitors, the colors of the diagram are therefore
+ * wrong. With a display profile, the diagram converts its colors
+ * directly to the RGB values of the monitor.
+ *
+ * Qt does not provide the ICC profile of a screen, so the application has
+ * to provide it (for example from the platform color management API),
+ * and has to set it again when the widget is moved to another screen.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the
+ * monitor. An empty byte array (or a profile that is not a valid RGB
+ * profile) means that the RGB values of the color space are shown
+ * without conversion.
+ *
+ * @sa @ref displayProfile() */
+void ChromaHueDiagram::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (d_pointer->m_displayProfile == newDisplayProfile) {
+        return;
+    }
+    d_pointer->m_displayProfile = newDisplayProfile;
+    d_pointer->m_chromaHueImage.setDisplayProfile(newDisplayProfile);
+    d_pointer->m_wheelImage.setDisplayProfile(newDisplayProfile);
+    update();
+}
+
+/** @brief The color space whose gamut outline is drawn on the diagram.
+ *
+ * @returns The color space whose gamut outline is drawn on top of the
+ * diagram, or <tt>nullptr</tt> if no outline is drawn. Default value
+ * is <tt>nullptr</tt>.
+ *
+ * @sa @ref setOutlineColorSpace() */
+QSharedPointer<PerceptualColor::RgbColorSpace> ChromaHueDiagram::outlineColorSpace() const
+{
+    return d_pointer->m_outlineColorSpace;
+}
+
+/** @brief Draws the gamut outline of a second color space.
+ *
+ * This allows to compare two gamuts: The diagram shows the gamut of its
+ * own color space, and on top of it, the outline of the gamut of
+ * <em>newOutlineColorSpace</em> is drawn as a dashed line, at the
+ * lightness of @ref currentColor.
+ *
+ * @param newOutlineColorSpace The color space whose gamut outline is
+ * drawn, or <tt>nullptr</tt> to not draw any outline.
+ *
+ * @sa @ref outlineColorSpace() */
+void ChromaHueDiagram::setOutlineColorSpace(const QSharedPointer<PerceptualColor::RgbColorSpace> &newOutlineColorSpace)
+{
+    if (d_pointer->m_outlineColorSpace == newOutlineColorSpace) {
+        return;
+    }
+    d_pointer->m_outlineColorSpace = newOutlineColorSpace;
+    update();
 }
 
 /** @brief Converts widget pixel positions to Lab coordinates
@@ -500,6 +636,9 @@ cmsCIELab ChromaHueDiagram::ChromaHueDiagramPrivate::fromWidgetPixelPositionToLa
  * system. The given value  does not necessarily need to be within the
  * actual displayed diagram or even the gamut itself. It might even be
  * negative.
+ * @param precision The precision of the chroma search for out-of-gamut
+ * positions. See @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma()
+ * and @ref interactionGamutPrecision().
  *
  * @post If the <em>center</em> of the widget pixel is within the represented
  * gamut, then the @ref currentColor property is set correspondingly. If the
@@ -521,10 +660,31 @@ cmsCIELab ChromaHueDiagram::ChromaHueDiagramPrivate::fromWidgetPixelPositionToLa
  * was chosen too small)? For consistency, the handle of the diagram should
  * stay within the gray circle, and this should be interpretat also actually
  * as the value at the position of the handle. */
-void ChromaHueDiagram::ChromaHueDiagramPrivate::setColorFromWidgetPixelPosition(const QPoint position)
+void ChromaHueDiagram::ChromaHueDiagramPrivate::setColorFromWidgetPixelPosition(const QPoint position, qreal precision)
 {
     cmsCIELab lab = fromWidgetPixelPositionToLab(position);
-    q_pointer->setCurrentColor(m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(m_rgbColorSpace->toLch(lab)));
+    q_pointer->setCurrentColor(m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(m_rgbColorSpace->toLch(lab), precision));
+}
+
+/** @brief Precision of the gamut search during mouse interaction.
+ *
+ * While the user drags the handle, a chroma precision that is finer than
+ * the physical pixels of the screen is not visible. Therefore, the gamut
+ * search can stop at half a physical pixel, which saves transforms.
+ * Final values (mouse release, keyboard, API) use the full
+ * @ref gamutPrecision instead.
+ *
+ * @returns The chroma that corresponds to half a physical pixel, but not
+ * less than @ref gamutPrecision. */
+qreal ChromaHueDiagram::ChromaHueDiagramPrivate::interactionGamutPrecision() const
+{
+    const qreal diagramDiameter = q_pointer->maximumWidgetSquareSize() - 2.0 * diagramBorder();
+    if (diagramDiameter <= 0) {
+        return gamutPrecision;
+    }
+    const qreal chromaPerLogicalPixel = (2.0 * m_rgbColorSpace->maximumChroma()) / diagramDiameter;
+    const qreal chromaPerPhysicalPixel = chromaPerLogicalPixel / q_pointer->devicePixelRatioF();
+    return qMax(gamutPrecision, chromaPerPhysicalPixel / 2);
 }
 
 /** @brief Tests if a wiget pixel positon is within the mouse sensible circle.
@@ -629,8 +789,8 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
     d_pointer->m_chromaHueImage.setChromaRange(d_pointer->m_rgbColorSpace->maximumChroma());
     d_pointer->m_chromaHueImage.setLightness(d_pointer->m_currentColor.l);
     d_pointer->m_chromaHueImage.setDevicePixelRatioF(devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                          // position of the image
-                            d_pointer->m_chromaHueImage.getImage() // image
+    bufferPainter.drawImage(QPoint(0, 0),                                          // position of the image
+                            PerformanceHud::image(this, d_pointer->m_chromaHueImage) // image
     );
 
     // Paint a color wheel around
@@ -641,10 +801,23 @@ void ChromaHueDiagram::paintEvent(QPaintEvent *event)
     d_pointer->m_wheelImage.setDevicePixelRatioF(devicePixelRatioF());
     d_pointer->m_wheelImage.setImageSize(maximumPhysicalSquareSize());
     d_pointer->m_wheelImage.setWheelThickness(gradientThickness() * devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                      // position of the image
-                            d_pointer->m_wheelImage.getImage() // the image itself
+    bufferPainter.drawImage(QPoint(0, 0),                                      // position of the image
+                            PerformanceHud::image(this, d_pointer->m_wheelImage) // the image itself
     );
 
+    // Paint the gamut outline of the second color space (if any)
+    const QPolygonF outline = d_pointer->outlinePolygon();
+    if (!outline.isEmpty()) {
+        pen = QPen();
+        pen.setWidth(handleOutlineThickness());
+        pen.setColor(handleColor);
+        pen.setStyle(Qt::DashLine);
+        bufferPainter.setPen(pen);
+        bufferPainter.setBrush(transparentBrush);
+        bufferPainter.setRenderHint(QPainter::Antialiasing, true);
+        bufferPainter.drawPolygon(outline);
+    }
+
     // Paint a handle on the color wheel (only if a mouse event is
     // currently active).
     if (d_pointer->m_isMouseEventActive) {
@@ -38,6 +38,8 @@
 #include "constpropagatingrawpointer.h"
 #include "lchvalues.h"
 
+#include <QPolygonF>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -85,6 +87,10 @@ public:
      * circular widget, only reacting on mouse events within the circle;
      * this requires this custom implementation. */
     bool m_isMouseEventActive = false;
+    /** @brief Internal storage for @ref displayProfile() */
+    QByteArray m_displayProfile;
+    /** @brief Internal storage for @ref outlineColorSpace() */
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_outlineColorSpace;
     /** @brief Pointer to @ref RgbColorSpace object used to describe the
      * color space. */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
@@ -96,8 +102,11 @@ public:
     QPointF diagramCenter() const;
     qreal diagramOffset() const;
     cmsCIELab fromWidgetPixelPositionToLab(const QPoint position) const;
+    qreal interactionGamutPrecision() const;
     bool isWidgetPixelPositionWithinMouseSensibleCircle(const QPoint widgetCoordinates) const;
-    void setColorFromWidgetPixelPosition(const QPoint position);
+    QPolygonF outlinePolygon() const;
+    void setColorFromWidgetPixelPosition(const QPoint position, qreal precision);
+    QPointF widgetCoordinatesFromChromaHue(qreal chroma, qreal hue) const;
     QPointF widgetCoordinatesFromCurrentColor() const;
 
 private:
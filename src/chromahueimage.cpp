@@ -31,8 +31,11 @@
 // First the interface, which forces the header to be self-contained.
 #include "chromahueimage.h"
 
+#include "diagramimagecache.h"
 #include "helper.h"
 #include "lchvalues.h"
+#include "slicerenderer.h"
+#include "tracepoints.h"
 
 #include <QPainter>
 #include <QtMath>
@@ -103,6 +106,39 @@ void ChromaHueImage::setDevicePixelRatioF(const qreal newDevicePixelRatioF)
     }
 }
 
+/** @brief Setter for the exact rendering property.
+ *
+ * @param newExactRendering If <tt>true</tt>, the image is always rendered
+ * directly at the requested size. If <tt>false</tt> (default), it might
+ * be derived from a bigger rendering in the @ref DiagramImageCache of the
+ * color space, which is much faster, but differs slightly in the
+ * anti-aliasing at the gamut boundary. */
+void ChromaHueImage::setExactRendering(const bool newExactRendering)
+{
+    if (m_exactRendering != newExactRendering) {
+        m_exactRendering = newExactRendering;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the display profile property.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the monitor.
+ * If it is a valid RGB profile, the in-gamut pixels are converted with a
+ * single transform directly from Lab to the RGB values of the monitor
+ * (see @ref DisplayTransform). If it is empty (default), the RGB values
+ * of the color space are used, which Qt interprets as sRGB. */
+void ChromaHueImage::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (m_displayProfile != newDisplayProfile) {
+        m_displayProfile = newDisplayProfile;
+        m_displayTransform = m_rgbColorSpace->displayTransform(newDisplayProfile);
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
 /** @brief Setter for the image size property.
  *
  * This value fixes the size of the image. The image will be a square
@@ -152,6 +188,34 @@ void ChromaHueImage::setChromaRange(const qreal newChromaRange)
     }
 }
 
+/** @brief Setter for the cancel flag.
+ *
+ * @param newCancelFlag Pointer to a flag that another thread can set to
+ * <tt>true</tt> to cancel a running @ref getImage(). It is checked
+ * before each row of the gamut. The flag must stay valid as long as
+ * this object uses it. <tt>nullptr</tt> (default) means that the
+ * rendering cannot be canceled.
+ *
+ * A canceled rendering returns a null image, and caches nothing. */
+void ChromaHueImage::setCancelFlag(const std::atomic<bool> *newCancelFlag)
+{
+    m_cancelFlag = newCancelFlag;
+}
+
+/** @brief Setter for the color model property.
+ *
+ * @param newColorModel The color model in which the lightness and the
+ * chroma range are interpreted, and in which the chroma hue plane is
+ * laid out. Default value is @ref ColorModel::CielchD50. */
+void ChromaHueImage::setColorModel(const ColorModel newColorModel)
+{
+    if (m_colorModel != newColorModel) {
+        m_colorModel = newColorModel;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
 /** @brief Delivers an image of the chroma hue plane.
  *
  * @returns Delivers a square image of the chroma hue plane. It consists
@@ -169,6 +233,20 @@ QImage ChromaHueImage::getImage()
         return m_image;
     }
 
+    // Maybe the image (or a bigger one) has yet been rendered by another
+    // object that uses the same color space.
+    DiagramImageCache *const sharedCache = m_rgbColorSpace->diagramImageCache();
+    const QString key = cacheKey();
+    const QSize size(m_imageSizePhysical, m_imageSizePhysical);
+    if (!size.isEmpty()) {
+        m_image = sharedCache->find(key, size, isScalable() && !m_exactRendering);
+        if (!m_image.isNull()) {
+            return m_image;
+        }
+    }
+
+    PERCEPTUALCOLOR_TRACE_SCOPE1(chroma_hue_image_render, m_imageSizePhysical);
+
     // If no image is in cache, create a new one (in the cache) with
     // correct image size.
     m_image = QImage(QSize(m_imageSizePhysical, m_imageSizePhysical), QImage::Format_ARGB32_Premultiplied);
@@ -188,45 +266,31 @@ QImage ChromaHueImage::getImage()
     // If we continue, the circle will at least be visible.
     // Initialize the hole image background to the background color
     // of the circle.
-    m_image.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
+    if (m_displayTransform) {
+        m_image.fill(m_displayTransform->toRgb(LchValues::neutralGray()));
+    } else {
+        m_image.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
+    }
 
-    // Prepare for gamut painting
-    cmsCIELab lab;
-    lab.L = m_lightness;
-    int x;
-    int y;
-    QColor tempColor;
+    // Paint the gamut.
     const qreal scaleFactor = static_cast<qreal>(2 * m_chromaRange)
         // The following line will never be 0 because we have have
         // tested above that circleRadius is > 0, so this line will
         // we > 0 also.
         / (m_imageSizePhysical - 2 * m_borderPhysical);
-
-    // Paint the gamut.
-    // The pixel at position QPoint(x, y) is the square with the top-left
-    // edge at coordinate point QPoint(x, y) and the botton-right edge at
-    // coordinate point QPoint(x+1, y+1). This pixel is supposed to have
-    // the color from coordinate point QPoint(x+0.5, y+0.5), which is
-    // the middle of this pixel. Therefore, with an offset of 0.5 we can
-    // convert from the pixel position to the point in the middle of the pixel.
-    constexpr qreal pixelOffset = 0.5;
-    // TODO Could this be further optimized? For example not go from zero
-    // up to m_imageSizePhysical, but exclude the border (and add the
-    // tolerance)? Tought anyway the color transform (which is the heavy
-    // work) is only done when within a given diameter, reducing loop runs
-    // itself might also increase performance at least a little bit…
-    for (y = 0; y < m_imageSizePhysical; ++y) {
-        lab.b = m_chromaRange - (y + pixelOffset - m_borderPhysical) * scaleFactor;
-        for (x = 0; x < m_imageSizePhysical; ++x) {
-            lab.a = (x + pixelOffset - m_borderPhysical) * scaleFactor - m_chromaRange;
-            if ((qPow(lab.a, 2) + qPow(lab.b, 2)) <= (qPow(m_chromaRange + overlap, 2))) {
-                tempColor = m_rgbColorSpace->toQColorRgbUnbound(lab);
-                if (tempColor.isValid()) {
-                    // The pixel is within the gamut!
-                    m_image.setPixelColor(x, y, tempColor);
-                }
-            }
-        }
+    SliceRenderer::Plane plane = SliceRenderer::Plane::constantLightness( //
+        m_colorModel,
+        m_lightness,
+        -m_chromaRange - m_borderPhysical * scaleFactor, // a at the left edge
+        m_chromaRange + m_borderPhysical * scaleFactor, // b at the top edge
+        scaleFactor);
+    // Everything outside the circle will be cut off anyway, so there is
+    // no need to convert it.
+    plane.maximumChroma = m_chromaRange + overlap;
+    if (!SliceRenderer::paintGamut(&m_image, plane, *m_rgbColorSpace, m_displayTransform.data(), m_cancelFlag)) {
+        // Never keep or cache an incomplete image.
+        m_image = QImage();
+        return m_image;
     }
 
     // Cut off everything outside the circle.
@@ -252,10 +316,42 @@ QImage ChromaHueImage::getImage()
                           circleRadius + cutOffThickness / 2,                   // width
                           circleRadius + cutOffThickness / 2                    // height
     );
+    myPainter.end();
 
     // Set the correct scaling information for the image and return
     m_image.setDevicePixelRatio(m_devicePixelRatioF);
+    sharedCache->insert(key, m_image, isScalable());
     return m_image;
 }
 
+/** @brief The key for the diagram image cache of the color space.
+ *
+ * @returns A key that describes all properties apart from the
+ * image size.
+ *
+ * @sa @ref RgbColorSpace::diagramImageCache() */
+QString ChromaHueImage::cacheKey() const
+{
+    return QStringLiteral("chromahue?lightness=%1&chroma=%2&model=%3&border=%4&dpr=%5&display=%6")
+        .arg(QString::number(m_lightness, 'g', 17),
+             QString::number(m_chromaRange, 'g', 17),
+             QString::number(static_cast<int>(m_colorModel)),
+             QString::number(m_borderPhysical, 'g', 17),
+             QString::number(m_devicePixelRatioF, 'g', 17),
+             m_displayTransform.isNull() //
+                 ? QString()
+                 : QString::fromLatin1(m_displayTransform->profileHash()));
+}
+
+/** @brief If the image can be derived from a bigger rendering.
+ *
+ * @returns <tt>true</tt> if there is no border. The border is measured in
+ * pixels and therefore does not scale with the image.
+ *
+ * @sa @ref DiagramImageCache */
+bool ChromaHueImage::isScalable() const
+{
+    return m_borderPhysical == 0;
+}
+
 } // namespace PerceptualColor
@@ -32,7 +32,12 @@
 
 #include <QImage>
 #include <QSharedPointer>
+#include <QString>
 
+#include <atomic>
+
+#include "colormodel.h"
+#include "displaytransform.h"
 #include "rgbcolorspace.h"
 
 namespace PerceptualColor
@@ -53,7 +58,10 @@ namespace PerceptualColor
  * and getters.
  *
  * This class has a cache. The data is cached because it is expensive to
- * calculate the image again and again on the fly.
+ * calculate the image again and again on the fly. Furthermore, the
+ * rendered images are stored in the @ref DiagramImageCache of the
+ * color space, so that other objects with the same properties (also
+ * at a smaller size, if there is no border) can use them.
  *
  * When changing one of the properties, the image is <em>not</em> calculated
  * inmediatly. But the old image in the cache is deleted, so that this
@@ -91,13 +99,20 @@ public:
     QImage getImage();
     void setBorder(const qreal newBorder);
     void setChromaRange(const qreal newChromaRange);
+    void setCancelFlag(const std::atomic<bool> *newCancelFlag);
+    void setColorModel(const ColorModel newColorModel);
     void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
+    void setExactRendering(const bool newExactRendering);
     void setImageSize(const int newImageSize);
     void setLightness(const qreal newLightness);
 
 private:
     Q_DISABLE_COPY(ChromaHueImage)
 
+    QString cacheKey() const;
+    bool isScalable() const;
+
     /** @internal @brief Only for unit tests. */
     friend class TestChromaHueImage;
 
@@ -105,11 +120,32 @@ private:
      *
      * @sa @ref setBorder() */
     qreal m_borderPhysical = 0;
+    /** @brief Internal store for the cancel flag.
+     *
+     * @sa @ref setCancelFlag() */
+    const std::atomic<bool> *m_cancelFlag = nullptr;
+    /** @brief Internal store for the color model.
+     *
+     * @sa @ref setColorModel() */
+    ColorModel m_colorModel = ColorModel::CielchD50;
     /** @brief Internal storage of the device pixel ratio property
      * as floating point.
      *
      * @sa @ref setDevicePixelRatioF() */
     qreal m_devicePixelRatioF = 1;
+    /** @brief Internal store for the display profile.
+     *
+     * @sa @ref setDisplayProfile() */
+    QByteArray m_displayProfile;
+    /** @brief Transform to the display, or <tt>nullptr</tt> if no display
+     * profile is used.
+     *
+     * @sa @ref setDisplayProfile() */
+    QSharedPointer<DisplayTransform> m_displayTransform;
+    /** @brief Internal store for the exact rendering property.
+     *
+     * @sa @ref setExactRendering() */
+    bool m_exactRendering = false;
     /** @brief Internal storage of the image (cache).
      *
      * - If <tt>m_image.isNull()</tt> than either no cache is available
@@ -0,0 +1,78 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "chromalightnessboundary.h"
+
+#include <QtMath>
+
+#include <limits>
+
+namespace PerceptualColor
+{
+/** @brief The lightness of a row.
+ *
+ * @param row The row index, within <tt>[0, @ref rowCount[</tt>
+ * @returns The lightness of this row. */
+qreal ChromaLightnessBoundary::rowLightness(int row)
+{
+    return 100 - row * 100.0 / (rowCount - 1);
+}
+
+/** @brief An upper estimate of the maximum in-gamut chroma.
+ *
+ * Uses the maximum of the two neighboring rows plus
+ * @ref estimateTolerance, so that the boundary between the rows is
+ * covered. Callers can skip colors beyond this chroma without any
+ * in-gamut test; colors below still need an exact test.
+ *
+ * @param lightness The lightness
+ * @returns The estimate. Negative if both neighboring rows are
+ * out-of-gamut. Infinity if the boundary has not
+ * @ref hasContiguousRows, so that callers skip nothing. */
+qreal ChromaLightnessBoundary::maximumChromaEstimate(qreal lightness) const
+{
+    if (!hasContiguousRows) {
+        return std::numeric_limits<qreal>::infinity();
+    }
+    if (maximumChroma.count() != rowCount) {
+        return -1;
+    }
+    const qreal position = qBound<qreal>(0, (100 - lightness) * (rowCount - 1) / 100.0, rowCount - 1);
+    const int lowerRow = qFloor(position);
+    const int upperRow = qMin(lowerRow + 1, rowCount - 1);
+    const qreal result = qMax(maximumChroma.at(lowerRow), maximumChroma.at(upperRow));
+    if (result < 0) {
+        return -1;
+    }
+    return result + estimateTolerance;
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,99 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CHROMALIGHTNESSBOUNDARY_H
+#define CHROMALIGHTNESSBOUNDARY_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QVector>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The gamut boundary within a chroma-lightness plane.
+ *
+ * For a given hue, this stores the maximum in-gamut chroma for
+ * @ref rowCount lightness values that are equally distributed
+ * from <tt>100</tt> (row <tt>0</tt>) to <tt>0</tt> (the last row).
+ *
+ * It is calculated once per hue by
+ * @ref RgbColorSpace::chromaLightnessBoundary() and shared between the
+ * nearest-in-gamut search and the rendering of
+ * @ref ChromaLightnessImage, so that a hue change costs a single
+ * evaluation of the chroma-lightness plane.
+ *
+ * Within each row, the in-gamut range is supposed to go from chroma
+ * <tt>0</tt> up to the maximum chroma of the row. This is true for usual
+ * RGB profiles, but not guaranteed for arbitrary ICC profiles. Therefore,
+ * @ref RgbColorSpace verifies it when calculating the boundary, see
+ * @ref hasContiguousRows. */
+struct ChromaLightnessBoundary {
+public:
+    qreal maximumChromaEstimate(qreal lightness) const;
+    static qreal rowLightness(int row);
+
+    /** @brief Number of lightness rows. */
+    static constexpr int rowCount = 401;
+    /** @brief Recommended spacing of the hues for which boundaries are
+     * requested.
+     *
+     * Equals the column spacing of @ref ChromaHueBoundary. Callers that
+     * follow a continuously changing hue (like a drag) should request
+     * only multiples of this value and interpolate between them.
+     * Otherwise, each new hue would be a cache miss in
+     * @ref RgbColorSpace::chromaLightnessBoundary(). */
+    static constexpr qreal hueStep = 1;
+    /** @brief Safety margin of @ref maximumChromaEstimate(), measured
+     * in chroma. */
+    static constexpr qreal estimateTolerance = 2;
+
+    /** @brief The hue, normalized to <tt>[0, 360[</tt>. */
+    qreal hue;
+    /** @brief The maximum in-gamut chroma for each row.
+     *
+     * Negative if the gray of this row is out-of-gamut (which means it is
+     * below the blackpoint or above the whitepoint). */
+    QVector<qreal> maximumChroma;
+    /** @brief If, within each row, the in-gamut range goes from chroma
+     * <tt>0</tt> up to @ref maximumChroma, without gaps.
+     *
+     * If <tt>false</tt>, the profile has in-gamut colors beyond
+     * @ref maximumChroma or out-of-gamut colors below. Then,
+     * @ref maximumChroma is meaningless, and callers have to test the
+     * gamut exactly.
+     *
+     * @note This is weaker than a convex gamut: Each row has to be
+     * contiguous, but the outline of the chroma-lightness plane may
+     * still have concave parts. */
+    bool hasContiguousRows = true;
+};
+
+} // namespace PerceptualColor
+
+#endif // CHROMALIGHTNESSBOUNDARY_H
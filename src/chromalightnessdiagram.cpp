@@ -33,8 +33,11 @@
 // Second, the private implementation.
 #include "chromalightnessdiagram_p.h"
 
+#include "chromalightnessboundary.h"
 #include "helper.h"
 #include "lchvalues.h"
+#include "performancehud.h"
+#include "rgbcolorspace.h"
 
 #include <QApplication>
 #include <QDebug>
@@ -294,9 +297,9 @@ void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
     painter.setRenderHint(QPainter::Antialiasing, false);
     painter.drawImage(
         // Operating in physical pixels:
-        d_pointer->leftBorderPhysical(),             // x position (top-left)
-        d_pointer->defaultBorderPhysical(),          // y position (top-left)
-        d_pointer->m_chromaLightnessImage.getImage() // image
+        d_pointer->leftBorderPhysical(),                               // x position (top-left)
+        d_pointer->defaultBorderPhysical(),                            // y position (top-left)
+        PerformanceHud::image(this, d_pointer->m_chromaLightnessImage) // image
     );
 
     // Paint a focus indicator.
@@ -351,6 +354,18 @@ void ChromaLightnessDiagram::paintEvent(QPaintEvent *event)
         painter.drawLine(pointOne, pointTwo);
     }
 
+    // Paint the gamut outline of the second color space (if any)
+    const QPolygonF outline = d_pointer->outlinePolyline();
+    if (!outline.isEmpty()) {
+        pen = QPen();
+        pen.setWidthF(handleOutlineThickness() * devicePixelRatioF());
+        pen.setColor(handleColorFromBackgroundLightness(d_pointer->m_currentColor.l));
+        pen.setStyle(Qt::DashLine);
+        painter.setPen(pen);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.drawPolyline(outline);
+    }
+
     // Paint the handle on-the-fly.
     const int diagramHeight = d_pointer->calculateImageSizePhysical().height();
     QPointF colorCoordinatePoint = QPointF(
@@ -566,6 +581,131 @@ QSize ChromaLightnessDiagram::minimumSizeHint() const
     return QSize(minimumWidth, minimumHeight).expandedTo(QApplication::globalStrut());
 }
 
+/** @brief The gamut outline of @ref outlineColorSpace() at the hue
+ * of @ref currentColor.
+ *
+ * The outline comes from the cached
+ * @ref RgbColorSpace::chromaLightnessBoundary(). Only the hues of the
+ * grid of @ref ChromaLightnessBoundary::hueStep are requested, and the
+ * outline is interpolated linearly between the two neighboring ones.
+ * So it is cheap even when the hue changes continuously: Most paint
+ * events hit the cache. It starts and ends on the gray axis, at the
+ * blackpoint and the whitepoint of @ref outlineColorSpace().
+ *
+ * @returns The outline as polyline in physical pixels of the paint
+ * buffer. Empty if there is no @ref outlineColorSpace(). */
+QPolygonF ChromaLightnessDiagram::ChromaLightnessDiagramPrivate::outlinePolyline() const
+{
+    QPolygonF result;
+    if (m_outlineColorSpace.isNull()) {
+        return result;
+    }
+    const qreal position = m_currentColor.h / ChromaLightnessBoundary::hueStep;
+    if (!qIsFinite(position)) {
+        return result;
+    }
+    const qreal lowerPosition = std::floor(position);
+    const qreal fraction = position - lowerPosition;
+    const QSharedPointer<const ChromaLightnessBoundary> lower = //
+        m_outlineColorSpace->chromaLightnessBoundary(lowerPosition * ChromaLightnessBoundary::hueStep);
+    const QSharedPointer<const ChromaLightnessBoundary> upper = (fraction > 0) //
+        ? m_outlineColorSpace->chromaLightnessBoundary((lowerPosition + 1) * ChromaLightnessBoundary::hueStep)
+        : lower;
+    const qreal diagramHeight = calculateImageSizePhysical().height();
+    const QPointF offset(leftBorderPhysical(), defaultBorderPhysical());
+    const auto toPhysical = [diagramHeight, offset](qreal chroma, qreal lightness) {
+        return QPointF(
+                   // x:
+                   chroma * diagramHeight / 100.0,
+                   // y:
+                   lightness * diagramHeight / 100.0 * (-1) + diagramHeight)
+            + offset;
+    };
+    result.reserve(ChromaLightnessBoundary::rowCount + 2);
+    for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+        const qreal lowerChroma = lower->maximumChroma.at(row);
+        const qreal upperChroma = upper->maximumChroma.at(row);
+        // Rows with an out-of-gamut gray are not part of the outline.
+        // This depends only on the lightness, so it is the same for
+        // both hues.
+        if ((lowerChroma < 0) || (upperChroma < 0)) {
+            continue;
+        }
+        const qreal chroma = lowerChroma + fraction * (upperChroma - lowerChroma);
+        const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+        if (result.isEmpty()) {
+            // Start on the gray axis
+            result.append(toPhysical(0, lightness));
+        }
+        result.append(toPhysical(chroma, lightness));
+    }
+    if (!result.isEmpty()) {
+        // End on the gray axis
+        result.append(QPointF(offset.x(), result.last().y()));
+    }
+    return result;
+}
+
+/** @brief The ICC profile of the monitor.
+ *
+ * @returns The raw data of the ICC profile of the monitor, or an empty
+ * byte array (default) if none has been set.
+ *
+ * @sa @ref setDisplayProfile() */
+QByteArray ChromaLightnessDiagram::displayProfile() const
+{
+    return d_pointer->m_displayProfile;
+}
+
+/** @brief Sets the ICC profile of the monitor.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the
+ * monitor. The diagram converts its colors directly to the RGB values
+ * of this monitor (see @ref ChromaLightnessImage::setDisplayProfile()).
+ * An empty byte array means no conversion.
+ *
+ * @sa @ref displayProfile() */
+void ChromaLightnessDiagram::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (d_pointer->m_displayProfile == newDisplayProfile) {
+        return;
+    }
+    d_pointer->m_displayProfile = newDisplayProfile;
+    d_pointer->m_chromaLightnessImage.setDisplayProfile(newDisplayProfile);
+    update();
+}
+
+/** @brief The color space whose gamut outline is drawn on the diagram.
+ *
+ * @returns The color space whose gamut outline is drawn on top of the
+ * diagram, or <tt>nullptr</tt> if no outline is drawn. Default value
+ * is <tt>nullptr</tt>.
+ *
+ * @sa @ref setOutlineColorSpace() */
+QSharedPointer<PerceptualColor::RgbColorSpace> ChromaLightnessDiagram::outlineColorSpace() const
+{
+    return d_pointer->m_outlineColorSpace;
+}
+
+/** @brief Draws the gamut outline of a second color space.
+ *
+ * The diagram shows the gamut of its own color space, and on top of it,
+ * the outline of the gamut of <em>newOutlineColorSpace</em> is drawn as
+ * a dashed line, at the hue of @ref currentColor.
+ *
+ * @param newOutlineColorSpace The color space whose gamut outline is
+ * drawn, or <tt>nullptr</tt> to not draw any outline.
+ *
+ * @sa @ref outlineColorSpace() */
+void ChromaLightnessDiagram::setOutlineColorSpace(const QSharedPointer<PerceptualColor::RgbColorSpace> &newOutlineColorSpace)
+{
+    if (d_pointer->m_outlineColorSpace == newOutlineColorSpace) {
+        return;
+    }
+    d_pointer->m_outlineColorSpace = newOutlineColorSpace;
+    update();
+}
+
 // No documentation here (documentation of properties
 // and its getters are in the header)
 LchDouble PerceptualColor::ChromaLightnessDiagram::currentColor() const
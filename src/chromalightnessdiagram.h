@@ -34,6 +34,8 @@
 #include "PerceptualColor/constpropagatinguniquepointer.h"
 #include "PerceptualColor/lchdouble.h"
 
+#include <QByteArray>
+
 namespace PerceptualColor
 {
 class RgbColorSpace;
@@ -89,7 +91,11 @@ public:
     /** @brief Getter for property @ref currentColor
      *  @returns the property @ref currentColor */
     PerceptualColor::LchDouble currentColor() const;
+    QByteArray displayProfile() const;
     virtual QSize minimumSizeHint() const override;
+    QSharedPointer<PerceptualColor::RgbColorSpace> outlineColorSpace() const;
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
+    void setOutlineColorSpace(const QSharedPointer<PerceptualColor::RgbColorSpace> &newOutlineColorSpace);
     virtual QSize sizeHint() const override;
 
 public Q_SLOTS:
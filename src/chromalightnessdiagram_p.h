@@ -36,6 +36,8 @@
 #include "chromalightnessimage.h"
 #include "constpropagatingrawpointer.h"
 
+#include <QPolygonF>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -73,6 +75,10 @@ public:
      * circular widget, only reacting on mouse events within the circle;
      * this requires this custom implementation. */
     bool m_isMouseEventActive = false; // TODO Remove me!
+    /** @brief Internal storage for @ref displayProfile() */
+    QByteArray m_displayProfile;
+    /** @brief Internal storage for @ref outlineColorSpace() */
+    QSharedPointer<RgbColorSpace> m_outlineColorSpace;
     /** @brief Pointer to RgbColorSpace() object */
     QSharedPointer<RgbColorSpace> m_rgbColorSpace;
 
@@ -82,6 +88,7 @@ public:
     LchDouble fromWidgetPixelPositionToColor(const QPoint widgetPixelPosition) const;
     bool isWidgetPixelPositionInGamut(const QPoint widgetPixelPosition) const;
     int leftBorderPhysical() const;
+    QPolygonF outlinePolyline() const;
     void setCurrentColorFromWidgetPixelPosition(const QPoint widgetPixelPosition);
 
 private:
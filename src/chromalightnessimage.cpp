@@ -31,10 +31,11 @@
 // First the interface, which forces the header to be self-contained.
 #include "chromalightnessimage.h"
 
+#include "diagramimagecache.h"
 #include "lchvalues.h"
 #include "polarpointf.h"
-
-#include <QPainter>
+#include "slicerenderer.h"
+#include "tracepoints.h"
 
 namespace PerceptualColor
 {
@@ -49,10 +50,7 @@ ChromaLightnessImage::ChromaLightnessImage(const QSharedPointer<PerceptualColor:
 /** @brief Setter for the backgroundColor property.
  *
  * @param newBackgroundColor The new background color. Set this to an
- * invalid <tt>QColor</tt> to get the default background.
- *
- * @todo This function should become obsolete once @ref RgbColorSpace
- * does not rely anymore on an image to find nearest in-gamut colors. */
+ * invalid <tt>QColor</tt> to get the default background. */
 void ChromaLightnessImage::setBackgroundColor(const QColor newBackgroundColor)
 {
     if (m_backgroundColor != newBackgroundColor) {
@@ -62,6 +60,92 @@ void ChromaLightnessImage::setBackgroundColor(const QColor newBackgroundColor)
     }
 }
 
+/** @brief Setter for the exact rendering property.
+ *
+ * @param newExactRendering If <tt>true</tt>, the image is always rendered
+ * directly at the requested size. If <tt>false</tt> (default), it might
+ * be derived from a bigger rendering in the @ref DiagramImageCache of the
+ * color space, which is much faster, but differs slightly in the
+ * anti-aliasing at the gamut boundary. */
+void ChromaLightnessImage::setExactRendering(const bool newExactRendering)
+{
+    if (m_exactRendering != newExactRendering) {
+        m_exactRendering = newExactRendering;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the device pixel ratio (floating point).
+ *
+ * This value is set as device pixel ratio (floating point) in the
+ * QImage that this class holds. It does <em>not</em> change
+ * the <em>pixel</em> size of the image.
+ *
+ * This is for HiDPI support. You can set this to
+ * <tt>QWidget::devicePixelRatioF()</tt> to get HiDPI images in the correct
+ * resolution for your widgets.
+ *
+ * The default value is <tt>1</tt> which means no special scaling.
+ *
+ * @param newDevicePixelRatioF the new device pixel ratio as a
+ * floating point data type. (Values smaller than <tt>1.0</tt> will be
+ * considered as <tt>1.0</tt>.) */
+void ChromaLightnessImage::setDevicePixelRatioF(const qreal newDevicePixelRatioF)
+{
+    const qreal tempDevicePixelRatioF = qMax<qreal>(1, newDevicePixelRatioF);
+    if (m_devicePixelRatioF != tempDevicePixelRatioF) {
+        m_devicePixelRatioF = tempDevicePixelRatioF;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the display profile property.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the monitor.
+ * If it is a valid RGB profile, the in-gamut pixels are converted with a
+ * single transform directly from Lab to the RGB values of the monitor
+ * (see @ref DisplayTransform). If it is empty (default), the RGB values
+ * of the color space are used, which Qt interprets as sRGB. */
+void ChromaLightnessImage::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (m_displayProfile != newDisplayProfile) {
+        m_displayProfile = newDisplayProfile;
+        m_displayTransform = m_rgbColorSpace->displayTransform(newDisplayProfile);
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
+/** @brief Setter for the cancel flag.
+ *
+ * @param newCancelFlag Pointer to a flag that another thread can set to
+ * <tt>true</tt> to cancel a running @ref getImage(). It is checked
+ * before each row of the gamut. The flag must stay valid as long as
+ * this object uses it. <tt>nullptr</tt> (default) means that the
+ * rendering cannot be canceled.
+ *
+ * A canceled rendering returns a null image, and caches nothing. */
+void ChromaLightnessImage::setCancelFlag(const std::atomic<bool> *newCancelFlag)
+{
+    m_cancelFlag = newCancelFlag;
+}
+
+/** @brief Setter for the color model property.
+ *
+ * @param newColorModel The color model in which the hue is interpreted,
+ * and in which the chroma-lightness plane is laid out. Default value
+ * is @ref ColorModel::CielchD50. */
+void ChromaLightnessImage::setColorModel(const ColorModel newColorModel)
+{
+    if (m_colorModel != newColorModel) {
+        m_colorModel = newColorModel;
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
 /** @brief Setter for the image size property.
  *
  * This value fixes the size of the image.
@@ -121,58 +205,80 @@ QImage ChromaLightnessImage::getImage()
         return m_image;
     }
 
+    // Maybe the image (or a bigger one) has yet been rendered by another
+    // object that uses the same color space.
+    DiagramImageCache *const sharedCache = m_rgbColorSpace->diagramImageCache();
+    const QString key = cacheKey();
+    if (!m_imageSizePhysical.isEmpty()) {
+        m_image = sharedCache->find(key, m_imageSizePhysical, !m_exactRendering);
+        if (!m_image.isNull()) {
+            return m_image;
+        }
+    }
+
+    PERCEPTUALCOLOR_TRACE_SCOPE1(chroma_lightness_image_render, m_imageSizePhysical.width() * m_imageSizePhysical.height());
+
     // If no image is in cache, create a new one (in the cache) with
     // correct image size.
     m_image = QImage(m_imageSizePhysical, QImage::Format_ARGB32_Premultiplied);
     // Test if image size is empty.
     if (m_image.size().isEmpty()) {
+        m_image.setDevicePixelRatio(m_devicePixelRatioF);
         // The image must be non-empty (otherwise, our algorithm would
         // crash because of a division by 0).
         return m_image;
     }
 
-    // Initialization
-    LchDouble LCh;
-    QColor rgbColor;
-    int x;
-    int y;
-    const int imageHeight = m_imageSizePhysical.height();
-    const int imageWidth = m_imageSizePhysical.width();
-
     // Initialize the image background
     if (m_backgroundColor.isValid()) {
         m_image.fill(m_backgroundColor);
+    } else if (m_displayTransform) {
+        m_image.fill(m_displayTransform->toRgb(LchValues::neutralGray()));
     } else {
         m_image.fill(m_rgbColorSpace->toQColorRgbBound(LchValues::neutralGray()));
     }
 
-    // Paint the gamut.
-    LCh.h = PolarPointF::normalizedAngleDegree(m_hue);
-    for (y = 0; y < imageHeight; ++y) {
-        LCh.l = 100 - (y + 0.5) * 100.0 / imageHeight;
-        for (x = 0; x < imageWidth; ++x) {
-            // Using the same scale as on the y axis. floating point
-            // division thanks to 100 which is a "cmsFloat64Number"
-            LCh.c = (x + 0.5) * 100.0 / imageHeight;
-            rgbColor = m_rgbColorSpace->toQColorRgbUnbound(LCh);
-            if (rgbColor.isValid()) {
-                // The pixel is within the gamut
-                m_image.setPixelColor(x, y, rgbColor);
-                // If color is out-of-gamut: We have chroma on the x axis and
-                // lightness on the y axis. We are drawing the pixmap line per
-                // line, so we go for given lightness from low chroma to high
-                // chroma. Because of the nature of most gamuts, if once in a
-                // line we have an out-of-gamut value, all other pixels that
-                // are more at the right will be out-of-gamut also. So we
-                // could optimize our code and break here. But as we are not
-                // sure about this (we do not know the gamut at compile time)
-                // for the moment we do not optimize the code.
-            }
-        }
+    // Paint the gamut. Both axes use the same scale, given by the
+    // lightness range [0, 100] on the y axis.
+    const SliceRenderer::Plane plane = SliceRenderer::Plane::constantHue( //
+        m_colorModel,
+        PolarPointF::normalizedAngleDegree(m_hue),
+        100.0 / m_imageSizePhysical.height());
+    if (!SliceRenderer::paintGamut(&m_image, plane, *m_rgbColorSpace, m_displayTransform.data(), m_cancelFlag)) {
+        // Never keep or cache an incomplete image.
+        m_image = QImage();
+        return m_image;
     }
 
+    // Set the correct scaling information for the image. The diagram
+    // scales: Smaller sizes with the same aspect ratio can be derived
+    // from it.
+    m_image.setDevicePixelRatio(m_devicePixelRatioF);
+    sharedCache->insert(key, m_image, true);
+
     // Now return the cache.
     return m_image;
 }
 
+/** @brief The key for the diagram image cache of the color space.
+ *
+ * @returns A key that describes all properties apart from the
+ * image size.
+ *
+ * @sa @ref RgbColorSpace::diagramImageCache() */
+QString ChromaLightnessImage::cacheKey() const
+{
+    const QString background = m_backgroundColor.isValid() //
+        ? QString::number(static_cast<quint64>(m_backgroundColor.rgba64()), 16)
+        : QString();
+    return QStringLiteral("chromalightness?hue=%1&model=%2&background=%3&dpr=%4&display=%5")
+        .arg(QString::number(m_hue, 'g', 17),
+             QString::number(static_cast<int>(m_colorModel)),
+             background,
+             QString::number(m_devicePixelRatioF, 'g', 17),
+             m_displayTransform.isNull() //
+                 ? QString()
+                 : QString::fromLatin1(m_displayTransform->profileHash()));
+}
+
 } // namespace PerceptualColor
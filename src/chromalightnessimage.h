@@ -32,7 +32,12 @@
 
 #include <QImage>
 #include <QSharedPointer>
+#include <QString>
 
+#include <atomic>
+
+#include "colormodel.h"
+#include "displaytransform.h"
 #include "rgbcolorspace.h"
 
 namespace PerceptualColor
@@ -47,7 +52,10 @@ namespace PerceptualColor
  * and getters.
  *
  * This class has a cache. The data is cached because it is expensive to
- * calculate the image again and again on the fly.
+ * calculate the image again and again on the fly. Furthermore, the
+ * rendered images are stored in the @ref DiagramImageCache of the
+ * color space, so that other objects with the same properties (also
+ * at a smaller size with the same aspect ratio) can use them.
  *
  * When changing one of the properties, the image is <em>not</em> calculated
  * inmediatly. But the old image in the cache is deleted, so that this
@@ -63,6 +71,8 @@ namespace PerceptualColor
  * usage, as no memory will be hold for data that will not be
  * needed again.)
  *
+ * This class supports HiDPI via its @ref setDevicePixelRatioF function.
+ *
  * @note Resetting a property to its very same value does not trigger an
  * image calculation. So, if the hue is 5, and you call @ref setHue
  * <tt>(5)</tt>, than this will not trigger an image calculation, but the
@@ -82,12 +92,19 @@ public:
     explicit ChromaLightnessImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
     QImage getImage();
     void setBackgroundColor(const QColor newBackgroundColor);
+    void setCancelFlag(const std::atomic<bool> *newCancelFlag);
+    void setColorModel(const ColorModel newColorModel);
+    void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
+    void setExactRendering(const bool newExactRendering);
     void setHue(const qreal newHue);
     void setImageSize(const QSize newImageSize);
 
 private:
     Q_DISABLE_COPY(ChromaLightnessImage)
 
+    QString cacheKey() const;
+
     /** @internal @brief Only for unit tests. */
     friend class TestChromaLightnessImage;
 
@@ -95,6 +112,32 @@ private:
      *
      * @sa @ref setBackgroundColor() */
     QColor m_backgroundColor;
+    /** @brief Internal store for the cancel flag.
+     *
+     * @sa @ref setCancelFlag() */
+    const std::atomic<bool> *m_cancelFlag = nullptr;
+    /** @brief Internal store for the color model.
+     *
+     * @sa @ref setColorModel() */
+    ColorModel m_colorModel = ColorModel::CielchD50;
+    /** @brief Internal storage of the device pixel ratio property
+     * as floating point.
+     *
+     * @sa @ref setDevicePixelRatioF() */
+    qreal m_devicePixelRatioF = 1;
+    /** @brief Internal store for the display profile.
+     *
+     * @sa @ref setDisplayProfile() */
+    QByteArray m_displayProfile;
+    /** @brief Transform to the display, or <tt>nullptr</tt> if no display
+     * profile is used.
+     *
+     * @sa @ref setDisplayProfile() */
+    QSharedPointer<DisplayTransform> m_displayTransform;
+    /** @brief Internal store for the exact rendering property.
+     *
+     * @sa @ref setExactRendering() */
+    bool m_exactRendering = false;
     /** @brief Internal store for the hue.
      *
      * This is the hue (h) value in the LCH color model.
@@ -43,10 +43,14 @@
 #include <QVBoxLayout>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "csscolor.h"
 #include "helper.h"
 #include "lchvalues.h"
+#include "oklab.h"
+#include "palette.h"
 #include "refreshiconengine.h"
 #include "rgbcolorspace.h"
+#include "tracepoints.h"
 
 namespace PerceptualColor
 {
@@ -178,6 +182,54 @@ void ColorDialog::ColorDialogPrivate::setCurrentColorWithAlpha(const MultiColor
     setCurrentOpaqueColor(color, nullptr);
 }
 
+/** @brief Loads a palette file and shows its colors in the dialog.
+ *
+ * The colors are shown in an additional tab. When the user clicks on
+ * a color, it becomes the @ref currentColor. Loading another palette
+ * replaces the colors of the previous one.
+ *
+ * Supported file formats are GIMP palettes (<tt>.gpl</tt>), Adobe Swatch
+ * Exchange (<tt>.ase</tt>) and CSS custom properties. The format is
+ * detected from the content. RGB values are interpreted in the color
+ * space of this dialog. Even palettes with thousands of colors load
+ * quickly, because all colors are converted in a single batch.
+ *
+ * @param fileName The name of the palette file
+ * @returns <tt>true</tt> on success. <tt>false</tt> if the file could not
+ * be read or contains no colors; the dialog is not changed then. */
+bool ColorDialog::loadPalette(const QString &fileName)
+{
+    Palette palette;
+    if (!Palette::readFromFile(d_pointer->m_rgbColorSpace, fileName, &palette)) {
+        return false;
+    }
+    if (d_pointer->m_paletteView.isNull()) {
+        d_pointer->m_paletteModel = new PaletteModel( //
+            d_pointer->m_rgbColorSpace,
+            d_pointer.operator->());
+        d_pointer->m_paletteView = new QListView();
+        // Palettes might have thousands of entries. With uniform item
+        // sizes, the view does not need to measure each of them.
+        d_pointer->m_paletteView->setUniformItemSizes(true);
+        d_pointer->m_paletteView->setModel(d_pointer->m_paletteModel);
+        d_pointer->m_paletteView->setAccessibleName(tr("Palette"));
+        connect(d_pointer->m_paletteView,               // sender
+                &QListView::clicked,                    // signal
+                d_pointer.operator->(),                 // receiver
+                &ColorDialogPrivate::readPaletteValue); // slot
+        connect(d_pointer->m_paletteView,               // sender
+                &QListView::activated,                  // signal
+                d_pointer.operator->(),                 // receiver
+                &ColorDialogPrivate::readPaletteValue); // slot
+        d_pointer->m_tabWidget->addTab(d_pointer->m_paletteView, tr("&Palette"));
+    }
+    d_pointer->m_paletteModel->setPalette(palette);
+    d_pointer->m_tabWidget->setTabToolTip( //
+        d_pointer->m_tabWidget->indexOf(d_pointer->m_paletteView),
+        palette.title());
+    return true;
+}
+
 /** @brief Opens the dialog and connects its @ref colorSelected() signal to
  * the slot specified by receiver and member.
  *
@@ -233,6 +285,8 @@ void ColorDialog::ColorDialogPrivate::setCurrentOpaqueColor(const PerceptualColo
         return;
     }
 
+    PERCEPTUALCOLOR_TRACE_SCOPE(color_dialog_fan_out);
+
     // If we have really some work to do, block recursive calls of this function
     m_isColorChangeInProgress = true;
 
@@ -271,6 +325,11 @@ void ColorDialog::ColorDialogPrivate::setCurrentOpaqueColor(const PerceptualColo
         m_hlcSpinBox->setSectionValues(m_currentOpaqueColor.toHlc());
     }
 
+    // Update Oklch widget
+    if (m_oklchSpinBox != ignoreWidget) {
+        updateOklchButBlockSignals();
+    }
+
     // Update RGB hex widget
     if (m_rgbLineEdit != ignoreWidget) {
         updateRgbHexButBlockSignals();
@@ -376,17 +435,34 @@ void ColorDialog::ColorDialogPrivate::readChromaHueDiagramValue()
         m_chromaHueDiagram);
 }
 
+/** @brief Reads the color of an entry of the palette view and
+ * updates the dialog accordingly.
+ *
+ * @param index The index of the entry in @ref m_paletteModel */
+void ColorDialog::ColorDialogPrivate::readPaletteValue(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    const LchaDouble color = index.data(PaletteModel::lchaRole).value<LchaDouble>();
+    // Palette has already moved all colors into the gamut.
+    setCurrentColorWithAlpha( //
+        MultiColor::fromLch(m_rgbColorSpace, LchDouble(color.l, color.c, color.h)),
+        color.a);
+}
+
 /** @brief Reads the hexadecimal RGB numbers in the dialog and
  * updates the dialog accordingly. */
 void ColorDialog::ColorDialogPrivate::readRgbHexValues()
 {
-    QString temp = m_rgbLineEdit->text();
-    if (!temp.startsWith(QStringLiteral(u"#"))) {
-        temp = QStringLiteral(u"#") + temp;
-    }
-    QColor rgb;
-    rgb.setNamedColor(temp);
-    if (rgb.isValid()) {
+    // The leading “#” is optional, so parseHex() is used instead of the
+    // full CSS parser.
+    const QString text = m_rgbLineEdit->text();
+    CssColor::Value value;
+    if (CssColor::parseHex(QStringView(text), &value)) {
+        const QColor rgb = QColor::fromRgbF(value.rgb.red, //
+                                            value.rgb.green,
+                                            value.rgb.blue);
         setCurrentOpaqueColor(MultiColor::fromRgbQColor(m_rgbColorSpace, rgb), m_rgbLineEdit);
     } else {
         m_isDirtyRgbLineEdit = true;
@@ -409,19 +485,13 @@ void ColorDialog::ColorDialogPrivate::updateRgbHexButBlockSignals()
     // We cannot use QColor.name() directly because this function seems
     // to use floor() instead of round(), which does not make sense in
     // our dialog, and it would be inconsistend with the other widgets
-    // of the dialog. Therefore, we have to round explicitly (to integers):
-    // This format string provides a non-localized format!
-    // Format of the numbers:
-    // 1) The number itself
-    // 2) The minimal field width (2 digits)
-    // 3) The base of the number representation (16, hexadecimal)
-    // 4) The fill character (leading zero)
-    const QString hexString = QStringLiteral(u"#%1%2%3")
-                                  .arg(qRound(rgbColor.redF() * 255), 2, 16, QLatin1Char('0'))
-                                  .arg(qRound(rgbColor.greenF() * 255), 2, 16, QLatin1Char('0'))
-                                  .arg(qRound(rgbColor.blueF() * 255), 2, 16, QLatin1Char('0'))
-                                  .toUpper(); // Convert to upper case
-    m_rgbLineEdit->setText(hexString);
+    // of the dialog. CssColor::format() rounds (to integers) and
+    // provides a non-localized format with upper-case digits.
+    CssColor::Value value;
+    value.rgb = RgbDouble {rgbColor.redF(), rgbColor.greenF(), rgbColor.blueF()};
+    char buffer[CssColor::maximumFormattedLength + 1];
+    const int length = CssColor::format(value, CssColor::Syntax::Hex, buffer);
+    m_rgbLineEdit->setText(QString::fromLatin1(buffer, length));
 }
 
 /** @brief Basic initialization.
@@ -548,6 +618,16 @@ void ColorDialog::ColorDialogPrivate::initialize(const QSharedPointer<Perceptual
             this,                                         // receiver
             &ColorDialogPrivate::updateHlcButBlockSignals // slot
     );
+    connect(m_oklchSpinBox,                             // sender
+            &MultiSpinBox::sectionValuesChanged,        // signal
+            this,                                       // receiver
+            &ColorDialogPrivate::readOklchNumericValues // slot
+    );
+    connect(m_oklchSpinBox,                                 // sender
+            &MultiSpinBox::editingFinished,                 // signal
+            this,                                           // receiver
+            &ColorDialogPrivate::updateOklchButBlockSignals // slot
+    );
     connect(m_lchLightnessSelector,                 // sender
             &GradientSlider::valueChanged,          // signal
             this,                                   // receiver
@@ -666,6 +746,39 @@ void ColorDialog::ColorDialogPrivate::readHlcNumericValues()
         m_hlcSpinBox);
 }
 
+/** @brief Updates the Oklch spin box to @ref m_currentOpaqueColor.
+ *
+ * @post The @ref m_oklchSpinBox gets the value of @ref m_currentOpaqueColor.
+ * During this operation, all signals of @ref m_oklchSpinBox are blocked. */
+void ColorDialog::ColorDialogPrivate::updateOklchButBlockSignals()
+{
+    const LchDouble oklch = m_currentOpaqueColor.toOklch();
+    QSignalBlocker mySignalBlocker(m_oklchSpinBox);
+    m_oklchSpinBox->setSectionValues(QList<double> {oklch.l, oklch.c, oklch.h});
+}
+
+/** @brief Reads the Oklch numbers in the dialog and
+ * updates the dialog accordingly.
+ *
+ * The gamut is enforced in CIELCh, like for the HLC numbers. So the
+ * resulting color might have a slightly different Oklch hue. */
+void ColorDialog::ColorDialogPrivate::readOklchNumericValues()
+{
+    const QList<double> oklchValues = m_oklchSpinBox->sectionValues();
+    LchDouble oklch;
+    oklch.l = oklchValues.at(0);
+    oklch.c = oklchValues.at(1);
+    oklch.h = oklchValues.at(2);
+    const cmsCIELab cielab = OkLab::toCielabD50(OkLab::fromOklch(oklch));
+    setCurrentOpaqueColor( //
+        MultiColor::fromLch( //
+            m_rgbColorSpace,
+            m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness( //
+                m_rgbColorSpace->toLch(cielab))),
+        // widget that will ignored during updating:
+        m_oklchSpinBox);
+}
+
 /** @brief Initialize the numeric input widgets of this dialog.
  * @returns A pointer to a new widget that has the other, numeric input
  * widgets as child widgets. */
@@ -802,6 +915,33 @@ QWidget *ColorDialog::ColorDialogPrivate::initializeNumericPage()
                                   "<p>Chroma: 0–%1</p>")
                                    .arg(LchValues::humanMaximumChroma));
 
+    // Create widget for the Oklch color representation. Chroma has
+    // a much smaller range than in CIELCh, so it gets a decimal place.
+    QList<MultiSpinBoxSectionConfiguration> oklchSections;
+    m_oklchSpinBox = new MultiSpinBox;
+    mySection.setMinimum(0);
+    mySection.setMaximum(100);
+    mySection.setPrefix(QLatin1String());
+    mySection.setSuffix(QStringLiteral(u"% "));
+    mySection.setWrapping(false);
+    oklchSections.append(mySection);
+    mySection.setMaximum(OkLab::humanMaximumChroma);
+    mySection.setDecimals(1);
+    mySection.setPrefix(QStringLiteral(u" "));
+    mySection.setSuffix(QStringLiteral(u" "));
+    oklchSections.append(mySection);
+    mySection.setMaximum(360);
+    mySection.setDecimals(decimals);
+    mySection.setSuffix(QStringLiteral(u"°"));
+    mySection.setWrapping(true);
+    oklchSections.append(mySection);
+    m_oklchSpinBox->setSectionConfigurations(oklchSections);
+    m_oklchSpinBox->setWhatsThis(richTextMarker() +
+                                 tr("<p>Lightness: 0%–100%</p>"
+                                    "<p>Chroma: 0–%1</p>"
+                                    "<p>Hue: 0°–360°</p>")
+                                     .arg(OkLab::humanMaximumChroma));
+
     // Create a global widget
     QWidget *tempWidget = new QWidget;
     QVBoxLayout *tempMainLayout = new QVBoxLayout;
@@ -809,6 +949,7 @@ QWidget *ColorDialog::ColorDialogPrivate::initializeNumericPage()
     tempWidget->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
     QFormLayout *cielabFormLayout = new QFormLayout;
     cielabFormLayout->addRow(tr("HL&C"), m_hlcSpinBox);
+    cielabFormLayout->addRow(tr("O&klch"), m_oklchSpinBox);
     tempMainLayout->addLayout(cielabFormLayout);
     tempMainLayout->addWidget(rgbGroupBox);
     tempMainLayout->addStretch();
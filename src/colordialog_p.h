@@ -42,12 +42,15 @@
 #include "PerceptualColor/rgbcolorspacefactory.h"
 #include "PerceptualColor/wheelcolorpicker.h"
 #include "multicolor.h"
+#include "palettemodel.h"
 
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListView>
+#include <QModelIndex>
 #include <QPointer>
 #include <QTabWidget>
 
@@ -131,6 +134,17 @@ public:
     /** @brief Pointer to the widget that holds the numeric color
      *         representation. */
     QPointer<QWidget> m_numericalWidget;
+    /** @brief Pointer to the @ref MultiSpinBox for Oklch. */
+    QPointer<MultiSpinBox> m_oklchSpinBox;
+    /** @brief The colors of the palette that has been loaded with
+     * @ref ColorDialog::loadPalette().
+     *
+     * <tt>nullptr</tt> as long as no palette has been loaded. */
+    QPointer<PaletteModel> m_paletteModel;
+    /** @brief The view of @ref m_paletteModel in the tab widget.
+     *
+     * <tt>nullptr</tt> as long as no palette has been loaded. */
+    QPointer<QListView> m_paletteView;
     /** @brief Holds the receiver object (if any) to be disconnected
      *  automatically after closing the dialog.
      *
@@ -165,12 +179,15 @@ public Q_SLOTS:
     void readHlcNumericValues();
     void readHsvNumericValues();
     void readLightnessValue();
+    void readOklchNumericValues();
+    void readPaletteValue(const QModelIndex &index);
     void readRgbHexValues();
     void readRgbNumericValues();
     void readWheelColorPickerValues();
     void setCurrentOpaqueColor(const PerceptualColor::MultiColor &color, QWidget *const ignoreWidget);
     void updateColorPatch();
     void updateHlcButBlockSignals();
+    void updateOklchButBlockSignals();
     void updateRgbHexButBlockSignals();
 
 private:
@@ -0,0 +1,66 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COLORMODEL_H
+#define COLORMODEL_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The perceptual color model in which a diagram is laid out.
+ *
+ * The image generators can place their coordinate axes either in
+ * CIELCh or in Oklch. The chosen model defines how the lightness, chroma
+ * and hue values given to the generator (and the coordinate points of
+ * the resulting image) are interpreted. The color management itself
+ * (the conversion to the RGB values of the @ref RgbColorSpace) is not
+ * affected by this choice.
+ *
+ * Oklch values are scaled by <tt>100</tt> within this library, so that
+ * lightness has the same range <tt>[0, 100]</tt> as in CIELCh. See
+ * @ref OkLab for details.
+ *
+ * @note Only the image generators (and therefore @ref DiagramImageProvider)
+ * and the Oklch spin box of @ref ColorDialog support Oklch. The
+ * interactive diagrams (@ref ChromaHueDiagram, @ref ChromaLightnessDiagram
+ * and @ref WheelColorPicker) are still laid out in CIELCh only. */
+enum class ColorModel {
+    CielchD50, /**< CIELCh, based on CIELab with a D50 white point. This
+                  is the Lab connection space of LittleCMS and the
+                  default model of this library. */
+    OklchD65   /**< Oklch, the polar form of Oklab, which is based on
+                  a D65 white point. Converted to CIELab D50 with closed
+                  formulas, and for sRGB directly to RGB without any
+                  LittleCMS transform. */
+};
+
+} // namespace PerceptualColor
+
+#endif // COLORMODEL_H
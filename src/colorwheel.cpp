@@ -35,6 +35,7 @@
 
 #include "helper.h"
 #include "lchvalues.h"
+#include "performancehud.h"
 #include "polarpointf.h"
 
 #include <QApplication>
@@ -352,8 +353,8 @@ void ColorWheel::paintEvent(QPaintEvent *event)
     d_pointer->m_wheelImage.setDevicePixelRatioF(devicePixelRatioF());
     d_pointer->m_wheelImage.setImageSize(maximumPhysicalSquareSize());
     d_pointer->m_wheelImage.setWheelThickness(gradientThickness() * devicePixelRatioF());
-    bufferPainter.drawImage(QPoint(0, 0),                      // image position (top-left)
-                            d_pointer->m_wheelImage.getImage() // the image itself
+    bufferPainter.drawImage(QPoint(0, 0),                                      // image position (top-left)
+                            PerformanceHud::image(this, d_pointer->m_wheelImage) // the image itself
     );
 
     // Paint the handle
@@ -434,6 +435,39 @@ void ColorWheel::setHue(const qreal newHue)
     }
 }
 
+/** @brief The ICC profile of the monitor.
+ *
+ * @returns The raw data of the ICC profile of the monitor, or an empty
+ * byte array if none has been set. Default value is an empty byte array.
+ *
+ * @sa @ref setDisplayProfile() */
+QByteArray ColorWheel::displayProfile() const
+{
+    return d_pointer->m_displayProfile;
+}
+
+/** @brief Sets the ICC profile of the monitor.
+ *
+ * With a display profile, the wheel converts its colors directly to the
+ * RGB values of the monitor, instead of showing the RGB values of the
+ * color space as if they were sRGB. Qt does not know the profiles of
+ * the screens, so the application has to provide it, and set it again
+ * when the widget moves to another screen.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the
+ * monitor, or an empty byte array for no conversion.
+ *
+ * @sa @ref displayProfile() */
+void ColorWheel::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (d_pointer->m_displayProfile == newDisplayProfile) {
+        return;
+    }
+    d_pointer->m_displayProfile = newDisplayProfile;
+    d_pointer->m_wheelImage.setDisplayProfile(newDisplayProfile);
+    update();
+}
+
 /** @brief Setter for the @ref hue property.
  *  @param newHue the new hue
  *  @post Normalizes newHue, and than sets @ref hue to the normalized value.
@@ -53,6 +53,8 @@ public:
      * the class as a whole is <tt>final</tt>. */
     ~ColorWheelPrivate() noexcept = default;
 
+    /** @brief Internal storage for @ref displayProfile() */
+    QByteArray m_displayProfile;
     /** @brief Internal storage of the @ref hue() property */
     qreal m_hue;
     /** @brief Holds if currently a mouse event is active or not.
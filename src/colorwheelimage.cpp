@@ -33,7 +33,8 @@
 
 #include "helper.h"
 #include "lchvalues.h"
-#include "polarpointf.h"
+#include "slicerenderer.h"
+#include "tracepoints.h"
 
 #include <QPainter>
 #include <QtMath>
@@ -105,6 +106,23 @@ void ColorWheelImage::setDevicePixelRatioF(const qreal newDevicePixelRatioF)
     }
 }
 
+/** @brief Setter for the display profile property.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the monitor.
+ * If it is a valid RGB profile, the in-gamut pixels are converted with a
+ * single transform directly from Lab to the RGB values of the monitor
+ * (see @ref DisplayTransform). If it is empty (default), the RGB values
+ * of the color space are used, which Qt interprets as sRGB. */
+void ColorWheelImage::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    if (m_displayProfile != newDisplayProfile) {
+        m_displayProfile = newDisplayProfile;
+        m_displayTransform = m_rgbColorSpace->displayTransform(newDisplayProfile);
+        // Free the memory used by the old image.
+        m_image = QImage();
+    }
+}
+
 /** @brief Setter for the image size property.
  *
  * This value fixes the size of the image. The image will be a square
@@ -168,6 +186,8 @@ QImage ColorWheelImage::getImage()
         return m_image;
     }
 
+    PERCEPTUALCOLOR_TRACE_SCOPE1(color_wheel_image_render, m_imageSizePhysical);
+
     // If no cache is available (m_image.isNull()), render a new image.
 
     // Special case: zero-size-image
@@ -197,39 +217,32 @@ QImage ColorWheelImage::getImage()
     // defines an overlap for the wheel, so there are some more pixels that
     // are drawn at the outer and at the inner border of the wheel, to allow
     // later clipping with anti-aliasing
-    PolarPointF polarCoordinates;
-    int x;
-    int y;
-    QColor rgbColor;
-    LchDouble lch;
-    qreal center = (m_imageSizePhysical - 1) / static_cast<qreal>(2);
-    m_image = QImage(QSize(m_imageSizePhysical, m_imageSizePhysical), QImage::Format_ARGB32_Premultiplied);
+    //
     // Because there may be out-of-gamut colors for some hue (depending on the
     // given lightness and chroma value) which are drawn transparent, it is
-    // important to initialize this image with a transparent background.
-    m_image.fill(Qt::transparent);
-    lch.l = LchValues::neutralLightness;
-    lch.c = LchValues::srgbVersatileChroma;
-    // minimumRadial: Adding "+ 1" would reduce the workload (less pixel to
+    // important that the image has been initialized with a transparent
+    // background.
+    //
+    // The pixel at pixel position (x, y) shows the coordinate point
+    // (x + 0.5, y + 0.5), so the center of the wheel is at half the
+    // image size.
+    const qreal center = m_imageSizePhysical / static_cast<qreal>(2);
+    // minimumRadius: Adding "+ 1" would reduce the workload (less pixel to
     // process) and still work mostly, but not completely. It creates sometimes
     // artifacts in the anti-aliasing process. So we don't do that.
-    const qreal minimumRadial = center - m_wheelThicknessPhysical - m_borderPhysical - overlap;
-    const qreal maximumRadial = center - m_borderPhysical + overlap;
-    for (x = 0; x < m_imageSizePhysical; ++x) {
-        for (y = 0; y < m_imageSizePhysical; ++y) {
-            polarCoordinates = PolarPointF(QPointF(x - center, center - y));
-            if (isInRange<qreal>(minimumRadial, polarCoordinates.radial(), maximumRadial)
-
-            ) {
-                // We are within the wheel
-                lch.h = polarCoordinates.angleDegree();
-                rgbColor = m_rgbColorSpace->toQColorRgbUnbound(lch);
-                if (rgbColor.isValid()) {
-                    m_image.setPixelColor(x, y, rgbColor);
-                }
-            }
-        }
-    }
+    const qreal minimumRadius = center - 0.5 - m_wheelThicknessPhysical - m_borderPhysical - overlap;
+    const qreal maximumRadius = center - 0.5 - m_borderPhysical + overlap;
+    // All pixels are converted in batches: One conversion for the gamut
+    // test and, if necessary, one conversion to the display.
+    const SliceRenderer::Plane plane = SliceRenderer::Plane::hueWheel( //
+        ColorModel::CielchD50,
+        LchValues::neutralLightness,
+        LchValues::srgbVersatileChroma,
+        center,
+        center,
+        minimumRadius,
+        maximumRadius);
+    SliceRenderer::paintGamut(&m_image, plane, *m_rgbColorSpace, m_displayTransform.data());
 
     // Anti-aliased cut off everything outside the circle (that
     // means: the overlap)
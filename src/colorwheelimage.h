@@ -34,6 +34,7 @@
 #include <QObject>
 #include <QSharedPointer>
 
+#include "displaytransform.h"
 #include "rgbcolorspace.h"
 
 namespace PerceptualColor
@@ -84,6 +85,7 @@ public:
     QImage getImage();
     void setBorder(const qreal newBorder);
     void setDevicePixelRatioF(const qreal newDevicePixelRatioF);
+    void setDisplayProfile(const QByteArray &newDisplayProfile);
     void setImageSize(const int newImageSize);
     void setWheelThickness(const qreal newWheelThickness);
 
@@ -101,6 +103,15 @@ private:
      *
      * @sa @ref setDevicePixelRatioF() */
     qreal m_devicePixelRatioF = 1;
+    /** @brief Internal store for the display profile.
+     *
+     * @sa @ref setDisplayProfile() */
+    QByteArray m_displayProfile;
+    /** @brief Transform to the display, or <tt>nullptr</tt> if no display
+     * profile is used.
+     *
+     * @sa @ref setDisplayProfile() */
+    QSharedPointer<DisplayTransform> m_displayTransform;
     /** @brief Internal storage of the image (cache).
      *
      * - If <tt>m_image.isNull()</tt> than either no cache is available
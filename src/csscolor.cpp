@@ -0,0 +1,942 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "csscolor.h"
+
+#include "helper.h"
+
+#include <QColor>
+#include <QtMath>
+
+#include <cmath>
+#include <type_traits>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief The biggest absolute value of a number.
+ *
+ * Far beyond any meaningful color component. Parsed numbers with a
+ * bigger absolute value are clamped to this limit, and the formatter
+ * does the same, so that numbers always fit into <tt>long long</tt>
+ * after scaling with the decimal places. */
+constexpr double maximumNumber = 1e9;
+
+/** @internal
+ *
+ * @brief The ordering of the channels of 8-digit hexadecimal colors. */
+enum class HexAlpha {
+    Last, /**< CSS ordering: <tt>\#RRGGBBAA</tt> */
+    First /**< <tt>QColor</tt> ordering: <tt>\#AARRGGBB</tt> */
+};
+
+/** @internal
+ *
+ * @brief The unit of a component of a CSS color function. */
+enum class Unit {
+    Number,  /**< Plain number without unit */
+    Percent, /**< Percentage */
+    Degree,  /**< Angle in degree */
+    Radian,  /**< Angle in radian */
+    Gradian, /**< Angle in gradian */
+    Turn,    /**< Angle in turns */
+    None     /**< The keyword <tt>none</tt> */
+};
+
+/** @internal
+ *
+ * @brief Tests if a unit is allowed for a hue.
+ * @param unit The unit to test
+ * @returns <tt>true</tt> for numbers, angles and <tt>none</tt>. */
+bool isHueUnit(Unit unit)
+{
+    return (unit != Unit::Percent);
+}
+
+/** @internal
+ *
+ * @brief Tests if a unit is allowed for a non-hue component.
+ * @param unit The unit to test
+ * @returns <tt>true</tt> for numbers, percentages and <tt>none</tt>. */
+bool isNonHueUnit(Unit unit)
+{
+    return (unit == Unit::Number) //
+        || (unit == Unit::Percent) //
+        || (unit == Unit::None);
+}
+
+/** @internal
+ *
+ * @brief Converts an angle to degree.
+ * @param value The value
+ * @param unit The unit of the value. Plain numbers are interpreted as
+ * degree, as CSS does.
+ * @returns The angle in degree. */
+double toDegree(double value, Unit unit)
+{
+    switch (unit) {
+    case Unit::Radian:
+        return qRadiansToDegrees(value);
+    case Unit::Gradian:
+        return value * 0.9;
+    case Unit::Turn:
+        return value * 360;
+    default:
+        return value;
+    }
+}
+
+/** @internal
+ *
+ * @brief Conversion from HSL to RGB, following CSS Color Module Level 4.
+ * @param hue The hue, measured in degree
+ * @param saturation The saturation, within <tt>[0, 1]</tt>
+ * @param lightness The lightness, within <tt>[0, 1]</tt>
+ * @returns The RGB value. */
+RgbDouble hslToRgb(double hue, double saturation, double lightness)
+{
+    double normalizedHue = std::fmod(hue, 360);
+    if (normalizedHue < 0) {
+        normalizedHue += 360;
+    }
+    const double a = saturation * qMin(lightness, 1 - lightness);
+    const auto f = [&](double n) {
+        const double k = std::fmod(n + normalizedHue / 30, 12);
+        return lightness - a * qMax(-1.0, qMin(qMin(k - 3, 9 - k), 1.0));
+    };
+    return RgbDouble {f(0), f(8), f(4)};
+}
+
+/** @internal
+ *
+ * @brief Parser for CSS color strings.
+ *
+ * Works directly on the code units of the string, without allocating
+ * memory.
+ *
+ * @tparam Char The type of the code units: <tt>char</tt> (Latin-1 or
+ * UTF-8) or <tt>char16_t</tt> (UTF-16). Only ASCII characters are part
+ * of the CSS color syntax. */
+template<typename Char>
+class Parser
+{
+public:
+    /** @brief Constructor
+     * @param begin Pointer to the first code unit
+     * @param end Pointer behind the last code unit */
+    Parser(const Char *begin, const Char *end)
+        : m_position(begin)
+        , m_end(end)
+    {
+    }
+
+    /** @brief Parses a complete CSS color.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool parseColor(CssColor::Value *result)
+    {
+        skipWhitespace();
+        bool success;
+        if (consumeCharacter('#')) {
+            success = parseHexDigits(HexAlpha::Last, result);
+        } else if (consumeFunction("rgba") || consumeFunction("rgb")) {
+            success = parseFunction(CssColor::Syntax::Rgb, result);
+        } else if (consumeFunction("hsla") || consumeFunction("hsl")) {
+            success = parseFunction(CssColor::Syntax::Hsl, result);
+        } else if (consumeFunction("lab")) {
+            success = parseFunction(CssColor::Syntax::Lab, result);
+        } else if (consumeFunction("lch")) {
+            success = parseFunction(CssColor::Syntax::Lch, result);
+        } else {
+            return false;
+        }
+        skipWhitespace();
+        return success && atEnd();
+    }
+
+    /** @brief Parses a hexadecimal color with optional leading <tt>#</tt>.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool parseHexColor(CssColor::Value *result)
+    {
+        skipWhitespace();
+        consumeCharacter('#');
+        const bool success = parseHexDigits(HexAlpha::First, result);
+        skipWhitespace();
+        return success && atEnd();
+    }
+
+private:
+    /** @brief The current position */
+    const Char *m_position;
+    /** @brief The position behind the last code unit */
+    const Char *const m_end;
+
+    /** @brief The code unit as unsigned integer.
+     * @param character The code unit
+     * @returns The code unit as unsigned integer. */
+    static uint codeUnit(Char character)
+    {
+        if constexpr (std::is_same_v<Char, char>) {
+            return static_cast<unsigned char>(character);
+        } else {
+            return static_cast<uint>(character);
+        }
+    }
+
+    /** @brief Lower-case version of ASCII letters.
+     * @param character The code unit
+     * @returns The lower-case version for ASCII letters, the unchanged code
+     * unit otherwise. */
+    static uint toAsciiLower(Char character)
+    {
+        const uint value = codeUnit(character);
+        if ((value >= 'A') && (value <= 'Z')) {
+            return value - 'A' + 'a';
+        }
+        return value;
+    }
+
+    /** @returns If the current position is at the end. */
+    bool atEnd() const
+    {
+        return m_position == m_end;
+    }
+
+    /** @brief Advances the current position behind whitespace (if any). */
+    void skipWhitespace()
+    {
+        while (!atEnd()) {
+            const uint value = codeUnit(*m_position);
+            if ((value != ' ') && (value != '\t') && (value != '\n') //
+                && (value != '\r') && (value != '\f')) {
+                return;
+            }
+            ++m_position;
+        }
+    }
+
+    /** @brief Consumes a given character, if it is at the current position.
+     * @param character The ASCII character
+     * @returns <tt>true</tt> if the character has been consumed. */
+    bool consumeCharacter(char character)
+    {
+        if (!atEnd() && (codeUnit(*m_position) == static_cast<uint>(character))) {
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    /** @brief Consumes a keyword (case-insensitive), if it is at the
+     * current position and is not followed by other letters.
+     * @param keyword The lower-case ASCII keyword
+     * @returns <tt>true</tt> if the keyword has been consumed. */
+    bool consumeKeyword(const char *keyword)
+    {
+        const Char *position = m_position;
+        for (const char *k = keyword; *k != 0; ++k) {
+            if ((position == m_end) || (toAsciiLower(*position) != static_cast<uint>(*k))) {
+                return false;
+            }
+            ++position;
+        }
+        if (position != m_end) {
+            const uint next = toAsciiLower(*position);
+            if (((next >= 'a') && (next <= 'z')) || (next == '-') || (next == '_')) {
+                return false;
+            }
+        }
+        m_position = position;
+        return true;
+    }
+
+    /** @brief Consumes a function name (case-insensitive) and the
+     * following opening parenthesis.
+     * @param name The lower-case ASCII function name
+     * @returns <tt>true</tt> if the function name has been consumed. */
+    bool consumeFunction(const char *name)
+    {
+        const Char *const backup = m_position;
+        if (consumeKeyword(name) && consumeCharacter('(')) {
+            return true;
+        }
+        m_position = backup;
+        return false;
+    }
+
+    /** @brief Parses a number.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool parseNumber(double *result)
+    {
+        const Char *position = m_position;
+        bool isNegative = false;
+        if ((position != m_end) && ((codeUnit(*position) == '+') || (codeUnit(*position) == '-'))) {
+            isNegative = (codeUnit(*position) == '-');
+            ++position;
+        }
+        double value = 0;
+        bool hasDigits = false;
+        while ((position != m_end) && isInRange<uint>('0', codeUnit(*position), '9')) {
+            value = value * 10 + (codeUnit(*position) - '0');
+            hasDigits = true;
+            ++position;
+        }
+        if ((position != m_end) && (codeUnit(*position) == '.')) {
+            ++position;
+            double scale = 0.1;
+            while ((position != m_end) && isInRange<uint>('0', codeUnit(*position), '9')) {
+                value += (codeUnit(*position) - '0') * scale;
+                scale /= 10;
+                hasDigits = true;
+                ++position;
+            }
+        }
+        if (!hasDigits) {
+            return false;
+        }
+        // Optional exponent. (It is only consumed if it is complete,
+        // otherwise the “e” might belong to a unit.)
+        if ((position != m_end) && (toAsciiLower(*position) == 'e')) {
+            const Char *exponentPosition = position + 1;
+            bool isNegativeExponent = false;
+            if ((exponentPosition != m_end) //
+                && ((codeUnit(*exponentPosition) == '+') || (codeUnit(*exponentPosition) == '-'))) {
+                isNegativeExponent = (codeUnit(*exponentPosition) == '-');
+                ++exponentPosition;
+            }
+            if ((exponentPosition != m_end) && isInRange<uint>('0', codeUnit(*exponentPosition), '9')) {
+                int exponent = 0;
+                while ((exponentPosition != m_end) && isInRange<uint>('0', codeUnit(*exponentPosition), '9')) {
+                    // Bound the exponent to avoid integer overflow.
+                    exponent = qMin(exponent * 10 + static_cast<int>(codeUnit(*exponentPosition) - '0'), 1000);
+                    ++exponentPosition;
+                }
+                value *= std::pow(10.0, isNegativeExponent ? -exponent : exponent);
+                position = exponentPosition;
+            }
+        }
+        // Overflow (like 1e400) is rejected. Huge finite values are
+        // clamped.
+        if (!qIsFinite(value)) {
+            return false;
+        }
+        value = qMin(value, maximumNumber);
+        m_position = position;
+        *result = isNegative ? -value : value;
+        return true;
+    }
+
+    /** @brief Parses a component of a color function.
+     * @param value Pointer to the value
+     * @param unit Pointer to the unit
+     * @returns <tt>true</tt> on success. */
+    bool parseComponent(double *value, Unit *unit)
+    {
+        skipWhitespace();
+        if (consumeKeyword("none")) {
+            *value = 0;
+            *unit = Unit::None;
+            return true;
+        }
+        if (!parseNumber(value)) {
+            return false;
+        }
+        if (consumeCharacter('%')) {
+            *unit = Unit::Percent;
+        } else if (consumeKeyword("deg")) {
+            *unit = Unit::Degree;
+        } else if (consumeKeyword("grad")) {
+            *unit = Unit::Gradian;
+        } else if (consumeKeyword("rad")) {
+            *unit = Unit::Radian;
+        } else if (consumeKeyword("turn")) {
+            *unit = Unit::Turn;
+        } else {
+            *unit = Unit::Number;
+        }
+        return true;
+    }
+
+    /** @brief Parses the hexadecimal digits of a hexadecimal color.
+     * @param alpha The ordering of 8-digit colors. With
+     * @ref HexAlpha::First, the digits are read like
+     * <tt>QColor::setNamedColor()</tt> does: 3, 6, 8 (<tt>\#AARRGGBB</tt>),
+     * 9 and 12 digits are accepted. With @ref HexAlpha::Last, the digits
+     * are read like CSS does: 3, 4, 6 and 8 (<tt>\#RRGGBBAA</tt>) digits
+     * are accepted.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool parseHexDigits(HexAlpha alpha, CssColor::Value *result)
+    {
+        constexpr int maximumDigitCount = 12;
+        int digits[maximumDigitCount];
+        int count = 0;
+        while (!atEnd()) {
+            const uint value = toAsciiLower(*m_position);
+            int digit;
+            if (isInRange<uint>('0', value, '9')) {
+                digit = static_cast<int>(value - '0');
+            } else if (isInRange<uint>('a', value, 'f')) {
+                digit = static_cast<int>(value - 'a' + 10);
+            } else {
+                break;
+            }
+            if (count == maximumDigitCount) {
+                return false;
+            }
+            digits[count] = digit;
+            ++count;
+            ++m_position;
+        }
+        const bool isQColorOrdering = (alpha == HexAlpha::First);
+        // The channels in the order red, green, blue, alpha.
+        double channels[4] = {0, 0, 0, 1};
+        // Number of digits per channel
+        int channelDigits;
+        // If the first channel of the text is the alpha channel
+        bool isAlphaFirst = false;
+        switch (count) {
+        case 3:
+            channelDigits = 1;
+            break;
+        case 4:
+            if (isQColorOrdering) {
+                return false;
+            }
+            channelDigits = 1;
+            break;
+        case 6:
+            channelDigits = 2;
+            break;
+        case 8:
+            channelDigits = 2;
+            isAlphaFirst = isQColorOrdering;
+            break;
+        case 9:
+        case 12:
+            if (!isQColorOrdering) {
+                return false;
+            }
+            channelDigits = count / 3;
+            break;
+        default:
+            return false;
+        }
+        const int channelCount = count / channelDigits;
+        const double channelMaximum = (1 << (4 * channelDigits)) - 1;
+        for (int i = 0; i < channelCount; ++i) {
+            int channelValue = 0;
+            for (int j = 0; j < channelDigits; ++j) {
+                channelValue = channelValue * 16 + digits[i * channelDigits + j];
+            }
+            // #AARRGGBB: The first channel goes to the last position.
+            const int target = isAlphaFirst //
+                ? (i + 3) % 4
+                : i;
+            channels[target] = channelValue / channelMaximum;
+        }
+        result->syntax = CssColor::Syntax::Hex;
+        result->rgb = RgbDouble {channels[0], channels[1], channels[2]};
+        result->alpha = channels[3];
+        return true;
+    }
+
+    /** @brief Parses the arguments of a color function.
+     *
+     * @pre The function name and the opening parenthesis have yet
+     * been consumed.
+     *
+     * @param syntax The syntax corresponding to the function name
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool parseFunction(CssColor::Syntax syntax, CssColor::Value *result)
+    {
+        double values[3];
+        Unit units[3];
+        if (!parseComponent(&values[0], &units[0])) {
+            return false;
+        }
+        skipWhitespace();
+        // Legacy syntax uses commas, modern syntax uses whitespace.
+        const bool isLegacySyntax = consumeCharacter(',');
+        for (int i = 1; i < 3; ++i) {
+            if (isLegacySyntax && (i > 1)) {
+                skipWhitespace();
+                if (!consumeCharacter(',')) {
+                    return false;
+                }
+            }
+            if (!parseComponent(&values[i], &units[i])) {
+                return false;
+            }
+        }
+        skipWhitespace();
+        double alpha = 1;
+        if (consumeCharacter(isLegacySyntax ? ',' : '/')) {
+            Unit alphaUnit;
+            if (!parseComponent(&alpha, &alphaUnit) || !isNonHueUnit(alphaUnit)) {
+                return false;
+            }
+            if (alphaUnit == Unit::Percent) {
+                alpha /= 100;
+            }
+        }
+        skipWhitespace();
+        if (!consumeCharacter(')')) {
+            return false;
+        }
+
+        // Validate the units
+        const bool isFirstHue = (syntax == CssColor::Syntax::Hsl);
+        const bool isThirdHue = (syntax == CssColor::Syntax::Lch);
+        if (!(isFirstHue ? isHueUnit(units[0]) : isNonHueUnit(units[0])) //
+            || !isNonHueUnit(units[1]) //
+            || !(isThirdHue ? isHueUnit(units[2]) : isNonHueUnit(units[2]))) {
+            return false;
+        }
+
+        result->syntax = syntax;
+        result->alpha = qBound(0.0, alpha, 1.0);
+        switch (syntax) {
+        case CssColor::Syntax::Rgb: {
+            double channels[3];
+            for (int i = 0; i < 3; ++i) {
+                const double scale = (units[i] == Unit::Percent) ? 100.0 : 255.0;
+                channels[i] = qBound(0.0, values[i] / scale, 1.0);
+            }
+            result->rgb = RgbDouble {channels[0], channels[1], channels[2]};
+            break;
+        }
+        case CssColor::Syntax::Hsl:
+            // Plain numbers for saturation and lightness are
+            // interpreted like percentages.
+            result->rgb = hslToRgb(toDegree(values[0], units[0]), //
+                                   qBound(0.0, values[1] / 100, 1.0),
+                                   qBound(0.0, values[2] / 100, 1.0));
+            break;
+        case CssColor::Syntax::Lab:
+            // 100% corresponds to 100 for lightness and to 125 for a and b.
+            result->lab.L = qBound(0.0, values[0], 100.0);
+            result->lab.a = (units[1] == Unit::Percent) ? values[1] * 1.25 : values[1];
+            result->lab.b = (units[2] == Unit::Percent) ? values[2] * 1.25 : values[2];
+            break;
+        case CssColor::Syntax::Lch: {
+            // 100% corresponds to 100 for lightness and to 150 for chroma.
+            cmsCIELCh lch;
+            lch.L = qBound(0.0, values[0], 100.0);
+            lch.C = qMax(0.0, (units[1] == Unit::Percent) ? values[1] * 1.5 : values[1]);
+            lch.h = toDegree(values[2], units[2]);
+            cmsLCh2Lab(&result->lab, &lch);
+            break;
+        }
+        case CssColor::Syntax::Hex:
+            return false;
+        }
+        return true;
+    }
+};
+
+/** @internal
+ *
+ * @brief Writes ASCII text to a fixed-size <tt>char</tt> buffer.
+ *
+ * Characters beyond @ref CssColor::maximumFormattedLength are
+ * silently dropped. */
+class Writer
+{
+public:
+    /** @brief Constructor
+     * @param buffer The buffer, which must have space for
+     * @ref CssColor::maximumFormattedLength characters plus a
+     * terminating null. */
+    explicit Writer(char *buffer)
+        : m_buffer(buffer)
+    {
+    }
+
+    /** @brief Appends a character.
+     * @param character The character */
+    void append(char character)
+    {
+        if (m_length < CssColor::maximumFormattedLength) {
+            m_buffer[m_length] = character;
+            ++m_length;
+        }
+    }
+
+    /** @brief Appends a null-terminated string.
+     * @param text The string */
+    void append(const char *text)
+    {
+        for (const char *c = text; *c != 0; ++c) {
+            append(*c);
+        }
+    }
+
+    /** @brief Appends a byte as two upper-case hexadecimal digits.
+     * @param value The byte, within <tt>[0, 255]</tt> */
+    void appendHexByte(int value)
+    {
+        constexpr char hexDigits[] = "0123456789ABCDEF";
+        append(hexDigits[(value >> 4) & 0xF]);
+        append(hexDigits[value & 0xF]);
+    }
+
+    /** @brief Appends a decimal number.
+     * @param value The number
+     * @param decimals The maximum number of decimal places. Trailing zeros
+     * are omitted. */
+    void appendNumber(double value, int decimals)
+    {
+        // std::llround() has undefined behavior for values beyond the
+        // range of long long.
+        if (!qIsFinite(value)) {
+            value = 0;
+        }
+        value = qBound(-maximumNumber, value, maximumNumber);
+        Q_ASSERT(decimals <= 9);
+        long long factor = 1;
+        for (int i = 0; i < decimals; ++i) {
+            factor *= 10;
+        }
+        const long long scaled = std::llround(std::abs(value) * factor);
+        if ((value < 0) && (scaled != 0)) {
+            append('-');
+        }
+        appendInteger(scaled / factor);
+        long long fraction = scaled % factor;
+        if (fraction == 0) {
+            return;
+        }
+        int fractionDigits = decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            --fractionDigits;
+        }
+        append('.');
+        char digits[20];
+        for (int i = fractionDigits - 1; i >= 0; --i) {
+            digits[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        for (int i = 0; i < fractionDigits; ++i) {
+            append(digits[i]);
+        }
+    }
+
+    /** @brief Appends the alpha part of a color function, if the
+     * color is not fully opaque.
+     * @param alpha The alpha value */
+    void appendAlpha(double alpha)
+    {
+        const double boundedAlpha = qIsFinite(alpha) //
+            ? qBound(0.0, alpha, 1.0)
+            : 1.0;
+        if (std::llround(boundedAlpha * 1000) < 1000) {
+            append(" / ");
+            appendNumber(boundedAlpha, 3);
+        }
+    }
+
+    /** @brief Finishes the text.
+     * @returns The number of characters, not counting the terminating null
+     * that this function writes. */
+    int finish()
+    {
+        m_buffer[m_length] = 0;
+        return m_length;
+    }
+
+private:
+    /** @brief Appends a non-negative integer.
+     * @param value The integer */
+    void appendInteger(long long value)
+    {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count] = static_cast<char>('0' + value % 10);
+            value /= 10;
+            ++count;
+        } while ((value > 0) && (count < 20));
+        for (int i = count - 1; i >= 0; --i) {
+            append(digits[i]);
+        }
+    }
+
+    /** @brief The buffer */
+    char *const m_buffer;
+    /** @brief The number of characters that have been written */
+    int m_length = 0;
+};
+
+/** @internal
+ *
+ * @brief Rounds a channel to an integer within <tt>[0, 255]</tt>.
+ * @param value The channel, within <tt>[0, 1]</tt>
+ * @returns The rounded value */
+int toByte(double value)
+{
+    if (!qIsFinite(value)) {
+        return 0;
+    }
+    return qRound(qBound(0.0, value, 1.0) * 255);
+}
+
+} // namespace
+
+/** @brief Parses a CSS color.
+ *
+ * @param text The text to parse. Leading and trailing whitespace
+ * is ignored.
+ * @param result Pointer to the result. Only changed on success.
+ * @returns <tt>true</tt> on success, <tt>false</tt> if the text is not a
+ * valid (or not a supported) CSS color. */
+bool CssColor::parse(QStringView text, Value *result)
+{
+    Value temp;
+    const char16_t *begin = reinterpret_cast<const char16_t *>(text.utf16());
+    Parser<char16_t> parser(begin, begin + text.size());
+    if (!parser.parseColor(&temp)) {
+        return false;
+    }
+    *result = temp;
+    return true;
+}
+
+/** @brief Parses a CSS color.
+ *
+ * @param text Pointer to the text to parse (Latin-1 or UTF-8). Leading and
+ * trailing whitespace is ignored.
+ * @param length The number of characters of the text
+ * @param result Pointer to the result. Only changed on success.
+ * @returns <tt>true</tt> on success, <tt>false</tt> if the text is not a
+ * valid (or not a supported) CSS color. */
+bool CssColor::parse(const char *text, int length, Value *result)
+{
+    Value temp;
+    Parser<char> parser(text, text + length);
+    if (!parser.parseColor(&temp)) {
+        return false;
+    }
+    *result = temp;
+    return true;
+}
+
+/** @brief Parses a hexadecimal color with optional leading <tt>#</tt>.
+ *
+ * Intended for user input in text fields, where the leading <tt>#</tt>
+ * is often omitted.
+ *
+ * Unlike @ref parse(), this function reads the digits like
+ * <tt>QColor::setNamedColor()</tt> does, so that it is a drop-in
+ * replacement for existing user input: 8 digits are
+ * <tt>\#AARRGGBB</tt> (not <tt>\#RRGGBBAA</tt> like in CSS), 4 digits
+ * are not accepted, and 9 and 12 digits (<tt>\#RRRGGGBBB</tt> and
+ * <tt>\#RRRRGGGGBBBB</tt>) are accepted.
+ *
+ * @param text The text to parse, for example <tt>#1A2B3C</tt> or
+ * <tt>1a2b3c</tt>. Leading and trailing whitespace is ignored.
+ * @param result Pointer to the result. Only changed on success.
+ * @returns <tt>true</tt> on success. */
+bool CssColor::parseHex(QStringView text, Value *result)
+{
+    Value temp;
+    const char16_t *begin = reinterpret_cast<const char16_t *>(text.utf16());
+    Parser<char16_t> parser(begin, begin + text.size());
+    if (!parser.parseHexColor(&temp)) {
+        return false;
+    }
+    *result = temp;
+    return true;
+}
+
+/** @brief Formats a CSS color.
+ *
+ * @param value The value to format
+ * @param syntax The syntax to use. The RGB-based syntax (hexadecimal,
+ * <tt>rgb()</tt>, <tt>hsl()</tt>) requires a value with
+ * @ref Value::isRgbBased() <tt>true</tt>; <tt>lab()</tt> and
+ * <tt>lch()</tt> require a value with @ref Value::isRgbBased()
+ * <tt>false</tt>. Use @ref fromLcha() to get a value in the
+ * required form.
+ * @param buffer The buffer to which the text is written. It must have
+ * space for @ref maximumFormattedLength characters plus a terminating
+ * null.
+ * @returns The number of characters written, not counting the terminating
+ * null. <tt>0</tt> if the value does not fit to the syntax.
+ *
+ * Hexadecimal colors use upper-case digits and omit the alpha
+ * digits for opaque colors. The functions use the modern
+ * space-separated syntax. */
+int CssColor::format(const Value &value, Syntax syntax, char *buffer)
+{
+    Writer writer(buffer);
+    const bool isRgbSyntax = (syntax == Syntax::Hex) //
+        || (syntax == Syntax::Rgb) //
+        || (syntax == Syntax::Hsl);
+    if (isRgbSyntax != value.isRgbBased()) {
+        return writer.finish();
+    }
+    switch (syntax) {
+    case Syntax::Hex: {
+        writer.append('#');
+        writer.appendHexByte(toByte(value.rgb.red));
+        writer.appendHexByte(toByte(value.rgb.green));
+        writer.appendHexByte(toByte(value.rgb.blue));
+        const int alpha = toByte(value.alpha);
+        if (alpha < 255) {
+            writer.appendHexByte(alpha);
+        }
+        break;
+    }
+    case Syntax::Rgb:
+        writer.append("rgb(");
+        writer.appendNumber(toByte(value.rgb.red), 0);
+        writer.append(' ');
+        writer.appendNumber(toByte(value.rgb.green), 0);
+        writer.append(' ');
+        writer.appendNumber(toByte(value.rgb.blue), 0);
+        writer.appendAlpha(value.alpha);
+        writer.append(')');
+        break;
+    case Syntax::Hsl: {
+        const double red = qBound(0.0, value.rgb.red, 1.0);
+        const double green = qBound(0.0, value.rgb.green, 1.0);
+        const double blue = qBound(0.0, value.rgb.blue, 1.0);
+        const double maximum = qMax(red, qMax(green, blue));
+        const double minimum = qMin(red, qMin(green, blue));
+        const double difference = maximum - minimum;
+        const double lightness = (maximum + minimum) / 2;
+        double hue = 0;
+        double saturation = 0;
+        if (difference > 0) {
+            saturation = difference / (1 - std::abs(2 * lightness - 1));
+            if (maximum == red) {
+                hue = 60 * std::fmod((green - blue) / difference, 6);
+            } else if (maximum == green) {
+                hue = 60 * ((blue - red) / difference + 2);
+            } else {
+                hue = 60 * ((red - green) / difference + 4);
+            }
+            if (hue < 0) {
+                hue += 360;
+            }
+        }
+        writer.append("hsl(");
+        writer.appendNumber(hue, 2);
+        writer.append(' ');
+        writer.appendNumber(saturation * 100, 2);
+        writer.append("% ");
+        writer.appendNumber(lightness * 100, 2);
+        writer.append('%');
+        writer.appendAlpha(value.alpha);
+        writer.append(')');
+        break;
+    }
+    case Syntax::Lab:
+        writer.append("lab(");
+        writer.appendNumber(value.lab.L, 2);
+        writer.append(' ');
+        writer.appendNumber(value.lab.a, 2);
+        writer.append(' ');
+        writer.appendNumber(value.lab.b, 2);
+        writer.appendAlpha(value.alpha);
+        writer.append(')');
+        break;
+    case Syntax::Lch: {
+        cmsCIELCh lch;
+        cmsLab2LCh(&lch, &value.lab);
+        writer.append("lch(");
+        writer.appendNumber(lch.L, 2);
+        writer.append(' ');
+        writer.appendNumber(lch.C, 2);
+        writer.append(' ');
+        writer.appendNumber(lch.h, 2);
+        writer.appendAlpha(value.alpha);
+        writer.append(')');
+        break;
+    }
+    }
+    return writer.finish();
+}
+
+/** @brief Conversion from a color of this library to a CSS value.
+ *
+ * @param colorSpace The color space. RGB-based syntax uses the RGB
+ * values of this color space.
+ * @param color The color
+ * @param syntax The syntax for which the value is intended
+ * @returns A value that can be passed to @ref format() together
+ * with the same syntax. Out-of-gamut colors are bound to the gamut
+ * for the RGB-based syntax. */
+CssColor::Value CssColor::fromLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const LchaDouble &color, Syntax syntax)
+{
+    Value result;
+    result.syntax = syntax;
+    result.alpha = qBound(0.0, color.a, 1.0);
+    if (result.isRgbBased()) {
+        const QColor rgbColor = colorSpace->toQColorRgbBound( //
+            LchDouble(color.l, color.c, color.h));
+        result.rgb = RgbDouble {rgbColor.redF(), rgbColor.greenF(), rgbColor.blueF()};
+    } else {
+        const cmsCIELCh lch = toCmsCieLch(LchDouble(color.l, color.c, color.h));
+        cmsLCh2Lab(&result.lab, &lch);
+    }
+    return result;
+}
+
+/** @brief Conversion from a CSS value to a color of this library.
+ *
+ * @param colorSpace The color space. RGB-based values are interpreted as
+ * RGB values of this color space.
+ * @param value The value
+ * @returns The corresponding color. */
+LchaDouble CssColor::toLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const Value &value)
+{
+    LchDouble lch;
+    if (value.isRgbBased()) {
+        lch = colorSpace->toLch( //
+            QColor::fromRgbF(value.rgb.red, value.rgb.green, value.rgb.blue));
+    } else {
+        cmsCIELCh temp;
+        cmsLab2LCh(&temp, &value.lab);
+        lch = toLchDouble(temp);
+    }
+    return LchaDouble(lch.l, lch.c, lch.h, value.alpha);
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,136 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CSSCOLOR_H
+#define CSSCOLOR_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QSharedPointer>
+#include <QStringView>
+
+#include "PerceptualColor/lchadouble.h"
+#include "rgbcolorspace.h"
+#include "rgbdouble.h"
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Parser and formatter for CSS color strings.
+ *
+ * Supports the following syntax of
+ * <a href="https://www.w3.org/TR/css-color-4/">CSS Color Module Level 4</a>:
+ * - Hexadecimal notation: <tt>#rgb</tt>, <tt>#rgba</tt>, <tt>#rrggbb</tt>
+ *   and <tt>#rrggbbaa</tt>
+ * - <tt>rgb()</tt> and <tt>rgba()</tt>
+ * - <tt>hsl()</tt> and <tt>hsla()</tt>
+ * - <tt>lab()</tt>
+ * - <tt>lch()</tt>
+ *
+ * Both, the modern space-separated syntax (<tt>rgb(255 0 0 / 50%)</tt>) and
+ * the legacy comma-separated syntax (<tt>rgb(255, 0, 0, 0.5)</tt>) are
+ * accepted, as well as the keyword <tt>none</tt> for missing components.
+ * Named colors are not supported.
+ *
+ * Neither parsing nor formatting allocates memory: The parser works on
+ * <tt>QStringView</tt> or on <tt>char</tt> buffers; the formatter writes
+ * to a <tt>char</tt> buffer of @ref maximumFormattedLength characters.
+ * This makes it suitable for batch processing of many strings.
+ *
+ * CSS defines <tt>lab()</tt> and <tt>lch()</tt> relative to D50, like
+ * this library. For the RGB-based syntax (hexadecimal, <tt>rgb()</tt> and
+ * <tt>hsl()</tt>), CSS uses sRGB. Within this library, however, these
+ * values are interpreted in the RGB color space of the @ref RgbColorSpace
+ * that is used for the conversion (see @ref toLcha() and @ref fromLcha()),
+ * just like the RGB widgets of @ref ColorDialog do.
+ *
+ * @note All functions are thread-safe. */
+class CssColor final
+{
+public:
+    /** @brief The syntax of a CSS color. */
+    enum class Syntax {
+        Hex, /**< Hexadecimal notation */
+        Rgb, /**< <tt>rgb()</tt> function */
+        Hsl, /**< <tt>hsl()</tt> function */
+        Lab, /**< <tt>lab()</tt> function */
+        Lch  /**< <tt>lch()</tt> function */
+    };
+
+    /** @brief A parsed CSS color. */
+    struct Value {
+        /** @brief The syntax that has been parsed. */
+        Syntax syntax = Syntax::Hex;
+        /** @brief The RGB value, each channel within <tt>[0, 1]</tt>.
+         *
+         * Only valid if @ref isRgbBased() is <tt>true</tt>. The value of
+         * <tt>hsl()</tt> colors is converted to RGB. */
+        RgbDouble rgb {0, 0, 0};
+        /** @brief The Lab value.
+         *
+         * Only valid if @ref isRgbBased() is <tt>false</tt>. The value of
+         * <tt>lch()</tt> colors is converted to Lab. */
+        cmsCIELab lab {0, 0, 0};
+        /** @brief The opacity, within <tt>[0, 1]</tt>. */
+        double alpha = 1;
+        /** @brief If the value is stored in @ref rgb or in @ref lab.
+         * @returns <tt>true</tt> for hexadecimal, <tt>rgb()</tt> and
+         * <tt>hsl()</tt> colors. <tt>false</tt> otherwise. */
+        bool isRgbBased() const
+        {
+            return (syntax == Syntax::Hex) //
+                || (syntax == Syntax::Rgb) //
+                || (syntax == Syntax::Hsl);
+        }
+    };
+
+    /** @brief The maximum number of characters that @ref format() writes,
+     * not counting the terminating null. */
+    static constexpr int maximumFormattedLength = 63;
+
+    static int format(const Value &value, Syntax syntax, char *buffer);
+    static Value fromLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const LchaDouble &color, Syntax syntax);
+    static bool parse(QStringView text, Value *result);
+    static bool parse(const char *text, int length, Value *result);
+    static bool parseHex(QStringView text, Value *result);
+    static LchaDouble toLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const Value &value);
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    CssColor() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestCssColor;
+};
+
+} // namespace PerceptualColor
+
+#endif // CSSCOLOR_H
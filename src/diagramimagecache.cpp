@@ -0,0 +1,155 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own header
+#include "diagramimagecache.h"
+
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * @param maximumCost The maximum cost of the images and of the
+ * pyramids (each), measured in KiB. */
+DiagramImageCache::DiagramImageCache(int maximumCost)
+    : m_imageCache(maximumCost)
+    , m_pyramidCache(maximumCost)
+{
+}
+
+/** @brief Removes all entries. */
+void DiagramImageCache::clear()
+{
+    m_imageCache.clear();
+    m_pyramidCache.clear();
+}
+
+/** @brief Searches an image.
+ *
+ * @param key The key of the diagram, without the image size
+ * @param size The requested image size, measured in physical pixels
+ * @param isScalable If the image may be derived from the pyramid of
+ * a bigger rendering
+ * @returns The cached image, or an image derived from the pyramid, or a
+ * null image if the cache cannot provide this size. */
+QImage DiagramImageCache::find(const QString &key, const QSize &size, bool isScalable) const
+{
+    QImage result;
+    if (m_imageCache.find(sizedKey(key, size), &result)) {
+        return result;
+    }
+    if (isScalable) {
+        const QSharedPointer<const ImagePyramid> pyramid = m_pyramidCache.value(key);
+        // The pyramid is thread-safe, so resampling can happen without
+        // the lock of the cache. The first smaller size creates its levels.
+        if (!pyramid.isNull() && isDerivable(pyramid->baseSize(), size)) {
+            return pyramid->scaled(size);
+        }
+    }
+    return QImage();
+}
+
+/** @brief Stores a rendered image.
+ *
+ * @param key The key of the diagram, without the image size
+ * @param image The rendered image. Null images are ignored.
+ * @param isScalable If smaller sizes may be derived from this image. If
+ * <tt>true</tt> and if the image is bigger than the pyramid that is
+ * currently cached for this key, it replaces the pyramid. Otherwise, the
+ * image is cached for its own size only.
+ *
+ * This function is cheap: It does not resample the image. The levels of
+ * the pyramid are created only when a smaller size is requested the first
+ * time; see @ref ImagePyramid. So the image generators can insert each
+ * new rendering (for example each frame while dragging a slider) without
+ * slowing down the GUI thread. */
+void DiagramImageCache::insert(const QString &key, const QImage &image, bool isScalable)
+{
+    if (image.isNull()) {
+        return;
+    }
+    const QSize size = image.size();
+    if (isScalable) {
+        const auto isBigger = [size](const QSharedPointer<const ImagePyramid> &cachedPyramid) {
+            return (size.width() > cachedPyramid->baseSize().width()) //
+                || (size.height() > cachedPyramid->baseSize().height());
+        };
+        const QSharedPointer<const ImagePyramid> cachedPyramid = m_pyramidCache.value(key);
+        // Do not build a pyramid that would not be used.
+        if (cachedPyramid.isNull() || isBigger(cachedPyramid)) {
+            const QSharedPointer<const ImagePyramid> newPyramid(new ImagePyramid(image));
+            // Meanwhile, another thread might have inserted an even
+            // bigger pyramid.
+            if (m_pyramidCache.insertIf(key, newPyramid, newPyramid->cost(), isBigger)) {
+                return;
+            }
+        }
+        // The cached pyramid is bigger, but cannot provide this size,
+        // for example because of another aspect ratio.
+    }
+    const int cost = qMax(1, static_cast<int>(image.sizeInBytes() / 1024));
+    m_imageCache.insert(sizedKey(key, size), image, cost);
+}
+
+/** @brief If a pyramid can provide an image of a given size.
+ *
+ * @param baseSize The base size of the pyramid
+ * @param size The requested size
+ * @returns <tt>true</tt> if the requested size is not bigger than the base
+ * size and has (within one pixel) the same aspect ratio. Otherwise, the
+ * diagram would be distorted: For example, the chroma scale of a
+ * chroma-lightness diagram is bound to the image height, not to
+ * its width. */
+bool DiagramImageCache::isDerivable(const QSize &baseSize, const QSize &size)
+{
+    if (!baseSize.isValid() || !size.isValid()) {
+        return false;
+    }
+    if ((size.width() > baseSize.width()) || (size.height() > baseSize.height())) {
+        return false;
+    }
+    // Width that corresponds to the requested height at the aspect
+    // ratio of the base size:
+    const qreal matchingWidth = static_cast<qreal>(baseSize.width()) * size.height() / baseSize.height();
+    return qAbs(matchingWidth - size.width()) < 1;
+}
+
+/** @brief The key for images that are cached for a single size.
+ *
+ * @param key The key of the diagram, without the image size
+ * @param size The image size
+ * @returns The key for @ref m_imageCache. */
+QString DiagramImageCache::sizedKey(const QString &key, const QSize &size)
+{
+    return key //
+        + QStringLiteral("@") + QString::number(size.width()) //
+        + QStringLiteral("x") + QString::number(size.height());
+}
+
+} // namespace PerceptualColor
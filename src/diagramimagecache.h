@@ -0,0 +1,99 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef DIAGRAMIMAGECACHE_H
+#define DIAGRAMIMAGECACHE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QImage>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+#include "imagepyramid.h"
+#include "readmostlycache.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A cache of rendered diagram images.
+ *
+ * Each diagram is identified by a key that describes all its parameters
+ * apart from the image size. For diagrams that scale (a rendering,
+ * downsampled to a smaller size, looks like a direct rendering at the
+ * smaller size), this cache keeps an @ref ImagePyramid of the biggest
+ * rendering so far, and derives smaller sizes with the same aspect ratio
+ * from it. The pyramid creates its levels only on the first request for
+ * a smaller size. All other images (diagrams that do not scale, and scalable
+ * diagrams at sizes that the pyramid cannot provide) are cached
+ * individually for each size.
+ *
+ * Each @ref RgbColorSpace has such a cache (see
+ * @ref RgbColorSpace::diagramImageCache()), which is shared by all
+ * image generators that use this color space.
+ *
+ * @note All functions are thread-safe. */
+class DiagramImageCache final
+{
+public:
+    explicit DiagramImageCache(int maximumCost = defaultMaximumCost);
+    /** @brief Default destructor */
+    ~DiagramImageCache() noexcept = default;
+    void clear();
+    QImage find(const QString &key, const QSize &size, bool isScalable) const;
+    void insert(const QString &key, const QImage &image, bool isScalable);
+    static bool isDerivable(const QSize &baseSize, const QSize &size);
+
+    /** @brief Default maximum cost of each of the two internal caches,
+     * measured in KiB. */
+    static constexpr int defaultMaximumCost = 32 * 1024;
+
+private:
+    Q_DISABLE_COPY(DiagramImageCache)
+
+    static QString sizedKey(const QString &key, const QSize &size);
+
+    /** @brief Images that are cached for a single size.
+     *
+     * @sa @ref sizedKey() */
+    ReadMostlyCache<QString, QImage> m_imageCache;
+    /** @brief For each scalable diagram, the pyramid of the biggest
+     * rendering so far. */
+    ReadMostlyCache<QString, QSharedPointer<const ImagePyramid>> m_pyramidCache;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestChromaLightnessImage;
+    /** @internal @brief Only for unit tests. */
+    friend class TestDiagramImageCache;
+    /** @internal @brief Only for unit tests. */
+    friend class TestDiagramImageProvider;
+};
+
+} // namespace PerceptualColor
+
+#endif // DIAGRAMIMAGECACHE_H
@@ -0,0 +1,496 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/diagramimageprovider.h"
+// Second, the private implementation.
+#include "diagramimageprovider_p.h"
+
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QQuickTextureFactory>
+#include <QUrlQuery>
+
+#include "chromahueimage.h"
+#include "chromalightnessimage.h"
+#include "colormodel.h"
+#include "colorwheelimage.h"
+#include "csscolor.h"
+#include "diagramimagecache.h"
+#include "gradientimage.h"
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief Default edge length of square images, measured in pixel. */
+constexpr int defaultImageSize = 256;
+
+/** @internal
+ *
+ * @brief Maximum edge length of images, measured in pixel.
+ *
+ * Protects against accidentally huge allocations. */
+constexpr int maximumImageSize = 4096;
+
+/** @internal
+ *
+ * @brief Reads a numeric parameter.
+ * @param query The query
+ * @param key The name of the parameter
+ * @param defaultValue The value that is returned if the parameter is
+ * missing or not a number
+ * @returns The value of the parameter */
+qreal parameter(const QUrlQuery &query, const QString &key, qreal defaultValue)
+{
+    bool ok;
+    const qreal value = query.queryItemValue(key, QUrl::FullyDecoded).toDouble(&ok);
+    return ok ? value : defaultValue;
+}
+
+/** @internal
+ *
+ * @brief Reads a color parameter.
+ * @param colorSpace The color space
+ * @param query The query
+ * @param key The name of the parameter
+ * @param defaultValue The value that is returned if the parameter is
+ * missing or not a valid CSS color
+ * @returns The value of the parameter */
+LchaDouble colorParameter(const QSharedPointer<RgbColorSpace> &colorSpace, const QUrlQuery &query, const QString &key, const LchaDouble &defaultValue)
+{
+    const QString text = query.queryItemValue(key, QUrl::FullyDecoded);
+    CssColor::Value value;
+    if (!CssColor::parse(QStringView(text), &value)) {
+        return defaultValue;
+    }
+    return CssColor::toLcha(colorSpace, value);
+}
+
+/** @internal
+ *
+ * @brief Reads the color model parameter.
+ * @param query The query
+ * @returns The value of the <tt>model</tt> parameter */
+ColorModel colorModelParameter(const QUrlQuery &query)
+{
+    const QString text = query.queryItemValue(QStringLiteral("model"), QUrl::FullyDecoded);
+    if (text == QStringLiteral("oklch")) {
+        return ColorModel::OklchD65;
+    }
+    return ColorModel::CielchD50;
+}
+
+/** @internal
+ *
+ * @brief Reads the exact parameter.
+ * @param query The query
+ * @returns <tt>true</tt> if the parameter <tt>exact</tt> is set to
+ * <tt>1</tt> or <tt>true</tt>, which requests a direct rendering
+ * instead of an image that is derived from a bigger rendering. */
+bool exactParameter(const QUrlQuery &query)
+{
+    const QString exact = query.queryItemValue(QStringLiteral("exact"), QUrl::FullyDecoded);
+    return (exact == QStringLiteral("1")) || (exact == QStringLiteral("true"));
+}
+
+/** @internal
+ *
+ * @brief Determines the size of the image.
+ * @param query The query
+ * @param requestedSize The size requested by QML. Components that are
+ * not positive are considered unset.
+ * @param defaultSize The size that is used for components that are neither
+ * requested by QML nor set as parameter
+ * @returns The size of the image, bounded to @ref maximumImageSize. */
+QSize imageSize(const QUrlQuery &query, const QSize &requestedSize, const QSize &defaultSize)
+{
+    int width = requestedSize.width();
+    if (width <= 0) {
+        width = qRound(parameter(query, QStringLiteral("width"), defaultSize.width()));
+    }
+    int height = requestedSize.height();
+    if (height <= 0) {
+        height = qRound(parameter(query, QStringLiteral("height"), defaultSize.height()));
+    }
+    return QSize(qBound(1, width, maximumImageSize), //
+                 qBound(1, height, maximumImageSize));
+}
+
+/** @internal
+ *
+ * @brief Edge length of a square image.
+ * @param query The query
+ * @param requestedSize The size requested by QML
+ * @returns The shorter edge of @ref imageSize(). */
+int squareImageSize(const QUrlQuery &query, const QSize &requestedSize)
+{
+    QSize size = requestedSize;
+    // If only one component is set, use it for both.
+    if (size.width() <= 0) {
+        size.setWidth(size.height());
+    }
+    if (size.height() <= 0) {
+        size.setHeight(size.width());
+    }
+    const QSize result = imageSize(query, size, QSize(defaultImageSize, defaultImageSize));
+    return qMin(result.width(), result.height());
+}
+
+/** @internal
+ *
+ * @brief Splits an image identifier.
+ * @param id The image identifier
+ * @param query Pointer to a query object that receives the parameters
+ * @returns The diagram type */
+QString parseId(const QString &id, QUrlQuery *query)
+{
+    const int separator = id.indexOf(QStringLiteral("?"));
+    *query = QUrlQuery((separator < 0) ? QString() : id.mid(separator + 1));
+    return (separator < 0) ? id : id.left(separator);
+}
+
+/** @internal
+ *
+ * @brief Size of the rendered image.
+ * @param type The diagram type
+ * @param query The query
+ * @param requestedSize The size requested by QML
+ * @returns The size of the image that is rendered for the given
+ * parameters. An invalid size for unknown diagram types. */
+QSize outputSize(const QString &type, const QUrlQuery &query, const QSize &requestedSize)
+{
+    if ((type == QStringLiteral("chromahue")) || (type == QStringLiteral("colorwheel"))) {
+        const int size = squareImageSize(query, requestedSize);
+        return QSize(size, size);
+    }
+    if (type == QStringLiteral("chromalightness")) {
+        return imageSize(query, requestedSize, QSize(defaultImageSize, defaultImageSize));
+    }
+    if (type == QStringLiteral("gradient")) {
+        return imageSize(query, requestedSize, QSize(defaultImageSize, 20));
+    }
+    return QSize();
+}
+
+} // namespace
+
+/** @brief Constructor
+ *
+ * @param colorSpace The color space within which this provider should
+ * operate. Can be created with @ref RgbColorSpaceFactory. */
+DiagramImageProvider::DiagramImageProvider(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace)
+    : QQuickAsyncImageProvider()
+    , d_pointer(new DiagramImageProviderPrivate)
+{
+    d_pointer->m_rgbColorSpace = colorSpace;
+}
+
+/** @brief Destructor
+ *
+ * Waits until all pending requests have been finished. */
+DiagramImageProvider::~DiagramImageProvider() noexcept
+{
+    d_pointer->m_threadPool.waitForDone();
+}
+
+/** @brief The ICC profile of the monitor.
+ *
+ * This function is thread-safe.
+ *
+ * @returns The raw data of the ICC profile of the monitor, or an empty
+ * byte array if none has been set. Default value is an empty byte array.
+ *
+ * @sa @ref setDisplayProfile() */
+QByteArray DiagramImageProvider::displayProfile() const
+{
+    return d_pointer->displayProfile();
+}
+
+/** @brief Sets the ICC profile of the monitor.
+ *
+ * With a display profile, the images are converted directly to the RGB
+ * values of the monitor. Qt Quick does not know the profiles of the
+ * screens, so the application has to provide it, and set it again when
+ * the window moves to another screen. Already delivered images are not
+ * changed: The QML engine caches them by their source. To update them,
+ * change their <tt>source</tt>, for example by adding a parameter that
+ * counts the changes of the profile.
+ *
+ * This function is thread-safe.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the
+ * monitor, or an empty byte array for no conversion. Profiles that are
+ * not valid RGB profiles are treated like an empty byte array.
+ *
+ * @sa @ref displayProfile() */
+void DiagramImageProvider::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    QMutexLocker locker(&d_pointer->m_displayProfileMutex);
+    d_pointer->m_displayProfile = newDisplayProfile;
+}
+
+/** @brief Starts rendering an image.
+ *
+ * This function returns immediately; the image is rendered
+ * on a worker thread.
+ *
+ * @param id The image identifier. See @ref DiagramImageProvider for
+ * the syntax.
+ * @param requestedSize The requested size
+ * @returns The response object. The QML engine takes ownership. */
+QQuickImageResponse *DiagramImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    DiagramImageResponse *response = new DiagramImageResponse( //
+        d_pointer.operator->(),
+        id,
+        requestedSize);
+    d_pointer->m_threadPool.start(response);
+    return response;
+}
+
+/** @brief Thread-safe getter for @ref m_displayProfile
+ *
+ * @returns @ref m_displayProfile */
+QByteArray DiagramImageProvider::DiagramImageProviderPrivate::displayProfile() const
+{
+    QMutexLocker locker(&m_displayProfileMutex);
+    return m_displayProfile;
+}
+
+/** @brief The key for the @ref DiagramImageCache.
+ *
+ * @param id The image identifier
+ * @param displayProfile The display profile used for the rendering
+ * @returns The key for the cache. This is the image identifier
+ * without the size parameters, so that all sizes of the same diagram
+ * share the same key, plus a hash of the display profile. */
+QString DiagramImageProvider::DiagramImageProviderPrivate::cacheKey(const QString &id, const QByteArray &displayProfile)
+{
+    QUrlQuery query;
+    const QString type = parseId(id, &query);
+    query.removeAllQueryItems(QStringLiteral("width"));
+    query.removeAllQueryItems(QStringLiteral("height"));
+    query.removeAllQueryItems(QStringLiteral("display"));
+    if (!displayProfile.isEmpty()) {
+        const QByteArray hash = QCryptographicHash::hash( //
+                                    displayProfile,
+                                    QCryptographicHash::Sha1)
+                                    .toHex();
+        query.addQueryItem(QStringLiteral("display"), QString::fromLatin1(hash));
+    }
+    return type + QStringLiteral("?") + query.toString(QUrl::FullyEncoded);
+}
+
+/** @brief Size of the rendered image.
+ *
+ * @param id The image identifier
+ * @param requestedSize The requested size
+ * @returns The size of the image that @ref render() creates, or an invalid
+ * size if the identifier is invalid. */
+QSize DiagramImageProvider::DiagramImageProviderPrivate::imageSize(const QString &id, const QSize &requestedSize)
+{
+    QUrlQuery query;
+    const QString type = parseId(id, &query);
+    return outputSize(type, query, requestedSize);
+}
+
+/** @brief If the renderer of an image caches the image itself.
+ *
+ * @param id The image identifier
+ * @returns <tt>true</tt> for <tt>chromahue</tt> and
+ * <tt>chromalightness</tt>. @ref ChromaHueImage and
+ * @ref ChromaLightnessImage store their images in the
+ * @ref DiagramImageCache of the color space, with a key that describes
+ * their properties. So the images are shared with the widgets that use
+ * the same color space, and smaller sizes are derived from bigger
+ * renderings. The other images are cached by the provider itself. */
+bool DiagramImageProvider::DiagramImageProviderPrivate::isCachedByRenderer(const QString &id)
+{
+    QUrlQuery query;
+    const QString type = parseId(id, &query);
+    return (type == QStringLiteral("chromahue")) //
+        || (type == QStringLiteral("chromalightness"));
+}
+
+/** @brief Renders an image.
+ *
+ * Thread-safe, because a new renderer object is used for each call,
+ * and the renderers only use the thread-safe functions of the color space.
+ *
+ * @param colorSpace The color space
+ * @param id The image identifier
+ * @param requestedSize The requested size
+ * @param errorString Pointer to a string that receives an error message
+ * if the identifier is invalid.
+ * @param cancelFlag If not <tt>nullptr</tt>, the renderers that support
+ * it (<tt>chromahue</tt> and <tt>chromalightness</tt>) check this flag
+ * during the rendering, and abandon the rendering as soon as it is
+ * <tt>true</tt>.
+ * @param displayProfile The raw data of the ICC profile of the monitor,
+ * or an empty byte array. Used by the renderers that support it
+ * (<tt>chromahue</tt>, <tt>chromalightness</tt> and <tt>colorwheel</tt>).
+ * @returns The image, or a null image if the identifier is invalid or if
+ * the rendering has been canceled. */
+QImage DiagramImageProvider::DiagramImageProviderPrivate::render(const QSharedPointer<RgbColorSpace> &colorSpace, const QString &id, const QSize &requestedSize, QString *errorString, const std::atomic<bool> *cancelFlag, const QByteArray &displayProfile)
+{
+    QUrlQuery query;
+    const QString type = parseId(id, &query);
+    const QSize size = outputSize(type, query, requestedSize);
+    const qreal devicePixelRatioF = qBound<qreal>( //
+        1,
+        parameter(query, QStringLiteral("dpr"), 1),
+        8);
+
+    if (type == QStringLiteral("chromahue")) {
+        ChromaHueImage image(colorSpace);
+        image.setImageSize(size.width());
+        image.setBorder(parameter(query, QStringLiteral("border"), 0));
+        image.setLightness(parameter(query, QStringLiteral("lightness"), 50));
+        image.setColorModel(colorModelParameter(query));
+        image.setDevicePixelRatioF(devicePixelRatioF);
+        image.setDisplayProfile(displayProfile);
+        image.setExactRendering(exactParameter(query));
+        image.setCancelFlag(cancelFlag);
+        return image.getImage();
+    }
+    if (type == QStringLiteral("chromalightness")) {
+        ChromaLightnessImage image(colorSpace);
+        image.setImageSize(size);
+        image.setHue(parameter(query, QStringLiteral("hue"), 0));
+        image.setColorModel(colorModelParameter(query));
+        image.setDevicePixelRatioF(devicePixelRatioF);
+        image.setDisplayProfile(displayProfile);
+        image.setExactRendering(exactParameter(query));
+        image.setCancelFlag(cancelFlag);
+        return image.getImage();
+    }
+    if (type == QStringLiteral("colorwheel")) {
+        ColorWheelImage image(colorSpace);
+        image.setImageSize(size.width());
+        image.setBorder(parameter(query, QStringLiteral("border"), 0));
+        image.setWheelThickness(parameter(query, QStringLiteral("thickness"), 20));
+        image.setDevicePixelRatioF(devicePixelRatioF);
+        image.setDisplayProfile(displayProfile);
+        return image.getImage();
+    }
+    if (type == QStringLiteral("gradient")) {
+        GradientImage image(colorSpace);
+        image.setGradientLength(size.width());
+        image.setGradientThickness(size.height());
+        image.setFirstColor(colorParameter(colorSpace, query, QStringLiteral("first"), LchaDouble(0, 0, 0, 1)));
+        image.setSecondColor(colorParameter(colorSpace, query, QStringLiteral("second"), LchaDouble(100, 0, 0, 1)));
+        image.setDevicePixelRatioF(devicePixelRatioF);
+        return image.getImage();
+    }
+    *errorString = QStringLiteral("Unknown diagram type: ") + type;
+    return QImage();
+}
+
+/** @brief Constructor
+ *
+ * @param provider The provider that creates this response
+ * @param id The image identifier
+ * @param requestedSize The requested size */
+DiagramImageResponse::DiagramImageResponse(DiagramImageProvider::DiagramImageProviderPrivate *provider, const QString &id, const QSize &requestedSize)
+    : m_displayProfile(provider->displayProfile())
+    , m_id(id)
+    , m_provider(provider)
+    , m_requestedSize(requestedSize)
+{
+    // The QML engine owns the response, not the thread pool.
+    setAutoDelete(false);
+}
+
+/** @brief Destructor */
+DiagramImageResponse::~DiagramImageResponse() noexcept
+{
+}
+
+/** @brief Cancels the request.
+ *
+ * Called by the QML engine (in the GUI thread) when the image is not
+ * needed anymore. */
+void DiagramImageResponse::cancel()
+{
+    m_isCanceled = true;
+}
+
+/** @brief Error message
+ *
+ * @returns An error message if the request failed. An empty
+ * string otherwise. */
+QString DiagramImageResponse::errorString() const
+{
+    return m_errorString;
+}
+
+/** @brief Renders the image.
+ *
+ * Called by the thread pool on a worker thread. All images are cached in
+ * the @ref DiagramImageCache of the color space: Either by the renderer
+ * itself (see
+ * @ref DiagramImageProvider::DiagramImageProviderPrivate::isCachedByRenderer()),
+ * or here, with the image identifier as key. If the request is canceled
+ * meanwhile, nothing is cached: The renderers that cache themselves get
+ * the cancel flag, check it for each row and abandon the rendering. */
+void DiagramImageResponse::run()
+{
+    using Private = DiagramImageProvider::DiagramImageProviderPrivate;
+    if (m_isCanceled) {
+        // Nothing to do.
+    } else if (Private::isCachedByRenderer(m_id)) {
+        m_image = Private::render(m_provider->m_rgbColorSpace, m_id, m_requestedSize, &m_errorString, &m_isCanceled, m_displayProfile);
+    } else {
+        DiagramImageCache *const cache = m_provider->m_rgbColorSpace->diagramImageCache();
+        const QString key = Private::cacheKey(m_id, m_displayProfile);
+        m_image = cache->find(key, Private::imageSize(m_id, m_requestedSize), false);
+        if (m_image.isNull()) {
+            m_image = Private::render(m_provider->m_rgbColorSpace, m_id, m_requestedSize, &m_errorString, nullptr, m_displayProfile);
+            if (!m_isCanceled) {
+                cache->insert(key, m_image, false);
+            }
+        }
+    }
+    Q_EMIT finished();
+}
+
+/** @brief The rendered image.
+ *
+ * @returns A texture factory for the rendered image. The caller takes
+ * ownership. */
+QQuickTextureFactory *DiagramImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+} // namespace PerceptualColor
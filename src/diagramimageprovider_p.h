@@ -0,0 +1,134 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DIAGRAMIMAGEPROVIDER_P_H
+#define DIAGRAMIMAGEPROVIDER_P_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Include the header of the public class of this private implementation.
+#include "PerceptualColor/diagramimageprovider.h"
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QQuickImageResponse>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+#include <atomic>
+
+#include "rgbcolorspace.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ *  @brief Private implementation within the <em>Pointer to
+ *  implementation</em> idiom */
+class DiagramImageProvider::DiagramImageProviderPrivate final
+{
+public:
+    /** @brief Constructor */
+    DiagramImageProviderPrivate() = default;
+    /** @brief Default destructor
+     *
+     * The destructor is non-<tt>virtual</tt> because
+     * the class as a whole is <tt>final</tt>. */
+    ~DiagramImageProviderPrivate() noexcept = default;
+
+    /** @brief Pointer to @ref RgbColorSpace object
+     *
+     * Its @ref RgbColorSpace::diagramImageCache() caches the rendered
+     * images for all requests. */
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+    /** @brief Internal storage for @ref DiagramImageProvider::displayProfile()
+     *
+     * Guarded by @ref m_displayProfileMutex. */
+    QByteArray m_displayProfile;
+    /** @brief Guards @ref m_displayProfile
+     *
+     * The QML engine requests the images from its own thread, while the
+     * application might change the display profile in the GUI thread. */
+    mutable QMutex m_displayProfileMutex;
+    /** @brief The worker threads that render the images. */
+    QThreadPool m_threadPool;
+
+    QByteArray displayProfile() const;
+    static QString cacheKey(const QString &id, const QByteArray &displayProfile = QByteArray());
+    static QSize imageSize(const QString &id, const QSize &requestedSize);
+    static bool isCachedByRenderer(const QString &id);
+    static QImage render(const QSharedPointer<RgbColorSpace> &colorSpace, const QString &id, const QSize &requestedSize, QString *errorString, const std::atomic<bool> *cancelFlag = nullptr, const QByteArray &displayProfile = QByteArray());
+
+private:
+    Q_DISABLE_COPY(DiagramImageProviderPrivate)
+};
+
+/** @internal
+ *
+ * @brief Response to a single request to @ref DiagramImageProvider.
+ *
+ * Renders the image when run on the thread pool of the provider, and
+ * emits <tt>finished()</tt> afterwards – also if the request has
+ * been canceled, as required by <tt>QQuickImageResponse</tt>. */
+class DiagramImageResponse final : public QQuickImageResponse, public QRunnable
+{
+public:
+    DiagramImageResponse(DiagramImageProvider::DiagramImageProviderPrivate *provider, const QString &id, const QSize &requestedSize);
+    virtual ~DiagramImageResponse() noexcept override;
+    virtual void cancel() override;
+    virtual QString errorString() const override;
+    virtual void run() override;
+    virtual QQuickTextureFactory *textureFactory() const override;
+
+private:
+    Q_DISABLE_COPY(DiagramImageResponse)
+
+    /** @brief The display profile of the provider at the time of the
+     * request. */
+    const QByteArray m_displayProfile;
+    /** @brief Internal storage for @ref errorString() */
+    QString m_errorString;
+    /** @brief The image identifier of the request */
+    const QString m_id;
+    /** @brief The rendered image */
+    QImage m_image;
+    /** @brief If the request has been canceled. */
+    std::atomic<bool> m_isCanceled {false};
+    /** @brief The provider that created this response. */
+    DiagramImageProvider::DiagramImageProviderPrivate *const m_provider;
+    /** @brief The requested size of the request */
+    const QSize m_requestedSize;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestDiagramImageProvider;
+};
+
+} // namespace PerceptualColor
+
+#endif // DIAGRAMIMAGEPROVIDER_P_H
@@ -0,0 +1,172 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "displaytransform.h"
+
+#include "helper.h"
+
+#include <QCryptographicHash>
+
+namespace PerceptualColor
+{
+/** @brief Creates a transform from Lab to a display profile.
+ *
+ * @param displayProfile The raw data of the ICC profile of the display.
+ * @returns The transform. <tt>nullptr</tt> if the data is not a valid
+ * RGB profile. */
+QSharedPointer<DisplayTransform> DisplayTransform::create(const QByteArray &displayProfile)
+{
+    if (displayProfile.isEmpty()) {
+        return nullptr;
+    }
+    cmsHPROFILE displayProfileHandle = cmsOpenProfileFromMem( //
+        displayProfile.constData(),
+        static_cast<cmsUInt32Number>(displayProfile.size()));
+    if (displayProfileHandle == nullptr) {
+        return nullptr;
+    }
+    if (cmsGetColorSpace(displayProfileHandle) != cmsSigRgbData) {
+        cmsCloseProfile(displayProfileHandle);
+        return nullptr;
+    }
+    // nullptr means: Default white point (D50)
+    cmsHPROFILE labProfileHandle = cmsCreateLab4Profile(nullptr);
+    // QRgb is an unsigned integer 0xAARRGGBB. The transform writes the
+    // color channels directly into this memory layout. The alpha channel
+    // is an extra channel which LittleCMS does not touch.
+    constexpr cmsUInt32Number outputFormat = //
+        (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ? TYPE_BGRA_8 : TYPE_ARGB_8;
+    QSharedPointer<DisplayTransform> result(new DisplayTransform);
+    result->m_profileHash = QCryptographicHash::hash( //
+                                displayProfile,
+                                QCryptographicHash::Sha1)
+                                .toHex();
+    result->m_transformHandle = cmsCreateTransform(
+        // Create a transform function and get a handle to this function:
+        labProfileHandle,     // input profile handle
+        TYPE_Lab_DBL,         // input buffer format
+        displayProfileHandle, // output profile handle
+        outputFormat,         // output buffer format
+        // This intentionally differs from the absolute colorimetric
+        // intent of the working-space transforms of RgbColorSpace:
+        // - The working-space transforms define which Lab value an RGB
+        //   value has, and thereby the gamut. These must be the true
+        //   colorimetric values, so absolute colorimetric is correct.
+        // - This transform only decides which monitor pixel shows a Lab
+        //   value. The eye is adapted to the monitor white, so the D50
+        //   white of the Lab space must map to the monitor white, which
+        //   is relative colorimetric.
+        // Both intents are equivalent for V4 profiles (like the
+        // built-in sRGB profile), whose media white point is D50.
+        // They differ only for V2 profiles with a non-D50 media white
+        // point. There, absolute colorimetric would tint the white of
+        // all diagrams.
+        // Only the gamut test uses the working-space transforms, so the
+        // gamut of the diagrams does not depend on this intent.
+        INTENT_RELATIVE_COLORIMETRIC, // rendering intent
+        // Without the 1-pixel-cache, the transform is thread-safe.
+        cmsFLAGS_NOCACHE // flags
+    );
+    // It is mandatory to close the profiles to prevent memory leaks:
+    cmsCloseProfile(labProfileHandle);
+    cmsCloseProfile(displayProfileHandle);
+    if (result->m_transformHandle == nullptr) {
+        return nullptr;
+    }
+    return result;
+}
+
+DisplayTransform::~DisplayTransform() noexcept
+{
+    if (m_transformHandle != nullptr) {
+        cmsDeleteTransform(m_transformHandle);
+    }
+}
+
+/** @brief Identifies the display profile.
+ *
+ * The transform objects are not kept forever (see
+ * @ref RgbColorSpace::displayTransform()), so their address does not
+ * identify the profile. Use this value instead, for example in the keys
+ * of the @ref DiagramImageCache.
+ *
+ * @returns A hash of the raw data of the display profile, as hexadecimal
+ * digits. */
+QByteArray DisplayTransform::profileHash() const
+{
+    return m_profileHash;
+}
+
+/** @brief Converts many colors at once.
+ *
+ * @param lab Pointer to the Lab colors (CIELab D50).
+ * @param rgb Pointer to the result buffer. The color channels are written;
+ * the alpha channel is set to fully opaque.
+ * @param count Number of colors. */
+void DisplayTransform::toRgb(const cmsCIELab *lab, QRgb *rgb, int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        rgb[i] = 0xFF000000;
+    }
+    cmsDoTransform(m_transformHandle, // handle to transform function
+                   lab, // input
+                   rgb, // output
+                   static_cast<cmsUInt32Number>(count) // number of values
+    );
+}
+
+/** @brief Converts a color.
+ *
+ * @param lab A CIELab D50 color
+ * @returns The opaque RGB value of the display. */
+QRgb DisplayTransform::toRgb(const cmsCIELab &lab) const
+{
+    QRgb result;
+    toRgb(&lab, &result, 1);
+    return result;
+}
+
+/** @brief Converts a color.
+ *
+ * @param lch A CIELCh D50 color
+ * @returns The opaque RGB value of the display. */
+QRgb DisplayTransform::toRgb(const LchDouble &lch) const
+{
+    cmsCIELab lab;
+    const cmsCIELCh cmsLch = toCmsCieLch(lch);
+    cmsLCh2Lab(&lab, &cmsLch);
+    return toRgb(lab);
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,98 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DISPLAYTRANSFORM_H
+#define DISPLAYTRANSFORM_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/lchdouble.h"
+
+#include <QByteArray>
+#include <QColor>
+#include <QSharedPointer>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A color transform from CIELab directly to a display profile.
+ *
+ * Without a display profile, the image generators convert Lab to the RGB
+ * values of the working @ref RgbColorSpace, and Qt shows these RGB values
+ * as if they were sRGB. On calibrated (wide-gamut) monitors, this is
+ * wrong; correcting the images afterwards would need a second pass over
+ * every pixel. This class provides a single transform from Lab directly
+ * to the RGB values of the monitor, which the image generators use
+ * instead for in-gamut pixels.
+ *
+ * The images show only colors that are within the gamut of the working
+ * color space. For these colors, the colorimetric conversion from Lab to
+ * the monitor is the same as the conversion from Lab via the working
+ * color space to the monitor, so the working profile is not part of the
+ * transform.
+ *
+ * The output is written directly in the memory layout of <tt>QRgb</tt>,
+ * so no intermediate buffer is necessary.
+ *
+ * Objects are usually obtained from @ref RgbColorSpace::displayTransform(),
+ * which caches the most recently used transforms per color space.
+ *
+ * @note All functions are thread-safe. */
+class DisplayTransform final
+{
+public:
+    static QSharedPointer<DisplayTransform> create(const QByteArray &displayProfile);
+    /** @brief Destructor */
+    ~DisplayTransform() noexcept;
+    QByteArray profileHash() const;
+    QRgb toRgb(const cmsCIELab &lab) const;
+    QRgb toRgb(const LchDouble &lch) const;
+    void toRgb(const cmsCIELab *lab, QRgb *rgb, int count) const;
+
+private:
+    Q_DISABLE_COPY(DisplayTransform)
+
+    /** @brief Constructor
+     *
+     * Use @ref create() instead. */
+    DisplayTransform() = default;
+
+    /** @brief Internal storage for @ref profileHash() */
+    QByteArray m_profileHash;
+    /** @brief Handle to the LittleCMS transform from Lab to the display. */
+    cmsHTRANSFORM m_transformHandle = nullptr;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestDisplayTransform;
+};
+
+} // namespace PerceptualColor
+
+#endif // DISPLAYTRANSFORM_H
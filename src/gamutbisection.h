@@ -0,0 +1,159 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAMUTBISECTION_H
+#define GAMUTBISECTION_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/lchdouble.h"
+
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief The bisections that search the gamut boundary.
+ *
+ * The gamut test itself is passed as a callable, so the same code serves
+ * @ref RgbColorSpace and the build-time tool
+ * <tt>generatesrgbgamuttable</tt> (which cannot link against the library
+ * it generates data for). This guarantees that @ref SrgbGamutTable
+ * contains exactly what @ref RgbColorSpace would calculate at runtime.
+ *
+ * @note All functions are thread-safe if the gamut test is thread-safe. */
+class GamutBisection final
+{
+public:
+    /** @brief Maximum number of colors for @ref maximumChroma().
+     *
+     * All buffers are on the stack. */
+    static constexpr int blockSize = 256;
+
+    /** @brief Searches the gamut boundary on the gray axis.
+     *
+     * @pre The gray with <em>inGamutLightness</em> is in-gamut.
+     *
+     * @param isInGamut Callable <tt>bool(qreal lightness)</tt> that tests
+     * if the gray with this lightness is in-gamut
+     * @param inGamutLightness Lightness of an in-gamut gray
+     * @param outOfGamutLightness Lightness of a gray which is (likely)
+     * out-of-gamut. The boundary is searched between both lightness values.
+     * @param precision The precision of the search
+     * @returns The in-gamut lightness that is nearest to the boundary, with
+     * the given precision. If <em>outOfGamutLightness</em> is in-gamut
+     * itself, it is returned. */
+    template<typename IsInGamut>
+    static qreal grayAxisBoundary(const IsInGamut &isInGamut, qreal inGamutLightness, qreal outOfGamutLightness, qreal precision)
+    {
+        if (isInGamut(outOfGamutLightness)) {
+            return outOfGamutLightness;
+        }
+        qreal inside = inGamutLightness;
+        qreal outside = outOfGamutLightness;
+        while (qAbs(outside - inside) > precision) {
+            const qreal candidate = (inside + outside) / 2;
+            if (isInGamut(candidate)) {
+                inside = candidate;
+            } else {
+                outside = candidate;
+            }
+        }
+        return inside;
+    }
+
+    /** @brief Searches the maximum in-gamut chroma of many colors at once.
+     *
+     * All bisections advance in lockstep: Each iteration calls the gamut
+     * test once for all colors that are not yet resolved.
+     *
+     * @pre For each color, the gray with the same lightness is in-gamut,
+     * and the color itself is out-of-gamut.
+     *
+     * @param isInGamutBlock Callable
+     * <tt>void(const LchDouble *colors, bool *inGamut, int count)</tt>
+     * that tests <em>count</em> colors at once
+     * @param colors The colors. The bisection searches the chroma between
+     * <tt>0</tt> and the original chroma. On return, the chroma is the
+     * highest in-gamut chroma that has been found.
+     * @param count Number of colors. Must not be bigger than
+     * @ref blockSize.
+     * @param precision The precision of the search. The bisection stops as
+     * soon as the remaining interval is not bigger than this value. */
+    template<typename IsInGamutBlock>
+    static void maximumChroma(const IsInGamutBlock &isInGamutBlock, LchDouble *colors, int count, qreal precision)
+    {
+        LchDouble candidates[blockSize];
+        bool inGamut[blockSize];
+        qreal lowerChroma[blockSize];
+        qreal upperChroma[blockSize];
+        // Indices of the colors that are not resolved yet
+        int pending[blockSize];
+        int pendingCount = count;
+        for (int i = 0; i < count; ++i) {
+            lowerChroma[i] = 0;
+            upperChroma[i] = colors[i].c;
+            pending[i] = i;
+        }
+        while (pendingCount > 0) {
+            int newPendingCount = 0;
+            for (int j = 0; j < pendingCount; ++j) {
+                const int i = pending[j];
+                if (upperChroma[i] - lowerChroma[i] > precision) {
+                    pending[newPendingCount] = i;
+                    ++newPendingCount;
+                } else {
+                    colors[i].c = lowerChroma[i];
+                }
+            }
+            pendingCount = newPendingCount;
+            for (int j = 0; j < pendingCount; ++j) {
+                const int i = pending[j];
+                candidates[j] = colors[i];
+                candidates[j].c = (lowerChroma[i] + upperChroma[i]) / 2;
+            }
+            isInGamutBlock(candidates, inGamut, pendingCount);
+            for (int j = 0; j < pendingCount; ++j) {
+                const int i = pending[j];
+                if (inGamut[j]) {
+                    lowerChroma[i] = candidates[j].c;
+                } else {
+                    upperChroma[i] = candidates[j].c;
+                }
+            }
+        }
+    }
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    GamutBisection() = delete;
+};
+
+} // namespace PerceptualColor
+
+#endif // GAMUTBISECTION_H
@@ -0,0 +1,529 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own header
+#include "gamutsolidrenderer.h"
+
+#include "helper.h"
+#include "rgbcolorspace.h"
+#include "tracepoints.h"
+
+#include <QColor>
+#include <QRect>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief Number of segments in which an occupied voxel is sampled
+ * when searching the surface.
+ *
+ * Thin parts of the gamut (near the cusps and near black and white)
+ * can be missed between two samples, so the samples must be dense. */
+constexpr int surfaceSampleCount = 8;
+
+/** @internal
+ *
+ * @brief Number of bisection steps to locate the surface. */
+constexpr int surfaceBisectionCount = 6;
+
+/** @internal
+ *
+ * @brief Minimum brightness of the shading, for surfaces that are
+ * perpendicular to the view. */
+constexpr double ambientLight = 0.3;
+
+/** @internal
+ *
+ * @brief If integer coordinates are within a cubic grid.
+ *
+ * @param a Coordinate on the first axis
+ * @param b Coordinate on the second axis
+ * @param l Coordinate on the third axis
+ * @param resolution Number of cells of the grid along each axis
+ * @returns If all coordinates are within <tt>[0, resolution - 1]</tt>. */
+bool isInRangeOfGrid(int a, int b, int l, int resolution)
+{
+    return isInRange(0, a, resolution - 1) //
+        && isInRange(0, b, resolution - 1) //
+        && isInRange(0, l, resolution - 1);
+}
+
+} // namespace
+
+/** @brief Constructor
+ *
+ * Samples the gamut of the color space at the corners of the grid (in
+ * parallel) and derives the voxel and brick occupancy.
+ *
+ * @param colorSpace The color space whose gamut is rendered. */
+GamutSolidRenderer::GamutSolidRenderer(const QSharedPointer<RgbColorSpace> &colorSpace)
+    : m_chromaRange(qMax(1, colorSpace->maximumChroma()))
+    , m_rgbColorSpace(colorSpace)
+{
+    // Sample the corners, one lightness layer per task.
+    m_corners.resize(cornerResolution * cornerResolution * cornerResolution);
+    QVector<int> layers;
+    layers.reserve(cornerResolution);
+    for (int l = 0; l < cornerResolution; ++l) {
+        layers.append(l);
+    }
+    quint8 *const corners = m_corners.data();
+    QtConcurrent::blockingMap(layers, [this, corners](const int l) {
+        for (int b = 0; b < cornerResolution; ++b) {
+            for (int a = 0; a < cornerResolution; ++a) {
+                const double position[3] = {static_cast<double>(a), static_cast<double>(b), static_cast<double>(l)};
+                corners[cornerIndex(a, b, l)] = m_rgbColorSpace->isInGamut(toLab(position)) ? 1 : 0;
+            }
+        }
+    });
+
+    // A voxel is surely occupied if any of its corners is in-gamut.
+    QVector<quint8> seeds(gridResolution * gridResolution * gridResolution, 0);
+    for (int l = 0; l < gridResolution; ++l) {
+        for (int b = 0; b < gridResolution; ++b) {
+            for (int a = 0; a < gridResolution; ++a) {
+                bool occupied = false;
+                for (int corner = 0; corner < 8; ++corner) {
+                    occupied = occupied //
+                        || m_corners.at(cornerIndex(a + (corner & 1), b + ((corner >> 1) & 1), l + ((corner >> 2) & 1)));
+                }
+                seeds[(l * gridResolution + b) * gridResolution + a] = occupied ? 1 : 0;
+            }
+        }
+    }
+
+    // But thin parts of the gamut (near the cusps, and the tips at black
+    // and white) might reach into voxels without any in-gamut corner. To
+    // be conservative, the occupancy is dilated by one voxel in each
+    // direction (including the diagonals). The dilation is separable, so
+    // it is done axis by axis.
+    m_voxels = seeds;
+    const int strides[3] = {1, gridResolution, gridResolution * gridResolution};
+    for (const int stride : strides) {
+        const QVector<quint8> source = m_voxels;
+        for (int index = 0; index < source.count(); ++index) {
+            const int position = (index / stride) % gridResolution;
+            const bool hasPrevious = (position > 0) && source.at(index - stride);
+            const bool hasNext = (position < gridResolution - 1) && source.at(index + stride);
+            if (hasPrevious || hasNext) {
+                m_voxels[index] = 1;
+            }
+        }
+    }
+
+    m_bricks.fill(0, brickResolution * brickResolution * brickResolution);
+    for (int l = 0; l < gridResolution; ++l) {
+        for (int b = 0; b < gridResolution; ++b) {
+            for (int a = 0; a < gridResolution; ++a) {
+                if (m_voxels.at((l * gridResolution + b) * gridResolution + a) != 0) {
+                    m_bricks[((l / brickSize) * brickResolution + b / brickSize) * brickResolution + a / brickSize] = 1;
+                }
+            }
+        }
+    }
+}
+
+/** @brief Index of a grid corner within @ref m_corners.
+ *
+ * @param a Corner coordinate on the <em>a</em> axis.
+ * Range: <tt>[0, @ref gridResolution]</tt>
+ * @param b Corner coordinate on the <em>b</em> axis.
+ * Range: <tt>[0, @ref gridResolution]</tt>
+ * @param l Corner coordinate on the <em>L</em> axis.
+ * Range: <tt>[0, @ref gridResolution]</tt>
+ * @returns The index */
+int GamutSolidRenderer::cornerIndex(int a, int b, int l) const
+{
+    return (l * cornerResolution + b) * cornerResolution + a;
+}
+
+/** @brief If a voxel is occupied.
+ *
+ * @param a Voxel coordinate on the <em>a</em> axis.
+ * @param b Voxel coordinate on the <em>b</em> axis.
+ * @param l Voxel coordinate on the <em>L</em> axis.
+ * @returns If the voxel is occupied. <tt>false</tt> for coordinates
+ * outside of the grid. */
+bool GamutSolidRenderer::isVoxelOccupied(int a, int b, int l) const
+{
+    if (!isInRangeOfGrid(a, b, l, gridResolution)) {
+        return false;
+    }
+    return m_voxels.at((l * gridResolution + b) * gridResolution + a) != 0;
+}
+
+/** @brief If a brick contains any occupied voxel.
+ *
+ * @param a Brick coordinate on the <em>a</em> axis.
+ * @param b Brick coordinate on the <em>b</em> axis.
+ * @param l Brick coordinate on the <em>L</em> axis.
+ * @returns If the brick contains any occupied voxel. <tt>false</tt>
+ * for coordinates outside of the grid. */
+bool GamutSolidRenderer::isBrickOccupied(int a, int b, int l) const
+{
+    if (!isInRangeOfGrid(a, b, l, brickResolution)) {
+        return false;
+    }
+    return m_bricks.at((l * brickResolution + b) * brickResolution + a) != 0;
+}
+
+/** @brief Conversion from grid coordinates to CIELab.
+ *
+ * @param gridPosition Position in grid coordinates. The corners of the
+ * grid have integer coordinates within <tt>[0, @ref gridResolution]</tt>.
+ * @returns The corresponding CIELab value. */
+cmsCIELab GamutSolidRenderer::toLab(const double gridPosition[3]) const
+{
+    const double chromaVoxelSize = 2 * m_chromaRange / gridResolution;
+    const double lightnessVoxelSize = 100.0 / gridResolution;
+    cmsCIELab result;
+    result.a = -m_chromaRange + gridPosition[0] * chromaVoxelSize;
+    result.b = -m_chromaRange + gridPosition[1] * chromaVoxelSize;
+    result.L = gridPosition[2] * lightnessVoxelSize;
+    return result;
+}
+
+/** @brief Surface normal derived from the sampled grid.
+ *
+ * The in-gamut samples at the corners are interpolated trilinearly to a
+ * continuous field. The normal is the negative gradient of this field.
+ *
+ * @param position Position in grid coordinates
+ * @param normal Receives the normalized normal in CIELab space (with the
+ * components <em>a</em>, <em>b</em>, <em>L</em>). The zero vector if the
+ * field has no gradient at this position. */
+void GamutSolidRenderer::gridNormal(const double position[3], double normal[3]) const
+{
+    // Trilinear interpolation of the corner field
+    const auto field = [this](const double x, const double y, const double z) -> double {
+        const double point[3] = {x, y, z};
+        int base[3];
+        double fraction[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const double clamped = qBound<double>(0, point[axis], gridResolution);
+            base[axis] = qMin(static_cast<int>(clamped), gridResolution - 1);
+            fraction[axis] = clamped - base[axis];
+        }
+        double result = 0;
+        for (int corner = 0; corner < 8; ++corner) {
+            const int offset[3] = {corner & 1, (corner >> 1) & 1, (corner >> 2) & 1};
+            double weight = 1;
+            for (int axis = 0; axis < 3; ++axis) {
+                weight *= (offset[axis] == 1) ? fraction[axis] : (1 - fraction[axis]);
+            }
+            result += weight * m_corners.at(cornerIndex(base[0] + offset[0], base[1] + offset[1], base[2] + offset[2]));
+        }
+        return result;
+    };
+    // Central differences, converted from grid units to CIELab units
+    // (chain rule), so that the normal is correct also for non-cubic
+    // voxels.
+    constexpr double h = 0.5;
+    const double voxelSize[3] = {2 * m_chromaRange / gridResolution, //
+                                 2 * m_chromaRange / gridResolution,
+                                 100.0 / gridResolution};
+    const double &x = position[0];
+    const double &y = position[1];
+    const double &z = position[2];
+    normal[0] = -(field(x + h, y, z) - field(x - h, y, z)) / voxelSize[0];
+    normal[1] = -(field(x, y + h, z) - field(x, y - h, z)) / voxelSize[1];
+    normal[2] = -(field(x, y, z + h) - field(x, y, z - h)) / voxelSize[2];
+    const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    for (int axis = 0; axis < 3; ++axis) {
+        normal[axis] = (length > 0) ? normal[axis] / length : 0;
+    }
+}
+
+/** @brief Searches the gamut surface on a segment of a ray.
+ *
+ * Tests the exact gamut of the color space at some points of the segment.
+ * At the first in-gamut point, the surface is located by bisection.
+ *
+ * @param ray The ray
+ * @param begin Begin of the segment
+ * @param end End of the segment
+ * @param hit Receives the first in-gamut color on the segment, if any.
+ * @param hitT Receives the ray parameter of the hit, if any.
+ * @returns If the segment contains an in-gamut color. */
+bool GamutSolidRenderer::findSurface(const Ray &ray, double begin, double end, cmsCIELab *hit, double *hitT) const
+{
+    const auto labAt = [this, &ray](const double t) -> cmsCIELab {
+        const double position[3] = {ray.origin[0] + t * ray.direction[0], //
+                                    ray.origin[1] + t * ray.direction[1],
+                                    ray.origin[2] + t * ray.direction[2]};
+        return toLab(position);
+    };
+    double outside = begin;
+    for (int i = 0; i <= surfaceSampleCount; ++i) {
+        double inside = begin + (end - begin) * i / surfaceSampleCount;
+        cmsCIELab lab = labAt(inside);
+        if (!m_rgbColorSpace->isInGamut(lab)) {
+            outside = inside;
+            continue;
+        }
+        if (i > 0) {
+            for (int step = 0; step < surfaceBisectionCount; ++step) {
+                const double middle = (outside + inside) / 2;
+                const cmsCIELab middleLab = labAt(middle);
+                if (m_rgbColorSpace->isInGamut(middleLab)) {
+                    inside = middle;
+                    lab = middleLab;
+                } else {
+                    outside = middle;
+                }
+            }
+        }
+        *hit = lab;
+        *hitT = inside;
+        return true;
+    }
+    return false;
+}
+
+/** @brief Casts a ray through the grid.
+ *
+ * @param ray The ray, in grid coordinates
+ * @param hit Receives the color at the first intersection with the gamut
+ * surface, if any.
+ * @param normal Receives the normalized surface normal at the
+ * intersection (in CIELab space), if any.
+ * @returns If the ray intersects the gamut. */
+bool GamutSolidRenderer::castRay(const Ray &ray, cmsCIELab *hit, double normal[3]) const
+{
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    // Intersection with the bounding box of the grid (slab method)
+    double tEnter = 0;
+    double tExit = infinity;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (ray.direction[axis] == 0) {
+            if (!isInRange<double>(0, ray.origin[axis], gridResolution)) {
+                return false;
+            }
+            continue;
+        }
+        double t0 = (0 - ray.origin[axis]) / ray.direction[axis];
+        double t1 = (gridResolution - ray.origin[axis]) / ray.direction[axis];
+        if (t0 > t1) {
+            qSwap(t0, t1);
+        }
+        tEnter = qMax(tEnter, t0);
+        tExit = qMin(tExit, t1);
+    }
+
+    // Step such a small distance into the next cell that rounding errors
+    // at the cell border do not matter.
+    constexpr double epsilon = 1e-7;
+    double t = tEnter;
+    while (t < tExit) {
+        int voxel[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const double position = ray.origin[axis] + (t + epsilon) * ray.direction[axis];
+            voxel[axis] = qBound(0, static_cast<int>(std::floor(position)), gridResolution - 1);
+        }
+        const int brick[3] = {voxel[0] / brickSize, voxel[1] / brickSize, voxel[2] / brickSize};
+
+        if (!isBrickOccupied(brick[0], brick[1], brick[2])) {
+            // Skip the whole brick.
+            double tBrickExit = infinity;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (ray.direction[axis] != 0) {
+                    const int border = (ray.direction[axis] > 0) ? (brick[axis] + 1) * brickSize : brick[axis] * brickSize;
+                    tBrickExit = qMin(tBrickExit, (border - ray.origin[axis]) / ray.direction[axis]);
+                }
+            }
+            t = qMax(tBrickExit, t + epsilon);
+            continue;
+        }
+
+        // Walk from voxel to voxel within the brick (3D DDA).
+        int step[3];
+        double tMax[3];
+        double tDelta[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            if (ray.direction[axis] > 0) {
+                step[axis] = 1;
+                tMax[axis] = (voxel[axis] + 1 - ray.origin[axis]) / ray.direction[axis];
+                tDelta[axis] = 1 / ray.direction[axis];
+            } else if (ray.direction[axis] < 0) {
+                step[axis] = -1;
+                tMax[axis] = (voxel[axis] - ray.origin[axis]) / ray.direction[axis];
+                tDelta[axis] = -1 / ray.direction[axis];
+            } else {
+                step[axis] = 0;
+                tMax[axis] = infinity;
+                tDelta[axis] = infinity;
+            }
+        }
+        double tVoxelEnter = t;
+        while (true) {
+            int nextAxis = 0;
+            if (tMax[1] < tMax[nextAxis]) {
+                nextAxis = 1;
+            }
+            if (tMax[2] < tMax[nextAxis]) {
+                nextAxis = 2;
+            }
+            const double tVoxelExit = qMin(tMax[nextAxis], tExit);
+            if (isVoxelOccupied(voxel[0], voxel[1], voxel[2])) {
+                double hitT;
+                if (findSurface(ray, tVoxelEnter, tVoxelExit, hit, &hitT)) {
+                    const double position[3] = {ray.origin[0] + hitT * ray.direction[0], //
+                                                ray.origin[1] + hitT * ray.direction[1],
+                                                ray.origin[2] + hitT * ray.direction[2]};
+                    gridNormal(position, normal);
+                    return true;
+                }
+            }
+            tVoxelEnter = tVoxelExit;
+            if (tVoxelEnter >= tExit) {
+                return false;
+            }
+            voxel[nextAxis] += step[nextAxis];
+            tMax[nextAxis] += tDelta[nextAxis];
+            if ((voxel[nextAxis] < 0) || (voxel[nextAxis] / brickSize != brick[nextAxis])) {
+                // Left the brick
+                break;
+            }
+        }
+        t = qMax(tVoxelEnter, t + epsilon);
+    }
+    return false;
+}
+
+/** @brief Renders the gamut solid.
+ *
+ * @param imageSize The size of the image, measured in physical pixels.
+ * @param azimuth The rotation of the view around the gray axis, measured
+ * in degree. At <tt>0</tt>, the view looks from the positive <em>a</em>
+ * axis to the gray axis.
+ * @param elevation The angle of the view above the <em>a</em>-<em>b</em>
+ * plane, measured in degree. <tt>90</tt> looks from above (from white),
+ * <tt>-90</tt> from below (from black).
+ * @param pixelStep Only each n-th pixel (horizontally and vertically) is
+ * actually calculated and fills a square of n × n pixels. <tt>1</tt> is
+ * full quality. Bigger values are meant for fast preview renderings
+ * during interaction.
+ * @returns An image in <tt>QImage::Format_ARGB32_Premultiplied</tt>. Pixels
+ * that do not show the gamut solid are transparent. The whole gamut solid
+ * is visible at any rotation. */
+QImage GamutSolidRenderer::render(const QSize &imageSize, qreal azimuth, qreal elevation, int pixelStep) const
+{
+    PERCEPTUALCOLOR_TRACE_SCOPE1(gamut_solid_render, pixelStep);
+    QImage result(imageSize, QImage::Format_ARGB32_Premultiplied);
+    if (result.isNull()) {
+        return result;
+    }
+    result.fill(Qt::transparent);
+    const int step = qMax(1, pixelStep);
+
+    // View direction and screen axes in CIELab (a, b, L)
+    const double azimuthRadian = qDegreesToRadians(azimuth);
+    const double elevationRadian = qDegreesToRadians(qBound<qreal>(-90, elevation, 90));
+    const double toViewer[3] = {std::cos(elevationRadian) * std::cos(azimuthRadian), //
+                                std::cos(elevationRadian) * std::sin(azimuthRadian),
+                                std::sin(elevationRadian)};
+    const double right[3] = {-std::sin(azimuthRadian), std::cos(azimuthRadian), 0};
+    const double up[3] = {-std::sin(elevationRadian) * std::cos(azimuthRadian), //
+                          -std::sin(elevationRadian) * std::sin(azimuthRadian),
+                          std::cos(elevationRadian)};
+    // The bounding sphere of the grid fits into the image.
+    const double sphereRadius = std::sqrt(2 * m_chromaRange * m_chromaRange + 50 * 50);
+    const double pixelsPerUnit = qMin(imageSize.width(), imageSize.height()) / (2 * sphereRadius);
+    const double center[3] = {0, 0, 50};
+    const double gridMinimum[3] = {-m_chromaRange, -m_chromaRange, 0};
+    const double voxelSize[3] = {2 * m_chromaRange / gridResolution, //
+                                 2 * m_chromaRange / gridResolution,
+                                 100.0 / gridResolution};
+
+    QVector<QRect> tiles;
+    for (int y = 0; y < imageSize.height(); y += tileSize) {
+        for (int x = 0; x < imageSize.width(); x += tileSize) {
+            tiles.append(QRect(x, y, tileSize, tileSize).intersected(result.rect()));
+        }
+    }
+    // Obtain the pointer before the parallel work: QImage::scanLine() is
+    // not thread-safe because it might detach.
+    uchar *const bits = result.bits();
+    const qsizetype bytesPerLine = result.bytesPerLine();
+    const auto renderTile = [&](const QRect &tile) {
+        Ray ray;
+        for (int y = tile.top(); y <= tile.bottom(); y += step) {
+            for (int x = tile.left(); x <= tile.right(); x += step) {
+                const int blockWidth = qMin(step, tile.right() + 1 - x);
+                const int blockHeight = qMin(step, tile.bottom() + 1 - y);
+                const double screenX = (x + blockWidth / 2.0 - imageSize.width() / 2.0) / pixelsPerUnit;
+                const double screenY = (imageSize.height() / 2.0 - (y + blockHeight / 2.0)) / pixelsPerUnit;
+                for (int axis = 0; axis < 3; ++axis) {
+                    // Start outside of the bounding sphere, looking
+                    // to the center.
+                    const double origin = center[axis] //
+                        + screenX * right[axis] //
+                        + screenY * up[axis] //
+                        + 2 * sphereRadius * toViewer[axis];
+                    ray.origin[axis] = (origin - gridMinimum[axis]) / voxelSize[axis];
+                    ray.direction[axis] = -toViewer[axis] / voxelSize[axis];
+                }
+                cmsCIELab hit;
+                double normal[3];
+                if (!castRay(ray, &hit, normal)) {
+                    continue;
+                }
+                const QColor color = m_rgbColorSpace->toQColorRgbUnbound(hit);
+                if (!color.isValid()) {
+                    continue;
+                }
+                const double facing = normal[0] * toViewer[0] //
+                    + normal[1] * toViewer[1] //
+                    + normal[2] * toViewer[2];
+                const double shade = ambientLight + (1 - ambientLight) * qMax(0.0, facing);
+                const QRgb pixel = qRgb(qRound(color.red() * shade), //
+                                        qRound(color.green() * shade),
+                                        qRound(color.blue() * shade));
+                for (int blockY = 0; blockY < blockHeight; ++blockY) {
+                    QRgb *line = reinterpret_cast<QRgb *>(bits + (y + blockY) * bytesPerLine);
+                    for (int blockX = 0; blockX < blockWidth; ++blockX) {
+                        line[x + blockX] = pixel;
+                    }
+                }
+            }
+        }
+    };
+    QtConcurrent::blockingMap(tiles, renderTile);
+    return result;
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,131 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GAMUTSOLIDRENDERER_H
+#define GAMUTSOLIDRENDERER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QImage>
+#include <QSharedPointer>
+#include <QSize>
+#include <QVector>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+class RgbColorSpace;
+
+/** @internal
+ *
+ * @brief Software renderer for the gamut solid of an @ref RgbColorSpace.
+ *
+ * Renders the three-dimensional body of all in-gamut colors within
+ * CIELab by ray casting, without any GPU. The axes are <em>a</em> and
+ * <em>b</em> horizontally and <em>L</em> vertically; the view is an
+ * orthographic projection that rotates around the gray axis.
+ *
+ * Testing the gamut needs a color transform, which is too slow to be done
+ * at each step of each ray. Therefore, the constructor samples the gamut
+ * once at the corners of a regular grid of @ref gridResolution ³ voxels.
+ * A voxel is occupied if any of its corners is in-gamut, and to be
+ * conservative also if any of its neighbour voxels is. The voxels are
+ * grouped to bricks of @ref brickSize ³ voxels, and empty bricks are
+ * skipped as a whole. Within occupied bricks, the rays walk from voxel to
+ * voxel (3D DDA), so no voxel is missed. Only within occupied voxels the
+ * exact gamut of the color space is tested, and the surface is located
+ * by bisection. The shading uses the normal of the sampled grid.
+ *
+ * @ref render() splits the image into tiles that are rendered in
+ * parallel on all cores. For interactive use, it can render only every
+ * n-th pixel (progressive refinement).
+ *
+ * @note The object is immutable after construction. All functions are
+ * thread-safe. */
+class GamutSolidRenderer final
+{
+public:
+    explicit GamutSolidRenderer(const QSharedPointer<RgbColorSpace> &colorSpace);
+    /** @brief Default destructor */
+    ~GamutSolidRenderer() noexcept = default;
+    QImage render(const QSize &imageSize, qreal azimuth, qreal elevation, int pixelStep) const;
+
+    /** @brief Number of voxels of the grid along each axis.
+     *
+     * Must be a multiple of @ref brickSize. */
+    static constexpr int gridResolution = 64;
+    /** @brief Number of voxels of a brick along each axis. */
+    static constexpr int brickSize = 8;
+    /** @brief Edge length of the tiles that are rendered in parallel,
+     * measured in pixels. */
+    static constexpr int tileSize = 32;
+
+private:
+    Q_DISABLE_COPY(GamutSolidRenderer)
+
+    /** @brief A ray in grid coordinates. */
+    struct Ray {
+        /** @brief Origin */
+        double origin[3];
+        /** @brief Direction */
+        double direction[3];
+    };
+
+    /** @brief Number of bricks along each axis. */
+    static constexpr int brickResolution = gridResolution / brickSize;
+    /** @brief Number of grid corners along each axis. */
+    static constexpr int cornerResolution = gridResolution + 1;
+
+    bool castRay(const Ray &ray, cmsCIELab *hit, double normal[3]) const;
+    int cornerIndex(int a, int b, int l) const;
+    bool findSurface(const Ray &ray, double begin, double end, cmsCIELab *hit, double *hitT) const;
+    void gridNormal(const double position[3], double normal[3]) const;
+    bool isBrickOccupied(int a, int b, int l) const;
+    bool isVoxelOccupied(int a, int b, int l) const;
+    cmsCIELab toLab(const double gridPosition[3]) const;
+
+    /** @brief For each grid corner, if it is in-gamut (<tt>1</tt>) or
+     * not (<tt>0</tt>). @sa @ref cornerIndex() */
+    QVector<quint8> m_corners;
+    /** @brief For each brick, if it contains any occupied voxel. */
+    QVector<quint8> m_bricks;
+    /** @brief Half of the extent of the grid in <em>a</em> and
+     * <em>b</em>, measured in CIELab units. */
+    double m_chromaRange;
+    /** @brief For each voxel, if it is occupied. */
+    QVector<quint8> m_voxels;
+    /** @brief Pointer to @ref RgbColorSpace object */
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestGamutSolidRenderer;
+};
+
+} // namespace PerceptualColor
+
+#endif // GAMUTSOLIDRENDERER_H
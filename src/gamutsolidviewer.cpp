@@ -0,0 +1,448 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/gamutsolidviewer.h"
+// Second, the private implementation.
+#include "gamutsolidviewer_p.h"
+
+#include "helper.h"
+#include "polarpointf.h"
+
+#include <QApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QtConcurrent>
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * @param colorSpace The color space within which this widget should operate.
+ * Can be created with @ref RgbColorSpaceFactory.
+ *
+ * @param parent The widget’s parent widget. This parameter will be passed
+ * to the base class’s constructor. */
+GamutSolidViewer::GamutSolidViewer(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QWidget *parent)
+    : AbstractDiagram(parent)
+    , d_pointer(new GamutSolidViewerPrivate(this, colorSpace))
+{
+    // Like the other diagrams, accept focus by mouse click only within
+    // the actual diagram. See ColorWheel for details.
+    setFocusPolicy(Qt::FocusPolicy::TabFocus);
+
+    d_pointer->m_refinementTimer.setSingleShot(true);
+    d_pointer->m_refinementTimer.setInterval(GamutSolidViewerPrivate::refinementDelay);
+    connect(&d_pointer->m_refinementTimer, // sender
+            &QTimer::timeout, // signal
+            this, // receiver
+            QOverload<>::of(&GamutSolidViewer::update) // slot
+    );
+    connect(&d_pointer->m_renderWatcher, // sender
+            &QFutureWatcher<GamutSolidViewerPrivate::Frame>::finished, // signal
+            this, // receiver
+            [this]() { // slot
+                d_pointer->takeFrame();
+            });
+}
+
+/** @brief Default destructor */
+GamutSolidViewer::~GamutSolidViewer() noexcept
+{
+}
+
+/** @brief Constructor
+ *
+ * @param backLink Pointer to the object from which <em>this</em> object
+ * is the private implementation.
+ *
+ * @param colorSpace The color space within which this widget should operate. */
+GamutSolidViewer::GamutSolidViewerPrivate::GamutSolidViewerPrivate(GamutSolidViewer *backLink, const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace)
+    : m_rgbColorSpace(colorSpace)
+    , q_pointer(backLink)
+{
+}
+
+/** @brief Reacts on a change of the view.
+ *
+ * Schedules a fast preview rendering immediately and a full-resolution
+ * rendering after the interaction has stopped for
+ * @ref refinementDelay milliseconds. Until the new rendering has
+ * finished, the last one is shown. */
+void GamutSolidViewer::GamutSolidViewerPrivate::interact()
+{
+    m_refinementTimer.start();
+    q_pointer->update();
+}
+
+/** @brief The size of the image that the current view needs.
+ *
+ * @returns The edge length of the (square) image, measured in
+ * physical pixels. */
+int GamutSolidViewer::GamutSolidViewerPrivate::requestedImageSize() const
+{
+    const int borderPhysical = qRound(q_pointer->spaceForFocusIndicator() * q_pointer->devicePixelRatioF());
+    return qMax(0, q_pointer->maximumPhysicalSquareSize() - 2 * borderPhysical);
+}
+
+/** @brief The pixel step that the current view needs.
+ *
+ * @returns While the view is changing (and shortly after)
+ * @ref previewPixelStep, otherwise <tt>1</tt>. */
+int GamutSolidViewer::GamutSolidViewerPrivate::requestedPixelStep() const
+{
+    const bool isInteractive = m_isMouseEventActive || m_refinementTimer.isActive();
+    return isInteractive ? previewPixelStep : 1;
+}
+
+/** @brief If @ref m_image corresponds to the current view.
+ *
+ * @returns If @ref m_image corresponds to the current view. */
+bool GamutSolidViewer::GamutSolidViewerPrivate::isImageUpToDate() const
+{
+    const int size = requestedImageSize();
+    return (m_image.size() == QSize(size, size)) //
+        && (m_imagePixelStep == requestedPixelStep()) //
+        && (m_imageAzimuth == m_azimuth) //
+        && (m_imageElevation == m_elevation);
+}
+
+/** @brief Starts rendering the current view in the background.
+ *
+ * Does nothing if @ref m_image is up-to-date or if a background rendering
+ * is already running. In the latter case, @ref takeFrame() calls this
+ * function again when the running rendering has finished. So during a
+ * fast interaction, intermediate views are skipped instead of queued. */
+void GamutSolidViewer::GamutSolidViewerPrivate::startRendering()
+{
+    if (m_renderWatcher.isRunning() || isImageUpToDate()) {
+        return;
+    }
+    const QSharedPointer<const GamutSolidRenderer> renderer = m_renderer;
+    const QSharedPointer<RgbColorSpace> colorSpace = m_rgbColorSpace;
+    const int size = requestedImageSize();
+    const qreal azimuth = m_azimuth;
+    const qreal elevation = m_elevation;
+    const int pixelStep = requestedPixelStep();
+    // Capture only values, not this object, which might be destroyed
+    // before the rendering has finished.
+    m_renderWatcher.setFuture(QtConcurrent::run([renderer, colorSpace, size, azimuth, elevation, pixelStep]() {
+        Frame frame;
+        frame.renderer = renderer;
+        if (frame.renderer.isNull()) {
+            frame.renderer.reset(new GamutSolidRenderer(colorSpace));
+        }
+        frame.image = frame.renderer->render(QSize(size, size), azimuth, elevation, pixelStep);
+        frame.azimuth = azimuth;
+        frame.elevation = elevation;
+        frame.pixelStep = pixelStep;
+        return frame;
+    }));
+}
+
+/** @brief Takes the result of the finished background rendering.
+ *
+ * Stores it as @ref m_image, schedules a repaint, and starts rendering
+ * the current view if it has changed in the meantime. */
+void GamutSolidViewer::GamutSolidViewerPrivate::takeFrame()
+{
+    const Frame frame = m_renderWatcher.result();
+    m_renderer = frame.renderer;
+    m_image = frame.image;
+    m_image.setDevicePixelRatio(q_pointer->devicePixelRatioF());
+    m_imageAzimuth = frame.azimuth;
+    m_imageElevation = frame.elevation;
+    m_imagePixelStep = frame.pixelStep;
+    q_pointer->update();
+    startRendering();
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal GamutSolidViewer::azimuth() const
+{
+    return d_pointer->m_azimuth;
+}
+
+/** @brief Setter for the @ref azimuth property.
+ *
+ * @param newAzimuth the new azimuth */
+void GamutSolidViewer::setAzimuth(const qreal newAzimuth)
+{
+    const qreal normalizedAzimuth = PolarPointF::normalizedAngleDegree(newAzimuth);
+    if (normalizedAzimuth == d_pointer->m_azimuth) {
+        return;
+    }
+    d_pointer->m_azimuth = normalizedAzimuth;
+    d_pointer->interact();
+    Q_EMIT azimuthChanged(normalizedAzimuth);
+}
+
+// No documentation here (documentation of properties
+// and its getters are in the header)
+qreal GamutSolidViewer::elevation() const
+{
+    return d_pointer->m_elevation;
+}
+
+/** @brief Setter for the @ref elevation property.
+ *
+ * @param newElevation the new elevation */
+void GamutSolidViewer::setElevation(const qreal newElevation)
+{
+    const qreal boundedElevation = qBound<qreal>(-90, newElevation, 90);
+    if (boundedElevation == d_pointer->m_elevation) {
+        return;
+    }
+    d_pointer->m_elevation = boundedElevation;
+    d_pointer->interact();
+    Q_EMIT elevationChanged(boundedElevation);
+}
+
+/** @brief React on a mouse press event.
+ *
+ * Reimplemented from base class.
+ *
+ * Starts rotating the view if the click is within the diagram.
+ *
+ * @param event The corresponding mouse event */
+void GamutSolidViewer::mousePressEvent(QMouseEvent *event)
+{
+    const qreal radius = maximumWidgetSquareSize() / 2.0 - spaceForFocusIndicator();
+    const QPointF center(maximumWidgetSquareSize() / 2.0, maximumWidgetSquareSize() / 2.0);
+    const QPointF offset = event->pos() - center;
+    if (offset.x() * offset.x() + offset.y() * offset.y() > radius * radius) {
+        // Make sure default coordinates like drag-window
+        // in KDE’s Breeze widget style works:
+        event->ignore();
+        return;
+    }
+    setFocus(Qt::MouseFocusReason);
+    d_pointer->m_isMouseEventActive = true;
+    d_pointer->m_lastMousePosition = event->pos();
+}
+
+/** @brief React on a mouse move event.
+ *
+ * Reimplemented from base class.
+ *
+ * Rotates the view if previously there had been a mouse press event
+ * that had been accepted. Horizontal movements change the @ref azimuth,
+ * vertical movements the @ref elevation.
+ *
+ * @param event The corresponding mouse event */
+void GamutSolidViewer::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!d_pointer->m_isMouseEventActive) {
+        // Make sure default coordinates like drag-window in KDE’s Breeze
+        // widget style works
+        event->ignore();
+        return;
+    }
+    const QPoint delta = event->pos() - d_pointer->m_lastMousePosition;
+    d_pointer->m_lastMousePosition = event->pos();
+    setAzimuth(d_pointer->m_azimuth - delta.x() * GamutSolidViewerPrivate::rotationPerPixel);
+    setElevation(d_pointer->m_elevation + delta.y() * GamutSolidViewerPrivate::rotationPerPixel);
+}
+
+/** @brief React on a mouse release event.
+ *
+ * Reimplemented from base class. Does not differentiate between left,
+ * middle and right mouse click.
+ *
+ * @param event The corresponding mouse event */
+void GamutSolidViewer::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!d_pointer->m_isMouseEventActive) {
+        // Make sure default coordinates like drag-window in KDE’s Breeze
+        // widget style works
+        event->ignore();
+        return;
+    }
+    d_pointer->m_isMouseEventActive = false;
+    // Schedule the full-resolution rendering.
+    d_pointer->interact();
+}
+
+/** @brief React on key press events.
+ *
+ * Reimplemented from base class.
+ *
+ * The arrow keys rotate the view. <tt>Qt::Key_PageUp</tt> and
+ * <tt>Qt::Key_PageDown</tt> rotate faster around the gray axis.
+ *
+ * @param event the corresponding event */
+void GamutSolidViewer::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key()) {
+    case Qt::Key_Left:
+        setAzimuth(d_pointer->m_azimuth - singleStepHue);
+        break;
+    case Qt::Key_Right:
+        setAzimuth(d_pointer->m_azimuth + singleStepHue);
+        break;
+    case Qt::Key_Up:
+        setElevation(d_pointer->m_elevation + singleStepHue);
+        break;
+    case Qt::Key_Down:
+        setElevation(d_pointer->m_elevation - singleStepHue);
+        break;
+    case Qt::Key_PageUp:
+        setAzimuth(d_pointer->m_azimuth + pageStepHue);
+        break;
+    case Qt::Key_PageDown:
+        setAzimuth(d_pointer->m_azimuth - pageStepHue);
+        break;
+    default:
+        /* Quote from Qt documentation:
+         *
+         * If you reimplement this handler, it is very important
+         * that you call the base class implementation if you do not
+         * act upon the key.
+         *
+         * The default implementation closes popup widgets if the user
+         * presses the key sequence for QKeySequence::Cancel (typically
+         * the Escape key). Otherwise the event is ignored, so that the
+         * widget’s parent can interpret it. */
+        QWidget::keyPressEvent(event);
+        break;
+    }
+}
+
+/** @brief Paint the widget.
+ *
+ * Reimplemented from base class.
+ *
+ * @param event the paint event
+ *
+ * @internal
+ *
+ * The gamut solid is rendered in the background and cached in
+ * @ref GamutSolidViewerPrivate::m_image. While the view is changing (and
+ * shortly after), it is rendered with reduced resolution, otherwise in
+ * full resolution. Until a new rendering has finished, the last one is
+ * painted (scaled if the size has changed), so the paint event never
+ * blocks. */
+void GamutSolidViewer::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    // Paint on a QImage buffer first, like the other diagrams do, to get
+    // identical anti-aliasing results on all platforms.
+    QImage paintBuffer(maximumPhysicalSquareSize(), // width
+                       maximumPhysicalSquareSize(), // height
+                       QImage::Format_ARGB32_Premultiplied // format
+    );
+    paintBuffer.fill(Qt::transparent);
+    paintBuffer.setDevicePixelRatio(devicePixelRatioF());
+    QPainter bufferPainter(&paintBuffer);
+
+    // Paint the gamut solid
+    d_pointer->startRendering();
+    if (!d_pointer->m_image.isNull()) {
+        const qreal imageSize = d_pointer->requestedImageSize() / devicePixelRatioF();
+        bufferPainter.setRenderHint(QPainter::Antialiasing, false);
+        bufferPainter.drawImage(QRectF(spaceForFocusIndicator(), // left
+                                       spaceForFocusIndicator(), // top
+                                       imageSize, // width
+                                       imageSize), // height
+                                d_pointer->m_image // the image itself
+        );
+    }
+
+    // Paint a focus indicator if the widget has the focus
+    if (hasFocus()) {
+        bufferPainter.setRenderHint(QPainter::Antialiasing, true);
+        QPen pen;
+        pen.setWidth(handleOutlineThickness());
+        pen.setColor(focusIndicatorColor());
+        bufferPainter.setPen(pen);
+        const qreal center = maximumWidgetSquareSize() / 2.0;
+        bufferPainter.drawEllipse(
+            // center:
+            QPointF(center, center),
+            // x radius:
+            center - handleOutlineThickness() / 2.0,
+            // y radius:
+            center - handleOutlineThickness() / 2.0);
+    }
+
+    // Paint the buffer to the actual widget
+    QPainter widgetPainter(this);
+    widgetPainter.setRenderHint(QPainter::Antialiasing, false);
+    widgetPainter.drawImage(QPoint(0, 0), paintBuffer);
+}
+
+/** @brief React on a resize event.
+ *
+ * Reimplemented from base class.
+ *
+ * @param event The corresponding resize event */
+void GamutSolidViewer::resizeEvent(QResizeEvent *event)
+{
+    // The initial size is rendered directly in full resolution.
+    if (event->oldSize().isValid()) {
+        // While resizing, show fast previews.
+        d_pointer->interact();
+    }
+    /* As by Qt documentation:
+     *     “The widget will be erased and receive a paint event immediately
+     *      after processing the resize event. No drawing need be (or should
+     *      be) done inside this handler.” */
+}
+
+/** @brief Recommended size for the widget.
+ *
+ * Reimplemented from base class.
+ *
+ * @returns Recommended size for the widget.
+ *
+ * @sa @ref minimumSizeHint() */
+QSize GamutSolidViewer::sizeHint() const
+{
+    return minimumSizeHint() * scaleFromMinumumSizeHintToSizeHint;
+}
+
+/** @brief Recommended minimum size for the widget
+ *
+ * Reimplemented from base class.
+ *
+ * @returns Recommended minimum size for the widget.
+ *
+ * @sa @ref sizeHint() */
+QSize GamutSolidViewer::minimumSizeHint() const
+{
+    const int size = 2 * gradientMinimumLength() + 2 * spaceForFocusIndicator();
+    // Expand to the global minimum size for GUI elements
+    return QSize(size, size).expandedTo(QApplication::globalStrut());
+}
+
+} // namespace PerceptualColor
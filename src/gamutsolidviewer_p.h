@@ -0,0 +1,135 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GAMUTSOLIDVIEWER_P_H
+#define GAMUTSOLIDVIEWER_P_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Include the header of the public class of this private implementation.
+#include "PerceptualColor/gamutsolidviewer.h"
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include "constpropagatingrawpointer.h"
+#include "gamutsolidrenderer.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ *  @brief Private implementation within the <em>Pointer to
+ *  implementation</em> idiom */
+class GamutSolidViewer::GamutSolidViewerPrivate final
+{
+public:
+    GamutSolidViewerPrivate(GamutSolidViewer *backLink, const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace);
+    /** @brief Default destructor
+     *
+     * The destructor is non-<tt>virtual</tt> because
+     * the class as a whole is <tt>final</tt>. */
+    ~GamutSolidViewerPrivate() noexcept = default;
+
+    /** @brief Pixel step of the preview renderings during interaction.
+     *
+     * @sa @ref GamutSolidRenderer::render() */
+    static constexpr int previewPixelStep = 4;
+    /** @brief Delay after the last interaction before the full
+     * resolution is rendered, measured in milliseconds. */
+    static constexpr int refinementDelay = 150;
+    /** @brief Degree of rotation per device-independent pixel of
+     * mouse movement. */
+    static constexpr qreal rotationPerPixel = 0.5;
+
+    /** @brief Result of a background rendering. */
+    struct Frame {
+        /** @brief The rendered image. */
+        QImage image;
+        /** @brief Azimuth with which @ref image has been rendered. */
+        qreal azimuth = 0;
+        /** @brief Elevation with which @ref image has been rendered. */
+        qreal elevation = 0;
+        /** @brief Pixel step with which @ref image has been rendered. */
+        int pixelStep = 0;
+        /** @brief The renderer that has been used. It is created by the
+         * first background rendering, because sampling the gamut is
+         * expensive. */
+        QSharedPointer<const GamutSolidRenderer> renderer;
+    };
+
+    /** @brief Internal storage of the @ref azimuth() property */
+    qreal m_azimuth = 30;
+    /** @brief Internal storage of the @ref elevation() property */
+    qreal m_elevation = 20;
+    /** @brief The last finished rendering. A null image if no rendering
+     * has finished yet. */
+    QImage m_image;
+    /** @brief Azimuth with which @ref m_image has been rendered. */
+    qreal m_imageAzimuth = 0;
+    /** @brief Elevation with which @ref m_image has been rendered. */
+    qreal m_imageElevation = 0;
+    /** @brief Pixel step with which @ref m_image has been rendered. */
+    int m_imagePixelStep = 0;
+    /** @brief If currently a mouse drag is rotating the view. */
+    bool m_isMouseEventActive = false;
+    /** @brief Mouse position of the last mouse event of the current
+     * drag. */
+    QPoint m_lastMousePosition;
+    /** @brief Timer that triggers the full-resolution rendering after
+     * the interaction has stopped. */
+    QTimer m_refinementTimer;
+    /** @brief The renderer. Created by the first background rendering,
+     * because sampling the gamut is expensive. */
+    QSharedPointer<const GamutSolidRenderer> m_renderer;
+    /** @brief Watches the background rendering, if any. */
+    QFutureWatcher<Frame> m_renderWatcher;
+    /** @brief Pointer to @ref RgbColorSpace object used to describe the
+     * color space. */
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+
+    void interact();
+    bool isImageUpToDate() const;
+    int requestedImageSize() const;
+    int requestedPixelStep() const;
+    void startRendering();
+    void takeFrame();
+
+private:
+    Q_DISABLE_COPY(GamutSolidViewerPrivate)
+
+    /** @brief Pointer to the object from which <em>this</em> object
+     *  is the private implementation. */
+    ConstPropagatingRawPointer<GamutSolidViewer> q_pointer;
+};
+
+} // namespace PerceptualColor
+
+#endif // GAMUTSOLIDVIEWER_P_H
@@ -34,8 +34,12 @@
 #include <math.h>
 
 #include "helper.h"
+#include "tracepoints.h"
 
 #include <QPainter>
+#include <QtMath>
+
+#include <algorithm>
 
 namespace PerceptualColor
 {
@@ -45,8 +49,13 @@ namespace PerceptualColor
 GradientImage::GradientImage(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace)
     : m_rgbColorSpace(colorSpace)
 {
-    setFirstColor(LchaDouble(0, 0, 0, 1));
-    setFirstColor(LchaDouble(1000, 0, 0, 1));
+    GradientStop firstStop;
+    firstStop.position = 0;
+    firstStop.color = LchaDouble(0, 0, 0, 1);
+    GradientStop secondStop;
+    secondStop.position = 1;
+    secondStop.color = LchaDouble(100, 0, 0, 1);
+    setStops({firstStop, secondStop});
 }
 
 /** @brief Normalizes the value and bounds it to the LCH color space.
@@ -73,46 +82,175 @@ LchaDouble GradientImage::completlyNormalizedAndBounded(const LchaDouble &color)
     return result;
 }
 
-/** @brief Setter for the first color property.
- * @param newFirstColor The new first color.
- * @sa @ref m_firstColorCorrected */
-void GradientImage::setFirstColor(const LchaDouble &newFirstColor)
+/** @brief Compares two stop lists.
+ * @param first the first stop list
+ * @param second the second stop list
+ * @returns <tt>true</tt> if both lists have the same number of stops, and
+ * all stops have the same position, the same color coordinates and the
+ * same hue interpolation. <tt>false</tt> otherwise. */
+bool GradientImage::hasSameStops(const QVector<GradientStop> &first, const QVector<GradientStop> &second)
 {
-    LchaDouble correctedNewFirstColor = completlyNormalizedAndBounded(newFirstColor);
-    if (!m_firstColorCorrected.hasSameCoordinates(correctedNewFirstColor)) {
-        m_firstColorCorrected = correctedNewFirstColor;
-        updateSecondColor();
-        // Free the memory used by the old image.
+    if (first.count() != second.count()) {
+        return false;
+    }
+    for (int i = 0; i < first.count(); ++i) {
+        if ((first.at(i).position != second.at(i).position) //
+            || (!first.at(i).color.hasSameCoordinates(second.at(i).color)) //
+            || (first.at(i).hueInterpolation != second.at(i).hueInterpolation)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Setter for the stops property.
+ *
+ * @param newStops The new stops. The colors are normalized and bound to the
+ * LCH color space (see @ref completlyNormalizedAndBounded()). The positions
+ * are bound to <tt>[0, 1]</tt>. The stops do not need to be sorted; they
+ * are sorted by position (stops with identical positions keep their
+ * relative order, which allows hard color changes). A single stop
+ * produces a solid color; an empty list produces a transparent gradient.
+ *
+ * @sa @ref stops() */
+void GradientImage::setStops(const QVector<GradientStop> &newStops)
+{
+    QVector<GradientStop> correctedStops = newStops;
+    for (GradientStop &stop : correctedStops) {
+        stop.position = qBound<qreal>(0, stop.position, 1);
+        stop.color = completlyNormalizedAndBounded(stop.color);
+    }
+    std::stable_sort(correctedStops.begin(), //
+                     correctedStops.end(),
+                     [](const GradientStop &first, const GradientStop &second) {
+                         return first.position < second.position;
+                     });
+    if (!hasSameStops(m_stops, correctedStops)) {
+        m_stops = correctedStops;
+        updateUnwrappedHues();
+        // Free the memory used by the old ramp and the old image.
+        m_ramp.clear();
         m_image = QImage();
     }
 }
 
-/** @brief Setter for the second color property.
- * @param newSecondColor The new second color.
- * @sa @ref m_secondColorCorrectedAndAltered */
+/** @brief Getter for the stops property.
+ *
+ * @returns The stops, normalized and sorted by position.
+ *
+ * @sa @ref setStops() */
+QVector<GradientStop> GradientImage::stops() const
+{
+    return m_stops;
+}
+
+/** @brief Setter for the first color.
+ *
+ * Convenience function for two-stop gradients: Changes the color of
+ * the first stop.
+ *
+ * @param newFirstColor The new first color. */
+void GradientImage::setFirstColor(const LchaDouble &newFirstColor)
+{
+    QVector<GradientStop> newStops = m_stops;
+    if (newStops.isEmpty()) {
+        newStops.append(GradientStop());
+    }
+    newStops.first().color = newFirstColor;
+    setStops(newStops);
+}
+
+/** @brief Setter for the second color.
+ *
+ * Convenience function for two-stop gradients: Changes the color of
+ * the last stop.
+ *
+ * @param newSecondColor The new second color. */
 void GradientImage::setSecondColor(const LchaDouble &newSecondColor)
 {
-    LchaDouble correctedNewSecondColor = completlyNormalizedAndBounded(newSecondColor);
-    if (!m_secondColorCorrectedAndAltered.hasSameCoordinates(correctedNewSecondColor)) {
-        m_secondColorCorrectedAndAltered = correctedNewSecondColor;
-        updateSecondColor();
-        // Free the memory used by the old image.
-        m_image = QImage();
+    QVector<GradientStop> newStops = m_stops;
+    if (newStops.count() < 2) {
+        GradientStop lastStop;
+        lastStop.position = 1;
+        newStops.append(lastStop);
+    }
+    newStops.last().color = newSecondColor;
+    setStops(newStops);
+}
+
+/** @brief Updates @ref m_unwrappedHues
+ *
+ * This update takes into account the current value of @ref m_stops. */
+void GradientImage::updateUnwrappedHues()
+{
+    m_unwrappedHues.resize(m_stops.count());
+    for (int i = 0; i < m_stops.count(); ++i) {
+        if (i == 0) {
+            m_unwrappedHues[i] = m_stops.at(i).color.h;
+            continue;
+        }
+        // Difference within [0°, 360°[
+        qreal difference = fmod(m_stops.at(i).color.h - m_stops.at(i - 1).color.h, 360);
+        if (difference < 0) {
+            difference += 360;
+        }
+        switch (m_stops.at(i).hueInterpolation) {
+        case HueInterpolation::Shorter:
+            if (difference > 180) {
+                difference -= 360;
+            }
+            break;
+        case HueInterpolation::Longer:
+            if ((difference > 0) && (difference < 180)) {
+                difference -= 360;
+            }
+            break;
+        case HueInterpolation::Increasing:
+            break;
+        case HueInterpolation::Decreasing:
+            if (difference > 0) {
+                difference -= 360;
+            }
+            break;
+        }
+        m_unwrappedHues[i] = m_unwrappedHues.at(i - 1) + difference;
     }
 }
 
-/** @brief Updates @ref m_secondColorCorrectedAndAltered
+/** @brief Updates @ref m_ramp
  *
- * This update takes into account the current values of
- * @ref m_firstColorCorrected and @ref m_secondColorCorrectedAndAltered. */
-void GradientImage::updateSecondColor()
+ * Converts about @ref rampResolution colors to premultiplied RGB: The
+ * exact colors of all stops, and colors in between that are distributed
+ * over each segment proportionally to its length. If a color is
+ * out-of-gamut, a nearby substitution color will be used. */
+void GradientImage::updateRamp()
 {
-    m_secondColorCorrectedAndAltered = completlyNormalizedAndBounded(m_secondColorCorrectedAndAltered);
-    if (qAbs(m_firstColorCorrected.h - m_secondColorCorrectedAndAltered.h) > 180) {
-        if (m_firstColorCorrected.h > m_secondColorCorrectedAndAltered.h) {
-            m_secondColorCorrectedAndAltered.h += 360;
-        } else {
-            m_secondColorCorrectedAndAltered.h -= 360;
+    m_ramp.clear();
+    const auto appendEntry = [this](const qreal position, const LchaDouble &color) {
+        const QColor rgbColor = m_rgbColorSpace->toQColorRgbBound(color);
+        m_ramp.append(RampEntry {position, qPremultiply(rgbColor.rgba())});
+    };
+    if (m_stops.isEmpty()) {
+        appendEntry(0, colorFromValue(0));
+        return;
+    }
+    appendEntry(m_stops.first().position, m_stops.first().color);
+    for (int i = 1; i < m_stops.count(); ++i) {
+        const GradientStop &lowerStop = m_stops.at(i - 1);
+        const GradientStop &upperStop = m_stops.at(i);
+        const qreal length = upperStop.position - lowerStop.position;
+        if (length > 0) {
+            // Within the segment, colorFromValue() is unambiguous.
+            const int intervals = qMax(1, qCeil(length * (rampResolution - 1)));
+            for (int j = 1; j < intervals; ++j) {
+                const qreal position = lowerStop.position + length * j / intervals;
+                appendEntry(position, colorFromValue(position));
+            }
+        }
+        // Also for hard color changes (length 0), so that the previous
+        // segment ends exactly with its own stop color.
+        if (length > 0 || !lowerStop.color.hasSameCoordinates(upperStop.color)) {
+            appendEntry(upperStop.position, upperStop.color);
         }
     }
 }
@@ -120,8 +258,8 @@ void GradientImage::updateSecondColor()
 /** @brief Delivers an image of a gradient
  *
  * @returns Delivers an image of a gradient. Its size is @ref m_gradientLength
- * and its height is @ref m_gradientThickness. The first color will be
- * at the left, and the second color will be at the right. The background
+ * and its height is @ref m_gradientThickness. Position <tt>0</tt> will be
+ * at the left, and position <tt>1</tt> will be at the right. The background
  * of transparent colors (if any) will be aligned to the top-left edge.
  *
  * If a color is out-of-gamut, a nearby substitution color will be used. */
@@ -132,6 +270,8 @@ QImage GradientImage::getImage()
         return m_image;
     }
 
+    PERCEPTUALCOLOR_TRACE_SCOPE1(gradient_image_render, m_gradientLength);
+
     // If no cache is available (m_image.isNull()), render a new image.
 
     // Special case: zero-size-image
@@ -141,22 +281,74 @@ QImage GradientImage::getImage()
 
     // If no image is in cache, create a new one (in the cache) and return it.
 
-    // First, create an image of the gradient with only one pixel thickness.
-    // (Color management operations are expensive in CPU time; we try to
-    // minimize this.)
+    // Color management operations are expensive in CPU time. They are
+    // done only once per stop set, for the ramp table.
+    if (m_ramp.isEmpty()) {
+        updateRamp();
+    }
+
+    // First, create an image of the gradient with only one pixel thickness
+    // by sampling the ramp table. The colors are premultiplied, so that
+    // the color of a transparent stop does not bleed into its neighbors.
+    // Each pixel is sampled at its center. The pixels are processed in
+    // spans: One span per interval between two neighbor ramp entries. So
+    // the inner loop has no search and no branches, only arithmetic.
     QImage temp(m_gradientLength, 1, QImage::Format_ARGB32_Premultiplied);
-    temp.fill(Qt::transparent); // Initialize the image with transparency.
-    LchaDouble color;
-    for (int i = 0; i < m_gradientLength; ++i) {
-        color = colorFromValue((i + 0.5) / static_cast<qreal>(m_gradientLength));
-        temp.setPixelColor(i, 0, m_rgbColorSpace->toQColorRgbBound(color));
+    QRgb *const scanLine = reinterpret_cast<QRgb *>(temp.scanLine(0));
+    const RampEntry *const ramp = m_ramp.constData();
+    const int rampCount = m_ramp.count();
+    // Index of the first pixel whose center is not before the position.
+    const auto firstPixelAt = [this](const qreal position) {
+        return qBound(0, qCeil(position * m_gradientLength - 0.5), m_gradientLength);
+    };
+    // Before the first stop
+    const int firstPixel = firstPixelAt(ramp[0].position);
+    std::fill(scanLine, scanLine + firstPixel, ramp[0].color);
+    // Fixed-point factor with 8 fractional bits
+    constexpr int fractionBits = 8;
+    constexpr uint fractionOne = 1 << fractionBits;
+    int spanBegin = firstPixel;
+    for (int index = 0; index + 1 < rampCount; ++index) {
+        const RampEntry &leftEntry = ramp[index];
+        const RampEntry &rightEntry = ramp[index + 1];
+        const int spanEnd = firstPixelAt(rightEntry.position);
+        if (spanEnd <= spanBegin) {
+            // No pixel center within this interval, for example at
+            // a hard color change.
+            continue;
+        }
+        // The weight of the right entry grows linearly with the pixel
+        // index. Within the span, it is within [0, fractionOne].
+        const qreal weightScale = fractionOne //
+            / ((rightEntry.position - leftEntry.position) * m_gradientLength);
+        const qreal weightOffset = (0.5 - leftEntry.position * m_gradientLength) //
+            * weightScale;
+        // Interpolate the channels pairwise: 0x00AA00GG and 0x00RR00BB
+        const uint leftAg = (leftEntry.color >> 8) & 0x00FF00FF;
+        const uint leftRb = leftEntry.color & 0x00FF00FF;
+        const uint rightAg = (rightEntry.color >> 8) & 0x00FF00FF;
+        const uint rightRb = rightEntry.color & 0x00FF00FF;
+        for (int i = spanBegin; i < spanEnd; ++i) {
+            const uint weight = static_cast<uint>(qMax<qreal>(0, i * weightScale + weightOffset));
+            const uint ag = ((leftAg * (fractionOne - weight) + rightAg * weight) >> fractionBits) & 0x00FF00FF;
+            const uint rb = ((leftRb * (fractionOne - weight) + rightRb * weight) >> fractionBits) & 0x00FF00FF;
+            scanLine[i] = (ag << 8) | rb;
+        }
+        spanBegin = spanEnd;
     }
+    // After the last stop
+    std::fill(scanLine + spanBegin, scanLine + m_gradientLength, ramp[rampCount - 1].color);
 
     // Now, create a full image of the gradient
     m_image = QImage(m_gradientLength, m_gradientThickness, QImage::Format_ARGB32_Premultiplied);
     QPainter painter(&m_image);
     // Transparency background
-    if ((m_firstColorCorrected.a != 1) || (m_secondColorCorrectedAndAltered.a != 1)) {
+    const bool hasTransparency = std::any_of(m_stops.constBegin(), //
+                                             m_stops.constEnd(),
+                                             [](const GradientStop &stop) {
+                                                 return stop.color.a != 1;
+                                             });
+    if (hasTransparency || m_stops.isEmpty()) {
         // Fill the image with tiles. (QBrush will ignore
         // the devicePixelRatioF of the image of the tile.)
         painter.fillRect(0, 0, m_gradientLength, m_gradientThickness, QBrush(transparencyBackground(m_devicePixelRatioF)));
@@ -173,18 +365,54 @@ QImage GradientImage::getImage()
 
 /** @brief The color that the gradient has at a given position of the gradient.
  * @param value The position. Valid range: <tt>[0.0, 1.0]</tt>. <tt>0.0</tt>
- * means the first color, <tt>1.0</tt> means the second color, and everything
+ * means the left end, <tt>1.0</tt> means the right end, and everything
  * in between means a color in between.
  * @returns If the position is valid: The color at the given position and
- * its corresponding alpha value. If the position is out-of-range: An
- * arbitrary value. */
+ * its corresponding alpha value. Lightness and chroma are interpolated
+ * premultiplied with alpha. Before the first stop, this is the color
+ * of the first stop; after the last stop, this is the color of the last
+ * stop. If there are no stops at all, a fully transparent color. If the
+ * position is out-of-range: An arbitrary value. */
 LchaDouble GradientImage::colorFromValue(qreal value) const
 {
+    if (m_stops.isEmpty()) {
+        return LchaDouble(0, 0, 0, 0);
+    }
+    if (value <= m_stops.first().position) {
+        return m_stops.first().color;
+    }
+    if (value >= m_stops.last().position) {
+        return m_stops.last().color;
+    }
+    // Search the first stop that is behind the value. (It is guaranteed
+    // to exist, and it is not the first stop.)
+    const auto upper = std::upper_bound(m_stops.constBegin(), //
+                                        m_stops.constEnd(),
+                                        value,
+                                        [](qreal position, const GradientStop &stop) {
+                                            return position < stop.position;
+                                        });
+    const int upperIndex = static_cast<int>(upper - m_stops.constBegin());
+    const int lowerIndex = upperIndex - 1;
+    const GradientStop &lowerStop = m_stops.at(lowerIndex);
+    const GradientStop &upperStop = m_stops.at(upperIndex);
+    // Not 0 because value is < upperStop.position and >= lowerStop.position
+    const qreal factor = (value - lowerStop.position) / (upperStop.position - lowerStop.position);
     LchaDouble color;
-    color.l = m_firstColorCorrected.l + (m_secondColorCorrectedAndAltered.l - m_firstColorCorrected.l) * value;
-    color.c = m_firstColorCorrected.c + (m_secondColorCorrectedAndAltered.c - m_firstColorCorrected.c) * value;
-    color.h = m_firstColorCorrected.h + (m_secondColorCorrectedAndAltered.h - m_firstColorCorrected.h) * value;
-    color.a = m_firstColorCorrected.a + (m_secondColorCorrectedAndAltered.a - m_firstColorCorrected.a) * value;
+    color.a = lowerStop.color.a + (upperStop.color.a - lowerStop.color.a) * factor;
+    color.h = m_unwrappedHues.at(lowerIndex) + (m_unwrappedHues.at(upperIndex) - m_unwrappedHues.at(lowerIndex)) * factor;
+    if (color.a > 0) {
+        // Like CSS, interpolate premultiplied with alpha, so that the
+        // color of a transparent stop does not bleed into the gradient.
+        // The hue is not premultiplied.
+        const qreal lowerWeight = lowerStop.color.a * (1 - factor);
+        const qreal upperWeight = upperStop.color.a * factor;
+        color.l = (lowerStop.color.l * lowerWeight + upperStop.color.l * upperWeight) / color.a;
+        color.c = (lowerStop.color.c * lowerWeight + upperStop.color.c * upperWeight) / color.a;
+    } else {
+        color.l = lowerStop.color.l + (upperStop.color.l - lowerStop.color.l) * factor;
+        color.c = lowerStop.color.c + (upperStop.color.c - lowerStop.color.c) * factor;
+    }
     return color;
 }
 
@@ -32,7 +32,9 @@
 
 #include <QImage>
 #include <QSharedPointer>
+#include <QVector>
 
+#include "PerceptualColor/gradientstop.h"
 #include "PerceptualColor/lchadouble.h"
 #include "rgbcolorspace.h"
 
@@ -42,9 +44,21 @@ namespace PerceptualColor
  *
  *  @brief An image of a gradient.
  *
+ * The gradient has an arbitrary number of stops (see @ref setStops()).
+ * Between two stops, lightness, chroma and alpha are interpolated linearly.
+ * Like in CSS, lightness and chroma are premultiplied with alpha for the
+ * interpolation.
  * As the hue is a circular property, there exists two ways to go one hue to
- * another (clockwise or counter-clockwise). This gradient takes always the
- * shortest way.
+ * another (clockwise or counter-clockwise). Each stop defines the
+ * @ref HueInterpolation for the segment that ends at this stop. By default,
+ * the gradient takes always the shortest way.
+ *
+ * The colors are converted only once per stop set into a ramp table of
+ * about @ref rampResolution premultiplied RGB values. The image itself is
+ * sampled from this table, so that changing the size, the thickness or the
+ * device pixel ratio does not require new color conversions. The table
+ * contains the exact colors of all stops at their exact positions, so that
+ * hard color changes (two stops at the same position) stay sharp.
  *
  * The image has properties that can be accessed by the corresponding setters
  * and getters. You should explicitly set all values <em>before</em> calling
@@ -92,28 +106,48 @@ public:
     void setFirstColor(const LchaDouble &newFirstColor);
     void setGradientLength(const int newGradientLength);
     void setGradientThickness(const int newGradientThickness);
-    void setSecondColor(const LchaDouble &newFirstColor);
+    void setSecondColor(const LchaDouble &newSecondColor);
+    void setStops(const QVector<GradientStop> &newStops);
+    QVector<GradientStop> stops() const;
+
+    /** @brief Number of entries of the ramp table for the whole gradient.
+     *
+     * Each segment between two stops gets a share that corresponds to
+     * its length, but at least its two ends. The colors of the image are
+     * interpolated linearly (in premultiplied RGB) between the entries of
+     * the ramp table. As neighbor entries are very close to each other,
+     * this is visually indistinguishable from a conversion of each
+     * pixel. */
+    static constexpr int rampResolution = 256;
 
 private:
     Q_DISABLE_COPY(GradientImage)
 
+    /** @brief An entry of the ramp table.
+     *
+     * @sa @ref m_ramp */
+    struct RampEntry {
+        /** @brief The position within the gradient. Range:
+         * <tt>[0, 1]</tt> */
+        qreal position;
+        /** @brief The premultiplied RGB value at this position. */
+        QRgb color;
+    };
+
     /** @internal @brief Only for unit tests. */
     friend class TestGradientImage;
 
     // Methods
     static LchaDouble completlyNormalizedAndBounded(const LchaDouble &color);
-    void updateSecondColor();
+    static bool hasSameStops(const QVector<GradientStop> &first, const QVector<GradientStop> &second);
+    void updateRamp();
+    void updateUnwrappedHues();
 
     // Data members
     /** @brief Internal storage of the device pixel ratio as floating point.
      *
      * @sa @ref setDevicePixelRatioF() */
     qreal m_devicePixelRatioF = 1;
-    /** @brief Internal storage of the first color.
-     *
-     * The color is normalized and bound to the LCH color space.
-     * @sa @ref completlyNormalizedAndBounded() */
-    LchaDouble m_firstColorCorrected;
     /** @brief Internal storage for the gradient length, measured in
      * physical pixels.
      *
@@ -136,20 +170,35 @@ private:
     QImage m_image;
     /** @brief Pointer to @ref RgbColorSpace object */
     QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace;
-    /** @brief Internal storage of the second color (corrected and altered
-     * value).
+    /** @brief Internal storage of the ramp table (cache).
+     *
+     * Contains the entries sorted by position, or is empty if it has to
+     * be recalculated. Each stop has an entry at its exact position. At
+     * a hard color change, two entries have the same position: The
+     * first is the end of the previous segment, the second the start of
+     * the next segment.
+     *
+     * @sa @ref updateRamp() */
+    QVector<RampEntry> m_ramp;
+    /** @brief Internal storage of the stops.
+     *
+     * Each color is normalized and bound to the LCH color space. Each
+     * position is bound to <tt>[0, 1]</tt>. The stops are sorted by
+     * position.
+     *
+     * @sa @ref setStops()
+     * @sa @ref completlyNormalizedAndBounded() */
+    QVector<GradientStop> m_stops;
+    /** @brief The hues of @ref m_stops, altered for interpolation.
+     *
+     * Each hue has been altered (by increasing or decreasing it in steps of
+     * 360°) so that the difference to the hue of the previous stop
+     * corresponds to the @ref HueInterpolation of the stop. This is
+     * necessary to easily allow to calculate the intermediate colors of
+     * the gradient by linear interpolation.
      *
-     * The color is normalized and bound to the LCH color space. In an
-     * additional step, it has been altered (by increasing or decreasing the
-     * hue component in steps of 360°) to minimize the distance in hue
-     * from this color to @ref m_firstColorCorrected. This is necessary to
-     * easily allow to calculate the intermediate colors of the gradient, so
-     * that they take the shortest way through the color space.
-     * @sa @ref setFirstColor()
-     * @sa @ref setSecondColor()
-     * @sa @ref completlyNormalizedAndBounded()
-     * @sa @ref updateSecondColor() */
-    LchaDouble m_secondColorCorrectedAndAltered;
+     * @sa @ref updateUnwrappedHues() */
+    QVector<qreal> m_unwrappedHues;
 };
 
 } // namespace PerceptualColor
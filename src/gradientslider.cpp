@@ -41,6 +41,8 @@
 
 #include <helper.h>
 
+#include "performancehud.h"
+
 namespace PerceptualColor
 {
 /** @brief Constructs a vertical slider.
@@ -158,6 +160,60 @@ void GradientSlider::setSecondColor(const PerceptualColor::LchaDouble &newSecond
     }
 }
 
+/** @brief The stops of the gradient.
+ *
+ * @returns The stops of the gradient, normalized and sorted by position.
+ * As long as @ref setStops() has not been called, these are two stops:
+ * @ref firstColor at position <tt>0</tt> and @ref secondColor at
+ * position <tt>1</tt>.
+ *
+ * @sa @ref setStops() */
+QVector<GradientStop> GradientSlider::stops() const
+{
+    return d_pointer->m_gradientImageCache.stops();
+}
+
+/** @brief Sets the stops of the gradient.
+ *
+ * This allows gradients with more than two colors, for example color
+ * scales for data visualization. Between two stops, lightness, chroma
+ * and alpha are interpolated linearly. The hue is interpolated as
+ * defined by the @ref GradientStop::hueInterpolation of the
+ * stop at the end of the segment. The colors are converted only once
+ * per stop set, so redrawing and resizing stay cheap.
+ *
+ * @ref firstColor becomes the color of the first stop, and
+ * @ref secondColor the color of the last stop; the corresponding
+ * notify signals are emitted if they change. Changing @ref firstColor
+ * or @ref secondColor later changes the color of the first or the last
+ * stop; the other stops are kept.
+ *
+ * @param newStops The new stops. They do not need to be sorted. Stops with
+ * identical positions produce a hard color change. The positions are
+ * bound to <tt>[0, 1]</tt>, and the colors are normalized. An empty list
+ * is ignored.
+ *
+ * @sa @ref stops() */
+void GradientSlider::setStops(const QVector<PerceptualColor::GradientStop> &newStops)
+{
+    if (newStops.isEmpty()) {
+        return;
+    }
+    d_pointer->m_gradientImageCache.setStops(newStops);
+    const QVector<GradientStop> sortedStops = d_pointer->m_gradientImageCache.stops();
+    const LchaDouble newFirstColor = sortedStops.first().color;
+    const LchaDouble newSecondColor = sortedStops.last().color;
+    if (!d_pointer->m_firstColor.hasSameCoordinates(newFirstColor)) {
+        d_pointer->m_firstColor = newFirstColor;
+        Q_EMIT firstColorChanged(newFirstColor);
+    }
+    if (!d_pointer->m_secondColor.hasSameCoordinates(newSecondColor)) {
+        d_pointer->m_secondColor = newSecondColor;
+        Q_EMIT secondColorChanged(newSecondColor);
+    }
+    update();
+}
+
 /** @brief Setter for both, @ref firstColor property and @ref secondColor
  * property.
  *
@@ -549,7 +605,7 @@ void GradientSlider::paintEvent(QPaintEvent *event)
         // Normally, this should not change, but maybe on Hight-DPI
         // devices there are some differences.
         d_pointer->physicalPixelLength());
-    paintBuffer = d_pointer->m_gradientImageCache.getImage();
+    paintBuffer = PerformanceHud::image(this, d_pointer->m_gradientImageCache);
 
     // Draw slider handle
     QPainter bufferPainter(&paintBuffer);
@@ -30,6 +30,7 @@
 // Own header
 #include "helper.h"
 
+#include <QLocale>
 #include <QPainter>
 
 #include <math.h>
@@ -182,4 +183,129 @@ QString richTextMarker()
     return QStringLiteral(u"<a/>");
 }
 
+/** @brief Get information from an ICC profile via LittleCMS
+ *
+ * @param profileHandle handle to the ICC profile in which will be searched
+ * @param infoType the type of information that is searched
+ * @returns A QString with the information. First, it searches the
+ * information in the current locale (language code and country code as
+ * provided currently by <tt>QLocale</tt>). If the information is not
+ * available in this locale, it silently falls back to another available
+ * localization. Note that the returned QString() might be empty if the
+ * requested information is not available in the ICC profile. */
+QString getInformationFromProfile(cmsHPROFILE profileHandle, cmsInfoType infoType)
+{
+    // Initialize a char array of 3 values (two for actual characters and a
+    // one for a terminating null)cmsFloat64Number
+    // The recommended default value for language
+    // following LittleCMS documentation is “en”.
+    char languageCode[3] = "en";
+    // The recommended default value for country
+    // following LittleCMS documentation is “US”.
+    char countryCode[3] = "US";
+    // Update languageCode and countryCode to the actual locale (if possible)
+    const QStringList list = QLocale().name().split(QStringLiteral(u"_"));
+    // The locale codes should be ASCII only, so QString::toUtf8() should
+    // return ASCII-only valid results. We do not know what character encoding
+    // LittleCMS expects, but ASCII seems a save choise.
+    const QByteArray currentLocaleLanguage = list.at(0).toUtf8();
+    // QStringList::value() because the locale name might not contain a
+    // country code at all (for example “C”).
+    const QByteArray currentLocaleCountry = list.value(1).toUtf8();
+    if (currentLocaleLanguage.size() == 2) {
+        languageCode[0] = currentLocaleLanguage.at(0);
+        languageCode[1] = currentLocaleLanguage.at(1);
+        // No need for languageCode[2] = 0; for null-terminated string,
+        // because the array was yet initialized
+        if (currentLocaleCountry.size() == 2) {
+            countryCode[0] = currentLocaleCountry.at(0);
+            countryCode[1] = currentLocaleCountry.at(1);
+            // No need for countryCode[2] = 0; for null-terminated string,
+            // because the array was yet initialized
+        }
+    }
+    // Calculate the size of the buffer that we have to provide for
+    // cmsGetProfileInfo in order to return a value.
+    const cmsUInt32Number resultLength = cmsGetProfileInfo(
+        // Profile in which we search:
+        profileHandle,
+        // The type of information we search:
+        infoType,
+        // The preferred language in which we want to get the information:
+        languageCode,
+        // The preferred country for which we want to get the information:
+        countryCode,
+        // Do not actually provide the information,
+        // just return the required buffer size:
+        nullptr,
+        // Do not actually provide the information,
+        // just return the required buffer size:
+        0);
+    // For the actual buffer size, increment by 1. This helps us to
+    // guarantee a null-terminated string later on.
+    const cmsUInt32Number bufferLength = resultLength + 1;
+
+    // Allocate the buffer
+    wchar_t *buffer = new wchar_t[bufferLength];
+    // Initialize the buffer with 0
+    for (cmsUInt32Number i = 0; i < bufferLength; ++i) {
+        *(buffer + i) = 0;
+    }
+
+    // Write the actual information to the buffer
+    cmsGetProfileInfo(
+        // profile in which we search
+        profileHandle,
+        // the type of information we search
+        infoType,
+        // the preferred language in which we want to get the information
+        languageCode,
+        // the preferred country for which we want to get the information
+        countryCode,
+        // the buffer into which the requested information will be written
+        buffer,
+        // the buffer size as previously calculated
+        resultLength);
+    // Make absolutely sure the buffer is null-terminated by marking its last
+    // element (the one that was the +1 "extra" element) as null.
+    *(buffer + (bufferLength - 1)) = 0;
+
+    // Create a QString() from the from the buffer
+    // cmsGetProfileInfo returns often strings that are smaller than the
+    // previously calculated buffer size. But it seems they are
+    // null-terminated strings. So we read only up to the first null value.
+    // This is save, because we made sure previously that the buffer is
+    // indeed null-terminated.
+    // QString::fromWCharArray will return a QString. It accepts arrays of
+    // wchar_t. wchar_t might have different sizes, either 16 bit or 32 bit
+    // depending on the operating system. As Qt’s documantation of
+    // QString::fromWCharArray() says:
+    //
+    //     “If wchar is 4 bytes, the string is interpreted as UCS-4,
+    //      if wchar is 2 bytes it is interpreted as UTF-16.”
+    //
+    // However, apparently this is not exact: When wchar is 4 bytes, surrogate
+    // pairs in the code unit array are interpretated like UTF-16: The
+    // surrogate pair is recognized as such. TODO static_assert that this is
+    // true (which seems complicate: better provide a unit test!) (Which
+    // is not strictly UTF-32 conform). Single surrogates cannot be
+    // interpretated correctly, but there will be no crash:
+    // QString::fromWCharArray will continue to read, also the part after
+    // the first UTF error. We can rely on this behaviour: As we do
+    // not really know the encoding of the buffer that LittleCMS returns.
+    // Therefore, it is a good idea to be compatible for various
+    // interpretations.
+    QString result = QString::fromWCharArray(
+        // Convert to string with these parameters:
+        buffer, // read from this buffer
+        -1      // read until the first null element
+    );
+
+    // Free allocated memory of the buffer
+    delete[] buffer;
+
+    // Return
+    return result;
+}
+
 } // namespace PerceptualColor
@@ -235,6 +235,8 @@ constexpr int pageStepHue = 10 * singleStepHue;
  * its single step. */
 constexpr int pageStepLightness = 10 * singleStepLightness;
 
+QString getInformationFromProfile(cmsHPROFILE profileHandle, cmsInfoType infoType);
+
 QString richTextMarker();
 
 double roundToDigits(double value, int precision);
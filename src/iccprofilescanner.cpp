@@ -0,0 +1,205 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "iccprofilescanner.h"
+
+#include "helper.h"
+#include "iohandlerfactory.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @brief The default directories for ICC profiles.
+ *
+ * @returns The directories where ICC profiles are installed following the
+ * <a href="https://www.freedesktop.org/wiki/Specifications/icc_profiles_in_x_spec/">
+ * freedesktop.org conventions</a>: The subdirectories <tt>color/icc</tt>
+ * and <tt>icc</tt> of each generic data location (for example
+ * <tt>/usr/share/color/icc</tt> or <tt>~/.local/share/icc</tt>). Only
+ * existing directories are returned. */
+QStringList IccProfileScanner::defaultDirectories()
+{
+    QStringList result;
+    const QStringList dataLocations = QStandardPaths::standardLocations( //
+        QStandardPaths::GenericDataLocation);
+    for (const QString &dataLocation : dataLocations) {
+        const QStringList candidates {dataLocation + QStringLiteral("/color/icc"), //
+                                      dataLocation + QStringLiteral("/icc")};
+        for (const QString &candidate : candidates) {
+            const QString cleanPath = QDir::cleanPath(candidate);
+            if (QFileInfo(cleanPath).isDir() && !result.contains(cleanPath)) {
+                result.append(cleanPath);
+            }
+        }
+    }
+    return result;
+}
+
+/** @brief Scans directories for RGB profiles.
+ *
+ * @param directories The directories to scan. Subdirectories are scanned
+ * recursively. Non-existing directories are ignored.
+ *
+ * @returns Information about all RGB profiles of the display class or the
+ * color space class, sorted by file name. Each file is listed only once,
+ * even if it is reachable from more than one of the given directories.
+ *
+ * @note This function blocks until all files have been scanned. */
+QVector<IccProfileInformation> IccProfileScanner::scan(const QStringList &directories)
+{
+    QStringList fileNames;
+    for (const QString &directory : directories) {
+        QDirIterator iterator(directory, //
+                              QDir::Files | QDir::Readable,
+                              QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (iterator.hasNext()) {
+            fileNames.append(iterator.next());
+        }
+    }
+    fileNames.removeDuplicates();
+
+    const QVector<CacheEntry> entries = //
+        QtConcurrent::blockingMapped<QVector<CacheEntry>>(fileNames, &IccProfileScanner::scanFileCached);
+
+    QVector<IccProfileInformation> result;
+    for (const CacheEntry &entry : entries) {
+        if (entry.isRgbProfile) {
+            result.append(entry.information);
+        }
+    }
+    std::sort(result.begin(), //
+              result.end(),
+              [](const IccProfileInformation &first, const IccProfileInformation &second) {
+                  return first.fileName < second.fileName;
+              });
+    return result;
+}
+
+/** @brief The cache of @ref scanFileCached().
+ *
+ * @returns The cache, with the absolute file names as keys.
+ *
+ * @pre The caller holds @ref cacheMutex(). */
+QHash<QString, IccProfileScanner::CacheEntry> &IccProfileScanner::cache()
+{
+    // Thread-safe initialization of static local variables
+    // is guaranteed since C++11.
+    static QHash<QString, CacheEntry> result;
+    return result;
+}
+
+/** @brief The mutex that guards @ref cache().
+ *
+ * @returns The mutex that guards @ref cache(). */
+QMutex &IccProfileScanner::cacheMutex()
+{
+    static QMutex result;
+    return result;
+}
+
+/** @brief Scans a single file, using the cache if possible.
+ *
+ * @param fileName The name of the file.
+ * @returns The cached result of @ref scanFile() if the file has not been
+ * modified since, a newly calculated result otherwise. */
+IccProfileScanner::CacheEntry IccProfileScanner::scanFileCached(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString absoluteFileName = fileInfo.absoluteFilePath();
+    const QDateTime lastModified = fileInfo.lastModified();
+    {
+        QMutexLocker locker(&cacheMutex());
+        const auto iterator = cache().constFind(absoluteFileName);
+        if ((iterator != cache().constEnd()) && (iterator->lastModified == lastModified)) {
+            return iterator.value();
+        }
+    }
+    // Scan without holding the mutex, so that other
+    // threads can scan other files at the same time.
+    CacheEntry result = scanFile(absoluteFileName);
+    result.lastModified = lastModified;
+    result.information.lastModified = lastModified;
+    QMutexLocker locker(&cacheMutex());
+    cache().insert(absoluteFileName, result);
+    return result;
+}
+
+/** @brief Scans a single file.
+ *
+ * Reads only the ICC header, the tag table and (for matching profiles)
+ * the description tag.
+ *
+ * @param fileName The name of the file.
+ * @returns The scan result. @ref CacheEntry::lastModified is not set. */
+IccProfileScanner::CacheEntry IccProfileScanner::scanFile(const QString &fileName)
+{
+    CacheEntry result;
+    cmsIOHANDLER *myIOHandler = IOHandlerFactory::createReadOnly(nullptr, fileName);
+    if (myIOHandler == nullptr) {
+        return result;
+    }
+    // LittleCMS reads the header and the tag table when opening the
+    // profile. The tag data itself is read only on demand.
+    cmsHPROFILE myProfileHandle = cmsOpenProfileFromIOhandlerTHR( //
+        nullptr,                                                  // ContextID
+        myIOHandler                                               // IO handler
+    );
+    if (myProfileHandle == nullptr) {
+        // We do not have to delete myIOHandler manually.
+        // (cmsOpenProfileFromIOhandlerTHR did that when
+        // failing to open the profile handle.)
+        return result;
+    }
+    const cmsProfileClassSignature deviceClass = cmsGetDeviceClass(myProfileHandle);
+    const bool isSupportedClass = (deviceClass == cmsSigDisplayClass) //
+        || (deviceClass == cmsSigColorSpaceClass);
+    if (isSupportedClass && (cmsGetColorSpace(myProfileHandle) == cmsSigRgbData)) {
+        result.isRgbProfile = true;
+        result.information.fileName = fileName;
+        result.information.description = getInformationFromProfile( //
+            myProfileHandle,
+            cmsInfoDescription);
+    }
+    cmsCloseProfile(myProfileHandle);
+    // We do not have to delete myIOHandler manually.
+    // (myCmsProfileHandle did  that when cmsCloseProfile() was invoked.)
+    return result;
+}
+
+} // namespace PerceptualColor
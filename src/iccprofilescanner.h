@@ -0,0 +1,108 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ICCPROFILESCANNER_H
+#define ICCPROFILESCANNER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Information about an ICC profile file.
+ *
+ * @sa @ref IccProfileScanner */
+struct IccProfileInformation {
+    /** @brief The absolute file name of the profile. */
+    QString fileName;
+    /** @brief The description of the profile, in the current locale
+     * if available. Might be empty. */
+    QString description;
+    /** @brief The modification time of the file when it was scanned. */
+    QDateTime lastModified;
+};
+
+/** @internal
+ *
+ * @brief Fast scanner for ICC profile directories.
+ *
+ * Creating an @ref RgbColorSpace for each file just to offer a list of
+ * available profiles would be slow: It parses the whole profile and
+ * creates various color transforms. This scanner instead opens each file
+ * via @ref IOHandlerFactory and lets LittleCMS read only the ICC header and
+ * the tag table (LittleCMS reads tag data lazily). Only the description
+ * tag is actually read, and only for profiles that pass the header tests:
+ * RGB profiles of the display class or the color space class.
+ *
+ * The files are scanned in parallel (via <tt>QtConcurrent</tt>). The
+ * results are cached by file name and modification time, so that scanning
+ * again the same directories only costs a <tt>stat()</tt> call per file.
+ *
+ * @note All functions are thread-safe. */
+class IccProfileScanner final
+{
+public:
+    static QStringList defaultDirectories();
+    static QVector<IccProfileInformation> scan(const QStringList &directories);
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    IccProfileScanner() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestIccProfileScanner;
+
+    /** @brief A cache entry.
+     *
+     * @sa @ref cache() */
+    struct CacheEntry {
+        /** @brief The modification time of the file when it was scanned. */
+        QDateTime lastModified;
+        /** @brief If the file is a usable RGB profile. */
+        bool isRgbProfile = false;
+        /** @brief The information, valid only if @ref isRgbProfile. */
+        IccProfileInformation information;
+    };
+
+    static QHash<QString, CacheEntry> &cache();
+    static QMutex &cacheMutex();
+    static CacheEntry scanFile(const QString &fileName);
+    static CacheEntry scanFileCached(const QString &fileName);
+};
+
+} // namespace PerceptualColor
+
+#endif // ICCPROFILESCANNER_H
@@ -0,0 +1,279 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own header
+#include "imagepyramid.h"
+
+#include <QMutexLocker>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief One-dimensional area-averaging filter.
+ *
+ * For each destination index <tt>i</tt>, the source indices
+ * <tt>index[first[i]]</tt> to <tt>index[first[i + 1] - 1]</tt> contribute
+ * with the corresponding <tt>weight</tt>. The weights of each destination
+ * index sum up to <tt>1</tt>. */
+struct AreaFilter {
+    /** @brief Position of the first tap of each destination index,
+     * followed by the total number of taps. */
+    QVector<int> first;
+    /** @brief Source index of each tap */
+    QVector<int> index;
+    /** @brief Weight of each tap */
+    QVector<float> weight;
+};
+
+/** @internal
+ *
+ * @brief Calculates an area-averaging filter.
+ *
+ * @param sourceLength Number of source pixels. Must be positive.
+ * @param targetLength Number of destination pixels. Must be positive and
+ * not bigger than <tt>sourceLength</tt>.
+ * @returns The filter. Each destination pixel covers the corresponding
+ * (fractional) range of source pixels; each source pixel is weighted
+ * by the part of it that is covered. */
+AreaFilter areaFilter(int sourceLength, int targetLength)
+{
+    AreaFilter result;
+    result.first.reserve(targetLength + 1);
+    const double scale = static_cast<double>(sourceLength) / targetLength;
+    for (int i = 0; i < targetLength; ++i) {
+        result.first.append(result.index.count());
+        const double begin = i * scale;
+        const double end = qMin<double>((i + 1) * scale, sourceLength);
+        for (int source = static_cast<int>(begin); source < end; ++source) {
+            const double coverage = qMin<double>(end, source + 1) - qMax<double>(begin, source);
+            if (coverage > 0) {
+                result.index.append(source);
+                result.weight.append(static_cast<float>(coverage / scale));
+            }
+        }
+    }
+    result.first.append(result.index.count());
+    return result;
+}
+
+} // namespace
+
+/** @brief Constructor
+ *
+ * Only keeps the image. The levels are created on first use.
+ *
+ * @param image The original image. */
+ImagePyramid::ImagePyramid(const QImage &image)
+    : m_original(image)
+{
+}
+
+/** @brief The levels of the pyramid.
+ *
+ * Creates the levels if they do not exist yet.
+ *
+ * @returns The levels. See @ref m_levels for details. */
+QVector<QImage> ImagePyramid::levels() const
+{
+    QMutexLocker locker(&m_levelsMutex);
+    if (m_levels.isEmpty() && !m_original.isNull()) {
+        // Does not copy the data if the image has yet this format.
+        QImage level = m_original.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        m_levels.append(level);
+        while (level.width() > 1 || level.height() > 1) {
+            level = areaAverage(level, QSize((level.width() + 1) / 2, (level.height() + 1) / 2));
+            m_levels.append(level);
+        }
+    }
+    return m_levels;
+}
+
+/** @brief The size of the original image.
+ *
+ * @returns The size of the original image. This is the biggest size
+ * that @ref scaled() can provide. */
+QSize ImagePyramid::baseSize() const
+{
+    if (m_original.isNull()) {
+        return QSize();
+    }
+    return m_original.size();
+}
+
+/** @brief Memory usage
+ *
+ * @returns The memory usage of the original image and of all levels that
+ * will be created from it, measured in KiB, but at least <tt>1</tt>.
+ * Suitable as cost for <tt>QCache</tt>. As the levels are created
+ * lazily, this is the memory usage after the first call of
+ * @ref scaled() with a smaller size; it is calculated without
+ * creating the levels. */
+int ImagePyramid::cost() const
+{
+    if (m_original.isNull()) {
+        return 1;
+    }
+    qsizetype bytes = m_original.sizeInBytes();
+    QSize size = m_original.size();
+    while (size.width() > 1 || size.height() > 1) {
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+        // Format_ARGB32_Premultiplied has 4 bytes per pixel.
+        bytes += static_cast<qsizetype>(size.width()) * size.height() * 4;
+    }
+    return qMax(1, static_cast<int>(bytes / 1024));
+}
+
+/** @brief Number of levels
+ *
+ * Creates the levels if they do not exist yet.
+ *
+ * @returns The number of levels, including the level that has the
+ * size of the original image. */
+int ImagePyramid::levelCount() const
+{
+    return levels().count();
+}
+
+/** @brief Derives an image of a given size.
+ *
+ * Creates the levels if they do not exist yet and if they are needed
+ * for the requested size.
+ *
+ * @param size The requested size, measured in physical pixels.
+ * @returns If <tt>size</tt> is the size of the original image, the original
+ * image itself (without copying its data). Otherwise, if <tt>size</tt> is valid and not bigger
+ * than the original image, the original image resampled to the requested
+ * size, in the format and with the device pixel ratio of the original
+ * image. Otherwise, a null image. */
+QImage ImagePyramid::scaled(const QSize &size) const
+{
+    if (m_original.isNull() || size.isEmpty() //
+        || size.width() > m_original.width() //
+        || size.height() > m_original.height()) {
+        return QImage();
+    }
+    if (size == m_original.size()) {
+        // Does not need the levels.
+        return m_original;
+    }
+    const QVector<QImage> allLevels = levels();
+    // Find the smallest level that is still big enough.
+    int levelIndex = 0;
+    while ((levelIndex + 1 < allLevels.count()) //
+           && (allLevels.at(levelIndex + 1).width() >= size.width()) //
+           && (allLevels.at(levelIndex + 1).height() >= size.height())) {
+        ++levelIndex;
+    }
+    QImage result = areaAverage(allLevels.at(levelIndex), size) //
+                        .convertToFormat(m_original.format());
+    result.setDevicePixelRatio(m_original.devicePixelRatio());
+    return result;
+}
+
+/** @brief Resamples an image with an area-averaging filter.
+ *
+ * The filter is separable: First the rows are resampled, than
+ * the columns.
+ *
+ * @param source The source image. Must be in the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>.
+ * @param targetSize The size of the result. Must not be bigger than the
+ * size of the source image.
+ * @returns The resampled image, in the format
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>.
+ *
+ * @note As the filter is applied to premultiplied values, the result is
+ * a valid premultiplied image: The weighted average of values that
+ * are not bigger than their alpha is not bigger than the weighted
+ * average of their alpha. */
+QImage ImagePyramid::areaAverage(const QImage &source, const QSize &targetSize)
+{
+    const int sourceHeight = source.height();
+    const int targetWidth = targetSize.width();
+    const int targetHeight = targetSize.height();
+    const AreaFilter horizontal = areaFilter(source.width(), targetWidth);
+    const AreaFilter vertical = areaFilter(sourceHeight, targetHeight);
+
+    // Horizontal pass: targetWidth × sourceHeight pixels with 4 channels
+    // in the order alpha, red, green, blue.
+    QVector<float> intermediate(targetWidth * sourceHeight * 4);
+    for (int y = 0; y < sourceHeight; ++y) {
+        const QRgb *sourceLine = reinterpret_cast<const QRgb *>(source.constScanLine(y));
+        float *intermediateLine = intermediate.data() + y * targetWidth * 4;
+        for (int x = 0; x < targetWidth; ++x) {
+            float a = 0;
+            float r = 0;
+            float g = 0;
+            float b = 0;
+            for (int tap = horizontal.first.at(x); tap < horizontal.first.at(x + 1); ++tap) {
+                const QRgb pixel = sourceLine[horizontal.index.at(tap)];
+                const float weight = horizontal.weight.at(tap);
+                a += qAlpha(pixel) * weight;
+                r += qRed(pixel) * weight;
+                g += qGreen(pixel) * weight;
+                b += qBlue(pixel) * weight;
+            }
+            intermediateLine[x * 4] = a;
+            intermediateLine[x * 4 + 1] = r;
+            intermediateLine[x * 4 + 2] = g;
+            intermediateLine[x * 4 + 3] = b;
+        }
+    }
+
+    // Vertical pass
+    QImage result(targetSize, QImage::Format_ARGB32_Premultiplied);
+    QVector<float> accumulator(targetWidth * 4);
+    for (int y = 0; y < targetHeight; ++y) {
+        accumulator.fill(0);
+        float *accumulatorData = accumulator.data();
+        for (int tap = vertical.first.at(y); tap < vertical.first.at(y + 1); ++tap) {
+            const float *intermediateLine = intermediate.constData() + vertical.index.at(tap) * targetWidth * 4;
+            const float weight = vertical.weight.at(tap);
+            for (int i = 0; i < targetWidth * 4; ++i) {
+                accumulatorData[i] += intermediateLine[i] * weight;
+            }
+        }
+        QRgb *resultLine = reinterpret_cast<QRgb *>(result.scanLine(y));
+        for (int x = 0; x < targetWidth; ++x) {
+            const int alpha = qBound(0, qRound(accumulatorData[x * 4]), 255);
+            // Bound to alpha, to be robust against floating point errors.
+            resultLine[x] = qRgba(qBound(0, qRound(accumulatorData[x * 4 + 1]), alpha),
+                                  qBound(0, qRound(accumulatorData[x * 4 + 2]), alpha),
+                                  qBound(0, qRound(accumulatorData[x * 4 + 3]), alpha),
+                                  alpha);
+        }
+    }
+    return result;
+}
+
+} // namespace PerceptualColor
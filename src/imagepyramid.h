@@ -0,0 +1,114 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QVector>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A downsampled pyramid (mipmap) of an image.
+ *
+ * Rendering a diagram image is expensive, because each pixel goes through
+ * a color transform. When the same diagram is needed at several sizes,
+ * it is much faster to render it once at the biggest size and to derive
+ * the smaller sizes by resampling.
+ *
+ * The construction only keeps the original image, which is cheap. When
+ * @ref scaled() is called the first time with a size that is smaller
+ * than the original image, this class creates a chain of levels. Each
+ * level has half the width and half the height of the previous one
+ * (rounded up), down to a single pixel. The first level is the original
+ * image itself (converted to premultiplied alpha if necessary); the
+ * other levels need about a third of its memory. So images that are
+ * never requested at a smaller size (for example the images of a diagram
+ * that is being dragged) do not pay for the levels. @ref scaled() derives
+ * an image of any size
+ * that is not bigger than the original image from the smallest level that
+ * is big enough. That means that the resampling never has to cover more
+ * than two source pixels per destination pixel in each direction.
+ *
+ * All resampling uses an area-averaging (box) filter on premultiplied
+ * alpha. With non-premultiplied alpha, the color of transparent pixels
+ * (which is arbitrary) would bleed into the neighboring pixels and
+ * produce dark fringes at the border of the gamut.
+ *
+ * Downsampling is not exactly the same as rendering directly at the
+ * smaller size. The caller has to decide if the result is good enough.
+ *
+ * @note All functions are thread-safe. Apart from the lazy creation of
+ * the levels, which is guarded by a mutex, objects are immutable
+ * after construction. */
+class ImagePyramid final
+{
+public:
+    explicit ImagePyramid(const QImage &image);
+    /** @brief Default destructor */
+    ~ImagePyramid() noexcept = default;
+    QSize baseSize() const;
+    int cost() const;
+    int levelCount() const;
+    QImage scaled(const QSize &size) const;
+
+private:
+    static QImage areaAverage(const QImage &source, const QSize &targetSize);
+    QVector<QImage> levels() const;
+
+    /** @brief The original image. */
+    QImage m_original;
+    /** @brief The levels, in <tt>QImage::Format_ARGB32_Premultiplied</tt>.
+     *
+     * Created on first use by @ref levels(). Guarded by
+     * @ref m_levelsMutex.
+     *
+     * The first level is the original image. If the original image has
+     * already this format, it shares its data with the original image.
+     * Each following level has half the width and half the height of
+     * the previous one (rounded up). The last level has a size of
+     * 1 × 1 pixel. Empty if the original image is null or if the levels
+     * have not been created yet. */
+    mutable QVector<QImage> m_levels;
+    /** @brief Guards @ref m_levels. */
+    mutable QMutex m_levelsMutex;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestDiagramImageCache;
+    /** @internal @brief Only for unit tests. */
+    friend class TestImagePyramid;
+};
+
+} // namespace PerceptualColor
+
+#endif // IMAGEPYRAMID_H
@@ -33,6 +33,7 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QSaveFile>
 #include <QtGlobal>
 
 #include <lcms2_plugin.h>
@@ -52,7 +53,7 @@ namespace PerceptualColor
  * been read), <tt>0</tt> is returned. */
 cmsUInt32Number IOHandlerFactory::read(cmsIOHANDLER *iohandler, void *Buffer, cmsUInt32Number size, cmsUInt32Number count)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
+    QFileDevice *const myFile = static_cast<QFileDevice *>(iohandler->stream);
     const cmsUInt32Number numberOfBytesRequested = size * count;
     const qint64 numberOfBytesRead = myFile->read( //
         static_cast<char *>(Buffer),
@@ -71,7 +72,7 @@ cmsUInt32Number IOHandlerFactory::read(cmsIOHANDLER *iohandler, void *Buffer, cm
  * occurred. */
 cmsBool IOHandlerFactory::seek(cmsIOHANDLER *iohandler, cmsUInt32Number offset)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
+    QFileDevice *const myFile = static_cast<QFileDevice *>(iohandler->stream);
     const bool seekSucceeded = myFile->seek(offset);
     if (!seekSucceeded) {
         qDebug() << QStringLiteral("Seek error; probably corrupted file");
@@ -85,7 +86,7 @@ cmsBool IOHandlerFactory::seek(cmsIOHANDLER *iohandler, cmsUInt32Number offset)
  * @returns The position that data is written to or read from. */
 cmsUInt32Number IOHandlerFactory::tell(cmsIOHANDLER *iohandler)
 {
-    const QFile *const myFile = static_cast<QFile *>(iohandler->stream);
+    const QFileDevice *const myFile = static_cast<QFileDevice *>(iohandler->stream);
     return static_cast<cmsUInt32Number>(myFile->pos());
 }
 
@@ -98,26 +99,66 @@ cmsUInt32Number IOHandlerFactory::tell(cmsIOHANDLER *iohandler)
  * @param Buffer The buffer that should be written
  * @returns Returns <tt>true</tt> on success, <tt>false</tt> on error.
  *
- * @note Because @ref IOHandlerFactory only provides support for read-only
- * handlers, this function does nothing and returns always <tt>false</tt>. */
+ * @note For read-only handlers, this function does nothing and returns
+ * always <tt>false</tt>. */
 cmsBool IOHandlerFactory::write(cmsIOHANDLER *iohandler, cmsUInt32Number size, const void *Buffer)
 {
-    Q_UNUSED(iohandler);
-    Q_UNUSED(size);
-    Q_UNUSED(Buffer);
-    return false;
+    QFileDevice *const myFile = static_cast<QFileDevice *>(iohandler->stream);
+    if (!myFile->isWritable()) {
+        return false;
+    }
+    const qint64 numberOfBytesWritten = myFile->write( //
+        static_cast<const char *>(Buffer),
+        size);
+    if (numberOfBytesWritten != size) {
+        return false;
+    }
+    // LittleCMS relies on UsedSpace to know the size of the profile.
+    // Overwriting already written data (after a seek) does not
+    // enlarge the file.
+    iohandler->UsedSpace = qMax( //
+        iohandler->UsedSpace,
+        static_cast<cmsUInt32Number>(myFile->pos()));
+    return true;
 }
 
 /** @brief Closes the file and deletes the file handler.
+ *
+ * For write-only handlers, the written data replaces now the
+ * target file, unless @ref cancelWriting() has been called.
+ *
  * @param iohandler The <tt>cmsIOHANDLER</tt> on which to operate
  * @returns <tt>true</tt> on success. */
 cmsBool IOHandlerFactory::close(cmsIOHANDLER *iohandler)
 {
-    QFile *const myFile = static_cast<QFile *>(iohandler->stream);
+    QFileDevice *const myFile = static_cast<QFileDevice *>(iohandler->stream);
+    bool result = true;
+    QSaveFile *const mySaveFile = qobject_cast<QSaveFile *>(myFile);
+    if (mySaveFile != nullptr) {
+        result = mySaveFile->commit();
+    }
     delete myFile; // This will also close the file.
     iohandler->stream = nullptr;
     _cmsFree(iohandler->ContextID, iohandler);
-    return true;
+    return result;
+}
+
+/** @brief Discards the data of a write-only handler.
+ *
+ * When the handler is closed afterwards, the target file is left
+ * untouched, and <tt>cmsCloseIOhandler</tt> returns <tt>false</tt>.
+ * Use this if writing the data has failed, so that no incomplete file
+ * is left behind.
+ *
+ * @param iohandler A handler created by @ref createWriteOnly(). For other
+ * handlers, this function does nothing. */
+void IOHandlerFactory::cancelWriting(cmsIOHANDLER *iohandler)
+{
+    QSaveFile *const mySaveFile = qobject_cast<QSaveFile *>( //
+        static_cast<QFileDevice *>(iohandler->stream));
+    if (mySaveFile != nullptr) {
+        mySaveFile->cancelWriting();
+    }
 }
 
 /** @brief Create a read-only LittleCMS IO handler for a file.
@@ -184,4 +225,54 @@ cmsIOHANDLER *IOHandlerFactory::createReadOnly(cmsContext ContextID, const QStri
     return result;
 }
 
+/** @brief Create a write-only LittleCMS IO handler for a file.
+ *
+ * The handler has to be deleted with <tt>cmsCloseIOhandler</tt>
+ * to free memory once it is not used anymore. Only if
+ * <tt>cmsCloseIOhandler</tt> returns <tt>true</tt>, the data has
+ * actually been written to the file.
+ *
+ * @param ContextID Handle to user-defined context, or <tt>nullptr</tt> for
+ * the global context
+ * @param fileName Name of the file. See QFile::setFileName() for
+ * the valid format. If the file exists, it will be replaced.
+ * @returns On success, a pointer to a new IO handler. On fail,
+ * <tt>nullptr</tt>. The function might fail when the file cannot be
+ * opened for writing.
+ *
+ * @sa @ref createReadOnly() */
+cmsIOHANDLER *IOHandlerFactory::createWriteOnly(cmsContext ContextID, const QString &fileName)
+{
+    cmsIOHANDLER *const result = static_cast<cmsIOHANDLER *>( //
+        _cmsMallocZero(ContextID, sizeof(cmsIOHANDLER))       //
+    );
+    if (result == nullptr) {
+        return nullptr;
+    }
+
+    QSaveFile *const fileObject = new QSaveFile(fileName);
+    const bool openSucceeded = fileObject->open(QIODevice::WriteOnly);
+    if (!openSucceeded) {
+        delete fileObject;
+        _cmsFree(ContextID, result);
+        return nullptr;
+    }
+
+    // Initialize data members
+    result->ContextID = ContextID;
+    result->ReportedSize = 0;
+    result->stream = static_cast<void *>(fileObject);
+    result->UsedSpace = 0;
+    result->PhysicalFile[0] = 0;
+
+    // Initialize function pointers
+    result->Read = read;
+    result->Seek = seek;
+    result->Close = close;
+    result->Tell = tell;
+    result->Write = write;
+
+    return result;
+}
+
 } // namespace PerceptualColor
@@ -90,11 +90,18 @@ namespace PerceptualColor
  *
  * Therefore, this class provides a custom LittleCMS IO handler which
  * internally (but invisible for LittleCMS) relies on QFile. This gives
- * us Qt’s portability without the above-mentioned disadvantages. */
+ * us Qt’s portability without the above-mentioned disadvantages.
+ *
+ * Write-only handlers rely on <tt>QSaveFile</tt>: The data is written to
+ * a temporary file, which replaces the target file only when the handler
+ * is closed successfully. So other processes never see a half-written
+ * profile. */
 class IOHandlerFactory
 {
 public:
+    static void cancelWriting(cmsIOHANDLER *iohandler);
     static cmsIOHANDLER *createReadOnly(cmsContext ContextID, const QString &fileName);
+    static cmsIOHANDLER *createWriteOnly(cmsContext ContextID, const QString &fileName);
 
 private:
     IOHandlerFactory() = delete;
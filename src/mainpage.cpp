@@ -214,12 +214,6 @@
  * lightness, because the lightness is <em>by definition</em> bound
  * to <tt>[0, 100]</tt>.
  *
- * @todo Multi-threaded application of color transforms. It seems okay to
- * create the color transforms in one thread and use the same color
- * transform (once created) from various other threads at the same time
- * as long as the flag <tt>cmsFLAGS_NOCACHE</tt> is used to create the
- * transform.
- *
  * @todo Automatically scale the thickness of the wheel (and maybe even the
  * handle) with varying widget size?
  *
@@ -337,15 +331,21 @@
  * The library depends on (and therefore you has to link against) these
  * shared/dynamic libraries:
  *
- * |                         | Qt                 | LittleCMS               |
- * | :---------------------- | :----------------- | :---------------------- |
- * | <b>Major release</b>    | 5                  | 2                       |
- * | <b>Minimum version</b>  | ≥ 5.6*             | ≥ 2.0                   |
- * | <b>Required modules</b> | Core, Gui, Widgets | <em>not applicable</em> |
+ * |                         | Qt                               | LittleCMS               |
+ * | :---------------------- | :------------------------------- | :---------------------- |
+ * | <b>Major release</b>    | 5                                | 2                       |
+ * | <b>Minimum version</b>  | ≥ 5.6*                           | ≥ 2.0                   |
+ * | <b>Required modules</b> | Concurrent, Core, Gui, Widgets** | <em>not applicable</em> |
  *
  * <em>* Qt 5.6 introduces <tt>QPaintDevice::devicePixelRatioF()</tt> which is
  * used in this library.</em>
  *
+ * <em>** The library is split in two parts: The core library (color
+ * management, image generators, color math, palettes) does not depend on
+ * Widgets and can therefore be used in headless applications without
+ * loading the widget stack. Only the widget library depends on
+ * Widgets.</em>
+ *
  * Please make sure that you comply with the licences of the libraries
  * you are using.
  *
@@ -597,19 +597,68 @@
  *
  * @page multithreading Multithreading
  *
- * Currently, this library does not use multithreading. However, is seems
- * a good idea to implement multithreading in the future, particulary
- * for generating the gamut images, which seems to be the slowest
- * operation of this library. It could get disconnected from the GUI
- * thread, leading to a more responsive GUI. And the image could be
- * calculated by various threads simultaniously, so that the generation
- * could be faster.
+ * This library uses multithreading in various places. Most of them
+ * use the global <tt>QThreadPool</tt> via <tt>QtConcurrent</tt>.
+ *
+ * Blocking calls, which return only when the result is available, but
+ * distribute the work internally to the global thread pool
+ * (<tt>QtConcurrent::blockingMap</tt>):
+ * - @ref PerceptualColor::SliceRenderer paints the rows of the gamut
+ *   images in parallel. It is used by @ref PerceptualColor::ChromaHueImage,
+ *   @ref PerceptualColor::ChromaLightnessImage and
+ *   @ref PerceptualColor::ColorWheelImage. The widgets call them
+ *   in the GUI thread when painting, so the GUI thread waits for the
+ *   result.
+ * - @ref PerceptualColor::GamutSolidRenderer renders the layers and
+ *   tiles of the gamut solid in parallel.
+ * - The batch versions of
+ *   @ref PerceptualColor::RgbColorSpace::nearestInGamutColorByAdjustingChroma
+ *   and
+ *   @ref PerceptualColor::RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness
+ *   use multiple threads for big batches (from
+ *   @ref PerceptualColor::RgbColorSpacePrivate::batchParallelThreshold
+ *   colors on). Smaller batches are processed in the calling thread.
+ *   They are used for example by @ref PerceptualColor::Palette to
+ *   convert all colors of a palette file at once.
+ * - @ref PerceptualColor::PaletteGenerator::lightnessRamps calculates
+ *   the ramps of the various hues in parallel.
+ * - @ref PerceptualColor::IccProfileScanner scans the files of ICC
+ *   profile directories in parallel.
+ *
+ * Asynchronous calls, which return immediately:
+ * - @ref PerceptualColor::GamutSolidViewer renders its image with
+ *   <tt>QtConcurrent::run</tt> in the background and shows it when it is
+ *   finished. Meanwhile, the GUI thread stays responsive.
+ * - @ref PerceptualColor::DiagramImageProvider is called by the QML
+ *   engine from its own thread. It renders the images in its own
+ *   <tt>QThreadPool</tt>, so that pending requests do not occupy the
+ *   global thread pool that the renderers themselves use. The destructor
+ *   of the provider waits until all pending requests have finished. The
+ *   display profile is the only state that is shared with the GUI
+ *   thread; it is guarded by a mutex.
+ *
+ * Which threads touch the color space: As a consequence, the
+ * @ref PerceptualColor::RgbColorSpace object of a widget is used not
+ * only by the GUI thread, but at the same time by worker threads of the
+ * global thread pool and of the thread pools of
+ * @ref PerceptualColor::DiagramImageProvider. Therefore, all const
+ * functions of @ref PerceptualColor::RgbColorSpace are thread-safe:
+ * - The LittleCMS transforms are created with the flag
+ *   <tt>cmsFLAGS_NOCACHE</tt>, which disables the 1-pixel-cache. Without
+ *   this cache, LittleCMS allows to use the same transform
+ *   simultaneously from various threads.
+ * - The caches for the gamut boundaries, the display transforms and the
+ *   images (@ref PerceptualColor::DiagramImageCache) are
+ *   @ref PerceptualColor::ReadMostlyCache objects, which allow lock-free
+ *   reading from various threads.
  *
  * Points to consider:
- * - LittleCMS seems to allow using the same transform simultaniously
- *   from variouis threads as long as the 1-pixel-cache is disabled.
  * - QPixmap may only be used in the GUI thread. To generate the images
- *   in another thread, QImage must be used. */
+ *   in another thread, QImage must be used.
+ * - Code that runs on a worker thread must not capture objects that might
+ *   be destroyed before the work has finished. That is why
+ *   @ref PerceptualColor::GamutSolidViewer captures only values and
+ *   shared pointers. */
 
 /** @internal
  *
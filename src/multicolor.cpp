@@ -30,6 +30,10 @@
 // Own header
 #include "multicolor.h"
 
+#include "oklab.h"
+
+#include <lcms2.h>
+
 namespace PerceptualColor
 {
 /** @brief Constructor for an uninitialized object.
@@ -104,6 +108,21 @@ LchDouble MultiColor::toLch() const
     return m_lch;
 }
 
+/** @brief Oklch values
+ *
+ * Calculated on the fly from @ref toLch, with the closed-form formulas
+ * of @ref OkLab.
+ *
+ * @returns Oklch values, scaled like all Oklch values within this
+ * library. */
+LchDouble MultiColor::toOklch() const
+{
+    const cmsCIELCh lch {m_lch.l, m_lch.c, m_lch.h};
+    cmsCIELab lab;
+    cmsLCh2Lab(&lab, &lch);
+    return OkLab::toOklch(OkLab::fromCielabD50(lab));
+}
+
 /** @brief HCL values
  *
  * Convenience function that provedes the same value
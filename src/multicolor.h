@@ -81,6 +81,7 @@ public:
 
     QList<double> toHlc() const;
     LchDouble toLch() const;
+    LchDouble toOklch() const;
     QColor toRgbQColor() const;
 
 private:
@@ -153,19 +153,28 @@ MultiSpinBox::MultiSpinBoxPrivate::MultiSpinBoxPrivate(MultiSpinBox *backLink)
  *
  * @internal
  *
- * @sa @ref minimumSizeHint() */
+ * @sa @ref minimumSizeHint()
+ *
+ * The layout system calls this function very often. Therefore, the result
+ * is cached. The cache is invalidated by @ref invalidateSizeHintCache()
+ * whenever something changes that the result depends on: The section
+ * configuration, the action buttons, the locale, the font and the
+ * style. Changes of <tt>buttonSymbols()</tt> and <tt>hasFrame()</tt>
+ * cannot be detected this way; therefore, the cache also remembers
+ * these values and is only used if they are unchanged. */
 QSize MultiSpinBox::sizeHint() const
 {
-    // This function intentionally does not cache the text string.
-    // Which variant is the longest text string, that depends on the current
-    // font policy. This might have changed since the last call. Therefore,
-    // each time this functin is called, we calculate again the longest
-    // test string (“completeString”).
-
     ensurePolished();
 
+    const bool isCacheUsable = d_pointer->m_sizeHintCache.isValid() //
+        && (d_pointer->m_sizeHintCacheButtonSymbols == buttonSymbols()) //
+        && (d_pointer->m_sizeHintCacheFrame == hasFrame());
+    if (isCacheUsable) {
+        return d_pointer->m_sizeHintCache;
+    }
+
     const QFontMetrics myFontMetrics(fontMetrics());
-    QList<MultiSpinBoxSectionConfiguration> myConfiguration = d_pointer->m_sectionConfigurations;
+    const QList<MultiSpinBoxSectionConfiguration> &myConfiguration = d_pointer->m_sectionConfigurations;
     int height = lineEdit()->sizeHint().height();
     int width = 0;
     QString textOfMinimumValue;
@@ -253,9 +262,20 @@ QSize MultiSpinBox::sizeHint() const
         result.setWidth(result.width() + d_pointer->m_actionButtonCount * actionButtonSpace);
     }
 
+    d_pointer->m_sizeHintCache = result;
+    d_pointer->m_sizeHintCacheButtonSymbols = buttonSymbols();
+    d_pointer->m_sizeHintCacheFrame = hasFrame();
     return result;
 }
 
+/** @brief Invalidates the cache of @ref sizeHint().
+ *
+ * This does not call <tt>updateGeometry()</tt>. */
+void MultiSpinBox::MultiSpinBoxPrivate::invalidateSizeHintCache()
+{
+    m_sizeHintCache = QSize();
+}
+
 /** @brief Handle state changes
  *
  * Reimplemented from base class.
@@ -270,13 +290,17 @@ void MultiSpinBox::changeEvent(QEvent *event)
     // would only call update, not updateGeometry…
     case QEvent::LayoutDirectionChange:
         // Updates the widget content and its geometry
+        d_pointer->invalidateSizeHintCache();
         update();
         updateGeometry();
         break;
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+        // The base class’s implementation of this function triggers
+        // yet a content and geometry update.
+        d_pointer->invalidateSizeHintCache();
+        break;
     default:
-        // QEvent::StyleChange or QEvent::FontChange are not handled here
-        // because they trigger yet a content and geometry update in the
-        // base class’s implementation of this function.
         break;
     }
     QAbstractSpinBox::changeEvent(event);
@@ -305,6 +329,7 @@ void MultiSpinBox::addActionButton(QAction *action, QLineEdit::ActionPosition po
     d_pointer->m_actionButtonCount += 1;
     // The size hints have changed, because an additional button needs
     // more space.
+    d_pointer->invalidateSizeHintCache();
     updateGeometry();
 }
 
@@ -500,6 +525,7 @@ void MultiSpinBox::setSectionConfigurations(const QList<PerceptualColor::MultiSp
 
     // Make sure that the geometry is updated: sizeHint() and minimumSizeHint()
     // both depend on the section configuration!
+    d_pointer->invalidateSizeHintCache();
     updateGeometry();
 }
 
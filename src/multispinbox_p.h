@@ -79,6 +79,27 @@ public:
     QList<MultiSpinBoxSectionConfiguration> m_sectionConfigurations;
     /** @brief Internal storage for property @ref sectionValues. */
     QList<double> m_sectionValues;
+    /** @brief Cache for @ref sizeHint().
+     *
+     * An invalid size if the cache is invalid.
+     *
+     * @sa @ref invalidateSizeHintCache() */
+    mutable QSize m_sizeHintCache;
+    /** @brief The <tt>buttonSymbols()</tt> that @ref m_sizeHintCache
+     * has been calculated for.
+     *
+     * <tt>QAbstractSpinBox::setButtonSymbols()</tt> is not virtual and
+     * does not send an event, so the cache cannot be invalidated when it
+     * is called. Instead, @ref sizeHint() compares this value with the
+     * current one. */
+    mutable QAbstractSpinBox::ButtonSymbols m_sizeHintCacheButtonSymbols = QAbstractSpinBox::ButtonSymbols::UpDownArrows;
+    /** @brief The <tt>hasFrame()</tt> that @ref m_sizeHintCache has been
+     * calculated for.
+     *
+     * Like @ref m_sizeHintCacheButtonSymbols, because
+     * <tt>QAbstractSpinBox::setFrame()</tt> does not send an event
+     * either. */
+    mutable bool m_sizeHintCacheFrame = true;
     /** @brief The string of everything <em>after</em> the value of the
      * current section.
      *
@@ -112,6 +133,7 @@ public:
 
     // Functions
     QString formattedValue(int index) const;
+    void invalidateSizeHintCache();
     bool isCursorPositionAtCurrentSectionValue(const int cursorPosition) const;
     void setCurrentIndexAndUpdateTextAndSelectValue(int newIndex);
     void setCurrentIndexToZeroAndUpdateTextAndSelectValue();
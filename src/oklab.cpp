@@ -0,0 +1,340 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "oklab.h"
+
+#include "helper.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief Scale factor between the original Oklab definition and the
+ * values used within this library.
+ *
+ * @sa @ref OkLab */
+constexpr double okLabScale = 100;
+
+/** @internal
+ *
+ * @brief Tolerance when testing linear RGB values against the
+ * range <tt>[0, 1]</tt>.
+ *
+ * The Oklab matrices have ten decimal places. White (Oklab lightness 1)
+ * therefore converts to RGB values that differ from <tt>1</tt> by some
+ * rounding error. Without tolerance, white would be out-of-gamut. */
+constexpr double rgbTolerance = 0.000001;
+
+} // namespace
+
+/** @brief Conversion from linear sRGB to Oklab.
+ *
+ * @param linearRgb The linear sRGB value (without companding). The
+ * nominal range of each channel is <tt>[0, 1]</tt>, but values outside
+ * this range are converted as well.
+ * @returns The corresponding (scaled) Oklab value. */
+cmsCIELab OkLab::fromLinearSrgb(const RgbDouble &linearRgb)
+{
+    cmsCIELab result;
+    fromLinearSrgb(&linearRgb, &result, 1);
+    return result;
+}
+
+/** @brief Conversion from linear sRGB to Oklab for many values at once.
+ *
+ * The loop body has no branches and no function calls except
+ * <tt>std::cbrt</tt>, so that the compiler can vectorize it.
+ *
+ * @param linearRgb Pointer to the first of <tt>count</tt> input values.
+ * @param oklab Pointer to the first of <tt>count</tt> output values.
+ * @param count The number of values to convert. */
+void OkLab::fromLinearSrgb(const RgbDouble *linearRgb, cmsCIELab *oklab, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const double r = linearRgb[i].red;
+        const double g = linearRgb[i].green;
+        const double b = linearRgb[i].blue;
+        const double l = std::cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+        const double m = std::cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+        const double s = std::cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+        oklab[i].L = (0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s) * okLabScale;
+        oklab[i].a = (1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s) * okLabScale;
+        oklab[i].b = (0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s) * okLabScale;
+    }
+}
+
+/** @brief Conversion from Oklab to linear sRGB.
+ *
+ * @param oklab The (scaled) Oklab value.
+ * @returns The corresponding linear sRGB value (without companding).
+ * Out-of-gamut colors have channel values outside the range
+ * <tt>[0, 1]</tt>; they are <em>not</em> clipped. */
+RgbDouble OkLab::toLinearSrgb(const cmsCIELab &oklab)
+{
+    RgbDouble result;
+    toLinearSrgb(&oklab, &result, 1);
+    return result;
+}
+
+/** @brief Conversion from Oklab to linear sRGB for many values at once.
+ *
+ * The loop body has no branches and no function calls, so that the
+ * compiler can vectorize it.
+ *
+ * @param oklab Pointer to the first of <tt>count</tt> input values.
+ * @param linearRgb Pointer to the first of <tt>count</tt> output values.
+ * Out-of-gamut colors have channel values outside the range
+ * <tt>[0, 1]</tt>; they are <em>not</em> clipped.
+ * @param count The number of values to convert. */
+void OkLab::toLinearSrgb(const cmsCIELab *oklab, RgbDouble *linearRgb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const double L = oklab[i].L / okLabScale;
+        const double a = oklab[i].a / okLabScale;
+        const double b = oklab[i].b / okLabScale;
+        const double lRoot = L + 0.3963377774 * a + 0.2158037573 * b;
+        const double mRoot = L - 0.1055613458 * a - 0.0638541728 * b;
+        const double sRoot = L - 0.0894841775 * a - 1.2914855480 * b;
+        const double l = lRoot * lRoot * lRoot;
+        const double m = mRoot * mRoot * mRoot;
+        const double s = sRoot * sRoot * sRoot;
+        linearRgb[i].red = 4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s;
+        linearRgb[i].green = -1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s;
+        linearRgb[i].blue = -0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s;
+    }
+}
+
+/** @brief Conversion from CIELab (D50) to Oklab.
+ *
+ * @param cielab A CIELab value relative to D50, as used by LittleCMS.
+ * @returns The corresponding (scaled) Oklab value. The conversion goes
+ * through XYZ and uses the Bradford chromatic adaptation from D50 to
+ * D65. */
+cmsCIELab OkLab::fromCielabD50(const cmsCIELab &cielab)
+{
+    cmsCIEXYZ xyzD50;
+    // cmsLab2XYZ is a closed formula, not an ICC transform.
+    cmsLab2XYZ(cmsD50_XYZ(), &xyzD50, &cielab);
+    // Bradford adaptation from D50 to D65
+    const double x = 0.9555766 * xyzD50.X - 0.0230393 * xyzD50.Y + 0.0631636 * xyzD50.Z;
+    const double y = -0.0282895 * xyzD50.X + 1.0099416 * xyzD50.Y + 0.0210077 * xyzD50.Z;
+    const double z = 0.0122982 * xyzD50.X - 0.0204830 * xyzD50.Y + 1.3299098 * xyzD50.Z;
+    // XYZ (D65) to LMS
+    const double l = std::cbrt(0.8189330101 * x + 0.3618667424 * y - 0.1288597137 * z);
+    const double m = std::cbrt(0.0329845436 * x + 0.9293118715 * y + 0.0361456387 * z);
+    const double s = std::cbrt(0.0482003018 * x + 0.2643662691 * y + 0.6338517070 * z);
+    cmsCIELab result;
+    result.L = (0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s) * okLabScale;
+    result.a = (1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s) * okLabScale;
+    result.b = (0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s) * okLabScale;
+    return result;
+}
+
+/** @brief Conversion from Oklab to CIELab (D50).
+ *
+ * @param oklab The (scaled) Oklab value.
+ * @returns The corresponding CIELab value relative to D50, as used by
+ * LittleCMS. The conversion goes through XYZ and uses the Bradford
+ * chromatic adaptation from D65 to D50. */
+cmsCIELab OkLab::toCielabD50(const cmsCIELab &oklab)
+{
+    const double L = oklab.L / okLabScale;
+    const double a = oklab.a / okLabScale;
+    const double b = oklab.b / okLabScale;
+    const double lRoot = L + 0.3963377774 * a + 0.2158037573 * b;
+    const double mRoot = L - 0.1055613458 * a - 0.0638541728 * b;
+    const double sRoot = L - 0.0894841775 * a - 1.2914855480 * b;
+    const double l = lRoot * lRoot * lRoot;
+    const double m = mRoot * mRoot * mRoot;
+    const double s = sRoot * sRoot * sRoot;
+    // LMS to XYZ (D65)
+    const double x = 1.2270138511 * l - 0.5577999807 * m + 0.2812561490 * s;
+    const double y = -0.0405801784 * l + 1.1122568696 * m - 0.0716766787 * s;
+    const double z = -0.0763812845 * l - 0.4214819784 * m + 1.5861632204 * s;
+    // Bradford adaptation from D65 to D50
+    cmsCIEXYZ xyzD50;
+    xyzD50.X = 1.0478112 * x + 0.0228866 * y - 0.0501270 * z;
+    xyzD50.Y = 0.0295424 * x + 0.9904844 * y - 0.0170491 * z;
+    xyzD50.Z = -0.0092345 * x + 0.0150436 * y + 0.7521316 * z;
+    cmsCIELab result;
+    // cmsXYZ2Lab is a closed formula, not an ICC transform.
+    cmsXYZ2Lab(cmsD50_XYZ(), &result, &xyzD50);
+    return result;
+}
+
+/** @brief Conversion from Oklch to Oklab.
+ *
+ * @param oklch The (scaled) Oklch value.
+ * @returns The corresponding (scaled) Oklab value. */
+cmsCIELab OkLab::fromOklch(const LchDouble &oklch)
+{
+    const cmsCIELCh temp = toCmsCieLch(oklch);
+    cmsCIELab result;
+    // Only geometry (polar to cartesian), therefore valid also for Oklab.
+    cmsLCh2Lab(&result, &temp);
+    return result;
+}
+
+/** @brief Conversion from Oklab to Oklch.
+ *
+ * @param oklab The (scaled) Oklab value.
+ * @returns The corresponding (scaled) Oklch value. */
+LchDouble OkLab::toOklch(const cmsCIELab &oklab)
+{
+    cmsCIELCh temp;
+    // Only geometry (cartesian to polar), therefore valid also for Oklab.
+    cmsLab2LCh(&temp, &oklab);
+    return toLchDouble(temp);
+}
+
+/** @brief Tests if an Oklab value is within the sRGB gamut.
+ *
+ * @param oklab The (scaled) Oklab value.
+ * @returns <tt>true</tt> if the color is within the sRGB gamut.
+ * <tt>false</tt> otherwise. */
+bool OkLab::isInSrgbGamut(const cmsCIELab &oklab)
+{
+    const RgbDouble rgb = toLinearSrgb(oklab);
+    return isInRange<double>(-rgbTolerance, rgb.red, 1 + rgbTolerance)    //
+        && isInRange<double>(-rgbTolerance, rgb.green, 1 + rgbTolerance) //
+        && isInRange<double>(-rgbTolerance, rgb.blue, 1 + rgbTolerance);
+}
+
+/** @brief Conversion from Oklab to (companded) sRGB for many values
+ * at once.
+ *
+ * This is the fast path for sRGB diagrams in Oklch: No LittleCMS
+ * transform is involved.
+ *
+ * @param oklab Pointer to the first of <tt>count</tt> (scaled) Oklab input
+ * values.
+ * @param srgb Pointer to the first of <tt>count</tt> output values. Each
+ * channel is clipped to the range <tt>[0, 1]</tt>.
+ * @param inGamut Pointer to the first of <tt>count</tt> output values,
+ * that hold if the corresponding color was within the sRGB gamut before
+ * clipping.
+ * @param count The number of values to convert. */
+void OkLab::oklabToSrgb(const cmsCIELab *oklab, RgbDouble *srgb, bool *inGamut, int count)
+{
+    toLinearSrgb(oklab, srgb, count);
+    for (int i = 0; i < count; ++i) {
+        inGamut[i] = isInRange<double>(-rgbTolerance, srgb[i].red, 1 + rgbTolerance) //
+            && isInRange<double>(-rgbTolerance, srgb[i].green, 1 + rgbTolerance)    //
+            && isInRange<double>(-rgbTolerance, srgb[i].blue, 1 + rgbTolerance);
+        srgb[i] = linearSrgbToSrgb(srgb[i]);
+    }
+}
+
+/** @brief Conversion from Oklch to (companded) sRGB for many values
+ * at once.
+ *
+ * This is the fast path for sRGB diagrams in Oklch: No LittleCMS
+ * transform is involved.
+ *
+ * @param oklch Pointer to the first of <tt>count</tt> (scaled) Oklch input
+ * values.
+ * @param srgb Pointer to the first of <tt>count</tt> output values. Each
+ * channel is clipped to the range <tt>[0, 1]</tt>.
+ * @param inGamut Pointer to the first of <tt>count</tt> output values,
+ * that hold if the corresponding color was within the sRGB gamut before
+ * clipping.
+ * @param count The number of values to convert. */
+void OkLab::oklchToSrgb(const LchDouble *oklch, RgbDouble *srgb, bool *inGamut, int count)
+{
+    constexpr double degreeToRadian = M_PI / 180;
+    for (int i = 0; i < count; ++i) {
+        cmsCIELab oklab;
+        oklab.L = oklch[i].l;
+        oklab.a = oklch[i].c * std::cos(oklch[i].h * degreeToRadian);
+        oklab.b = oklch[i].c * std::sin(oklch[i].h * degreeToRadian);
+        oklabToSrgb(&oklab, &srgb[i], &inGamut[i], 1);
+    }
+}
+
+/** @brief The sRGB companding function.
+ *
+ * @param linear A linear value
+ * @returns The corresponding non-linear (companded) value */
+double OkLab::srgbCompanding(double linear)
+{
+    if (linear <= 0.0031308) {
+        return 12.92 * linear;
+    }
+    return 1.055 * std::pow(linear, 1 / 2.4) - 0.055;
+}
+
+/** @brief The inverse sRGB companding function.
+ *
+ * @param encoded A non-linear (companded) value
+ * @returns The corresponding linear value */
+double OkLab::srgbInverseCompanding(double encoded)
+{
+    if (encoded <= 0.04045) {
+        return encoded / 12.92;
+    }
+    return std::pow((encoded + 0.055) / 1.055, 2.4);
+}
+
+/** @brief Conversion from linear sRGB to (companded) sRGB.
+ *
+ * @param linearRgb The linear sRGB value.
+ * @returns The companded sRGB value. Each channel is clipped to the
+ * range <tt>[0, 1]</tt>. */
+RgbDouble OkLab::linearSrgbToSrgb(const RgbDouble &linearRgb)
+{
+    RgbDouble result;
+    result.red = srgbCompanding(qBound<double>(0, linearRgb.red, 1));
+    result.green = srgbCompanding(qBound<double>(0, linearRgb.green, 1));
+    result.blue = srgbCompanding(qBound<double>(0, linearRgb.blue, 1));
+    return result;
+}
+
+/** @brief Conversion from (companded) sRGB to linear sRGB.
+ *
+ * @param srgb The companded sRGB value. The valid range of each
+ * channel is <tt>[0, 1]</tt>.
+ * @returns The linear sRGB value. */
+RgbDouble OkLab::srgbToLinearSrgb(const RgbDouble &srgb)
+{
+    RgbDouble result;
+    result.red = srgbInverseCompanding(srgb.red);
+    result.green = srgbInverseCompanding(srgb.green);
+    result.blue = srgbInverseCompanding(srgb.blue);
+    return result;
+}
+
+} // namespace PerceptualColor
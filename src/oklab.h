@@ -0,0 +1,104 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef OKLAB_H
+#define OKLAB_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/lchdouble.h"
+#include "rgbdouble.h"
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Closed-form conversions for the Oklab and Oklch color models.
+ *
+ * <a href="https://bottosson.github.io/posts/oklab/">Oklab</a> is a
+ * perceptual color model that predicts hue more uniformly than CIELab.
+ * It is defined by two 3×3 matrices and a cube root, so it can be
+ * converted to and from linear sRGB (and XYZ) without any ICC engine.
+ *
+ * Within this library, Oklab and Oklch values are scaled by <tt>100</tt>:
+ * Lightness ranges from <tt>0</tt> to <tt>100</tt> like CIELab lightness,
+ * and <em>a</em>, <em>b</em> and chroma are scaled by the same factor. This
+ * way, the existing value types can be reused: Oklab values are stored in
+ * <tt>cmsCIELab</tt> and Oklch values in @ref LchDouble, and the polar
+ * conversion can be done with <tt>cmsLab2LCh()</tt> and
+ * <tt>cmsLCh2Lab()</tt>, which are pure geometry.
+ *
+ * CIELab within this library is always relative to D50 (the profile
+ * connection space of LittleCMS), while Oklab is relative to D65. The
+ * conversion between both uses the Bradford chromatic adaptation, like
+ * ICC profiles do.
+ *
+ * An upper limit of the sRGB gamut in Oklch is available from
+ * @ref OkLabSrgbGamutTable, which is generated at build time with
+ * these conversions.
+ *
+ * @note All functions are stateless and therefore thread-safe. */
+class OkLab final
+{
+public:
+    static cmsCIELab fromCielabD50(const cmsCIELab &cielab);
+    static cmsCIELab fromLinearSrgb(const RgbDouble &linearRgb);
+    static void fromLinearSrgb(const RgbDouble *linearRgb, cmsCIELab *oklab, int count);
+    static cmsCIELab fromOklch(const LchDouble &oklch);
+    static bool isInSrgbGamut(const cmsCIELab &oklab);
+    static RgbDouble linearSrgbToSrgb(const RgbDouble &linearRgb);
+    static void oklabToSrgb(const cmsCIELab *oklab, RgbDouble *srgb, bool *inGamut, int count);
+    static void oklchToSrgb(const LchDouble *oklch, RgbDouble *srgb, bool *inGamut, int count);
+    static RgbDouble srgbToLinearSrgb(const RgbDouble &srgb);
+    static cmsCIELab toCielabD50(const cmsCIELab &oklab);
+    static RgbDouble toLinearSrgb(const cmsCIELab &oklab);
+    static void toLinearSrgb(const cmsCIELab *oklab, RgbDouble *linearRgb, int count);
+    static LchDouble toOklch(const cmsCIELab &oklab);
+
+    /** @brief Maximum (scaled) Oklch chroma that is perceived by humans.
+     *
+     * The monochromatic colors of the visible spectrum have an Oklch
+     * chroma of less than <tt>50</tt>. */
+    static constexpr int humanMaximumChroma = 50;
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    OkLab() = delete;
+
+    static double srgbCompanding(double linear);
+    static double srgbInverseCompanding(double encoded);
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestOkLab;
+};
+
+} // namespace PerceptualColor
+
+#endif // OKLAB_H
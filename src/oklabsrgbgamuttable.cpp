@@ -0,0 +1,71 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "oklabsrgbgamuttable.h"
+
+#include "polarpointf.h"
+
+#include <cmath>
+
+namespace PerceptualColor
+{
+static_assert(100 % OkLabSrgbGamutTable::lightnessStep == 0);
+static_assert(360 % OkLabSrgbGamutTable::hueStep == 0);
+
+/** @brief Maximum in-gamut chroma of sRGB for a given Oklch lightness
+ * and hue.
+ *
+ * The value is answered from static memory, without any calculation.
+ *
+ * @param lightness The (scaled) Oklch lightness. Values outside of
+ * <tt>[0, 100]</tt> are bound to this range.
+ * @param hue The Oklch hue. Values outside of <tt>[0, 360[</tt> are
+ * normalized.
+ * @returns An <em>upper limit</em> of the maximum in-gamut (scaled)
+ * Oklch chroma: The value of the table cell that contains the given
+ * point. This can be used to skip the work on colors that are surely
+ * out-of-gamut, but colors below this limit have nevertheless to
+ * be tested with @ref OkLab::isInSrgbGamut(). */
+qreal OkLabSrgbGamutTable::maximumChroma(qreal lightness, qreal hue)
+{
+    const qreal boundedLightness = qBound<qreal>(0, lightness, 100) //
+        / lightnessStep;
+    const qreal normalizedHue = PolarPointF::normalizedAngleDegree(hue) //
+        / hueStep;
+    // A point exactly on the border between two cells (including the
+    // lightness 100) is covered by both cells, so it is enough to
+    // look at one of them.
+    const int lightnessIndex = qBound(0, static_cast<int>(std::floor(boundedLightness)), lightnessCount - 1);
+    const int hueIndex = qBound(0, static_cast<int>(std::floor(normalizedHue)), hueCount - 1);
+    return static_cast<qreal>(upperChromaLimit[lightnessIndex * hueCount + hueIndex]);
+}
+
+} // namespace PerceptualColor
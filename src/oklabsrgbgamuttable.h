@@ -0,0 +1,91 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef OKLABSRGBGAMUTTABLE_H
+#define OKLABSRGBGAMUTTABLE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief An upper limit of the sRGB gamut in Oklch, generated at
+ * build time.
+ *
+ * The sRGB gamut in Oklch is always the same. Instead of sampling it in
+ * every process (which takes millions of conversions), the build system
+ * runs the tool <tt>generateoklabsrgbgamuttable</tt>, which samples the
+ * gamut with the closed-form conversions of @ref OkLab and writes
+ * @ref upperChromaLimit into a generated source file.
+ *
+ * The table is a grid of cells. The cell <tt>(lightnessIndex,
+ * hueIndex)</tt> covers the lightness range <tt>[lightnessIndex,
+ * lightnessIndex + 1]</tt> (multiplied by @ref lightnessStep) and the
+ * corresponding hue range (multiplied by @ref hueStep). Each cell holds
+ * an upper limit of the in-gamut chroma for its whole area, also between
+ * the grid points: The maximum of a cell is not necessarily at its
+ * corners, because near the cusps the boundary has a peak between the
+ * grid points. Therefore, the tool samples each cell with a dense
+ * sub-grid, and adds the biggest difference between neighbouring samples
+ * as safety margin.
+ *
+ * @note All functions are thread-safe. */
+class OkLabSrgbGamutTable final
+{
+public:
+    static qreal maximumChroma(qreal lightness, qreal hue);
+
+    /** @brief Step of the lightness axis, measured in (scaled)
+     * Oklch lightness. */
+    static constexpr int lightnessStep = 1;
+    /** @brief Step of the hue axis, measured in degree. */
+    static constexpr int hueStep = 1;
+    /** @brief Number of lightness cells. */
+    static constexpr int lightnessCount = 100 / lightnessStep;
+    /** @brief Number of hue cells. */
+    static constexpr int hueCount = 360 / hueStep;
+
+    /** @brief An upper limit of the in-gamut (scaled) Oklch chroma for
+     * each cell.
+     *
+     * Index: <tt>lightnessIndex * hueCount + hueIndex</tt>. */
+    static const float upperChromaLimit[lightnessCount * hueCount];
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    OkLabSrgbGamutTable() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestOkLab;
+};
+
+} // namespace PerceptualColor
+
+#endif // OKLABSRGBGAMUTTABLE_H
@@ -0,0 +1,621 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "palette.h"
+
+#include <QFile>
+
+#include <cstring>
+#include <limits>
+
+namespace PerceptualColor
+{
+namespace
+{
+/** @internal
+ *
+ * @brief Tests if data starts with a given prefix.
+ * @param data The data
+ * @param size The size of the data
+ * @param prefix The null-terminated prefix
+ * @returns <tt>true</tt> if the data starts with the prefix. */
+bool startsWith(const char *data, qint64 size, const char *prefix)
+{
+    const qint64 prefixSize = static_cast<qint64>(qstrlen(prefix));
+    return (size >= prefixSize) && (std::memcmp(data, prefix, static_cast<size_t>(prefixSize)) == 0);
+}
+
+/** @internal
+ *
+ * @param character The character
+ * @returns If the character is ASCII whitespace. */
+bool isWhitespace(char character)
+{
+    return (character == ' ') || (character == '\t') || (character == '\r') //
+        || (character == '\n') || (character == '\f');
+}
+
+/** @internal
+ *
+ * @brief Removes leading and trailing whitespace from a range.
+ * @param begin Reference to the begin of the range
+ * @param end Reference to the end of the range */
+void trim(const char *&begin, const char *&end)
+{
+    while ((begin < end) && isWhitespace(*begin)) {
+        ++begin;
+    }
+    while ((end > begin) && isWhitespace(*(end - 1))) {
+        --end;
+    }
+}
+
+/** @internal
+ *
+ * @param character The character
+ * @returns If the character can be part of a CSS identifier. Non-ASCII
+ * characters (bytes of UTF-8 multi-byte sequences) are always accepted. */
+bool isIdentifierCharacter(char character)
+{
+    const uchar value = static_cast<uchar>(character);
+    return ((value >= 'a') && (value <= 'z')) //
+        || ((value >= 'A') && (value <= 'Z')) //
+        || ((value >= '0') && (value <= '9')) //
+        || (value == '-') || (value == '_') || (value >= 0x80);
+}
+
+/** @internal
+ *
+ * @brief Parses a non-negative decimal integer, skipping leading
+ * spaces and tabs.
+ * @param position Reference to the current position. Advanced behind
+ * the integer on success.
+ * @param end The end of the data
+ * @param result Pointer to the result
+ * @returns <tt>true</tt> on success. */
+bool parseInteger(const char *&position, const char *end, int *result)
+{
+    const char *temp = position;
+    while ((temp < end) && ((*temp == ' ') || (*temp == '\t'))) {
+        ++temp;
+    }
+    if ((temp == end) || (*temp < '0') || (*temp > '9')) {
+        return false;
+    }
+    int value = 0;
+    while ((temp < end) && (*temp >= '0') && (*temp <= '9')) {
+        // Bound the value to avoid integer overflow.
+        value = qMin(value * 10 + (*temp - '0'), 100000);
+        ++temp;
+    }
+    position = temp;
+    *result = value;
+    return true;
+}
+
+/** @internal
+ *
+ * @brief Reads big-endian binary data with bounds checking. */
+class BigEndianReader
+{
+public:
+    /** @brief Constructor
+     * @param begin The begin of the data
+     * @param end The end of the data */
+    BigEndianReader(const char *begin, const char *end)
+        : m_position(reinterpret_cast<const uchar *>(begin))
+        , m_end(reinterpret_cast<const uchar *>(end))
+    {
+    }
+    /** @returns The number of bytes that have not yet been read. */
+    qint64 remaining() const
+    {
+        return m_end - m_position;
+    }
+    /** @brief Reads an unsigned 16-bit integer.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool readUInt16(quint16 *result)
+    {
+        if (remaining() < 2) {
+            return false;
+        }
+        *result = static_cast<quint16>((m_position[0] << 8) | m_position[1]);
+        m_position += 2;
+        return true;
+    }
+    /** @brief Reads an unsigned 32-bit integer.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool readUInt32(quint32 *result)
+    {
+        if (remaining() < 4) {
+            return false;
+        }
+        *result = (static_cast<quint32>(m_position[0]) << 24) //
+            | (static_cast<quint32>(m_position[1]) << 16) //
+            | (static_cast<quint32>(m_position[2]) << 8) //
+            | static_cast<quint32>(m_position[3]);
+        m_position += 4;
+        return true;
+    }
+    /** @brief Reads an IEEE 754 single precision number.
+     * @param result Pointer to the result
+     * @returns <tt>true</tt> on success. */
+    bool readFloat(float *result)
+    {
+        quint32 bits;
+        if (!readUInt32(&bits)) {
+            return false;
+        }
+        static_assert(sizeof(float) == sizeof(quint32));
+        std::memcpy(result, &bits, sizeof(float));
+        return true;
+    }
+    /** @brief Compares the next bytes with a tag and skips them.
+     * @param tag The null-terminated tag
+     * @returns <tt>true</tt> if the next bytes are identical to the tag. */
+    bool readTag(const char *tag)
+    {
+        const qint64 tagSize = static_cast<qint64>(qstrlen(tag));
+        if ((remaining() < tagSize) || (std::memcmp(m_position, tag, static_cast<size_t>(tagSize)) != 0)) {
+            return false;
+        }
+        m_position += tagSize;
+        return true;
+    }
+
+private:
+    /** @brief The current position */
+    const uchar *m_position;
+    /** @brief The end of the data */
+    const uchar *m_end;
+};
+
+} // namespace
+
+/** @brief Reads a palette from memory.
+ *
+ * @param colorSpace The color space. RGB values of the palette are
+ * interpreted in this color space, and the colors are moved into its gamut.
+ * @param data Pointer to the content of a palette file
+ * @param size Size of the data
+ * @param result Pointer to the result. Only changed on success.
+ * @returns <tt>true</tt> on success. <tt>false</tt> if the data is not a
+ * valid palette. Data that is neither a GIMP palette nor an Adobe Swatch
+ * Exchange file is considered valid CSS only if it contains at least one
+ * custom property with a color value. */
+bool Palette::readFromData(const QSharedPointer<RgbColorSpace> &colorSpace, const char *data, qint64 size, Palette *result)
+{
+    // Skip UTF-8 byte order mark
+    if (startsWith(data, size, "\xEF\xBB\xBF")) {
+        data += 3;
+        size -= 3;
+    }
+    Palette temp;
+    QVector<CssColor::Value> values;
+    bool success;
+    if (startsWith(data, size, "ASEF")) {
+        success = parseAse(data, size, &temp, &values);
+    } else if (startsWith(data, size, "GIMP Palette")) {
+        success = parseGpl(data, size, &temp, &values);
+    } else {
+        success = parseCss(data, size, &temp, &values) && (values.count() > 0);
+    }
+    if (!success) {
+        return false;
+    }
+    temp.m_colors = toLcha(colorSpace, values);
+    *result = std::move(temp);
+    return true;
+}
+
+/** @brief Reads a palette file.
+ *
+ * The file is memory-mapped if possible.
+ *
+ * @param colorSpace The color space. RGB values of the palette are
+ * interpreted in this color space, and the colors are moved into its gamut.
+ * @param fileName The file name
+ * @param result Pointer to the result. Only changed on success.
+ * @returns <tt>true</tt> on success. <tt>false</tt> if the file could not
+ * be read or is not a valid palette.
+ *
+ * @sa @ref readFromData() */
+bool Palette::readFromFile(const QSharedPointer<RgbColorSpace> &colorSpace, const QString &fileName, Palette *result)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    uchar *mapped = (size > 0) ? file.map(0, size) : nullptr;
+    if (mapped != nullptr) {
+        const bool success = readFromData( //
+            colorSpace,
+            reinterpret_cast<const char *>(mapped),
+            size,
+            result);
+        file.unmap(mapped);
+        return success;
+    }
+    // Fallback for devices that cannot be mapped
+    const QByteArray data = file.readAll();
+    return readFromData(colorSpace, data.constData(), data.size(), result);
+}
+
+/** @brief Getter for the number of colors.
+ * @returns The number of colors. */
+int Palette::count() const
+{
+    return m_colors.count();
+}
+
+/** @brief Getter for a color.
+ * @param index The index, within <tt>[0, @ref count()[</tt>
+ * @returns The color. It is guaranteed to be within the gamut of the color
+ * space that was used to read the palette. */
+LchaDouble Palette::color(int index) const
+{
+    return m_colors.at(index);
+}
+
+/** @brief Getter for the name of a color.
+ * @param index The index, within <tt>[0, @ref count()[</tt>
+ * @returns The name of the color. Might be empty. */
+QString Palette::name(int index) const
+{
+    const int begin = m_nameOffsets.at(index);
+    return m_names.mid(begin, m_nameOffsets.at(index + 1) - begin);
+}
+
+/** @brief Getter for the title of the palette.
+ * @returns The title of the palette, if the file format provides one.
+ * An empty string otherwise. */
+QString Palette::title() const
+{
+    return m_title;
+}
+
+/** @brief Appends text to the name of the current entry.
+ *
+ * ASCII text is appended without creating a temporary <tt>QString</tt>.
+ *
+ * @param utf8 The text, UTF-8 encoded
+ * @param length The length of the text */
+void Palette::appendName(const char *utf8, qint64 length)
+{
+    bool isAscii = true;
+    for (qint64 i = 0; i < length; ++i) {
+        if (static_cast<uchar>(utf8[i]) >= 0x80) {
+            isAscii = false;
+            break;
+        }
+    }
+    if (isAscii) {
+        m_names.append(QLatin1String(utf8, static_cast<int>(length)));
+    } else {
+        m_names.append(QString::fromUtf8(utf8, static_cast<int>(length)));
+    }
+}
+
+/** @brief Finishes the current entry.
+ *
+ * The name that has been appended to @ref m_names since the previous
+ * call becomes the name of this entry.
+ *
+ * @param value The color of this entry
+ * @param values The list to which the color is appended */
+void Palette::finishEntry(const CssColor::Value &value, QVector<CssColor::Value> *values)
+{
+    values->append(value);
+    m_nameOffsets.append(m_names.size());
+}
+
+/** @brief Parses a GIMP palette.
+ *
+ * @param data The data
+ * @param size The size of the data
+ * @param palette The palette that receives title and names
+ * @param values The list that receives the colors
+ * @returns <tt>true</tt> on success. Malformed color lines
+ * are skipped. */
+bool Palette::parseGpl(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values)
+{
+    // A color line has at least 6 characters (“0 0 0\n”).
+    values->reserve(static_cast<int>(qMin<qint64>(size / 6, std::numeric_limits<int>::max())));
+    const char *position = data;
+    const char *const end = data + size;
+    bool isFirstLine = true;
+    while (position < end) {
+        const char *lineBegin = position;
+        const char *lineEnd = static_cast<const char *>( //
+            std::memchr(position, '\n', static_cast<size_t>(end - position)));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        position = (lineEnd < end) ? lineEnd + 1 : end;
+        trim(lineBegin, lineEnd);
+        const qint64 lineSize = lineEnd - lineBegin;
+
+        if (isFirstLine) {
+            isFirstLine = false;
+            if (!startsWith(lineBegin, lineSize, "GIMP Palette")) {
+                return false;
+            }
+            continue;
+        }
+        if ((lineSize == 0) || (*lineBegin == '#')) {
+            continue;
+        }
+        if (startsWith(lineBegin, lineSize, "Name:")) {
+            const char *titleBegin = lineBegin + 5;
+            trim(titleBegin, lineEnd);
+            palette->m_title = QString::fromUtf8(titleBegin, static_cast<int>(lineEnd - titleBegin));
+            continue;
+        }
+        if (startsWith(lineBegin, lineSize, "Columns:")) {
+            continue;
+        }
+
+        const char *linePosition = lineBegin;
+        int channels[3];
+        if (!parseInteger(linePosition, lineEnd, &channels[0]) //
+            || !parseInteger(linePosition, lineEnd, &channels[1]) //
+            || !parseInteger(linePosition, lineEnd, &channels[2])) {
+            continue;
+        }
+        CssColor::Value value;
+        value.syntax = CssColor::Syntax::Rgb;
+        value.rgb = RgbDouble {qMin(channels[0], 255) / 255.0, //
+                               qMin(channels[1], 255) / 255.0,
+                               qMin(channels[2], 255) / 255.0};
+        trim(linePosition, lineEnd);
+        palette->appendName(linePosition, lineEnd - linePosition);
+        palette->finishEntry(value, values);
+    }
+    return !isFirstLine;
+}
+
+/** @brief Parses an Adobe Swatch Exchange file.
+ *
+ * @param data The data
+ * @param size The size of the data
+ * @param palette The palette that receives the names
+ * @param values The list that receives the colors
+ * @returns <tt>true</tt> on success. <tt>false</tt> if the data is
+ * truncated or malformed. */
+bool Palette::parseAse(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values)
+{
+    BigEndianReader reader(data, data + size);
+    quint16 majorVersion;
+    quint16 minorVersion;
+    quint32 blockCount;
+    if (!reader.readTag("ASEF") //
+        || !reader.readUInt16(&majorVersion) //
+        || !reader.readUInt16(&minorVersion) //
+        || !reader.readUInt32(&blockCount)) {
+        return false;
+    }
+    // Each block has at least 6 bytes, so do not trust blockCount blindly.
+    values->reserve(static_cast<int>(qMin<qint64>(blockCount, size / 6)));
+    constexpr quint16 colorEntry = 0x0001;
+    for (quint32 i = 0; i < blockCount; ++i) {
+        quint16 blockType;
+        quint32 blockLength;
+        if (!reader.readUInt16(&blockType) || !reader.readUInt32(&blockLength)) {
+            return false;
+        }
+        if (blockLength > reader.remaining()) {
+            return false;
+        }
+        const qint64 blockBegin = size - reader.remaining();
+        BigEndianReader block(data + blockBegin, data + blockBegin + blockLength);
+        reader = BigEndianReader(data + blockBegin + blockLength, data + size);
+        if (blockType != colorEntry) {
+            // Group start and group end blocks are ignored.
+            continue;
+        }
+
+        // The name length is measured in UTF-16 code units, including
+        // the terminating null.
+        quint16 nameLength;
+        if (!block.readUInt16(&nameLength)) {
+            return false;
+        }
+        const int oldNamesSize = palette->m_names.size();
+        for (quint16 j = 0; j < nameLength; ++j) {
+            quint16 codeUnit;
+            if (!block.readUInt16(&codeUnit)) {
+                return false;
+            }
+            if (codeUnit != 0) {
+                palette->m_names.append(QChar(codeUnit));
+            }
+        }
+
+        CssColor::Value value;
+        float channels[3];
+        if (block.readTag("RGB ")) {
+            if (!block.readFloat(&channels[0]) //
+                || !block.readFloat(&channels[1]) //
+                || !block.readFloat(&channels[2])) {
+                return false;
+            }
+            value.syntax = CssColor::Syntax::Rgb;
+            value.rgb = RgbDouble {qBound(0.0, static_cast<double>(channels[0]), 1.0),
+                                   qBound(0.0, static_cast<double>(channels[1]), 1.0),
+                                   qBound(0.0, static_cast<double>(channels[2]), 1.0)};
+        } else if (block.readTag("LAB ")) {
+            if (!block.readFloat(&channels[0]) //
+                || !block.readFloat(&channels[1]) //
+                || !block.readFloat(&channels[2])) {
+                return false;
+            }
+            // Lightness is stored within [0, 1].
+            value.syntax = CssColor::Syntax::Lab;
+            value.lab = cmsCIELab {channels[0] * 100.0, channels[1], channels[2]};
+        } else if (block.readTag("Gray")) {
+            if (!block.readFloat(&channels[0])) {
+                return false;
+            }
+            const double gray = qBound(0.0, static_cast<double>(channels[0]), 1.0);
+            value.syntax = CssColor::Syntax::Rgb;
+            value.rgb = RgbDouble {gray, gray, gray};
+        } else {
+            // CMYK (or unknown) entry: Skip it, including its name.
+            palette->m_names.truncate(oldNamesSize);
+            continue;
+        }
+        palette->finishEntry(value, values);
+    }
+    return true;
+}
+
+/** @brief Parses CSS custom properties.
+ *
+ * Looks for declarations like <tt>--accent: #1A2B3C;</tt> anywhere
+ * in the data (outside of comments). The property name without the
+ * leading <tt>--</tt> becomes the name of the color.
+ *
+ * @param data The data
+ * @param size The size of the data
+ * @param palette The palette that receives the names
+ * @param values The list that receives the colors
+ * @returns Always <tt>true</tt>, because CSS parsing is error-tolerant. */
+bool Palette::parseCss(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values)
+{
+    const char *position = data;
+    const char *const end = data + size;
+    while (position < end) {
+        // Skip comments
+        if ((*position == '/') && (position + 1 < end) && (position[1] == '*')) {
+            position += 2;
+            while ((position + 1 < end) && !((position[0] == '*') && (position[1] == '/'))) {
+                ++position;
+            }
+            position = qMin(position + 2, end);
+            continue;
+        }
+        const bool isCustomProperty = (*position == '-') //
+            && (position + 1 < end) && (position[1] == '-') //
+            && ((position == data) || !isIdentifierCharacter(position[-1]));
+        if (!isCustomProperty) {
+            ++position;
+            continue;
+        }
+        const char *nameBegin = position + 2;
+        const char *nameEnd = nameBegin;
+        while ((nameEnd < end) && isIdentifierCharacter(*nameEnd)) {
+            ++nameEnd;
+        }
+        position = nameEnd;
+        while ((position < end) && isWhitespace(*position)) {
+            ++position;
+        }
+        if ((position == end) || (*position != ':')) {
+            // For example a reference like “var(--name)”
+            continue;
+        }
+        const char *valueBegin = position + 1;
+        const char *valueEnd = valueBegin;
+        while ((valueEnd < end) && (*valueEnd != ';') && (*valueEnd != '}')) {
+            ++valueEnd;
+        }
+        position = valueEnd;
+        trim(valueBegin, valueEnd);
+        CssColor::Value value;
+        if (CssColor::parse(valueBegin, static_cast<int>(valueEnd - valueBegin), &value)) {
+            palette->appendName(nameBegin, nameEnd - nameBegin);
+            palette->finishEntry(value, values);
+        }
+    }
+    return true;
+}
+
+/** @brief Converts parsed values to in-gamut LCh values.
+ *
+ * All RGB-based values are converted with a single batch call. Afterwards,
+ * all colors are moved into the gamut in parallel.
+ *
+ * @param colorSpace The color space
+ * @param values The parsed values
+ * @returns The corresponding in-gamut colors. */
+QVector<LchaDouble> Palette::toLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const QVector<CssColor::Value> &values)
+{
+    QVector<LchaDouble> result(values.count());
+    QVector<RgbDouble> rgb;
+    QVector<int> rgbIndices;
+    rgb.reserve(values.count());
+    rgbIndices.reserve(values.count());
+    for (int i = 0; i < values.count(); ++i) {
+        const CssColor::Value &value = values.at(i);
+        if (value.isRgbBased()) {
+            rgb.append(value.rgb);
+            rgbIndices.append(i);
+        } else {
+            cmsCIELCh lch;
+            cmsLab2LCh(&lch, &value.lab);
+            result[i] = LchaDouble(lch.L, lch.C, lch.h, value.alpha);
+        }
+    }
+
+    QVector<LchDouble> rgbLch(rgb.count());
+    colorSpace->toLch(rgb.constData(), rgbLch.data(), rgb.count());
+    for (int j = 0; j < rgbIndices.count(); ++j) {
+        const LchDouble &lch = rgbLch.at(j);
+        result[rgbIndices.at(j)] = LchaDouble( //
+            lch.l,
+            lch.c,
+            lch.h,
+            values.at(rgbIndices.at(j)).alpha);
+    }
+
+    // Gamut correction. For RGB-based values, this only compensates
+    // rounding errors; Lab-based values might be far out-of-gamut.
+    QVector<LchDouble> corrected(result.count());
+    for (int i = 0; i < result.count(); ++i) {
+        const LchaDouble &color = result.at(i);
+        corrected[i] = LchDouble(qBound<double>(0, color.l, 100), color.c, color.h);
+    }
+    colorSpace->nearestInGamutColorByAdjustingChroma( //
+        corrected.constData(),
+        corrected.data(),
+        corrected.count());
+    for (int i = 0; i < result.count(); ++i) {
+        result[i].l = corrected.at(i).l;
+        result[i].c = corrected.at(i).c;
+        result[i].h = corrected.at(i).h;
+    }
+    return result;
+}
+
+} // namespace PerceptualColor
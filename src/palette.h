@@ -0,0 +1,114 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "PerceptualColor/lchadouble.h"
+#include "csscolor.h"
+#include "rgbcolorspace.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A list of named colors, read from a palette file.
+ *
+ * Supported file formats:
+ * - GIMP palettes (<tt>.gpl</tt>)
+ * - Adobe Swatch Exchange (<tt>.ase</tt>). Entries in the CMYK model are
+ *   skipped, because they cannot be converted without a CMYK profile.
+ * - CSS custom properties (<tt>--name: color;</tt>), with all color
+ *   syntax that @ref CssColor supports. Custom properties whose value is
+ *   not a color are ignored.
+ *
+ * The format is detected from the content, not from the file name.
+ *
+ * Palette files might contain thousands of entries, so reading is
+ * optimized for large files:
+ * - The file is memory-mapped (with a fallback to reading it into memory
+ *   for devices that cannot be mapped) and parsed in place. Entries are
+ *   collected in pre-reserved arrays; all names share a single string
+ *   buffer instead of one <tt>QString</tt> per entry.
+ * - All RGB-based entries are converted to LCh in one batch call
+ *   (@ref RgbColorSpace::toLch(const RgbDouble *, LchDouble *, int) const)
+ *   instead of one transform call per entry.
+ * - Out-of-gamut entries are moved into the gamut with the batch version
+ *   of @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma, which
+ *   advances all bisections in lockstep and uses multiple threads for
+ *   big palettes.
+ *
+ * RGB values of the palette file are interpreted in the RGB color space
+ * that is used for reading the file.
+ *
+ * @sa @ref PaletteModel */
+class Palette final
+{
+public:
+    Palette() = default;
+    LchaDouble color(int index) const;
+    int count() const;
+    QString name(int index) const;
+    static bool readFromData(const QSharedPointer<RgbColorSpace> &colorSpace, const char *data, qint64 size, Palette *result);
+    static bool readFromFile(const QSharedPointer<RgbColorSpace> &colorSpace, const QString &fileName, Palette *result);
+    QString title() const;
+
+private:
+    void appendName(const char *utf8, qint64 length);
+    void finishEntry(const CssColor::Value &value, QVector<CssColor::Value> *values);
+    static bool parseAse(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values);
+    static bool parseCss(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values);
+    static bool parseGpl(const char *data, qint64 size, Palette *palette, QVector<CssColor::Value> *values);
+    static QVector<LchaDouble> toLcha(const QSharedPointer<RgbColorSpace> &colorSpace, const QVector<CssColor::Value> &values);
+
+    /** @brief Internal storage for @ref color() */
+    QVector<LchaDouble> m_colors;
+    /** @brief Offsets of the names within @ref m_names.
+     *
+     * Contains one more element than there are colors: The name of the
+     * color <em>i</em> starts at <tt>m_nameOffsets.at(i)</tt> and
+     * ends before <tt>m_nameOffsets.at(i + 1)</tt>. */
+    QVector<int> m_nameOffsets {0};
+    /** @brief The concatenated names of all colors.
+     * @sa @ref m_nameOffsets */
+    QString m_names;
+    /** @brief Internal storage for @ref title() */
+    QString m_title;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestPalette;
+};
+
+} // namespace PerceptualColor
+
+#endif // PALETTE_H
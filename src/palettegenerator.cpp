@@ -0,0 +1,211 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "PerceptualColor/palettegenerator.h"
+
+#include "chromahueboundary.h"
+#include "chromalightnessboundary.h"
+#include "lchvalues.h"
+#include "rgbcolorspace.h"
+
+#include <QtConcurrent>
+
+#include <numeric>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Moves colors into the gamut by reducing their chroma, without
+ * any estimates.
+ *
+ * @param colorSpace The color space
+ * @param colors The requested colors
+ * @returns For each color, the result of
+ * @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma. All colors
+ * are corrected together with a single batch call. */
+QVector<LchDouble> PaletteGenerator::reduceChroma(const RgbColorSpace &colorSpace, const QVector<LchDouble> &colors)
+{
+    QVector<LchDouble> result(colors.count());
+    colorSpace.nearestInGamutColorByAdjustingChroma(colors.constData(), result.data(), colors.count());
+    return result;
+}
+
+/** @internal
+ *
+ * @brief Moves colors into the gamut by reducing their chroma, with
+ * the help of estimates.
+ *
+ * @param colorSpace The color space
+ * @param colors The requested colors
+ * @param chromaEstimates For each color, an upper estimate of its maximum
+ * in-gamut chroma, or a negative value if its gray is out-of-gamut.
+ * @returns For each color, the result of
+ * @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma. The search
+ * starts at the estimate (if it is smaller than the requested chroma).
+ * If the estimate turns out to be in-gamut, so that it was not an upper
+ * limit, the search is repeated with the requested chroma. */
+QVector<LchDouble> PaletteGenerator::reduceChroma(const RgbColorSpace &colorSpace, const QVector<LchDouble> &colors, const QVector<qreal> &chromaEstimates)
+{
+    const int count = colors.count();
+    QVector<LchDouble> startColors = colors;
+    for (int i = 0; i < count; ++i) {
+        if ((colors.at(i).c > 0) && (chromaEstimates.at(i) < colors.at(i).c)) {
+            startColors[i].c = qMax<qreal>(chromaEstimates.at(i), 0);
+        }
+    }
+    QVector<LchDouble> result(count);
+    colorSpace.nearestInGamutColorByAdjustingChroma(startColors.constData(), result.data(), count);
+
+    QVector<LchDouble> retryColors;
+    QVector<int> retryIndices;
+    for (int i = 0; i < count; ++i) {
+        if ((startColors.at(i).c < colors.at(i).c) && (result.at(i).c >= startColors.at(i).c)) {
+            retryColors.append(colors.at(i));
+            retryIndices.append(i);
+        }
+    }
+    if (retryColors.isEmpty()) {
+        return result;
+    }
+    QVector<LchDouble> retryResults(retryColors.count());
+    colorSpace.nearestInGamutColorByAdjustingChroma(retryColors.constData(), retryResults.data(), retryColors.count());
+    for (int j = 0; j < retryIndices.count(); ++j) {
+        result[retryIndices.at(j)] = retryResults.at(j);
+    }
+    return result;
+}
+
+/** @brief A lightness ramp.
+ *
+ * @param colorSpace The color space
+ * @param hue The hue of all steps
+ * @param firstLightness The lightness of the first step
+ * @param lastLightness The lightness of the last step
+ * @param count The number of steps
+ * @returns <em>count</em> colors with equally spaced lightnesses from
+ * <em>firstLightness</em> to <em>lastLightness</em>. Each color has the
+ * highest in-gamut chroma for its lightness and hue. Lightnesses without
+ * any in-gamut color are moved to the nearest in-gamut gray. If
+ * <em>count</em> is <tt>1</tt>, the only color has
+ * <em>firstLightness</em>. If <em>count</em> is <tt>0</tt> or smaller,
+ * the result is empty. */
+QVector<LchDouble> PaletteGenerator::lightnessRamp(const QSharedPointer<RgbColorSpace> &colorSpace, qreal hue, qreal firstLightness, qreal lastLightness, int count)
+{
+    if (count <= 0) {
+        return QVector<LchDouble>();
+    }
+    const qreal lightnessStep = (count > 1) //
+        ? (lastLightness - firstLightness) / (count - 1)
+        : 0;
+    QVector<LchDouble> colors(count);
+    for (int i = 0; i < count; ++i) {
+        colors[i] = LchDouble(firstLightness + i * lightnessStep, LchValues::humanMaximumChroma, hue);
+    }
+    // Like the gamut search, treat a non-finite hue as 0. Calculating the
+    // boundary would cost more than it saves for a single ramp, so it is
+    // only used if it is already available.
+    const QSharedPointer<const ChromaLightnessBoundary> boundary = //
+        colorSpace->cachedChromaLightnessBoundary(qIsFinite(hue) ? hue : 0);
+    if (boundary.isNull()) {
+        return reduceChroma(*colorSpace, colors);
+    }
+    QVector<qreal> chromaEstimates(count);
+    for (int i = 0; i < count; ++i) {
+        const qreal lightness = colors.at(i).l;
+        chromaEstimates[i] = qIsFinite(lightness) //
+            ? boundary->maximumChromaEstimate(lightness)
+            : LchValues::humanMaximumChroma;
+    }
+    return reduceChroma(*colorSpace, colors, chromaEstimates);
+}
+
+/** @brief Lightness ramps for various hues, like for a whole design
+ * system.
+ *
+ * The ramps are calculated in parallel.
+ *
+ * @param colorSpace The color space
+ * @param hues The hues
+ * @param firstLightness The lightness of the first step of each ramp
+ * @param lastLightness The lightness of the last step of each ramp
+ * @param count The number of steps of each ramp
+ * @returns For each hue, the result of @ref lightnessRamp(). */
+QVector<QVector<LchDouble>> PaletteGenerator::lightnessRamps(const QSharedPointer<RgbColorSpace> &colorSpace, const QVector<qreal> &hues, qreal firstLightness, qreal lastLightness, int count)
+{
+    QVector<QVector<LchDouble>> result(hues.count());
+    QVector<int> indices(hues.count());
+    std::iota(indices.begin(), indices.end(), 0);
+    QVector<LchDouble> *const ramps = result.data();
+    QtConcurrent::blockingMap(indices, [&](const int index) {
+        ramps[index] = lightnessRamp(colorSpace, hues.at(index), firstLightness, lastLightness, count);
+    });
+    return result;
+}
+
+/** @brief A set of equally spaced hues.
+ *
+ * @param colorSpace The color space
+ * @param lightness The lightness of all steps
+ * @param chroma The requested chroma of all steps. Use a chroma that is
+ * out-of-gamut for all hues (like <tt>200</tt>) to get the highest
+ * in-gamut chroma for each hue.
+ * @param firstHue The hue of the first step
+ * @param count The number of steps
+ * @returns <em>count</em> colors with hues that are equally spaced around
+ * the whole hue circle, starting at <em>firstHue</em>. Each color has
+ * the requested chroma, or the highest in-gamut chroma if the requested
+ * chroma is out-of-gamut. If the lightness has no in-gamut color, the
+ * colors are moved to the nearest in-gamut gray. If <em>count</em> is
+ * <tt>0</tt> or smaller, the result is empty. */
+QVector<LchDouble> PaletteGenerator::hueSet(const QSharedPointer<RgbColorSpace> &colorSpace, qreal lightness, qreal chroma, qreal firstHue, int count)
+{
+    if (count <= 0) {
+        return QVector<LchDouble>();
+    }
+    QVector<LchDouble> colors(count);
+    for (int i = 0; i < count; ++i) {
+        colors[i] = LchDouble(lightness, chroma, firstHue + i * 360.0 / count);
+    }
+    // Calculating the boundary would cost more than it saves for a single
+    // hue set, so it is only used if it is already available.
+    const QSharedPointer<const ChromaHueBoundary> boundary = colorSpace->cachedChromaHueBoundary(lightness);
+    if (boundary.isNull()) {
+        return reduceChroma(*colorSpace, colors);
+    }
+    QVector<qreal> chromaEstimates(count);
+    for (int i = 0; i < count; ++i) {
+        chromaEstimates[i] = boundary->maximumChromaEstimate(colors.at(i).h);
+    }
+    return reduceChroma(*colorSpace, colors, chromaEstimates);
+}
+
+} // namespace PerceptualColor
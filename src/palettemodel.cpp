@@ -0,0 +1,134 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "palettemodel.h"
+// Second, the private implementation.
+#include "palettemodel_p.h"
+
+#include "csscolor.h"
+
+namespace PerceptualColor
+{
+/** @brief Constructor
+ *
+ * @param colorSpace The color space within which this model should operate.
+ * Should be the same color space that has been used to read the palettes.
+ * @param parent The parent object */
+PaletteModel::PaletteModel(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QObject *parent)
+    : QAbstractListModel(parent)
+    , d_pointer(new PaletteModelPrivate)
+{
+    d_pointer->m_rgbColorSpace = colorSpace;
+}
+
+/** @brief Destructor */
+PaletteModel::~PaletteModel() noexcept
+{
+}
+
+/** @brief Getter for the palette.
+ * @returns The palette. */
+Palette PaletteModel::palette() const
+{
+    return d_pointer->m_palette;
+}
+
+/** @brief Setter for the palette.
+ *
+ * Resets the model.
+ *
+ * @param palette The new palette */
+void PaletteModel::setPalette(const Palette &palette)
+{
+    beginResetModel();
+    d_pointer->m_palette = palette;
+    d_pointer->m_rgbColors.resize(palette.count());
+    for (int i = 0; i < palette.count(); ++i) {
+        d_pointer->m_rgbColors[i] = //
+            d_pointer->m_rgbColorSpace->toQColorRgbBound(palette.color(i));
+    }
+    endResetModel();
+}
+
+/** @brief Number of rows.
+ * @param parent The parent index. Must be invalid, because this is
+ * a list model.
+ * @returns The number of colors of the palette. */
+int PaletteModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return d_pointer->m_palette.count();
+}
+
+/** @brief Data of an item.
+ * @param index The index of the item
+ * @param role The role. See @ref PaletteModel for the supported roles.
+ * @returns The data, or an invalid <tt>QVariant</tt> for unsupported
+ * roles and invalid indexes. */
+QVariant PaletteModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= d_pointer->m_palette.count())) {
+        return QVariant();
+    }
+    const int row = index.row();
+    char buffer[CssColor::maximumFormattedLength + 1];
+    switch (role) {
+    case Qt::DisplayRole: {
+        const QString name = d_pointer->m_palette.name(row);
+        if (!name.isEmpty()) {
+            return name;
+        }
+        const QColor rgbColor = d_pointer->m_rgbColors.at(row);
+        CssColor::Value value;
+        value.rgb = RgbDouble {rgbColor.redF(), rgbColor.greenF(), rgbColor.blueF()};
+        const int length = CssColor::format(value, CssColor::Syntax::Hex, buffer);
+        return QString::fromLatin1(buffer, length);
+    }
+    case Qt::DecorationRole:
+        return d_pointer->m_rgbColors.at(row);
+    case Qt::ToolTipRole: {
+        const CssColor::Value value = CssColor::fromLcha( //
+            d_pointer->m_rgbColorSpace,
+            d_pointer->m_palette.color(row),
+            CssColor::Syntax::Lch);
+        const int length = CssColor::format(value, CssColor::Syntax::Lch, buffer);
+        return QString::fromLatin1(buffer, length);
+    }
+    case lchaRole:
+        return QVariant::fromValue(d_pointer->m_palette.color(row));
+    default:
+        return QVariant();
+    }
+}
+
+} // namespace PerceptualColor
@@ -0,0 +1,93 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PALETTEMODEL_H
+#define PALETTEMODEL_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QAbstractListModel>
+#include <QSharedPointer>
+
+#include "PerceptualColor/constpropagatinguniquepointer.h"
+
+namespace PerceptualColor
+{
+class Palette;
+class RgbColorSpace;
+
+/** @internal
+ *
+ * @brief List model that provides the colors of a @ref Palette.
+ *
+ * Intended as data source for palette views in @ref ColorDialog, but
+ * can be used with any <tt>QAbstractItemView</tt>.
+ *
+ * Provided roles:
+ * - <tt>Qt::DisplayRole</tt>: The name of the color. For colors without
+ *   name, its hexadecimal RGB value.
+ * - <tt>Qt::DecorationRole</tt>: The color as <tt>QColor</tt>.
+ * - <tt>Qt::ToolTipRole</tt>: The color in CSS <tt>lch()</tt> syntax.
+ * - @ref lchaRole: The color as @ref LchaDouble.
+ *
+ * The RGB values are calculated once when the palette is set, so
+ * that painting views does not involve color management. */
+class PaletteModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    /** @brief Role that provides the color as @ref LchaDouble. */
+    static constexpr int lchaRole = Qt::UserRole;
+    explicit PaletteModel(const QSharedPointer<PerceptualColor::RgbColorSpace> &colorSpace, QObject *parent = nullptr);
+    virtual ~PaletteModel() noexcept override;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Palette palette() const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    void setPalette(const Palette &palette);
+
+private:
+    Q_DISABLE_COPY(PaletteModel)
+
+    class PaletteModelPrivate;
+    /** @internal
+     *
+     * @brief Declare the private implementation as friend class.
+     *
+     * This allows the private class to access the protected members and
+     * functions of instances of <em>this</em> class. */
+    friend class PaletteModelPrivate;
+    /** @brief Pointer to implementation (pimpl) */
+    ConstPropagatingUniquePointer<PaletteModelPrivate> d_pointer;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestPaletteModel;
+};
+
+} // namespace PerceptualColor
+
+#endif // PALETTEMODEL_H
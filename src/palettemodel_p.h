@@ -0,0 +1,74 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PALETTEMODEL_P_H
+#define PALETTEMODEL_P_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Include the header of the public class of this private implementation.
+#include "palettemodel.h"
+
+#include <QColor>
+#include <QVector>
+
+#include "palette.h"
+#include "rgbcolorspace.h"
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ *  @brief Private implementation within the <em>Pointer to
+ *  implementation</em> idiom */
+class PaletteModel::PaletteModelPrivate final
+{
+public:
+    /** @brief Constructor */
+    PaletteModelPrivate() = default;
+    /** @brief Default destructor
+     *
+     * The destructor is non-<tt>virtual</tt> because
+     * the class as a whole is <tt>final</tt>. */
+    ~PaletteModelPrivate() noexcept = default;
+
+    /** @brief Internal storage for @ref palette() */
+    Palette m_palette;
+    /** @brief The colors of @ref m_palette as RGB values.
+     *
+     * Calculated in @ref setPalette(). */
+    QVector<QColor> m_rgbColors;
+    /** @brief Pointer to @ref RgbColorSpace object */
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace;
+
+private:
+    Q_DISABLE_COPY(PaletteModelPrivate)
+};
+
+} // namespace PerceptualColor
+
+#endif // PALETTEMODEL_P_H
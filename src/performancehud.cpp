@@ -0,0 +1,230 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own header
+#include "performancehud.h"
+
+#include <QApplication>
+#include <QEvent>
+#include <QFont>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QStringList>
+#include <QWidget>
+
+#include "PerceptualColor/abstractdiagram.h"
+#include "abstractdiagram_p.h"
+
+namespace PerceptualColor
+{
+/** @brief Internal storage for @ref isEnabled().
+ *
+ * Initialized on first use from the environment variable
+ * <tt>PERCEPTUALCOLOR_PERFORMANCE_HUD</tt>.
+ *
+ * @returns A reference to the flag. */
+bool &PerformanceHud::enabledFlag()
+{
+    static bool flag = (qEnvironmentVariableIntValue("PERCEPTUALCOLOR_PERFORMANCE_HUD") == 1);
+    return flag;
+}
+
+/** @brief If the overlay is enabled.
+ *
+ * @returns If the overlay is enabled. Initially, this is <tt>true</tt>
+ * if the environment variable <tt>PERCEPTUALCOLOR_PERFORMANCE_HUD</tt>
+ * is set to <tt>1</tt>.
+ *
+ * @sa @ref setEnabled() */
+bool PerformanceHud::isEnabled()
+{
+    return enabledFlag();
+}
+
+/** @brief Enables or disables the overlay at run time.
+ *
+ * This is a debug API for the library itself and its unit tests; it is
+ * not exported. Applications use the environment variable
+ * <tt>PERCEPTUALCOLOR_PERFORMANCE_HUD</tt> instead. All diagrams are
+ * repainted, so that the overlay appears or disappears immediately.
+ *
+ * @param enabled If the overlay is enabled.
+ *
+ * @sa @ref isEnabled() */
+void PerformanceHud::setEnabled(bool enabled)
+{
+    if (enabledFlag() == enabled) {
+        return;
+    }
+    enabledFlag() = enabled;
+    const QWidgetList widgets = QApplication::allWidgets();
+    for (QWidget *widget : widgets) {
+        if (qobject_cast<AbstractDiagram *>(widget) != nullptr) {
+            widget->update();
+        }
+    }
+}
+
+/** @brief The overlay of a widget.
+ *
+ * @param widget The widget
+ * @returns The overlay of the widget, or <tt>nullptr</tt> if the overlay
+ * is disabled or if the widget has not received any event since it
+ * has been enabled. */
+PerformanceHud *PerformanceHud::of(AbstractDiagram *widget)
+{
+    if (!isEnabled() || (widget == nullptr)) {
+        return nullptr;
+    }
+    return widget->d_pointer->m_performanceHud.get();
+}
+
+/** @brief Counts an event that is not a paint event.
+ *
+ * Input events are counted, because each of them might request an update,
+ * and these requests are coalesced into the next paint event.
+ *
+ * @param event The event */
+void PerformanceHud::countEvent(const QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseMove:
+    case QEvent::Resize:
+    case QEvent::TouchUpdate:
+    case QEvent::Wheel:
+        ++m_eventCount;
+        break;
+    default:
+        break;
+    }
+}
+
+/** @brief Starts the measurement of a paint event.
+ *
+ * To be called before the paint event is processed. */
+void PerformanceHud::beginPaint()
+{
+    m_imageIsCacheHit = true;
+    m_imageCount = 0;
+    m_imageTime = 0;
+    m_paintTimer.start();
+}
+
+/** @brief Records the image of an image generator.
+ *
+ * @param generator The image generator
+ * @param image The image that the generator has returned
+ * @param nanoseconds The time that the generator needed */
+void PerformanceHud::addImage(const void *generator, const QImage &image, qint64 nanoseconds)
+{
+    const qint64 key = image.cacheKey();
+    if (m_imageCacheKeys.value(generator, -1) != key) {
+        m_imageIsCacheHit = false;
+        m_imageCacheKeys.insert(generator, key);
+    }
+    ++m_imageCount;
+    m_imageTime += nanoseconds;
+}
+
+/** @brief Finishes the measurement of a paint event and paints the overlay.
+ *
+ * To be called after the paint event has been processed, while the widget
+ * is still in its paint event.
+ *
+ * @param widget The widget on which the overlay is painted. */
+void PerformanceHud::endPaint(QWidget *widget)
+{
+    const qint64 paintTime = m_paintTimer.nsecsElapsed();
+    if (m_frameTimes.count() < averageFrameCount) {
+        m_frameTimes.append(paintTime);
+    } else {
+        m_frameTimes[m_frameCount % averageFrameCount] = paintTime;
+    }
+    ++m_frameCount;
+    m_lastCoalescedEventCount = m_eventCount;
+    m_eventCount = 0;
+    m_lastImageIsCacheHit = m_imageIsCacheHit;
+    m_lastImageCount = m_imageCount;
+    m_lastImageTime = m_imageTime;
+
+    if (widget == nullptr) {
+        return;
+    }
+    QPainter painter(widget);
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPointSizeF(font.pointSizeF() * 0.8);
+    painter.setFont(font);
+    const QFontMetrics metrics(font);
+    const QString hudText = text();
+    const QRect textRect = metrics //
+                               .boundingRect(widget->rect(), Qt::AlignLeft | Qt::AlignTop, hudText)
+                               .translated(metrics.averageCharWidth(), metrics.averageCharWidth() / 2);
+    const int margin = metrics.averageCharWidth() / 2;
+    painter.fillRect(textRect.adjusted(-margin, -margin, margin, margin), QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, hudText);
+}
+
+/** @brief The text of the overlay.
+ *
+ * @returns The statistics of the last completed paint event, one
+ * per line. */
+QString PerformanceHud::text() const
+{
+    constexpr double nanosecondsPerMillisecond = 1000000;
+    qint64 sum = 0;
+    for (const qint64 frameTime : m_frameTimes) {
+        sum += frameTime;
+    }
+    const double average = m_frameTimes.isEmpty() //
+        ? 0
+        : static_cast<double>(sum) / m_frameTimes.count() / nanosecondsPerMillisecond;
+    const double last = m_frameTimes.isEmpty() //
+        ? 0
+        : m_frameTimes.at((m_frameCount - 1) % averageFrameCount) / nanosecondsPerMillisecond;
+    QStringList lines;
+    lines.append(QStringLiteral("paint %1 ms (avg %2 ms)") //
+                     .arg(last, 0, 'f', 2)
+                     .arg(average, 0, 'f', 2));
+    if (m_lastImageCount > 0) {
+        lines.append(QStringLiteral("image %1 ms (%2)") //
+                         .arg(m_lastImageTime / nanosecondsPerMillisecond, 0, 'f', 2)
+                         .arg(m_lastImageIsCacheHit ? QStringLiteral("cache hit") : QStringLiteral("rendered")));
+    } else {
+        lines.append(QStringLiteral("image n/a"));
+    }
+    lines.append(QStringLiteral("coalesced events %1").arg(m_lastCoalescedEventCount));
+    return lines.join(QStringLiteral("\n"));
+}
+
+} // namespace PerceptualColor
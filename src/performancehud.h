@@ -0,0 +1,169 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PERFORMANCEHUD_H
+#define PERFORMANCEHUD_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+class QEvent;
+class QWidget;
+
+namespace PerceptualColor
+{
+class AbstractDiagram;
+
+/** @internal
+ *
+ * @brief Overlay that shows paint timings on top of diagram widgets.
+ *
+ * When a diagram feels laggy, this overlay shows in-situ what is slow. It
+ * is painted on top of every @ref AbstractDiagram and shows:
+ *
+ * - The time of the last paint event and the average time of the
+ *   last @ref averageFrameCount paint events.
+ * - The time that was spent in the image generators (like
+ *   @ref ChromaHueImage) during the last paint event, and whether
+ *   their images came from the cache.
+ * - The number of input events (mouse, wheel, key, touch, resize) that
+ *   arrived since the previous paint event. Each of them might have
+ *   requested an update, and Qt has coalesced all these requests into
+ *   this single paint event.
+ *
+ * The overlay is disabled by default. It is enabled if the environment
+ * variable <tt>PERCEPTUALCOLOR_PERFORMANCE_HUD</tt> is set to <tt>1</tt>.
+ * This class is not exported, so for applications, the environment
+ * variable is the only switch (as documented in @ref AbstractDiagram).
+ * @ref setEnabled() is available only within the library and its
+ * unit tests.
+ *
+ * While disabled, the widgets do not create any instance of this class,
+ * and the only cost is the check of @ref isEnabled() for each event.
+ *
+ * The diagrams call @ref image() instead of <tt>getImage()</tt> of their
+ * image generators, so that the time of the image generation is measured.
+ *
+ * @note This class is not thread-safe. Like all widget code, it must be
+ * used only in the GUI thread. */
+class PerformanceHud final
+{
+public:
+    /** @brief Default constructor */
+    PerformanceHud() = default;
+    /** @brief Default destructor */
+    ~PerformanceHud() noexcept = default;
+
+    /** @brief Number of paint events that are considered for the
+     * average paint time. */
+    static constexpr int averageFrameCount = 32;
+
+    void beginPaint();
+    void countEvent(const QEvent *event);
+    void endPaint(QWidget *widget);
+    template<typename T> static QImage image(AbstractDiagram *widget, T &generator);
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+    QString text() const;
+
+private:
+    Q_DISABLE_COPY(PerformanceHud)
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestPerformanceHud;
+
+    void addImage(const void *generator, const QImage &image, qint64 nanoseconds);
+    static bool &enabledFlag();
+    static PerformanceHud *of(AbstractDiagram *widget);
+
+    /** @brief Number of input events since the previous paint event. */
+    int m_eventCount = 0;
+    /** @brief Number of input events that were coalesced into the
+     * last paint event. */
+    int m_lastCoalescedEventCount = 0;
+    /** @brief Number of paint events so far. */
+    int m_frameCount = 0;
+    /** @brief Paint times of the last paint events, in nanoseconds.
+     *
+     * A ring buffer with up to @ref averageFrameCount elements. */
+    QVector<qint64> m_frameTimes;
+    /** @brief The <tt>QImage::cacheKey()</tt> of the last image of each
+     * image generator.
+     *
+     * If the generator returns an image with the same cache key again, the
+     * image came from its cache. */
+    QHash<const void *, qint64> m_imageCacheKeys;
+    /** @brief If all images of the current paint event came from the
+     * cache. */
+    bool m_imageIsCacheHit = true;
+    /** @brief Number of images of the current paint event. */
+    int m_imageCount = 0;
+    /** @brief Time spent in the image generators during the current
+     * paint event, in nanoseconds. */
+    qint64 m_imageTime = 0;
+    /** @brief Like @ref m_imageIsCacheHit, but for the last completed
+     * paint event. */
+    bool m_lastImageIsCacheHit = true;
+    /** @brief Like @ref m_imageCount, but for the last completed
+     * paint event. */
+    int m_lastImageCount = 0;
+    /** @brief Like @ref m_imageTime, but for the last completed
+     * paint event. */
+    qint64 m_lastImageTime = 0;
+    /** @brief Measures the current paint event. */
+    QElapsedTimer m_paintTimer;
+};
+
+/** @brief Gets the image of an image generator and measures the time.
+ *
+ * @param widget The widget that is painting.
+ * @param generator An image generator like @ref ChromaHueImage,
+ * @ref ChromaLightnessImage, @ref ColorWheelImage or @ref GradientImage.
+ * @returns The same as <tt>generator.getImage()</tt>. If the overlay is
+ * enabled, the time of this call is added to the statistics of the
+ * current paint event of <em>widget</em>. */
+template<typename T> QImage PerformanceHud::image(AbstractDiagram *widget, T &generator)
+{
+    PerformanceHud *hud = of(widget);
+    if (hud == nullptr) {
+        return generator.getImage();
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const QImage result = generator.getImage();
+    hud->addImage(&generator, result, timer.nsecsElapsed());
+    return result;
+}
+
+} // namespace PerceptualColor
+
+#endif // PERFORMANCEHUD_H
@@ -0,0 +1,321 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef READMOSTLYCACHE_H
+#define READMOSTLYCACHE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <atomic>
+#include <limits>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief A thread-safe cache that never blocks readers.
+ *
+ * The caches of this library (gamut boundaries, display transforms,
+ * rendered images) are shared by render threads and the GUI thread.
+ * They are read very often and written rarely. With a mutex, every lookup
+ * would serialize all threads, and a lookup would have to wait while
+ * another thread inserts a new entry.
+ *
+ * This cache is read-copy-update (RCU): The content is an immutable
+ * snapshot. Readers load the current snapshot with an atomic operation
+ * and copy the value out of it, without any lock. Writers copy the
+ * snapshot, modify the copy, and publish it with an atomic pointer swap.
+ * The old snapshot is deleted only after all readers that might still
+ * use it have finished (grace period). For this, readers register in one
+ * of two counters, chosen by the parity of an epoch; a writer starts a
+ * new epoch and waits until the counter of the previous epoch has dropped
+ * to zero. Readers never wait for writers: At most they have to retry
+ * their registration if a writer starts a new epoch at the same moment.
+ * Writers are serialized by a mutex among themselves.
+ *
+ * Each entry has a cost. If the total cost exceeds the maximum cost,
+ * the oldest entries are removed. Unlike <tt>QCache</tt>, this is
+ * “first in, first out”: Updating the recency on each read would make
+ * each read a write.
+ *
+ * Inserting copies the whole snapshot, so this class is only suitable
+ * for caches with a moderate number of entries that are read much more
+ * often than written. The keys and values are copied while reading, so
+ * they should be cheap to copy, like implicitly shared Qt types or
+ * <tt>QSharedPointer</tt>.
+ *
+ * @note All functions are thread-safe.
+ *
+ * @warning Do not call this cache from within the copy constructor of
+ * its own keys or values, as a writer would wait for itself. */
+template<typename Key, typename Value> class ReadMostlyCache final
+{
+public:
+    /** @brief Constructor
+     *
+     * @param maximumCost The maximum total cost of all entries. */
+    explicit ReadMostlyCache(int maximumCost = std::numeric_limits<int>::max())
+        : m_maximumCost(maximumCost)
+    {
+        m_readerCounts[0].store(0);
+        m_readerCounts[1].store(0);
+        m_snapshot.store(new Snapshot);
+    }
+
+    /** @brief Destructor
+     *
+     * There must be no concurrent readers anymore. */
+    ~ReadMostlyCache() noexcept
+    {
+        delete m_snapshot.load();
+    }
+
+    /** @brief Removes all entries. */
+    void clear()
+    {
+        QMutexLocker locker(&m_writerMutex);
+        publish(new Snapshot);
+    }
+
+    /** @brief Number of entries
+     *
+     * @returns Number of entries */
+    int count() const
+    {
+        const unsigned int epoch = enterReadSection();
+        const int result = m_snapshot.load(std::memory_order_acquire)->entries.count();
+        leaveReadSection(epoch);
+        return result;
+    }
+
+    /** @brief Searches an entry.
+     *
+     * @param key The key
+     * @param value Receives a copy of the value if the key has been found.
+     * Not changed otherwise.
+     * @returns If the key has been found. */
+    bool find(const Key &key, Value *value) const
+    {
+        const unsigned int epoch = enterReadSection();
+        const Snapshot *snapshot = m_snapshot.load(std::memory_order_acquire);
+        const auto iterator = snapshot->entries.constFind(key);
+        const bool result = (iterator != snapshot->entries.constEnd());
+        if (result) {
+            *value = iterator->value;
+        }
+        leaveReadSection(epoch);
+        return result;
+    }
+
+    /** @brief Inserts an entry.
+     *
+     * An existing entry with the same key is replaced.
+     *
+     * @param key The key
+     * @param value The value
+     * @param cost The cost of this entry
+     * @returns <tt>true</tt> if the entry has been inserted. <tt>false</tt>
+     * if its cost is bigger than the maximum cost. */
+    bool insert(const Key &key, const Value &value, int cost = 1)
+    {
+        return insertIf(key, value, cost, [](const Value &) {
+            return true;
+        });
+    }
+
+    /** @brief Inserts an entry, but replaces an existing entry only
+     * on request.
+     *
+     * The check and the insert are atomic: No other writer can change
+     * the entry in between.
+     *
+     * @param key The key
+     * @param value The value
+     * @param cost The cost of this entry
+     * @param isReplacement Only called if there is yet an entry with this
+     * key, with the existing value as argument. Returns if the existing
+     * value should be replaced.
+     * @returns <tt>true</tt> if the entry has been inserted.
+     * <tt>false</tt> otherwise. */
+    template<typename Predicate> bool insertIf(const Key &key, const Value &value, int cost, Predicate isReplacement)
+    {
+        QMutexLocker locker(&m_writerMutex);
+        // Only writers change the snapshot, and they hold the mutex.
+        const Snapshot *current = m_snapshot.load(std::memory_order_acquire);
+        const auto iterator = current->entries.constFind(key);
+        if ((iterator != current->entries.constEnd()) && !isReplacement(iterator->value)) {
+            return false;
+        }
+        Snapshot *next = new Snapshot(*current);
+        if (next->entries.contains(key)) {
+            next->totalCost -= next->entries.value(key).cost;
+            next->entries.remove(key);
+            next->insertionOrder.removeOne(key);
+        }
+        const bool result = (cost <= m_maximumCost);
+        if (result) {
+            // Remove the oldest entries until the new one fits.
+            while (next->totalCost > m_maximumCost - cost) {
+                const Key oldestKey = next->insertionOrder.takeFirst();
+                next->totalCost -= next->entries.value(oldestKey).cost;
+                next->entries.remove(oldestKey);
+            }
+            next->entries.insert(key, Entry {value, cost});
+            next->insertionOrder.append(key);
+            next->totalCost += cost;
+        }
+        publish(next);
+        return result;
+    }
+
+    /** @brief Getter for the maximum cost
+     *
+     * @returns The maximum total cost of all entries. */
+    int maximumCost() const
+    {
+        return m_maximumCost;
+    }
+
+    /** @brief Total cost of all entries
+     *
+     * @returns Total cost of all entries */
+    int totalCost() const
+    {
+        const unsigned int epoch = enterReadSection();
+        const int result = m_snapshot.load(std::memory_order_acquire)->totalCost;
+        leaveReadSection(epoch);
+        return result;
+    }
+
+    /** @brief Searches an entry.
+     *
+     * @param key The key
+     * @param defaultValue The value to return if the key has not been
+     * found.
+     * @returns A copy of the value, or <em>defaultValue</em>. */
+    Value value(const Key &key, const Value &defaultValue = Value()) const
+    {
+        Value result = defaultValue;
+        find(key, &result);
+        return result;
+    }
+
+private:
+    Q_DISABLE_COPY(ReadMostlyCache)
+
+    /** @brief An entry of the cache */
+    struct Entry {
+        /** @brief The value */
+        Value value;
+        /** @brief The cost */
+        int cost;
+    };
+
+    /** @brief An immutable state of the cache */
+    struct Snapshot {
+        /** @brief The entries */
+        QHash<Key, Entry> entries;
+        /** @brief The keys, the oldest first */
+        QVector<Key> insertionOrder;
+        /** @brief Total cost of all entries */
+        int totalCost = 0;
+    };
+
+    /** @brief Registers a reader.
+     *
+     * @returns The epoch in which the reader has been registered. Must be
+     * passed to @ref leaveReadSection(). */
+    unsigned int enterReadSection() const
+    {
+        // All operations are seq_cst. See @ref publish() for the reason.
+        while (true) {
+            const unsigned int epoch = m_epoch.load();
+            m_readerCounts[epoch % 2].fetch_add(1);
+            if (m_epoch.load() == epoch) {
+                return epoch;
+            }
+            // A writer has started a new epoch meanwhile, and might
+            // yet wait for the counter of the old epoch.
+            m_readerCounts[epoch % 2].fetch_sub(1);
+        }
+    }
+
+    /** @brief Unregisters a reader.
+     *
+     * @param epoch The return value of @ref enterReadSection() */
+    void leaveReadSection(unsigned int epoch) const
+    {
+        m_readerCounts[epoch % 2].fetch_sub(1, std::memory_order_release);
+    }
+
+    /** @brief Publishes a new snapshot and deletes the old one.
+     *
+     * @pre @ref m_writerMutex is locked.
+     *
+     * @param newSnapshot The new snapshot. Takes ownership. */
+    void publish(const Snapshot *newSnapshot)
+    {
+        const Snapshot *oldSnapshot = m_snapshot.exchange(newSnapshot);
+        // Grace period: Readers that register from now on see the new
+        // snapshot. Wait for the readers of the old epoch, which might
+        // still use the old snapshot.
+        const unsigned int epoch = m_epoch.load();
+        m_epoch.store(epoch + 1);
+        // This is the store-buffer (Dekker) pattern: The writer stores the
+        // epoch and then loads the counter; the reader increments the
+        // counter and then loads the epoch. At least one of them must
+        // see the store of the other one, otherwise a reader could use
+        // the old snapshot while it is deleted. Only sequential
+        // consistency on both sides guarantees this, so the load must
+        // not be weaker than seq_cst (the reader uses seq_cst, too).
+        while (m_readerCounts[epoch % 2].load(std::memory_order_seq_cst) != 0) {
+            QThread::yieldCurrentThread();
+        }
+        delete oldSnapshot;
+    }
+
+    /** @brief The current epoch. Only its parity is relevant. */
+    mutable std::atomic<unsigned int> m_epoch {0};
+    /** @brief Internal storage for @ref maximumCost() */
+    const int m_maximumCost;
+    /** @brief Number of active readers, for each epoch parity */
+    mutable std::atomic<int> m_readerCounts[2];
+    /** @brief The current snapshot. Never <tt>nullptr</tt>. */
+    std::atomic<const Snapshot *> m_snapshot;
+    /** @brief Serializes the writers */
+    QMutex m_writerMutex;
+};
+
+} // namespace PerceptualColor
+
+#endif // READMOSTLYCACHE_H
@@ -33,11 +33,23 @@
 // Second, the private implementation.
 #include "rgbcolorspace_p.h"
 
+#include "gamutbisection.h"
 #include "helper.h"
 #include "iohandlerfactory.h"
 #include "polarpointf.h"
+#include "srgbgamuttable.h"
+#include "tracepoints.h"
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <algorithm>
+#include <limits>
 
 // TODO There should be no dependency on Posix headers, but only on standard C++.
 #include <unistd.h> // Posix header
@@ -63,10 +75,15 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createSrgb()
 {
     // Create an invalid object:
     QSharedPointer<PerceptualColor::RgbColorSpace> result {new RgbColorSpace()};
+    // Must be set before initialize(), which then uses the gamut data
+    // from SrgbGamutTable instead of analysing the gamut.
+    result->d_pointer->m_isSrgb = true;
 
     // Transform it into a valid object:
     cmsHPROFILE srgb = cmsCreate_sRGBProfile(); // Use build-in profile
-    result->d_pointer->initialize(srgb);
+    // No device link cache: The built-in profile is a fast matrix-shaper
+    // profile. A device link would only reduce precision.
+    result->d_pointer->initialize(srgb, QString());
     cmsCloseProfile(srgb);
 
     // Fine-tuning (and localization) of profile information for this
@@ -111,7 +128,9 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(con
     // Create an invalid object:
     QSharedPointer<PerceptualColor::RgbColorSpace> newObject {new RgbColorSpace()};
     // Try to transform it into a valid object:
-    const bool success = newObject->d_pointer->initialize(myProfileHandle);
+    const bool success = newObject->d_pointer->initialize( //
+        myProfileHandle,
+        RgbColorSpacePrivate::deviceLinkCacheFileName(fileName));
     // Clean up
     cmsCloseProfile(myProfileHandle);
     // We do not have to delete myIOHandler manually.
@@ -129,6 +148,9 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(con
  * Code that is shared between the various overloaded constructors.
  *
  * @param rgbProfileHandle Handle for the RGB profile
+ * @param cacheFileName The file name of the cached device link,
+ * or an empty string if no device link cache should be used. See
+ * @ref createLabToRgb16Transform() for details.
  *
  * @pre rgbProfileHandle is valid.
  *
@@ -136,13 +158,15 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpace::createFromFile(con
  * when it’s not an RGB profile but an CMYK profile). When <tt>false</tt>
  * is returned, the object is still in an undefined state; it cannot
  * be used, but only be destoyed. */
-bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandle)
+bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandle, const QString &cacheFileName)
 {
     m_cmsInfoDescription = getInformationFromProfile(rgbProfileHandle, cmsInfoDescription);
     m_cmsInfoCopyright = getInformationFromProfile(rgbProfileHandle, cmsInfoCopyright);
     m_cmsInfoManufacturer = getInformationFromProfile(rgbProfileHandle, cmsInfoManufacturer);
     m_cmsInfoModel = getInformationFromProfile(rgbProfileHandle, cmsInfoModel);
 
+    PERCEPTUALCOLOR_TRACE1(transform_create_start, static_cast<int>(!cacheFileName.isEmpty()));
+
     // Create an ICC v4 profile object for the Lab color space.
     cmsHPROFILE labProfileHandle = cmsCreateLab4Profile(
         // nullptr means: Default white point (D50)
@@ -166,15 +190,10 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
         INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
         cmsFLAGS_NOCACHE              // flags
     );
-    m_transformLabToRgb16Handle = cmsCreateTransform(
-        // Create a transform function and get a handle to this function:
-        labProfileHandle,             // input profile handle
-        TYPE_Lab_DBL,                 // input buffer format
-        rgbProfileHandle,             // output profile handle
-        TYPE_RGB_16,                  // output buffer format
-        INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
-        cmsFLAGS_NOCACHE              // flags
-    );
+    m_transformLabToRgb16Handle = createLabToRgb16Transform( //
+        labProfileHandle,
+        rgbProfileHandle,
+        cacheFileName);
     m_transformRgbToLabHandle = cmsCreateTransform(
         // Create a transform function and get a handle to this function:
         rgbProfileHandle,             // input profile handle
@@ -187,6 +206,8 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
     // It is mandatory to close the profiles to prevent memory leaks:
     cmsCloseProfile(labProfileHandle);
 
+    PERCEPTUALCOLOR_TRACE(transform_create_end);
+
     // After having closed the profiles, we can now return
     // (if appropriate) without having memory leaks:
     if ((m_transformLabToRgbHandle == nullptr)      //
@@ -204,39 +225,34 @@ bool RgbColorSpace::RgbColorSpacePrivate::initialize(cmsHPROFILE rgbProfileHandl
     // m_maximumChroma = LchValues::humanMaximumChroma;
     // m_maximumChroma = 350;
 
-    // Now we know for sure that lowerChroma is in-gamut and upperChroma is
-    // out-of-gamut…
-    LchDouble candidate;
-    candidate.l = 0;
-    candidate.c = 0;
-    candidate.h = 0;
-    while (!q_pointer->isInGamut(candidate) && (candidate.l < 100)) {
-        candidate.l += gamutPrecision;
-    }
-    m_blackpointL = candidate.l;
-    candidate.l = 100;
-    while (!q_pointer->isInGamut(candidate) && (candidate.l > 0)) {
-        candidate.l -= gamutPrecision;
-    }
-    m_whitepointL = candidate.l;
-    if (m_whitepointL <= m_blackpointL) {
+    // The gamut of the built-in sRGB profile has been analysed at build
+    // time.
+    if (m_isSrgb) {
+        m_blackpointL = SrgbGamutTable::blackpointL;
+        m_whitepointL = SrgbGamutTable::whitepointL;
+        return true;
+    }
+
+    // Search blackpoint and whitepoint on the gray axis by bisection,
+    // starting from an in-gamut gray. Usually the middle gray is in-gamut;
+    // otherwise, search with a coarse step.
+    qreal inGamutLightness = 50;
+    while (!q_pointer->isInGamut(LchDouble(inGamutLightness, 0, 0)) && (inGamutLightness < 100)) {
+        inGamutLightness += 1;
+    }
+    if (!q_pointer->isInGamut(LchDouble(inGamutLightness, 0, 0))) {
+        inGamutLightness = 50;
+        while (!q_pointer->isInGamut(LchDouble(inGamutLightness, 0, 0)) && (inGamutLightness > 0)) {
+            inGamutLightness -= 1;
+        }
+    }
+    m_blackpointL = grayAxisBoundary(inGamutLightness, 0, gamutPrecision);
+    m_whitepointL = grayAxisBoundary(inGamutLightness, 100, gamutPrecision);
+    if (!q_pointer->isInGamut(LchDouble(inGamutLightness, 0, 0)) || (m_whitepointL <= m_blackpointL)) {
         qCritical() << "Unable to find blackpoint and whitepoint on gray axis.";
         throw 0;
     }
 
-    // Dirty hacks:
-    QSharedPointer<PerceptualColor::RgbColorSpace> pointerToMainObject;
-    pointerToMainObject.reset(q_pointer);
-    // TODO Self-reference is always a bad idea…
-    m_nearestNeighborSearchImage = new ChromaLightnessImage(pointerToMainObject);
-    const QSize nearestNeighborImageSize = QSize(
-        // width:
-        qRound(nearestNeighborSearchImageHeight / 100.0 * LchValues::humanMaximumChroma) + 1,
-        // height:
-        nearestNeighborSearchImageHeight);
-    m_nearestNeighborSearchImage->setImageSize(nearestNeighborImageSize);
-    m_nearestNeighborSearchImage->setBackgroundColor(Qt::transparent);
-
     return true;
 }
 
@@ -248,6 +264,214 @@ RgbColorSpace::~RgbColorSpace() noexcept
     RgbColorSpacePrivate::deleteTransform(d_pointer->m_transformRgbToLabHandle);
 }
 
+/** @brief Creates the transform from Lab to 16-bit RGB.
+ *
+ * If a cache file name is given, the device link is loaded from this
+ * file if available. This avoids re-building the pipeline of the source
+ * profile. Otherwise, the transform is created from the profiles and then
+ * saved as device link to this file.
+ *
+ * The device link carries the profile ID of its source profile in its
+ * description (see @ref deviceLinkDescription()). A device link with
+ * another description is not used, but replaced. So a modified source
+ * profile never uses an outdated device link, even if it has kept
+ * its path, its size and its modification time.
+ *
+ * @warning Device links are cached only for this transform, which is
+ * bound to the gamut anyway. The floating point transforms
+ * (@ref m_transformLabToRgbHandle and @ref m_transformRgbToLabHandle) are
+ * always built from the profiles: The gamut detection relies on their
+ * unbound values outside the gamut, and the CLUT of a device link would
+ * clip these values. So for complex profiles, the cache saves only
+ * a part of the creation time.
+ *
+ * @param labProfileHandle Handle for the Lab profile
+ * @param rgbProfileHandle Handle for the RGB profile
+ * @param cacheFileName The file name of the cached device link, or an
+ * empty string if no device link cache should be used.
+ * @returns A handle to the new transform, or <tt>nullptr</tt> on
+ * failure. */
+cmsHTRANSFORM RgbColorSpace::RgbColorSpacePrivate::createLabToRgb16Transform(cmsHPROFILE labProfileHandle, cmsHPROFILE rgbProfileHandle, const QString &cacheFileName)
+{
+    // Try to load the device link from the cache
+    if (!cacheFileName.isEmpty()) {
+        cmsIOHANDLER *myIOHandler = IOHandlerFactory::createReadOnly(nullptr, cacheFileName);
+        cmsHPROFILE deviceLinkHandle = nullptr;
+        if (myIOHandler != nullptr) {
+            // If failing, cmsOpenProfileFromIOhandlerTHR deletes myIOHandler.
+            deviceLinkHandle = cmsOpenProfileFromIOhandlerTHR(nullptr, myIOHandler);
+        }
+        if (deviceLinkHandle != nullptr) {
+            cmsHTRANSFORM result = nullptr;
+            const bool isExpectedDeviceLink = //
+                (cmsGetDeviceClass(deviceLinkHandle) == cmsSigLinkClass) //
+                && (cmsGetColorSpace(deviceLinkHandle) == cmsSigLabData) //
+                && (cmsGetPCS(deviceLinkHandle) == cmsSigRgbData) //
+                && (readDeviceLinkDescription(deviceLinkHandle) == deviceLinkDescription(rgbProfileHandle));
+            if (isExpectedDeviceLink) {
+                result = cmsCreateTransform(
+                    // Create a transform function and get a handle to this function:
+                    deviceLinkHandle,                                // input profile handle
+                    TYPE_Lab_DBL,                                    // input buffer format
+                    nullptr,                                         // output profile handle
+                    TYPE_RGB_16,                                     // output buffer format
+                    cmsGetHeaderRenderingIntent(deviceLinkHandle), // rendering intent
+                    cmsFLAGS_NOCACHE                                 // flags
+                );
+            }
+            cmsCloseProfile(deviceLinkHandle);
+            if (result != nullptr) {
+                PERCEPTUALCOLOR_TRACE(device_link_cache_hit);
+                return result;
+            }
+        }
+    }
+
+    cmsHTRANSFORM result = cmsCreateTransform(
+        // Create a transform function and get a handle to this function:
+        labProfileHandle,             // input profile handle
+        TYPE_Lab_DBL,                 // input buffer format
+        rgbProfileHandle,             // output profile handle
+        TYPE_RGB_16,                  // output buffer format
+        INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
+        cmsFLAGS_NOCACHE              // flags
+    );
+
+    // Save the device link to the cache
+    if ((result != nullptr) && (!cacheFileName.isEmpty())) {
+        cmsHPROFILE deviceLinkHandle = cmsTransform2DeviceLink(result, 4.3, 0);
+        cmsMLU *description = cmsMLUalloc(nullptr, 1);
+        const bool descriptionSucceeded = //
+            (deviceLinkHandle != nullptr) //
+            && (description != nullptr) //
+            && cmsMLUsetASCII(description, "en", "US", deviceLinkDescription(rgbProfileHandle).constData()) //
+            && cmsWriteTag(deviceLinkHandle, cmsSigProfileDescriptionTag, description);
+        if (description != nullptr) {
+            cmsMLUfree(description);
+        }
+        if (descriptionSucceeded) {
+            QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+            cmsIOHANDLER *myIOHandler = IOHandlerFactory::createWriteOnly(nullptr, cacheFileName);
+            if (myIOHandler != nullptr) {
+                const bool saveSucceeded = (cmsSaveProfileToIOhandler(deviceLinkHandle, myIOHandler) > 0);
+                if (!saveSucceeded) {
+                    // Do not leave an incomplete device link in the cache.
+                    IOHandlerFactory::cancelWriting(myIOHandler);
+                }
+                // The file is only actually written when closing succeeds.
+                cmsCloseIOhandler(myIOHandler);
+            }
+        }
+        if (deviceLinkHandle != nullptr) {
+            cmsCloseProfile(deviceLinkHandle);
+        }
+    }
+
+    return result;
+}
+
+/** @brief The expected description of a cached device link.
+ *
+ * @param rgbProfileHandle Handle for the RGB source profile. If its header
+ * has no profile ID, the ID is calculated (and stored in the header of
+ * this handle).
+ * @returns A description that contains the profile ID of the source
+ * profile, which is the MD5 hash of its content. */
+QByteArray RgbColorSpace::RgbColorSpacePrivate::deviceLinkDescription(cmsHPROFILE rgbProfileHandle)
+{
+    cmsUInt8Number profileId[16];
+    cmsGetHeaderProfileID(rgbProfileHandle, profileId);
+    const auto isZero = [](cmsUInt8Number value) {
+        return value == 0;
+    };
+    if (std::all_of(std::begin(profileId), std::end(profileId), isZero)) {
+        // The profile ID is optional. Calculate it if missing.
+        cmsMD5computeID(rgbProfileHandle);
+        cmsGetHeaderProfileID(rgbProfileHandle, profileId);
+    }
+    return QByteArrayLiteral("PerceptualColor Lab to RGB device link for profile ID ") //
+        + QByteArray(reinterpret_cast<const char *>(profileId), sizeof(profileId)).toHex();
+}
+
+/** @brief The description of a device link.
+ *
+ * @param deviceLinkHandle Handle for the device link
+ * @returns The English description, or an empty byte array if the
+ * device link has no description. */
+QByteArray RgbColorSpace::RgbColorSpacePrivate::readDeviceLinkDescription(cmsHPROFILE deviceLinkHandle)
+{
+    const auto description = static_cast<const cmsMLU *>( //
+        cmsReadTag(deviceLinkHandle, cmsSigProfileDescriptionTag));
+    if (description == nullptr) {
+        return QByteArray();
+    }
+    const cmsUInt32Number bufferSize = cmsMLUgetASCII(description, "en", "US", nullptr, 0);
+    if (bufferSize <= 1) {
+        return QByteArray();
+    }
+    QByteArray result(static_cast<int>(bufferSize), '\0');
+    cmsMLUgetASCII(description, "en", "US", result.data(), bufferSize);
+    // Remove the terminating null character
+    result.chop(1);
+    return result;
+}
+
+/** @brief The storage for the device link cache directory.
+ *
+ * @returns A reference to the storage.
+ *
+ * @pre The caller holds @ref deviceLinkCacheMutex().
+ *
+ * @sa @ref RgbColorSpace::setDeviceLinkCacheDirectory() */
+QString &RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheDirectoryStorage()
+{
+    // Thread-safe initialization of static local variables
+    // is guaranteed since C++11.
+    static QString result;
+    return result;
+}
+
+/** @brief The mutex that guards @ref deviceLinkCacheDirectoryStorage().
+ *
+ * @returns The mutex that guards @ref deviceLinkCacheDirectoryStorage(). */
+QMutex &RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheMutex()
+{
+    static QMutex result;
+    return result;
+}
+
+/** @brief The file name of the cached device link for a given profile.
+ *
+ * The file name contains a hash of the absolute path of the source
+ * profile, and the version of LittleCMS. So each source profile has
+ * at most one device link in the cache, and an updated LittleCMS never
+ * uses an outdated device link. Whether the device link belongs to
+ * the current content of the source profile is verified when loading
+ * it; see @ref createLabToRgb16Transform().
+ *
+ * @param profileFileName The file name of the RGB profile
+ * @returns The absolute file name of the device link, or an empty
+ * string if the device link cache is disabled or if the source profile
+ * does not exist. */
+QString RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheFileName(const QString &profileFileName)
+{
+    const QString directory = RgbColorSpace::deviceLinkCacheDirectory();
+    if (directory.isEmpty()) {
+        return QString();
+    }
+    const QFileInfo profileInfo(profileFileName);
+    if (!profileInfo.exists()) {
+        return QString();
+    }
+    const QByteArray hash = QCryptographicHash::hash( //
+        profileInfo.absoluteFilePath().toUtf8(),
+        QCryptographicHash::Md5);
+    return QDir(directory).absoluteFilePath( //
+        QStringLiteral("%1-lcms%2-labtorgb16.icc")
+            .arg(QString::fromLatin1(hash.toHex()))
+            .arg(cmsGetEncodedCMMversion()));
+}
+
 /** @brief Constructor
  *
  * @param backLink Pointer to the object from which <em>this</em> object
@@ -330,6 +554,79 @@ PerceptualColor::LchDouble RgbColorSpace::toLch(const QColor &rgbColor) const
     return result;
 }
 
+/** @brief Searches the gamut boundary on the gray axis.
+ *
+ * The search is done by bisection.
+ *
+ * @pre The gray with <em>inGamutLightness</em> is in-gamut.
+ *
+ * @param inGamutLightness Lightness of an in-gamut gray
+ * @param outOfGamutLightness Lightness of a gray which is (likely)
+ * out-of-gamut. The boundary is searched between both lightness values.
+ * @param precision The precision of the search
+ * @returns The in-gamut lightness that is nearest to the boundary, with
+ * the given precision. If <em>outOfGamutLightness</em> is in-gamut
+ * itself, it is returned.
+ *
+ * @sa @ref GamutBisection::grayAxisBoundary() */
+qreal RgbColorSpace::RgbColorSpacePrivate::grayAxisBoundary(qreal inGamutLightness, qreal outOfGamutLightness, qreal precision) const
+{
+    const auto isInGamut = [this](const qreal lightness) {
+        return q_pointer->isInGamut(LchDouble(lightness, 0, 0));
+    };
+    return GamutBisection::grayAxisBoundary(isInGamut, inGamutLightness, outOfGamutLightness, precision);
+}
+
+/** @brief Calculates the CIELab values of many RGB colors at once.
+ *
+ * The colors are passed to LittleCMS in a single call, which avoids the
+ * per-call overhead of the transform. No memory is allocated, and the
+ * function is thread-safe, so large images can be converted in parallel
+ * by splitting them into tiles.
+ *
+ * @param rgb Pointer to the RGB values, each channel within <tt>[0, 1]</tt>
+ * @param lab Pointer to the buffer that receives the CIELab values. Must
+ * have space for <em>count</em> values.
+ * @param count Number of colors */
+void RgbColorSpace::toCielab(const RgbDouble *rgb, cmsCIELab *lab, int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    cmsDoTransform(d_pointer->m_transformRgbToLabHandle, // handle to transform function
+                   rgb,                                  // input
+                   lab,                                  // output
+                   static_cast<cmsUInt32Number>(count));
+}
+
+/** @brief Calculates the LCh values of many RGB colors at once.
+ *
+ * Equivalent to calling @ref toLch(const QColor &rgbColor) const for each
+ * color, but the colors are passed to LittleCMS in blocks, which avoids
+ * the per-call overhead of the transform. No memory is allocated.
+ *
+ * @param rgb Pointer to the RGB values, each channel within <tt>[0, 1]</tt>
+ * @param lch Pointer to the buffer that receives the LCh values. Must have
+ * space for <em>count</em> values.
+ * @param count Number of colors
+ *
+ * @note The same considerations about rounding errors as for
+ * @ref toLch(const QColor &rgbColor) const apply. */
+void RgbColorSpace::toLch(const RgbDouble *rgb, PerceptualColor::LchDouble *lch, int count) const
+{
+    constexpr int blockSize = 256;
+    cmsCIELab lab[blockSize];
+    for (int start = 0; start < count; start += blockSize) {
+        const int blockCount = qMin(blockSize, count - start);
+        toCielab(rgb + start, lab, blockCount);
+        for (int i = 0; i < blockCount; ++i) {
+            cmsCIELCh temp;
+            cmsLab2LCh(&temp, &lab[i]);
+            lch[start + i] = toLchDouble(temp);
+        }
+    }
+}
+
 /** @brief Calculates the Lab value
  *
  * @param rgb the color that will be converted.
@@ -392,6 +689,36 @@ QColor RgbColorSpace::toQColorRgbUnbound(const LchDouble &lch) const
     return toQColorRgbUnbound(temp);
 }
 
+/** @brief Calculates the RGB values of many Lab colors at once.
+ *
+ * Equivalent to calling @ref toQColorRgbUnbound(const cmsCIELab &Lab) const
+ * for each color, but all colors are passed to LittleCMS with a single
+ * call, which avoids the per-call overhead of the transform.
+ *
+ * @param lab Pointer to the Lab values
+ * @param rgb Pointer to the buffer that receives the RGB values, each
+ * channel within <tt>[0, 1]</tt> for in-gamut colors. Must have space for
+ * <em>count</em> values. The values of out-of-gamut colors are undefined.
+ * @param inGamut Pointer to the buffer that receives if the colors are
+ * within the gamut. Must have space for <em>count</em> values.
+ * @param count Number of colors */
+void RgbColorSpace::toRgbUnbound(const cmsCIELab *lab, RgbDouble *rgb, bool *inGamut, int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+    cmsDoTransform(d_pointer->m_transformLabToRgbHandle, // handle to transform function
+                   lab, // input
+                   rgb, // output
+                   static_cast<cmsUInt32Number>(count) // number of values
+    );
+    for (int i = 0; i < count; ++i) {
+        inGamut[i] = isInRange<cmsFloat64Number>(0, rgb[i].red, 1) //
+            && isInRange<cmsFloat64Number>(0, rgb[i].green, 1) //
+            && isInRange<cmsFloat64Number>(0, rgb[i].blue, 1);
+    }
+}
+
 RgbDouble RgbColorSpace::RgbColorSpacePrivate::colorRgbBoundSimple(const cmsCIELab &Lab) const
 {
     cmsUInt16Number rgb_int[3];
@@ -481,6 +808,11 @@ bool RgbColorSpace::isInGamut(const LchDouble &lch) const
  * false otherwise. */
 bool RgbColorSpace::isInGamut(const cmsCIELab &lab) const
 {
+    // NaN and infinity are never in-gamut. Do not pass them to LittleCMS.
+    if (!qIsFinite(lab.L) || !qIsFinite(lab.a) || !qIsFinite(lab.b)) {
+        return false;
+    }
+
     RgbDouble rgb;
 
     cmsDoTransform(
@@ -494,6 +826,114 @@ bool RgbColorSpace::isInGamut(const cmsCIELab &lab) const
     return (isInRange<cmsFloat64Number>(0, rgb.red, 1) && isInRange<cmsFloat64Number>(0, rgb.green, 1) && isInRange<cmsFloat64Number>(0, rgb.blue, 1));
 }
 
+/** @brief Frees the memory of the caches.
+ *
+ * Removes the gamut boundaries and the rendered diagram images that are
+ * cached within this object. This does not change any result; later calls
+ * simply calculate the data again. Useful under memory pressure, and to
+ * measure the latency of the uncached code paths.
+ *
+ * This function is thread-safe.
+ *
+ * @sa @ref chromaHueBoundary()
+ * @sa @ref chromaLightnessBoundary()
+ * @sa @ref diagramImageCache() */
+void RgbColorSpace::clearCaches()
+{
+    d_pointer->m_chromaHueBoundaryCache.clear();
+    d_pointer->m_chromaLightnessBoundaryCache.clear();
+    d_pointer->m_diagramImageCache.clear();
+}
+
+/** @brief The cache of rendered diagram images.
+ *
+ * Shared by all image generators that use this color space, so that the
+ * same diagram at various sizes (and in various widgets) is rendered
+ * only once where possible.
+ *
+ * @returns The cache. It lives as long as this object. */
+DiagramImageCache *RgbColorSpace::diagramImageCache() const
+{
+    return &d_pointer->m_diagramImageCache;
+}
+
+/** @brief Transform from Lab to a display profile.
+ *
+ * The image generators use this to convert the in-gamut colors of this
+ * color space directly to the RGB values of the monitor. The transform is
+ * created on first use and then cached within this object. The cache
+ * holds only the transforms of the most recently created few profiles;
+ * older ones are removed from the cache (but stay valid as long as
+ * somebody holds a reference to them).
+ *
+ * This function is thread-safe.
+ *
+ * @param displayProfile The raw data of the ICC profile of the display.
+ * @returns The transform, or <tt>nullptr</tt> if the profile is empty or
+ * not a valid RGB profile. */
+QSharedPointer<DisplayTransform> RgbColorSpace::displayTransform(const QByteArray &displayProfile) const
+{
+    if (displayProfile.isEmpty()) {
+        return nullptr;
+    }
+    QSharedPointer<DisplayTransform> result;
+    if (d_pointer->m_displayTransforms.find(displayProfile, &result)) {
+        return result;
+    }
+    // Also invalid profiles are cached (as nullptr), so that they are
+    // not parsed again and again.
+    result = DisplayTransform::create(displayProfile);
+    d_pointer->m_displayTransforms.insert(displayProfile, result);
+    return result;
+}
+
+/** @brief Getter for the device link cache directory.
+ *
+ * @returns The device link cache directory, or an empty string if the
+ * device link cache is disabled.
+ *
+ * @sa @ref setDeviceLinkCacheDirectory() */
+QString RgbColorSpace::deviceLinkCacheDirectory()
+{
+    QMutexLocker locker(&RgbColorSpacePrivate::deviceLinkCacheMutex());
+    return RgbColorSpacePrivate::deviceLinkCacheDirectoryStorage();
+}
+
+/** @brief Setter for the device link cache directory.
+ *
+ * Creating a color space from an ICC file builds the color transforms,
+ * which can be expensive for complex profiles. If a cache directory is
+ * set, the optimized transform to 16-bit RGB is saved as device link
+ * profile into this directory, and later calls of @ref createFromFile()
+ * (also in later runs of the application) load the device link instead.
+ * The floating point transforms, which are used for the gamut detection,
+ * are not cached, because a device link would clip their values.
+ *
+ * This affects only color space objects that are created after
+ * calling this function.
+ *
+ * @param directory The cache directory. It is created if necessary.
+ * An empty string disables the device link cache. This is the
+ * default value. */
+void RgbColorSpace::setDeviceLinkCacheDirectory(const QString &directory)
+{
+    QMutexLocker locker(&RgbColorSpacePrivate::deviceLinkCacheMutex());
+    RgbColorSpacePrivate::deviceLinkCacheDirectoryStorage() = directory;
+}
+
+/** @brief If this object uses the build-in sRGB profile.
+ *
+ * @returns <tt>true</tt> if this object has been created by
+ * @ref createSrgb(). <tt>false</tt> otherwise (also if it has been created
+ * from an ICC file that happens to contain an sRGB profile).
+ *
+ * If <tt>true</tt>, closed-form sRGB conversions like those of @ref OkLab
+ * can be used instead of the LittleCMS transforms. */
+bool RgbColorSpace::isSrgb() const
+{
+    return d_pointer->m_isSrgb;
+}
+
 QString RgbColorSpace::profileInfoCopyright() const
 {
     return d_pointer->m_cmsInfoCopyright;
@@ -531,10 +971,37 @@ QString RgbColorSpace::profileInfoModel() const
  *
  * @todo This function should never change anything than chroma. If it fails,
  * it should throw an exception.
+ *
+ * The search is done with the full precision @ref gamutPrecision. This
+ * is the right choice for final, committed values and for numeric input.
+ *
+ * @sa @ref nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color, qreal precision) const
  */
 PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color) const
 {
-    LchDouble result = color;
+    return nearestInGamutColorByAdjustingChroma(color, gamutPrecision);
+}
+
+/** @returns A <em>normalized</em> (this is guaranteed!) in-gamut color,
+ * maybe with different chroma (and even lightness??)
+ *
+ * @param color The original color
+ * @param precision The precision of the chroma search. The bisection
+ * stops as soon as the remaining interval is not bigger than this value.
+ * During user interaction, a diagram can pass a tolerance that
+ * corresponds to its physical pixel size: Higher precision would not be
+ * visible anyway, but costs additional transforms. Values smaller than
+ * @ref gamutPrecision are treated as @ref gamutPrecision.
+ *
+ * This function is thread-safe.
+ *
+ * @sa @ref nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color) const
+ */
+PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color, qreal precision) const
+{
+    PERCEPTUALCOLOR_TRACE_SCOPE1(nearest_in_gamut_chroma, 1);
+    const qreal effectivePrecision = qMax(precision, gamutPrecision);
+    LchDouble result = RgbColorSpacePrivate::sanitized(color);
     PolarPointF temp(result.c, result.h);
     result.c = temp.radial();
     result.h = temp.angleDegree();
@@ -545,250 +1012,631 @@ PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChroma(c
     }
 
     // Now we know: We are out-of-gamut…
-    LchDouble lowerChroma {result.l, 0, result.h};
-    LchDouble upperChroma {result};
-    LchDouble candidate;
-    if (isInGamut(lowerChroma)) {
-        // Now we know for sure that lowerChroma is in-gamut
-        // and upperChroma is out-of-gamut…
-        candidate = upperChroma;
-        while (upperChroma.c - lowerChroma.c > gamutPrecision) {
-            // Our test candidate is half the way between lowerChroma
-            // and upperChroma:
-            candidate.c = ((lowerChroma.c + upperChroma.c) / 2);
-            if (isInGamut(candidate)) {
-                lowerChroma = candidate;
-            } else {
-                upperChroma = candidate;
-            }
-        }
-        result = lowerChroma;
+    if (isInGamut(LchDouble(result.l, 0, result.h))) {
+        // Now we know for sure that the gray is in-gamut
+        // and the color is out-of-gamut…
+        const auto isInGamutBlock = [this](const LchDouble *lch, bool *inGamut, int count) {
+            d_pointer->isInGamutBlock(lch, inGamut, count);
+        };
+        GamutBisection::maximumChroma(isInGamutBlock, &result, 1, effectivePrecision);
     } else {
-        if (result.l < d_pointer->m_blackpointL) {
-            result.l = d_pointer->m_blackpointL;
-            result.c = 0;
+        result = d_pointer->nearestGray(result);
+    }
+
+    return result;
+}
+
+/** @brief Makes a color safe for the gamut searches.
+ *
+ * The bisections of the gamut searches need a number of steps that grows
+ * with the logarithm of the chroma, so an infinite chroma would never
+ * terminate. And NaN or infinite values would be passed to LittleCMS.
+ *
+ * @param color The color
+ * @returns The color with all values finite: NaN becomes <tt>0</tt>.
+ * Lightness and chroma are clamped to
+ * [−@ref searchLimit, @ref searchLimit]. Infinite hues become
+ * <tt>0</tt>. Finite values within the limits are not changed. */
+LchDouble RgbColorSpace::RgbColorSpacePrivate::sanitized(const LchDouble &color)
+{
+    LchDouble result = color;
+    result.l = qIsNaN(result.l) ? 0 : qBound(-searchLimit, result.l, searchLimit);
+    result.c = qIsNaN(result.c) ? 0 : qBound(-searchLimit, result.c, searchLimit);
+    result.h = qIsFinite(result.h) ? result.h : 0;
+    return result;
+}
+
+/** @brief The nearest in-gamut gray for colors whose gray is out-of-gamut.
+ *
+ * @param color A color with a lightness outside the range from
+ * @ref m_blackpointL to @ref m_whitepointL.
+ * @returns The blackpoint or the whitepoint (with the hue of
+ * <em>color</em>). For other lightness values, <em>color</em> is returned
+ * unchanged. */
+LchDouble RgbColorSpace::RgbColorSpacePrivate::nearestGray(const LchDouble &color) const
+{
+    LchDouble result = color;
+    if (result.l < m_blackpointL) {
+        result.l = m_blackpointL;
+        result.c = 0;
+    } else if (result.l > m_whitepointL) {
+        result.l = m_whitepointL;
+        result.c = 0;
+    }
+    return result;
+}
+
+/** @brief Tests many colors at once if they are in-gamut.
+ *
+ * @param lch Pointer to the colors
+ * @param inGamut Pointer to the buffer for the results
+ * @param count Number of colors. Must not be bigger than
+ * @ref batchBlockSize. */
+void RgbColorSpace::RgbColorSpacePrivate::isInGamutBlock(const LchDouble *lch, bool *inGamut, int count) const
+{
+    cmsCIELab lab[batchBlockSize];
+    RgbDouble rgb[batchBlockSize];
+    for (int i = 0; i < count; ++i) {
+        const cmsCIELCh cmsLch = toCmsCieLch(lch[i]);
+        cmsLCh2Lab(&lab[i], &cmsLch);
+    }
+    cmsDoTransform(m_transformLabToRgbHandle, // handle to transform function
+                   lab, // input
+                   rgb, // output
+                   static_cast<cmsUInt32Number>(count) // number of values
+    );
+    for (int i = 0; i < count; ++i) {
+        inGamut[i] = isInRange<cmsFloat64Number>(0, rgb[i].red, 1) //
+            && isInRange<cmsFloat64Number>(0, rgb[i].green, 1) //
+            && isInRange<cmsFloat64Number>(0, rgb[i].blue, 1);
+    }
+}
+
+/** @brief Batch version of
+ * @ref RgbColorSpace::nearestInGamutColorByAdjustingChroma() for a single
+ * block.
+ *
+ * All bisections advance in lockstep: Each iteration does one single
+ * transform for all colors of the block that are not yet resolved. The
+ * results are identical to the scalar function.
+ *
+ * @param colors Pointer to the original colors
+ * @param results Pointer to the buffer for the results. May be identical
+ * to <em>colors</em>.
+ * @param count Number of colors. Must not be bigger than
+ * @ref batchBlockSize.
+ * @param precision The precision of the search. Must not be smaller than
+ * @ref gamutPrecision. */
+void RgbColorSpace::RgbColorSpacePrivate::nearestInGamutColorByAdjustingChromaBlock(const LchDouble *colors, LchDouble *results, int count, qreal precision) const
+{
+    static_assert(batchBlockSize <= GamutBisection::blockSize);
+    LchDouble normalized[batchBlockSize];
+    LchDouble candidates[batchBlockSize];
+    bool inGamut[batchBlockSize];
+    // Indices of the colors that are not resolved yet
+    int pending[batchBlockSize];
+    int pendingCount = 0;
+
+    for (int i = 0; i < count; ++i) {
+        normalized[i] = sanitized(colors[i]);
+        const PolarPointF temp(normalized[i].c, normalized[i].h);
+        normalized[i].c = temp.radial();
+        normalized[i].h = temp.angleDegree();
+    }
+
+    // Colors that are yet in-gamut are not changed.
+    isInGamutBlock(normalized, inGamut, count);
+    for (int i = 0; i < count; ++i) {
+        if (inGamut[i]) {
+            results[i] = normalized[i];
         } else {
-            if (result.l > d_pointer->m_whitepointL) {
-                result.l = d_pointer->m_blackpointL;
-                result.c = 0;
-            }
+            pending[pendingCount] = i;
+            ++pendingCount;
+        }
+    }
+
+    // For out-of-gamut colors, the bisection needs an in-gamut gray.
+    for (int j = 0; j < pendingCount; ++j) {
+        candidates[j] = normalized[pending[j]];
+        candidates[j].c = 0;
+    }
+    isInGamutBlock(candidates, inGamut, pendingCount);
+    int newPendingCount = 0;
+    for (int j = 0; j < pendingCount; ++j) {
+        const int i = pending[j];
+        if (inGamut[j]) {
+            candidates[newPendingCount] = normalized[i];
+            pending[newPendingCount] = i;
+            ++newPendingCount;
+        } else {
+            results[i] = nearestGray(normalized[i]);
+        }
+    }
+    pendingCount = newPendingCount;
+
+    // Bisection in lockstep
+    const auto isInGamutBlockFunction = [this](const LchDouble *lch, bool *inGamut, int count) {
+        isInGamutBlock(lch, inGamut, count);
+    };
+    GamutBisection::maximumChroma(isInGamutBlockFunction, candidates, pendingCount, precision);
+    for (int j = 0; j < pendingCount; ++j) {
+        results[pending[j]] = candidates[j];
+    }
+}
+
+/** @brief Batch version of
+ * @ref nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color) const
+ *
+ * @param colors Pointer to the original colors
+ * @param results Pointer to the buffer for the results. Must have space
+ * for <em>count</em> values. May be identical to <em>colors</em>.
+ * @param count Number of colors
+ *
+ * The results are identical to calling the scalar function for each
+ * color, but it is much faster for many colors: All bisections of a
+ * block advance in lockstep, so each iteration is a single transform
+ * for all unresolved colors. Big inputs are processed by multiple
+ * threads.
+ *
+ * This function is thread-safe. */
+void RgbColorSpace::nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count) const
+{
+    nearestInGamutColorByAdjustingChroma(colors, results, count, gamutPrecision);
+}
+
+/** @brief Batch version of
+ * @ref nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color, qreal precision) const
+ *
+ * @param colors Pointer to the original colors
+ * @param results Pointer to the buffer for the results. Must have space
+ * for <em>count</em> values. May be identical to <em>colors</em>.
+ * @param count Number of colors
+ * @param precision The precision of the chroma search. Values smaller than
+ * @ref gamutPrecision are treated as @ref gamutPrecision.
+ *
+ * This function is thread-safe.
+ *
+ * @sa @ref nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count) const */
+void RgbColorSpace::nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count, qreal precision) const
+{
+    PERCEPTUALCOLOR_TRACE_SCOPE1(nearest_in_gamut_chroma, count);
+    const int blockSize = RgbColorSpacePrivate::batchBlockSize;
+    const qreal effectivePrecision = qMax(precision, gamutPrecision);
+    if (count < RgbColorSpacePrivate::batchParallelThreshold) {
+        for (int start = 0; start < count; start += blockSize) {
+            d_pointer->nearestInGamutColorByAdjustingChromaBlock( //
+                colors + start,
+                results + start,
+                qMin(blockSize, count - start),
+                effectivePrecision);
         }
+        return;
     }
+    QVector<int> blockStarts;
+    for (int start = 0; start < count; start += blockSize) {
+        blockStarts.append(start);
+    }
+    QtConcurrent::blockingMap(blockStarts, [this, colors, results, count, blockSize, effectivePrecision](const int start) {
+        d_pointer->nearestInGamutColorByAdjustingChromaBlock( //
+            colors + start,
+            results + start,
+            qMin(blockSize, count - start),
+            effectivePrecision);
+    });
+}
 
+/** @brief The nearest in-gamut color, changing chroma and lightness.
+ *
+ * @param color The original color
+ * @returns The original color if it is in-gamut (negative chroma is put
+ * to <tt>0</tt>). Otherwise, the nearest point on the gamut boundary of
+ * the chroma-lightness plane of this hue. The hue is not changed.
+ *
+ * The gamut boundary comes from @ref chromaLightnessBoundary(), which is
+ * cached per hue and shared with the rendering of
+ * @ref ChromaLightnessImage.
+ *
+ * This function is thread-safe. */
+PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color) const
+{
+    LchDouble result;
+    nearestInGamutColorByAdjustingChromaLightness(&color, &result, 1);
     return result;
 }
 
-PerceptualColor::LchDouble RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color)
+/** @brief Batch version of
+ * @ref nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color)
+ *
+ * @param colors Pointer to the original colors
+ * @param results Pointer to the buffer for the results. Must have space
+ * for <em>count</em> values. May be identical to <em>colors</em>.
+ * @param count Number of colors
+ *
+ * For each distinct hue, the gamut boundary is taken from
+ * @ref chromaLightnessBoundary(), and the nearest in-gamut point is
+ * searched on this boundary. Different hues are processed by multiple
+ * threads.
+ *
+ * This function is thread-safe. */
+void RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count) const
 {
-    // TODO Would be great if this function could be const
+    PERCEPTUALCOLOR_TRACE_SCOPE1(nearest_in_gamut_chroma_lightness, count);
+    // Group the colors by hue, so that each gamut boundary is
+    // calculated only once.
+    QHash<double, QVector<int>> indicesByHue;
+    for (int i = 0; i < count; ++i) {
+        indicesByHue[RgbColorSpacePrivate::sanitized(colors[i]).h].append(i);
+    }
+    QVector<QVector<int>> groups = indicesByHue.values().toVector();
+    if (count < RgbColorSpacePrivate::batchParallelThreshold) {
+        for (const QVector<int> &indices : groups) {
+            d_pointer->nearestInGamutColorByAdjustingChromaLightnessForHue(colors, indices, results);
+        }
+        return;
+    }
+    QtConcurrent::blockingMap(groups, [this, colors, results](const QVector<int> &indices) {
+        d_pointer->nearestInGamutColorByAdjustingChromaLightnessForHue(colors, indices, results);
+    });
+}
 
-    // Initialization
-    LchDouble temp = color;
-    if (temp.c < 0) {
-        temp.c = 0;
+/** @brief Helper for the batch version of
+ * @ref RgbColorSpace::nearestInGamutColorByAdjustingChromaLightness()
+ *
+ * @param colors Pointer to all original colors
+ * @param indices The indices of the colors to process. All these colors
+ * must have the same hue.
+ * @param results Pointer to the buffer for all results */
+void RgbColorSpace::RgbColorSpacePrivate::nearestInGamutColorByAdjustingChromaLightnessForHue(const LchDouble *colors, const QVector<int> &indices, LchDouble *results) const
+{
+    if (indices.isEmpty()) {
+        return;
+    }
+    const qreal hue = sanitized(colors[indices.first()]).h;
+    const QSharedPointer<const ChromaLightnessBoundary> boundary = //
+        q_pointer->chromaLightnessBoundary(hue);
+    // If the boundary cannot be trusted, search on a grid of exactly
+    // tested points instead.
+    QVector<LchDouble> gridPoints;
+    if (!boundary->hasContiguousRows) {
+        gridPoints = inGamutGridPoints(hue);
     }
 
-    if (isInGamut(temp)) {
-        return temp;
+    // Colors that are yet in-gamut are not changed.
+    LchDouble temp[batchBlockSize];
+    bool inGamut[batchBlockSize];
+    for (int start = 0; start < indices.count(); start += batchBlockSize) {
+        const int blockCount = qMin(batchBlockSize, indices.count() - start);
+        for (int j = 0; j < blockCount; ++j) {
+            temp[j] = sanitized(colors[indices.at(start + j)]);
+            if (temp[j].c < 0) {
+                temp[j].c = 0;
+            }
+        }
+        isInGamutBlock(temp, inGamut, blockCount);
+        for (int j = 0; j < blockCount; ++j) {
+            LchDouble result = temp[j];
+            if (!inGamut[j]) {
+                // Search the nearest point on the boundary. Within each
+                // row, the in-gamut range is [0, boundary chroma].
+                // Fallback if no row has an in-gamut range: White.
+                result.l = 100;
+                result.c = 0;
+                qreal bestDistanceSquare = std::numeric_limits<qreal>::max();
+                for (const LchDouble &point : qAsConst(gridPoints)) {
+                    const qreal distanceSquare = qPow(point.c - temp[j].c, 2) + qPow(point.l - temp[j].l, 2);
+                    if (distanceSquare < bestDistanceSquare) {
+                        bestDistanceSquare = distanceSquare;
+                        result.l = point.l;
+                        result.c = point.c;
+                    }
+                }
+                for (int y = 0; boundary->hasContiguousRows && (y < ChromaLightnessBoundary::rowCount); ++y) {
+                    const qreal maximumChroma = boundary->maximumChroma.at(y);
+                    if (maximumChroma < 0) {
+                        continue;
+                    }
+                    const qreal lightness = ChromaLightnessBoundary::rowLightness(y);
+                    const qreal chroma = qMin(temp[j].c, maximumChroma);
+                    const qreal distanceSquare = qPow(chroma - temp[j].c, 2) + qPow(lightness - temp[j].l, 2);
+                    if (distanceSquare < bestDistanceSquare) {
+                        bestDistanceSquare = distanceSquare;
+                        result.l = lightness;
+                        result.c = chroma;
+                    }
+                }
+            }
+            results[indices.at(start + j)] = result;
+        }
     }
+}
 
-    QPoint myPixelPosition( //
-        qRound(temp.c * (d_pointer->nearestNeighborSearchImageHeight - 1) / 100.0),
-        qRound(d_pointer->nearestNeighborSearchImageHeight - 1 - temp.l * (d_pointer->nearestNeighborSearchImageHeight - 1) / 100.0));
-    d_pointer->m_nearestNeighborSearchImage->setHue(temp.h);
-    myPixelPosition = d_pointer->nearestNeighborSearch( //
-        myPixelPosition,
-        d_pointer->m_nearestNeighborSearchImage->getImage());
-    LchDouble result = temp;
-    result.c = myPixelPosition.x() * 100.0 / (d_pointer->nearestNeighborSearchImageHeight - 1);
-    result.l = 100 - myPixelPosition.y() * 100.0 / (d_pointer->nearestNeighborSearchImageHeight - 1);
+/** @brief The gamut boundary within the chroma-lightness plane of a hue.
+ *
+ * The result is cached for a limited number of hues. Both the
+ * nearest-in-gamut search (@ref nearestInGamutColorByAdjustingChromaLightness())
+ * and the rendering of @ref ChromaLightnessImage use it, so that they
+ * share a single evaluation for each hue. For the built-in sRGB profile,
+ * hues that are contained in @ref SrgbGamutTable need no evaluation at
+ * all.
+ *
+ * This function is thread-safe.
+ *
+ * @param hue The hue
+ * @returns The gamut boundary for this hue */
+QSharedPointer<const ChromaLightnessBoundary> RgbColorSpace::chromaLightnessBoundary(qreal hue) const
+{
+    const qreal normalizedHue = PolarPointF::normalizedAngleDegree(hue);
+    QSharedPointer<const ChromaLightnessBoundary> result;
+    if (d_pointer->m_chromaLightnessBoundaryCache.find(normalizedHue, &result)) {
+        return result;
+    }
+    // Two threads might calculate the same hue concurrently; this is
+    // harmless. For the built-in sRGB profile, many hues are
+    // available from the table that has been generated at build time.
+    // Other hues need the exact boundary, because the nearest-in-gamut
+    // search relies on it; the interpolated values of the table are
+    // only estimates.
+    if (d_pointer->m_isSrgb && SrgbGamutTable::containsHue(normalizedHue)) {
+        result = SrgbGamutTable::chromaLightnessBoundary(normalizedHue);
+    } else {
+        result = d_pointer->calculateChromaLightnessBoundary(normalizedHue);
+    }
+    // If another thread has been faster, use its result, so that all
+    // callers share the same object.
+    const bool isInserted = d_pointer->m_chromaLightnessBoundaryCache.insertIf( //
+        normalizedHue,
+        result,
+        1,
+        [](const QSharedPointer<const ChromaLightnessBoundary> &) {
+            return false;
+        });
+    if (!isInserted) {
+        return d_pointer->m_chromaLightnessBoundaryCache.value(normalizedHue, result);
+    }
     return result;
 }
 
-/** @brief Search the nearest non-transparent neighbor pixel
- *
- * This implements a
- * <a href="https://en.wikipedia.org/wiki/Nearest_neighbor_search">
- * Nearest-neighbor-search</a>.
- *
- * @note This code is an inefficient implementation. See
- * <a href="https://stackoverflow.com/questions/307445/finding-closest-non-black-pixel-in-an-image-fast">here</a>
- * for a better approach.
- *
- * @param originalPoint The point for which you search the nearest neighbor,
- * expressed in the coordinate system of the image. This point may be within
- * or outside the image.
- * @param image The image in which the nearest neighbor is searched.
- * Must contain at least one pixel with an alpha value that is fully opaque.
- * @returns
- * \li If originalPoint itself is within the image and a
- *     non-transparent pixel, it returns originalPoint.
- * \li Else, if there is are non-transparent pixels in the image, the nearest
- *     non-transparent pixel is returned. (If there are various nearest
- *     neighbors at the same distance, it is undefined which one is returned.)
- * \li Else there are no non-transparent pixels, and simply the point
- *     <tt>0, 0</tt> is returned, but this is a very slow case.
- *
- * TODO Do not use nearest neighbor or other pixel based search algorithms,
- * but work directly with LittleCMS, maybe with a limited, but well-defined,
- * precision… */
-QPoint RgbColorSpace::RgbColorSpacePrivate::nearestNeighborSearch(const QPoint originalPoint, const QImage &image)
-{
-    // Test for special case:
-    // originalPoint itself is within the image and non-transparent
-    if (image.valid(originalPoint)) {
-        if (image.pixelColor(originalPoint).alpha() == 255) {
-            return originalPoint;
+/** @brief The gamut boundary within the chroma-lightness plane of a hue,
+ * but only if it is available without calculation.
+ *
+ * Like @ref chromaLightnessBoundary(), but never calculates the
+ * boundary. This is for callers that use the boundary only as an
+ * optimization, and for which a calculation would cost more than
+ * it saves.
+ *
+ * @warning For the built-in sRGB profile, the result might be
+ * interpolated between the hues of @ref SrgbGamutTable. Therefore, use
+ * it only through @ref ChromaLightnessBoundary::maximumChromaEstimate().
+ *
+ * This function is thread-safe.
+ *
+ * @param hue The hue
+ * @returns The gamut boundary for this hue if it is in the cache. For
+ * the built-in sRGB profile, the estimate from @ref SrgbGamutTable
+ * otherwise. A null pointer if neither is available. */
+QSharedPointer<const ChromaLightnessBoundary> RgbColorSpace::cachedChromaLightnessBoundary(qreal hue) const
+{
+    const qreal normalizedHue = PolarPointF::normalizedAngleDegree(hue);
+    QSharedPointer<const ChromaLightnessBoundary> result;
+    if (d_pointer->m_chromaLightnessBoundaryCache.find(normalizedHue, &result)) {
+        return result;
+    }
+    if (d_pointer->m_isSrgb) {
+        return SrgbGamutTable::chromaLightnessBoundary(normalizedHue);
+    }
+    return QSharedPointer<const ChromaLightnessBoundary>();
+}
+
+/** @brief Calculates the gamut boundary within a chroma-lightness plane.
+ *
+ * All rows are calculated together with the lockstep bisection of
+ * @ref nearestInGamutColorByAdjustingChromaBlock().
+ *
+ * @param hue The normalized hue
+ * @returns The gamut boundary for this hue */
+QSharedPointer<const ChromaLightnessBoundary> RgbColorSpace::RgbColorSpacePrivate::calculateChromaLightnessBoundary(qreal hue) const
+{
+    constexpr int rowCount = ChromaLightnessBoundary::rowCount;
+    QSharedPointer<ChromaLightnessBoundary> result(new ChromaLightnessBoundary);
+    result->hue = hue;
+    result->maximumChroma.resize(rowCount);
+    LchDouble rows[batchBlockSize];
+    for (int start = 0; start < rowCount; start += batchBlockSize) {
+        const int blockCount = qMin(batchBlockSize, rowCount - start);
+        for (int j = 0; j < blockCount; ++j) {
+            rows[j] = LchDouble(ChromaLightnessBoundary::rowLightness(start + j), LchValues::humanMaximumChroma, hue);
+        }
+        nearestInGamutColorByAdjustingChromaBlock(rows, rows, blockCount, gamutPrecision);
+        for (int j = 0; j < blockCount; ++j) {
+            const qreal lightness = ChromaLightnessBoundary::rowLightness(start + j);
+            // Rows with an out-of-gamut gray have no in-gamut range.
+            result->maximumChroma[start + j] = isInRange<qreal>(m_blackpointL, lightness, m_whitepointL) //
+                ? rows[j].c
+                : -1;
         }
     }
+    result->hasContiguousRows = hasContiguousRows(*result);
+    return result;
+}
 
-    // No special case. So we have to actually perform
-    // a nearest-neighbor-search.
-    int x;
-    int y;
-    int currentBestX = 0; // 0 is the fallback value
-    int currentBestY = 0; // 0 is the fallback value
-    int currentBestDistanceSquare = std::numeric_limits<int>::max();
-    int x_distance;
-    int y_distance;
-    int temp;
-    for (x = 0; x < image.width(); x++) {
-        for (y = 0; y < image.height(); y++) {
-            if (image.pixelColor(x, y).alpha() == 255) {
-                x_distance = originalPoint.x() - x;
-                y_distance = originalPoint.y() - y;
-                temp = x_distance * x_distance + y_distance * y_distance;
-                if (temp < currentBestDistanceSquare) {
-                    currentBestX = x;
-                    currentBestY = y;
-                    currentBestDistanceSquare = temp;
+/** @brief Verifies that the in-gamut range of each row has no gaps.
+ *
+ * The bisections that calculate a @ref ChromaLightnessBoundary assume
+ * that, within each row, the in-gamut range goes from chroma <tt>0</tt>
+ * up to the maximum chroma. For arbitrary ICC profiles, this is not
+ * guaranteed. This function tests @ref contiguitySampleCount chromas
+ * within this range and the same number beyond it, up to
+ * @ref LchValues::humanMaximumChroma.
+ *
+ * @param boundary The boundary to verify
+ * @returns <tt>true</tt> if all samples within the range are in-gamut and
+ * all samples beyond are out-of-gamut. <tt>false</tt> otherwise. */
+bool RgbColorSpace::RgbColorSpacePrivate::hasContiguousRows(const ChromaLightnessBoundary &boundary) const
+{
+    LchDouble samples[batchBlockSize];
+    bool expected[batchBlockSize];
+    bool inGamut[batchBlockSize];
+    int sampleCount = 0;
+    // Tests the collected samples. Returns false on the first mismatch.
+    const auto testSamples = [&]() {
+        isInGamutBlock(samples, inGamut, sampleCount);
+        const bool isMatching = std::equal(inGamut, inGamut + sampleCount, expected);
+        sampleCount = 0;
+        return isMatching;
+    };
+    const auto appendSample = [&](const qreal lightness, const qreal chroma, const bool isInGamut) {
+        samples[sampleCount] = LchDouble(lightness, chroma, boundary.hue);
+        expected[sampleCount] = isInGamut;
+        ++sampleCount;
+        return (sampleCount < batchBlockSize) || testSamples();
+    };
+    for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+        const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+        const qreal maximumChroma = boundary.maximumChroma.at(row);
+        const qreal insideEnd = qMax<qreal>(maximumChroma, 0);
+        for (int i = 1; i <= contiguitySampleCount; ++i) {
+            if (maximumChroma >= 0) {
+                if (!appendSample(lightness, insideEnd * i / (contiguitySampleCount + 1), true)) {
+                    return false;
+                }
+            }
+            if (insideEnd < LchValues::humanMaximumChroma) {
+                const qreal outsideChroma = insideEnd + (LchValues::humanMaximumChroma - insideEnd) * i / contiguitySampleCount;
+                if (!appendSample(lightness, outsideChroma, false)) {
+                    return false;
                 }
             }
         }
     }
-    return QPoint(currentBestX, currentBestY);
-}
-
-/** @brief Get information from an ICC profile via LittleCMS
- *
- * @param profileHandle handle to the ICC profile in which will be searched
- * @param infoType the type of information that is searched
- * @returns A QString with the information. First, it searches the
- * information in the current locale (language code and country code as
- * provided currently by <tt>QLocale</tt>). If the information is not
- * available in this locale, it silently falls back to another available
- * localization. Note that the returned QString() might be empty if the
- * requested information is not available in the ICC profile. */
-QString RgbColorSpace::RgbColorSpacePrivate::getInformationFromProfile(cmsHPROFILE profileHandle, cmsInfoType infoType)
-{
-    // Initialize a char array of 3 values (two for actual characters and a
-    // one for a terminating null)cmsFloat64Number
-    // The recommended default value for language
-    // following LittleCMS documentation is “en”.
-    char languageCode[3] = "en";
-    // The recommended default value for country
-    // following LittleCMS documentation is “US”.
-    char countryCode[3] = "US";
-    // Update languageCode and countryCode to the actual locale (if possible)
-    const QStringList list = QLocale().name().split(QStringLiteral(u"_"));
-    // The locale codes should be ASCII only, so QString::toUtf8() should
-    // return ASCII-only valid results. We do not know what character encoding
-    // LittleCMS expects, but ASCII seems a save choise.
-    const QByteArray currentLocaleLanguage = list.at(0).toUtf8();
-    const QByteArray currentLocaleCountry = list.at(1).toUtf8();
-    if (currentLocaleLanguage.size() == 2) {
-        languageCode[0] = currentLocaleLanguage.at(0);
-        languageCode[1] = currentLocaleLanguage.at(1);
-        // No need for languageCode[2] = 0; for null-terminated string,
-        // because the array was yet initialized
-        if (currentLocaleCountry.size() == 2) {
-            countryCode[0] = currentLocaleCountry.at(0);
-            countryCode[1] = currentLocaleCountry.at(1);
-            // No need for countryCode[2] = 0; for null-terminated string,
-            // because the array was yet initialized
+    return testSamples();
+}
+
+/** @brief All in-gamut points of a grid within a chroma-lightness plane.
+ *
+ * This is the fallback of the nearest-in-gamut search for boundaries
+ * that have not @ref ChromaLightnessBoundary::hasContiguousRows. The grid
+ * has the rows of @ref ChromaLightnessBoundary, and within each row the chromas
+ * from <tt>0</tt> to @ref LchValues::humanMaximumChroma in steps of
+ * @ref fallbackChromaStep.
+ *
+ * @param hue The hue
+ * @returns All grid points that are in-gamut */
+QVector<LchDouble> RgbColorSpace::RgbColorSpacePrivate::inGamutGridPoints(qreal hue) const
+{
+    const int columnCount = qFloor(LchValues::humanMaximumChroma / fallbackChromaStep) + 1;
+    QVector<LchDouble> result;
+    LchDouble points[batchBlockSize];
+    bool inGamut[batchBlockSize];
+    int pointCount = 0;
+    const auto testPoints = [&]() {
+        isInGamutBlock(points, inGamut, pointCount);
+        for (int i = 0; i < pointCount; ++i) {
+            if (inGamut[i]) {
+                result.append(points[i]);
+            }
+        }
+        pointCount = 0;
+    };
+    for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+        const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+        for (int column = 0; column < columnCount; ++column) {
+            points[pointCount] = LchDouble(lightness, column * fallbackChromaStep, hue);
+            ++pointCount;
+            if (pointCount == batchBlockSize) {
+                testPoints();
+            }
         }
     }
-    // Calculate the size of the buffer that we have to provide for
-    // cmsGetProfileInfo in order to return a value.
-    const cmsUInt32Number resultLength = cmsGetProfileInfo(
-        // Profile in which we search:
-        profileHandle,
-        // The type of information we search:
-        infoType,
-        // The preferred language in which we want to get the information:
-        languageCode,
-        // The preferred country for which we want to get the information:
-        countryCode,
-        // Do not actually provide the information,
-        // just return the required buffer size:
-        nullptr,
-        // Do not actually provide the information,
-        // just return the required buffer size:
-        0);
-    // For the actual buffer size, increment by 1. This helps us to
-    // guarantee a null-terminated string later on.
-    const cmsUInt32Number bufferLength = resultLength + 1;
-
-    // Allocate the buffer
-    wchar_t *buffer = new wchar_t[bufferLength];
-    // Initialize the buffer with 0
-    for (cmsUInt32Number i = 0; i < bufferLength; ++i) {
-        *(buffer + i) = 0;
-    }
-
-    // Write the actual information to the buffer
-    cmsGetProfileInfo(
-        // profile in which we search
-        profileHandle,
-        // the type of information we search
-        infoType,
-        // the preferred language in which we want to get the information
-        languageCode,
-        // the preferred country for which we want to get the information
-        countryCode,
-        // the buffer into which the requested information will be written
-        buffer,
-        // the buffer size as previously calculated
-        resultLength);
-    // Make absolutely sure the buffer is null-terminated by marking its last
-    // element (the one that was the +1 "extra" element) as null.
-    *(buffer + (bufferLength - 1)) = 0;
-
-    // Create a QString() from the from the buffer
-    // cmsGetProfileInfo returns often strings that are smaller than the
-    // previously calculated buffer size. But it seems they are
-    // null-terminated strings. So we read only up to the first null value.
-    // This is save, because we made sure previously that the buffer is
-    // indeed null-terminated.
-    // QString::fromWCharArray will return a QString. It accepts arrays of
-    // wchar_t. wchar_t might have different sizes, either 16 bit or 32 bit
-    // depending on the operating system. As Qt’s documantation of
-    // QString::fromWCharArray() says:
-    //
-    //     “If wchar is 4 bytes, the string is interpreted as UCS-4,
-    //      if wchar is 2 bytes it is interpreted as UTF-16.”
-    //
-    // However, apparently this is not exact: When wchar is 4 bytes, surrogate
-    // pairs in the code unit array are interpretated like UTF-16: The
-    // surrogate pair is recognized as such. TODO static_assert that this is
-    // true (which seems complicate: better provide a unit test!) (Which
-    // is not strictly UTF-32 conform). Single surrogates cannot be
-    // interpretated correctly, but there will be no crash:
-    // QString::fromWCharArray will continue to read, also the part after
-    // the first UTF error. We can rely on this behaviour: As we do
-    // not really know the encoding of the buffer that LittleCMS returns.
-    // Therefore, it is a good idea to be compatible for various
-    // interpretations.
-    QString result = QString::fromWCharArray(
-        // Convert to string with these parameters:
-        buffer, // read from this buffer
-        -1      // read until the first null element
-    );
+    testPoints();
+    return result;
+}
+
+/** @brief The gamut boundary within a chroma-hue plane.
+ *
+ * The result is cached for a limited number of lightnesses. The
+ * diagrams use it to draw the gamut outline of a color space as a
+ * vector path, without rendering the whole chroma-hue plane.
+ *
+ * This function is thread-safe.
+ *
+ * @param lightness The lightness. Values beyond the gamut search limits
+ * are clamped.
+ * @returns The gamut boundary for this lightness */
+QSharedPointer<const ChromaHueBoundary> RgbColorSpace::chromaHueBoundary(qreal lightness) const
+{
+    const qreal sanitizedLightness = RgbColorSpacePrivate::sanitized(LchDouble(lightness, 0, 0)).l;
+    QSharedPointer<const ChromaHueBoundary> result;
+    if (d_pointer->m_chromaHueBoundaryCache.find(sanitizedLightness, &result)) {
+        return result;
+    }
+    // Two threads might calculate the same lightness concurrently;
+    // this is harmless.
+    result = d_pointer->calculateChromaHueBoundary(sanitizedLightness);
+    // If another thread has been faster, use its result, so that all
+    // callers share the same object.
+    const bool isInserted = d_pointer->m_chromaHueBoundaryCache.insertIf( //
+        sanitizedLightness,
+        result,
+        1,
+        [](const QSharedPointer<const ChromaHueBoundary> &) {
+            return false;
+        });
+    if (!isInserted) {
+        return d_pointer->m_chromaHueBoundaryCache.value(sanitizedLightness, result);
+    }
+    return result;
+}
 
-    // Free allocated memory of the buffer
-    delete[] buffer;
+/** @brief The gamut boundary within a chroma-hue plane, but only if it
+ * is available without calculation.
+ *
+ * Like @ref chromaHueBoundary(), but never calculates the boundary.
+ * This is for callers that use the boundary only as an optimization,
+ * and for which a calculation would cost more than it saves.
+ *
+ * This function is thread-safe.
+ *
+ * @param lightness The lightness. Values beyond the gamut search limits
+ * are clamped.
+ * @returns The gamut boundary for this lightness if it is in the cache.
+ * A null pointer otherwise. */
+QSharedPointer<const ChromaHueBoundary> RgbColorSpace::cachedChromaHueBoundary(qreal lightness) const
+{
+    const qreal sanitizedLightness = RgbColorSpacePrivate::sanitized(LchDouble(lightness, 0, 0)).l;
+    QSharedPointer<const ChromaHueBoundary> result;
+    d_pointer->m_chromaHueBoundaryCache.find(sanitizedLightness, &result);
+    return result;
+}
 
-    // Return
+/** @brief Calculates the gamut boundary within a chroma-hue plane.
+ *
+ * All columns are calculated together with the lockstep bisection of
+ * @ref nearestInGamutColorByAdjustingChromaBlock().
+ *
+ * @param lightness The sanitized lightness
+ * @returns The gamut boundary for this lightness */
+QSharedPointer<const ChromaHueBoundary> RgbColorSpace::RgbColorSpacePrivate::calculateChromaHueBoundary(qreal lightness) const
+{
+    constexpr int columnCount = ChromaHueBoundary::columnCount;
+    QSharedPointer<ChromaHueBoundary> result(new ChromaHueBoundary);
+    result->lightness = lightness;
+    // If the gray is out-of-gamut, there is no in-gamut range at all.
+    if (!isInRange<qreal>(m_blackpointL, lightness, m_whitepointL)) {
+        result->maximumChroma.fill(-1, columnCount);
+        return result;
+    }
+    result->maximumChroma.resize(columnCount);
+    LchDouble columns[batchBlockSize];
+    for (int start = 0; start < columnCount; start += batchBlockSize) {
+        const int blockCount = qMin(batchBlockSize, columnCount - start);
+        for (int j = 0; j < blockCount; ++j) {
+            columns[j] = LchDouble(lightness, LchValues::humanMaximumChroma, ChromaHueBoundary::columnHue(start + j));
+        }
+        nearestInGamutColorByAdjustingChromaBlock(columns, columns, blockCount, gamutPrecision);
+        for (int j = 0; j < blockCount; ++j) {
+            result->maximumChroma[start + j] = columns[j].c;
+        }
+    }
     return result;
 }
 
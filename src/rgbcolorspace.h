@@ -35,11 +35,17 @@
 #include "PerceptualColor/constpropagatinguniquepointer.h"
 #include "PerceptualColor/lchadouble.h"
 #include "PerceptualColor/lchdouble.h"
+#include "rgbdouble.h"
 
 #include <lcms2.h>
 
 namespace PerceptualColor
 {
+struct ChromaHueBoundary;
+struct ChromaLightnessBoundary;
+class DiagramImageCache;
+class DisplayTransform;
+
 /** @internal
  *
  * @brief Provides access to LittleCMS color management library
@@ -59,22 +65,39 @@ class RgbColorSpace : public QObject
 public:
     Q_INVOKABLE static QSharedPointer<PerceptualColor::RgbColorSpace> createFromFile(const QString &fileName);
     Q_INVOKABLE static QSharedPointer<PerceptualColor::RgbColorSpace> createSrgb();
+    QSharedPointer<const ChromaHueBoundary> cachedChromaHueBoundary(qreal lightness) const;
+    QSharedPointer<const ChromaLightnessBoundary> cachedChromaLightnessBoundary(qreal hue) const;
+    QSharedPointer<const ChromaHueBoundary> chromaHueBoundary(qreal lightness) const;
+    QSharedPointer<const ChromaLightnessBoundary> chromaLightnessBoundary(qreal hue) const;
+    void clearCaches();
+    static QString deviceLinkCacheDirectory();
+    DiagramImageCache *diagramImageCache() const;
+    QSharedPointer<DisplayTransform> displayTransform(const QByteArray &displayProfile) const;
     virtual ~RgbColorSpace() noexcept override;
     Q_INVOKABLE bool isInGamut(const cmsCIELab &lab) const;
     Q_INVOKABLE bool isInGamut(const PerceptualColor::LchDouble &lch) const;
+    Q_INVOKABLE bool isSrgb() const;
     Q_INVOKABLE int maximumChroma() const;
     Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color) const;
-    Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color);
+    Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble &color, qreal precision) const;
+    void nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count) const;
+    void nearestInGamutColorByAdjustingChroma(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count, qreal precision) const;
+    Q_INVOKABLE PerceptualColor::LchDouble nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble &color) const;
+    void nearestInGamutColorByAdjustingChromaLightness(const PerceptualColor::LchDouble *colors, PerceptualColor::LchDouble *results, int count) const;
     QString profileInfoCopyright() const;
     QString profileInfoDescription() const;
     QString profileInfoManufacturer() const;
     QString profileInfoModel() const;
+    static void setDeviceLinkCacheDirectory(const QString &directory);
+    void toCielab(const RgbDouble *rgb, cmsCIELab *lab, int count) const;
     Q_INVOKABLE PerceptualColor::LchDouble toLch(const cmsCIELab &lab) const;
     Q_INVOKABLE PerceptualColor::LchDouble toLch(const QColor &rgbColor) const;
+    void toLch(const RgbDouble *rgb, PerceptualColor::LchDouble *lch, int count) const;
     Q_INVOKABLE QColor toQColorRgbBound(const PerceptualColor::LchDouble &lch) const;
     Q_INVOKABLE QColor toQColorRgbBound(const PerceptualColor::LchaDouble &lcha) const;
     Q_INVOKABLE QColor toQColorRgbUnbound(const cmsCIELab &Lab) const;                  // TODO Isn’t QColor _always_ bound??? No: Unbound means, out-of-gamut color create an INVALID QColor.
     Q_INVOKABLE QColor toQColorRgbUnbound(const PerceptualColor::LchDouble &lch) const; // TODO Isn’t QColor _always_ bound???
+    void toRgbUnbound(const cmsCIELab *lab, RgbDouble *rgb, bool *inGamut, int count) const;
 
 private:
     Q_DISABLE_COPY(RgbColorSpace)
@@ -94,6 +117,8 @@ private:
 
     /** @internal @brief Only for unit tests. */
     friend class TestRgbColorSpace;
+    /** @internal @brief Only for unit tests. */
+    friend class TestGamutLatency;
 };
 
 } // namespace PerceptualColor
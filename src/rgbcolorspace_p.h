@@ -33,11 +33,20 @@
 // Include the header of the public class of this private implementation.
 #include "rgbcolorspace.h"
 
-#include "chromalightnessimage.h"
+#include "chromahueboundary.h"
+#include "chromalightnessboundary.h"
 #include "constpropagatingrawpointer.h"
+#include "diagramimagecache.h"
+#include "displaytransform.h"
 #include "lchvalues.h"
+#include "readmostlycache.h"
 #include "rgbdouble.h"
 
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
 namespace PerceptualColor
 {
 /** @internal
@@ -62,6 +71,23 @@ public:
     QString m_cmsInfoDescription;
     QString m_cmsInfoManufacturer;
     QString m_cmsInfoModel;
+    /** @brief If this object uses the build-in sRGB profile.
+     * @sa @ref RgbColorSpace::isSrgb() */
+    bool m_isSrgb = false;
+    /** @brief Storage for @ref RgbColorSpace::diagramImageCache() */
+    mutable DiagramImageCache m_diagramImageCache;
+    /** @brief Cache for @ref RgbColorSpace::displayTransform()
+     *
+     * Key: The raw data of the display profile. Value: The transform,
+     * or <tt>nullptr</tt> if the profile is not usable. */
+    mutable ReadMostlyCache<QByteArray, QSharedPointer<DisplayTransform>> m_displayTransforms {displayTransformCacheSize};
+    /** @brief Number of display profiles in @ref m_displayTransforms
+     *
+     * Usually, there is one profile per screen. Each entry holds a
+     * LittleCMS transform, so the number is limited: Widgets that move
+     * between screens, or applications that load many profiles, would
+     * otherwise keep all transforms forever. */
+    static constexpr int displayTransformCacheSize = 8;
     int m_maximumChroma = LchValues::humanMaximumChroma;
     cmsHTRANSFORM m_transformLabToRgb16Handle = nullptr;
     cmsHTRANSFORM m_transformLabToRgbHandle = nullptr;
@@ -70,29 +96,60 @@ public:
      * @sa blackpointL() */
     qreal m_whitepointL;
 
+    /** @brief Cache for @ref RgbColorSpace::chromaHueBoundary()
+     *
+     * Key: The lightness. */
+    mutable ReadMostlyCache<qreal, QSharedPointer<const ChromaHueBoundary>> m_chromaHueBoundaryCache {chromaHueBoundaryCacheSize};
+    /** @brief Number of lightnesses in @ref m_chromaHueBoundaryCache */
+    static constexpr int chromaHueBoundaryCacheSize = 32;
+    /** @brief Cache for @ref RgbColorSpace::chromaLightnessBoundary()
+     *
+     * Key: The normalized hue. */
+    mutable ReadMostlyCache<qreal, QSharedPointer<const ChromaLightnessBoundary>> m_chromaLightnessBoundaryCache {chromaLightnessBoundaryCacheSize};
+    /** @brief Number of hues in @ref m_chromaLightnessBoundaryCache */
+    static constexpr int chromaLightnessBoundaryCacheSize = 32;
+    /** @brief Number of chromas within each row, and the same number
+     * beyond each row, that @ref hasContiguousRows() tests. */
+    static constexpr int contiguitySampleCount = 8;
+    /** @brief Chroma step of @ref inGamutGridPoints() */
+    static constexpr qreal fallbackChromaStep = 0.5;
+    /** @brief Number of colors that the batch functions process at once.
+     *
+     * All buffers of a block are on the stack. */
+    static constexpr int batchBlockSize = 256;
+    /** @brief Minimum number of colors for which the batch functions
+     * use multiple threads. */
+    static constexpr int batchParallelThreshold = 4 * batchBlockSize;
+    /** @brief Maximum absolute lightness and chroma for the gamut searches.
+     *
+     * Far beyond any real gamut. Bigger values are clamped to this limit
+     * by @ref sanitized(). */
+    static constexpr qreal searchLimit = 1000;
+
     // Functions:
     cmsCIELab colorLab(const RgbDouble &rgb) const;
+    cmsHTRANSFORM createLabToRgb16Transform(cmsHPROFILE labProfileHandle, cmsHPROFILE rgbProfileHandle, const QString &cacheFileName);
+    static QString &deviceLinkCacheDirectoryStorage();
+    static QByteArray deviceLinkDescription(cmsHPROFILE rgbProfileHandle);
+    static QString deviceLinkCacheFileName(const QString &profileFileName);
+    static QMutex &deviceLinkCacheMutex();
     RgbDouble colorRgbBoundSimple(const cmsCIELab &Lab) const;
+    static QByteArray readDeviceLinkDescription(cmsHPROFILE deviceLinkHandle);
     static void deleteTransform(cmsHTRANSFORM &transformHandle);
-    static QString getInformationFromProfile(cmsHPROFILE profileHandle, cmsInfoType infoType);
-    bool initialize(cmsHPROFILE rgbProfileHandle);
+    qreal grayAxisBoundary(qreal inGamutLightness, qreal outOfGamutLightness, qreal precision) const;
+    bool initialize(cmsHPROFILE rgbProfileHandle, const QString &cacheFileName);
+    bool hasContiguousRows(const ChromaLightnessBoundary &boundary) const;
+    QVector<LchDouble> inGamutGridPoints(qreal hue) const;
+    void isInGamutBlock(const LchDouble *lch, bool *inGamut, int count) const;
+    void nearestInGamutColorByAdjustingChromaBlock(const LchDouble *colors, LchDouble *results, int count, qreal precision) const;
+    QSharedPointer<const ChromaHueBoundary> calculateChromaHueBoundary(qreal lightness) const;
+    QSharedPointer<const ChromaLightnessBoundary> calculateChromaLightnessBoundary(qreal hue) const;
+    void nearestInGamutColorByAdjustingChromaLightnessForHue(const LchDouble *colors, const QVector<int> &indices, LchDouble *results) const;
+    LchDouble nearestGray(const LchDouble &color) const;
+    static LchDouble sanitized(const LchDouble &color);
     cmsCIELab toLab(const QColor &rgbColor) const;
     QColor toQColorRgbBound(const cmsCIELab &Lab) const;
 
-    // Dirty hacks:
-    static QPoint nearestNeighborSearch(const QPoint originalPoint, const QImage &image);
-    /** TODO WARNING This is a memory leak. This member is not deleted in
-     * the desctuctor of the class. This is because ChromaLightnessImage has
-     * a shared pointer to _this_ object. If nearestNeighborSearchImage
-     * would be on the heap, deleting in when _this_ object is deleted will
-     * call again deleting _this_ object, and this recursive destructor
-     * call will crash the library. Therefore, we implement
-     * nearestNeighborSearchImage as a pointer with memory leak to avoid
-     * the crash. This memory leak is not fixed currently, because
-     * anyway we need to re-write all the code for nearest-neigbor search. */
-    ChromaLightnessImage *m_nearestNeighborSearchImage;
-    static constexpr int nearestNeighborSearchImageHeight = 400;
-
 private:
     Q_DISABLE_COPY(RgbColorSpacePrivate)
 
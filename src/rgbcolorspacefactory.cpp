@@ -60,4 +60,30 @@ QSharedPointer<PerceptualColor::RgbColorSpace> RgbColorSpaceFactory::createFromF
     return RgbColorSpace::createFromFile(fileName);
 }
 
+/** @brief Enables or disables the device link cache.
+ *
+ * Creating a color space object from an ICC file can be slow for complex
+ * profiles, because the color transforms have to be built. If a cache
+ * directory is set, the optimized transform to 16-bit RGB is saved as
+ * device link profile into this directory, so that later calls of
+ * @ref createFromFile() (also in later runs of the application) can load
+ * it instead. Cached device links are validated against the profile ID
+ * (the MD5 hash of the content) of the source profile.
+ *
+ * @note Only the transform to 16-bit RGB is cached. The floating point
+ * transforms, which are used for the gamut detection, are always built
+ * from the profile, because a device link would clip their values.
+ *
+ * This affects only color space objects that are created after
+ * calling this function.
+ *
+ * @param directory The cache directory, for example a subdirectory of
+ * <tt>QStandardPaths::writableLocation(QStandardPaths::CacheLocation)</tt>.
+ * It is created if necessary. An empty string disables the device
+ * link cache. This is the default value. */
+void RgbColorSpaceFactory::setDeviceLinkCacheDirectory(const QString &directory)
+{
+    RgbColorSpace::setDeviceLinkCacheDirectory(directory);
+}
+
 } // namespace PerceptualColor
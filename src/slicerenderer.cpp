@@ -0,0 +1,345 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own header
+#include "slicerenderer.h"
+
+#include "chromalightnessboundary.h"
+#include "displaytransform.h"
+#include "helper.h"
+#include "oklab.h"
+#include "oklabsrgbgamuttable.h"
+#include "polarpointf.h"
+#include "rgbcolorspace.h"
+#include "rgbdouble.h"
+
+#include <QColor>
+#include <QSharedPointer>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtMath>
+
+namespace PerceptualColor
+{
+/** @brief A plane of constant chroma.
+ *
+ * This is the curved surface of a cylinder around the gray axis, unrolled
+ * to a plane: The top-left corner of the image has lightness <tt>100</tt>
+ * and hue <tt>0</tt>. The hue increases to the right, the lightness
+ * decreases downwards.
+ *
+ * @param colorModel The color model
+ * @param chroma The chroma
+ * @param hueScale The hue difference from one pixel to the next, measured
+ * in degree.
+ * @param lightnessScale The lightness difference from one pixel to the
+ * next.
+ * @returns The plane. */
+SliceRenderer::Plane SliceRenderer::Plane::constantChroma(ColorModel colorModel, qreal chroma, qreal hueScale, qreal lightnessScale)
+{
+    Plane result;
+    result.colorModel = colorModel;
+    result.geometry = Geometry::Cylindrical;
+    result.origin[0] = 100;
+    result.origin[1] = chroma;
+    result.yAxis[0] = -lightnessScale;
+    result.xAxis[2] = hueScale;
+    return result;
+}
+
+/** @brief A plane of constant hue.
+ *
+ * The top-left corner of the image has lightness <tt>100</tt> and
+ * chroma <tt>0</tt>. The chroma increases to the right, the lightness
+ * decreases downwards, both with the same scale.
+ *
+ * @param colorModel The color model
+ * @param hue The hue
+ * @param scale The chroma and lightness difference from one pixel to
+ * the next.
+ * @returns The plane. */
+SliceRenderer::Plane SliceRenderer::Plane::constantHue(ColorModel colorModel, qreal hue, qreal scale)
+{
+    Plane result;
+    result.colorModel = colorModel;
+    result.geometry = Geometry::Cylindrical;
+    result.origin[0] = 100;
+    result.origin[2] = hue;
+    result.yAxis[0] = -scale;
+    result.xAxis[1] = scale;
+    return result;
+}
+
+/** @brief A plane of constant lightness.
+ *
+ * The <em>a</em> axis goes to the right, the <em>b</em> axis upwards,
+ * both with the same scale.
+ *
+ * @param colorModel The color model
+ * @param lightness The lightness
+ * @param topLeftA The <em>a</em> value of the top-left corner of the image
+ * @param topLeftB The <em>b</em> value of the top-left corner of the image
+ * @param scale The <em>a</em> and <em>b</em> difference from one pixel
+ * to the next.
+ * @returns The plane. */
+SliceRenderer::Plane SliceRenderer::Plane::constantLightness(ColorModel colorModel, qreal lightness, qreal topLeftA, qreal topLeftB, qreal scale)
+{
+    Plane result;
+    result.colorModel = colorModel;
+    result.geometry = Geometry::Cartesian;
+    result.origin[0] = lightness;
+    result.origin[1] = topLeftA;
+    result.origin[2] = topLeftB;
+    result.xAxis[1] = scale;
+    result.yAxis[2] = -scale;
+    return result;
+}
+
+/** @brief A hue wheel.
+ *
+ * @param colorModel The color model
+ * @param lightness The lightness of all points
+ * @param chroma The chroma of all points
+ * @param centerX The x coordinate of the center, measured in pixels.
+ * @param centerY The y coordinate of the center, measured in pixels.
+ * @param minimumRadius The inner radius of the wheel, measured in pixels.
+ * @param maximumRadius The outer radius of the wheel, measured in pixels.
+ * @returns The plane. The hue is the polar angle around the center,
+ * with hue <tt>0</tt> to the right and hue <tt>90</tt> upwards. */
+SliceRenderer::Plane SliceRenderer::Plane::hueWheel(ColorModel colorModel, qreal lightness, qreal chroma, qreal centerX, qreal centerY, qreal minimumRadius, qreal maximumRadius)
+{
+    Plane result;
+    result.colorModel = colorModel;
+    result.geometry = Geometry::Polar;
+    result.origin[0] = lightness;
+    result.origin[1] = chroma;
+    result.center[0] = centerX;
+    result.center[1] = centerY;
+    result.minimumRadius = minimumRadius;
+    result.maximumRadius = maximumRadius;
+    return result;
+}
+
+/** @brief If a coordinate point is painted at all.
+ *
+ * @param x The x coordinate within the image, measured in pixels.
+ * @param y The y coordinate within the image, measured in pixels.
+ * @returns For @ref Geometry::Polar, if the point is within the ring
+ * from @ref minimumRadius to @ref maximumRadius. For other geometries
+ * always <tt>true</tt>. */
+bool SliceRenderer::Plane::isWithinRing(qreal x, qreal y) const
+{
+    if (geometry != Geometry::Polar) {
+        return true;
+    }
+    const qreal radius = qSqrt(qPow(x - center[0], 2) + qPow(y - center[1], 2));
+    return isInRange<qreal>(minimumRadius, radius, maximumRadius);
+}
+
+/** @brief If all points of the plane have the same hue.
+ *
+ * @returns <tt>true</tt> for cylindrical planes that do not change the
+ * hue. <tt>false</tt> otherwise. */
+bool SliceRenderer::Plane::hasConstantHue() const
+{
+    return (geometry == Geometry::Cylindrical) //
+        && (xAxis[2] == 0) //
+        && (yAxis[2] == 0);
+}
+
+/** @brief The Lab value at a given coordinate point.
+ *
+ * @param x The x coordinate within the image, measured in pixels.
+ * @param y The y coordinate within the image, measured in pixels.
+ * @returns The Lab value (in the color model of this plane, so for
+ * @ref ColorModel::OklchD65 the scaled Oklab value). */
+cmsCIELab SliceRenderer::Plane::labAt(qreal x, qreal y) const
+{
+    cmsCIELab result;
+    if (geometry == Geometry::Polar) {
+        const PolarPointF polar(QPointF(x - center[0], center[1] - y));
+        const cmsCIELCh lch {origin[0], origin[1], polar.angleDegree()};
+        // Only geometry (polar to cartesian), therefore valid also for Oklab.
+        cmsLCh2Lab(&result, &lch);
+        return result;
+    }
+    double coordinates[3];
+    for (int i = 0; i < 3; ++i) {
+        coordinates[i] = origin[i] + x * xAxis[i] + y * yAxis[i];
+    }
+    if (geometry == Geometry::Cylindrical) {
+        const cmsCIELCh lch {coordinates[0], coordinates[1], coordinates[2]};
+        // Only geometry (polar to cartesian), therefore valid also for Oklab.
+        cmsLCh2Lab(&result, &lch);
+    } else {
+        result.L = coordinates[0];
+        result.a = coordinates[1];
+        result.b = coordinates[2];
+    }
+    return result;
+}
+
+/** @brief Paints the in-gamut part of a slice.
+ *
+ * Each pixel shows the color of the coordinate point at its center. So
+ * the pixel at pixel position <tt>(2, 3)</tt> shows the color
+ * corresponding to coordinate point <tt>(2.5, 3.5)</tt>. In-gamut pixels
+ * are painted opaque; all other pixels are not changed, so the caller
+ * can initialize the image with any background.
+ *
+ * @param image The image to paint on. Must have a 32-bit format like
+ * <tt>QImage::Format_ARGB32_Premultiplied</tt>. Nothing happens if it
+ * is <tt>nullptr</tt> or null.
+ * @param plane The slice
+ * @param colorSpace The color space that defines the gamut
+ * @param displayTransform If not <tt>nullptr</tt>, the in-gamut pixels
+ * are converted with this transform instead of the RGB values of the
+ * color space.
+ * @param cancelFlag If not <tt>nullptr</tt>, it is checked before each
+ * row. As soon as it is <tt>true</tt>, the remaining rows are skipped.
+ * This allows to abandon a rendering (for example for an image request
+ * that is not needed anymore) from another thread.
+ * @returns <tt>false</tt> if the painting has been canceled, so that the
+ * image is incomplete. <tt>true</tt> otherwise. */
+bool SliceRenderer::paintGamut(QImage *image, const Plane &plane, const RgbColorSpace &colorSpace, const DisplayTransform *displayTransform, const std::atomic<bool> *cancelFlag)
+{
+    const auto isCanceled = [cancelFlag]() {
+        return (cancelFlag != nullptr) && cancelFlag->load(std::memory_order_relaxed);
+    };
+    if ((image == nullptr) || image->isNull()) {
+        return !isCanceled();
+    }
+    const int imageWidth = image->width();
+    const int bytesPerLine = image->bytesPerLine();
+    // Detach only once, so that each thread can write its own rows.
+    uchar *const bits = image->bits();
+    const bool isOklch = (plane.colorModel == ColorModel::OklchD65);
+    const bool useSrgbFastPath = isOklch && colorSpace.isSrgb();
+    // The gamut boundary is shared with the nearest-in-gamut search of
+    // the color space. It is only available per hue. An estimate is good
+    // enough to skip pixels, so it is calculated only if there is none.
+    QSharedPointer<const ChromaLightnessBoundary> boundary;
+    if (!isOklch && plane.hasConstantHue()) {
+        boundary = colorSpace.cachedChromaLightnessBoundary(plane.origin[2]);
+        if (boundary.isNull()) {
+            boundary = colorSpace.chromaLightnessBoundary(plane.origin[2]);
+        }
+    }
+
+    const auto paintRow = [&](const int y) {
+        if (isCanceled()) {
+            return;
+        }
+        // The buffers hold only the candidates: The pixels of this row
+        // that might be in-gamut.
+        QVector<int> columns;
+        QVector<cmsCIELab> labs; // In the color model of the plane
+        QVector<cmsCIELab> cielabs; // CIELab D50
+        columns.reserve(imageWidth);
+        labs.reserve(imageWidth);
+        for (int x = 0; x < imageWidth; ++x) {
+            if (!plane.isWithinRing(x + 0.5, y + 0.5)) {
+                continue;
+            }
+            const cmsCIELab lab = plane.labAt(x + 0.5, y + 0.5);
+            cmsCIELCh lch;
+            // Only geometry (cartesian to polar), therefore valid also
+            // for Oklab.
+            cmsLab2LCh(&lch, &lab);
+            if (lch.C > plane.maximumChroma) {
+                continue;
+            }
+            if (boundary && (lch.C > boundary->maximumChromaEstimate(lch.L))) {
+                continue;
+            }
+            if (useSrgbFastPath && (lch.C > OkLabSrgbGamutTable::maximumChroma(lch.L, lch.h))) {
+                continue;
+            }
+            columns.append(x);
+            labs.append(lab);
+        }
+        const int count = columns.count();
+        if (count == 0) {
+            return;
+        }
+
+        // Convert all candidates at once.
+        QVector<RgbDouble> rgb(count);
+        QVector<bool> inGamut(count);
+        if (useSrgbFastPath) {
+            OkLab::oklabToSrgb(labs.constData(), rgb.data(), inGamut.data(), count);
+        } else {
+            if (isOklch) {
+                cielabs.reserve(count);
+                for (int i = 0; i < count; ++i) {
+                    cielabs.append(OkLab::toCielabD50(labs.at(i)));
+                }
+            } else {
+                cielabs = labs;
+            }
+            colorSpace.toRgbUnbound(cielabs.constData(), rgb.data(), inGamut.data(), count);
+        }
+
+        QRgb *const line = reinterpret_cast<QRgb *>(bits + y * bytesPerLine);
+        if (displayTransform == nullptr) {
+            for (int i = 0; i < count; ++i) {
+                if (inGamut.at(i)) {
+                    line[columns.at(i)] = QColor::fromRgbF(rgb.at(i).red, rgb.at(i).green, rgb.at(i).blue).rgb();
+                }
+            }
+            return;
+        }
+        // Convert all in-gamut pixels at once to the display.
+        QVector<int> displayColumns;
+        QVector<cmsCIELab> displayLabs;
+        displayColumns.reserve(count);
+        displayLabs.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            if (inGamut.at(i)) {
+                displayColumns.append(columns.at(i));
+                displayLabs.append(isOklch ? OkLab::toCielabD50(labs.at(i)) : labs.at(i));
+            }
+        }
+        QVector<QRgb> displayRgb(displayColumns.count());
+        displayTransform->toRgb(displayLabs.constData(), displayRgb.data(), displayRgb.count());
+        for (int i = 0; i < displayColumns.count(); ++i) {
+            line[displayColumns.at(i)] = displayRgb.at(i);
+        }
+    };
+
+    QVector<int> rows;
+    rows.reserve(image->height());
+    for (int y = 0; y < image->height(); ++y) {
+        rows.append(y);
+    }
+    QtConcurrent::blockingMap(rows, paintRow);
+    return !isCanceled();
+}
+
+} // namespace PerceptualColor
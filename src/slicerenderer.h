@@ -0,0 +1,148 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLICERENDERER_H
+#define SLICERENDERER_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "colormodel.h"
+
+#include <QImage>
+
+#include <lcms2.h>
+
+#include <atomic>
+#include <limits>
+
+namespace PerceptualColor
+{
+class DisplayTransform;
+class RgbColorSpace;
+
+/** @internal
+ *
+ * @brief Paints a planar slice through the color solid.
+ *
+ * All two-dimensional diagrams of this library show a slice through the
+ * color solid: @ref ChromaHueImage a plane of constant lightness,
+ * @ref ChromaLightnessImage a plane of constant hue. This class renders
+ * any such slice, described by a @ref Plane, so that all diagrams share
+ * the same optimized code:
+ *
+ * - The rows of the image are painted in parallel on all cores.
+ * - Within a row, all candidate pixels are converted with a single
+ *   batch conversion: @ref RgbColorSpace::toRgbUnbound() for LittleCMS,
+ *   @ref OkLab::oklabToSrgb() for Oklch on sRGB, and
+ *   @ref DisplayTransform for the display profile.
+ * - Pixels that are surely out-of-gamut are skipped without any
+ *   conversion. For CIELCh slices of constant hue, the estimate comes
+ *   from the cached @ref RgbColorSpace::chromaLightnessBoundary().
+ *   For Oklch on sRGB, it comes from @ref OkLabSrgbGamutTable, which
+ *   is generated at build time and works for any slice.
+ *
+ * @note All functions are thread-safe. */
+class SliceRenderer final
+{
+public:
+    /** @brief How the coordinates of a @ref Plane are interpreted. */
+    enum class Geometry {
+        Cartesian, /**< The coordinates are <em>L</em>, <em>a</em> and
+                      <em>b</em>. The slice is a flat plane through Lab,
+                      which might be tilted in any direction. */
+        Cylindrical, /**< The coordinates are <em>L</em>, <em>C</em> and
+                        <em>h</em> (in degree). The slice is flat within
+                        LCh, which allows for example the curved surface
+                        of constant chroma. */
+        Polar /**< Lightness and chroma are constant (the first two
+                 values of @ref Plane::origin). The hue is the polar
+                 angle of the point around @ref Plane::center, measured
+                 counter-clockwise, with <tt>0</tt> to the right. Used
+                 for hue wheels. Only points within the ring from
+                 @ref Plane::minimumRadius to @ref Plane::maximumRadius
+                 are painted. */
+    };
+
+    /** @brief A slice through the color solid.
+     *
+     * The point in the middle of the pixel at pixel position
+     * <tt>(x, y)</tt> has the coordinates
+     * <tt>origin + (x + 0.5) * xAxis + (y + 0.5) * yAxis</tt>. The order
+     * of the coordinates is defined by @ref geometry. */
+    struct Plane {
+        static Plane constantChroma(ColorModel colorModel, qreal chroma, qreal hueScale, qreal lightnessScale);
+        static Plane constantHue(ColorModel colorModel, qreal hue, qreal scale);
+        static Plane constantLightness(ColorModel colorModel, qreal lightness, qreal topLeftA, qreal topLeftB, qreal scale);
+        static Plane hueWheel(ColorModel colorModel, qreal lightness, qreal chroma, qreal centerX, qreal centerY, qreal minimumRadius, qreal maximumRadius);
+        bool hasConstantHue() const;
+        bool isWithinRing(qreal x, qreal y) const;
+        cmsCIELab labAt(qreal x, qreal y) const;
+
+        /** @brief The color model of the coordinates. */
+        ColorModel colorModel = ColorModel::CielchD50;
+        /** @brief The geometry of the coordinates. */
+        Geometry geometry = Geometry::Cartesian;
+        /** @brief Coordinates of the top-left corner of the image, which
+         * is coordinate point <tt>(0, 0)</tt>. */
+        double origin[3] = {0, 0, 0};
+        /** @brief Change of the coordinates from one pixel to the next
+         * pixel on the right. */
+        double xAxis[3] = {0, 0, 0};
+        /** @brief Change of the coordinates from one pixel to the next
+         * pixel below. */
+        double yAxis[3] = {0, 0, 0};
+        /** @brief Points with a higher chroma are not painted, even if
+         * they are in-gamut. */
+        qreal maximumChroma = std::numeric_limits<qreal>::infinity();
+        /** @brief The center of the wheel, measured in pixels.
+         *
+         * Only for @ref Geometry::Polar. */
+        double center[2] = {0, 0};
+        /** @brief The inner radius of the wheel, measured in pixels.
+         *
+         * Only for @ref Geometry::Polar. */
+        qreal minimumRadius = 0;
+        /** @brief The outer radius of the wheel, measured in pixels.
+         *
+         * Only for @ref Geometry::Polar. */
+        qreal maximumRadius = std::numeric_limits<qreal>::infinity();
+    };
+
+    static bool paintGamut(QImage *image, const Plane &plane, const RgbColorSpace &colorSpace, const DisplayTransform *displayTransform, const std::atomic<bool> *cancelFlag = nullptr);
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    SliceRenderer() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestSliceRenderer;
+};
+
+} // namespace PerceptualColor
+
+#endif // SLICERENDERER_H
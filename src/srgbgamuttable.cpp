@@ -0,0 +1,102 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// Own headers
+// First the interface, which forces the header to be self-contained.
+#include "srgbgamuttable.h"
+
+#include "chromalightnessboundary.h"
+#include "polarpointf.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+namespace PerceptualColor
+{
+static_assert(SrgbGamutTable::rowCount == ChromaLightnessBoundary::rowCount);
+static_assert(360 % SrgbGamutTable::hueStep == 0);
+
+/** @brief If the table contains the exact boundary of a given hue.
+ *
+ * @param hue The hue. Values outside of <tt>[0, 360[</tt> are normalized.
+ * @returns <tt>true</tt> if the hue is (exactly) a multiple of
+ * @ref hueStep. <tt>false</tt> otherwise. For these hues,
+ * @ref chromaLightnessBoundary() is exact; for all other hues, it is
+ * only an estimate. */
+bool SrgbGamutTable::containsHue(qreal hue)
+{
+    const qreal position = PolarPointF::normalizedAngleDegree(hue) / hueStep;
+    return position == std::floor(position);
+}
+
+/** @brief The gamut boundary within the chroma-lightness plane of a hue.
+ *
+ * @param hue The hue. Values outside of <tt>[0, 360[</tt> are normalized.
+ * @returns The gamut boundary for this hue. For hues that are contained
+ * in the table (see @ref containsHue()), it is like the result of
+ * @ref RgbColorSpace::chromaLightnessBoundary(), but the values are
+ * rounded down to <tt>1 / @ref chromaScale</tt>. For all other hues,
+ * each row has the maximum of the two neighboring table hues. Between
+ * two neighboring hues, the boundary changes only a little, so that
+ * @ref ChromaLightnessBoundary::maximumChromaEstimate() (with its
+ * tolerance) stays a safe upper estimate; but the values themselves
+ * might be slightly out-of-gamut. <tt>nullptr</tt> if the hue is not
+ * finite. */
+QSharedPointer<const ChromaLightnessBoundary> SrgbGamutTable::chromaLightnessBoundary(qreal hue)
+{
+    if (!qIsFinite(hue)) {
+        return nullptr;
+    }
+    const qreal normalizedHue = PolarPointF::normalizedAngleDegree(hue);
+    const qreal position = normalizedHue / hueStep;
+    // Because of the normalization, the indices might be hueCount.
+    const int lowerHueIndex = qFloor(position) % hueCount;
+    const int upperHueIndex = qCeil(position) % hueCount;
+    const quint16 *const lowerValues = &maximumChroma[lowerHueIndex * rowCount];
+    const quint16 *const upperValues = &maximumChroma[upperHueIndex * rowCount];
+    QSharedPointer<ChromaLightnessBoundary> result(new ChromaLightnessBoundary);
+    result->hue = normalizedHue;
+    result->maximumChroma.resize(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        // Conservative: A row is in-gamut if it is in-gamut for at
+        // least one of the neighbors.
+        qreal value = -1;
+        if (lowerValues[row] != outOfGamut) {
+            value = static_cast<qreal>(lowerValues[row]) / chromaScale;
+        }
+        if (upperValues[row] != outOfGamut) {
+            value = qMax(value, static_cast<qreal>(upperValues[row]) / chromaScale);
+        }
+        result->maximumChroma[row] = value;
+    }
+    return result;
+}
+
+} // namespace PerceptualColor
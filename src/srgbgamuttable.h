@@ -0,0 +1,105 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SRGBGAMUTTABLE_H
+#define SRGBGAMUTTABLE_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include <QSharedPointer>
+#include <QtGlobal>
+
+namespace PerceptualColor
+{
+struct ChromaLightnessBoundary;
+
+/** @internal
+ *
+ * @brief The gamut boundary of the built-in sRGB profile, generated at
+ * build time.
+ *
+ * The built-in sRGB profile of @ref RgbColorSpace::createSrgb() has
+ * always the same gamut. Instead of probing LittleCMS in every process,
+ * the build system runs the tool <tt>generatesrgbgamuttable</tt>, which
+ * analyses the gamut once and writes the data members of this class into
+ * a generated source file. The tool uses the same transform as
+ * @ref RgbColorSpace and the same bisections (see @ref GamutBisection).
+ *
+ * This way, the built-in sRGB color space starts without any gamut
+ * analysis, and @ref RgbColorSpace::chromaLightnessBoundary() answers
+ * hues that are multiples of @ref hueStep from static memory. For all
+ * other hues, the table provides a conservative estimate that is
+ * interpolated from the neighboring hues, which is good enough for
+ * @ref RgbColorSpace::cachedChromaLightnessBoundary().
+ *
+ * @note All functions are thread-safe. */
+class SrgbGamutTable final
+{
+public:
+    static QSharedPointer<const ChromaLightnessBoundary> chromaLightnessBoundary(qreal hue);
+    static bool containsHue(qreal hue);
+
+    /** @brief Step of the hue axis, measured in degree. */
+    static constexpr int hueStep = 1;
+    /** @brief Number of hues. */
+    static constexpr int hueCount = 360 / hueStep;
+    /** @brief Number of lightness rows for each hue. Same as
+     * @ref ChromaLightnessBoundary::rowCount. */
+    static constexpr int rowCount = 401;
+    /** @brief Scale of the values in @ref maximumChroma.
+     *
+     * The values are rounded down, so they are at most
+     * <tt>1 / chromaScale</tt> below the exact boundary. */
+    static constexpr int chromaScale = 400;
+    /** @brief Value in @ref maximumChroma for rows with an out-of-gamut
+     * gray. */
+    static constexpr quint16 outOfGamut = 0xFFFF;
+
+    /** @brief The darkest in-gamut point on the L* axis. */
+    static const double blackpointL;
+    /** @brief The lightest in-gamut point on the L* axis. */
+    static const double whitepointL;
+    /** @brief The maximum in-gamut chroma, multiplied by
+     * @ref chromaScale.
+     *
+     * Index: <tt>hueIndex * rowCount + row</tt>. The hue of a
+     * <tt>hueIndex</tt> is <tt>hueIndex * hueStep</tt>. The lightness of
+     * a row is @ref ChromaLightnessBoundary::rowLightness(). */
+    static const quint16 maximumChroma[hueCount * rowCount];
+
+private:
+    /** @brief Delete the constructor to disallow creating an instance
+     * of this class. */
+    SrgbGamutTable() = delete;
+
+    /** @internal @brief Only for unit tests. */
+    friend class TestSrgbGamutTable;
+};
+
+} // namespace PerceptualColor
+
+#endif // SRGBGAMUTTABLE_H
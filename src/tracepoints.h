@@ -0,0 +1,135 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TRACEPOINTS_H
+#define TRACEPOINTS_H
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+/** @internal @file
+ *
+ * @brief Static tracepoints (USDT probes) for production profiling.
+ *
+ * The probes mark the start and the end of the expensive operations of
+ * this library: rendering of the image generators, the gamut searches,
+ * the creation of the LittleCMS transforms and the propagation of a new
+ * color to all widgets of the @ref ColorDialog. Tools like
+ * <tt>perf</tt>, <tt>bpftrace</tt> or SystemTap can attach to them in a
+ * running process to measure latency distributions:
+ *
+ * @code{.unparsed}
+ * bpftrace -e 'usdt:./libperceptualcolor.so:perceptualcolor:*_start { … }'
+ * @endcode
+ *
+ * The probes are compiled if the CMake option
+ * <tt>PERCEPTUALCOLOR_TRACEPOINTS</tt> is enabled (the default) and the
+ * header <tt>sys/sdt.h</tt> is available (on Debian and Ubuntu provided
+ * by the package <tt>systemtap-sdt-dev</tt>). Without this header, the
+ * library is built without probes. A compiled probe is a single
+ * <tt>nop</tt> instruction as long as no tracer is attached, so it can
+ * stay enabled in release builds. If the option is disabled, the macros
+ * expand to nothing, and their arguments are not evaluated.
+ *
+ * All probes belong to the provider <tt>perceptualcolor</tt>. The
+ * arguments must be integers or pointers.
+ *
+ * - @ref PERCEPTUALCOLOR_TRACE and @ref PERCEPTUALCOLOR_TRACE1 define a
+ *   single probe.
+ * - @ref PERCEPTUALCOLOR_TRACE_SCOPE and @ref PERCEPTUALCOLOR_TRACE_SCOPE1
+ *   define a probe <tt><em>name</em>_start</tt> at the place of the macro
+ *   and a probe <tt><em>name</em>_end</tt> when the current scope is
+ *   left, no matter by which <tt>return</tt>. Each name can be used only
+ *   once per scope. */
+
+#ifdef PERCEPTUALCOLOR_TRACEPOINTS
+
+#include <sys/sdt.h>
+
+namespace PerceptualColor
+{
+/** @internal
+ *
+ * @brief Calls a function when the scope is left.
+ *
+ * Helper for @ref PERCEPTUALCOLOR_TRACE_SCOPE. */
+template<typename Function> class TraceScopeGuard final
+{
+public:
+    /** @brief Constructor
+     * @param function The function to call when the scope is left. */
+    explicit TraceScopeGuard(Function function)
+        : m_function(function)
+    {
+    }
+    /** @brief Destructor. Calls the function. */
+    ~TraceScopeGuard() noexcept
+    {
+        m_function();
+    }
+
+private:
+    Q_DISABLE_COPY(TraceScopeGuard)
+
+    /** @brief The function to call when the scope is left. */
+    Function m_function;
+};
+
+} // namespace PerceptualColor
+
+/** @internal @brief Defines a probe without arguments. */
+#define PERCEPTUALCOLOR_TRACE(name) DTRACE_PROBE(perceptualcolor, name)
+
+/** @internal @brief Defines a probe with one argument. */
+#define PERCEPTUALCOLOR_TRACE1(name, argument) DTRACE_PROBE1(perceptualcolor, name, argument)
+
+/** @internal @brief Defines a start probe here and an end probe at the
+ * end of the scope. */
+#define PERCEPTUALCOLOR_TRACE_SCOPE(name)                                            \
+    DTRACE_PROBE(perceptualcolor, name##_start);                                     \
+    const ::PerceptualColor::TraceScopeGuard perceptualColorTraceGuard_##name([]() { \
+        DTRACE_PROBE(perceptualcolor, name##_end);                                   \
+    })
+
+/** @internal @brief Like @ref PERCEPTUALCOLOR_TRACE_SCOPE, but both probes
+ * get an argument, which is evaluated only once, at the start. */
+#define PERCEPTUALCOLOR_TRACE_SCOPE1(name, argument)                                                                     \
+    const auto perceptualColorTraceArgument_##name = (argument);                                                         \
+    DTRACE_PROBE1(perceptualcolor, name##_start, perceptualColorTraceArgument_##name);                                   \
+    const ::PerceptualColor::TraceScopeGuard perceptualColorTraceGuard_##name([&perceptualColorTraceArgument_##name]() { \
+        DTRACE_PROBE1(perceptualcolor, name##_end, perceptualColorTraceArgument_##name);                                 \
+    })
+
+#else
+
+#define PERCEPTUALCOLOR_TRACE(name) static_cast<void>(0)
+#define PERCEPTUALCOLOR_TRACE1(name, argument) static_cast<void>(0)
+#define PERCEPTUALCOLOR_TRACE_SCOPE(name) static_cast<void>(0)
+#define PERCEPTUALCOLOR_TRACE_SCOPE1(name, argument) static_cast<void>(0)
+
+#endif // PERCEPTUALCOLOR_TRACEPOINTS
+
+#endif // TRACEPOINTS_H
@@ -351,6 +351,33 @@ void WheelColorPicker::setCurrentColor(const LchDouble &newCurrentColor)
     d_pointer->m_colorWheel->setHue(d_pointer->m_chromaLightnessDiagram->currentColor().h);
 }
 
+/** @brief The ICC profile of the monitor.
+ *
+ * @returns The raw data of the ICC profile of the monitor, or an empty
+ * byte array if none has been set. Default value is an empty byte array.
+ *
+ * @sa @ref setDisplayProfile() */
+QByteArray WheelColorPicker::displayProfile() const
+{
+    return d_pointer->m_colorWheel->displayProfile();
+}
+
+/** @brief Sets the ICC profile of the monitor.
+ *
+ * Both, the wheel and the chroma-lightness diagram, convert their colors
+ * directly to the RGB values of this monitor. See
+ * @ref ColorWheel::setDisplayProfile() for details.
+ *
+ * @param newDisplayProfile The raw data of the ICC profile of the
+ * monitor, or an empty byte array for no conversion.
+ *
+ * @sa @ref displayProfile() */
+void WheelColorPicker::setDisplayProfile(const QByteArray &newDisplayProfile)
+{
+    d_pointer->m_colorWheel->setDisplayProfile(newDisplayProfile);
+    d_pointer->m_chromaLightnessDiagram->setDisplayProfile(newDisplayProfile);
+}
+
 /** @brief Recommended size for the widget
  *
  * Reimplemented from base class.
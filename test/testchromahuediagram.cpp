@@ -36,7 +36,31 @@
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "chromahueboundary.h"
 #include "polarpointf.h"
+#include "rgbcolorspace.h"
+
+#include <lcms2.h>
+
+/** @brief The raw data of an ICC profile with sRGB primaries.
+ *
+ * @param gamma The gamma of the tone curves
+ * @returns The raw data of the profile */
+static QByteArray rgbProfileData(double gamma)
+{
+    cmsToneCurve *curve = cmsBuildGamma(nullptr, gamma);
+    cmsToneCurve *curves[3] = {curve, curve, curve};
+    const cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    const cmsCIExyYTRIPLE primaries {{0.64, 0.33, 1}, {0.30, 0.60, 1}, {0.15, 0.06, 1}};
+    cmsHPROFILE profileHandle = cmsCreateRGBProfile(&whitePoint, &primaries, curves);
+    cmsFreeToneCurve(curve);
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profileHandle, nullptr, &size);
+    QByteArray result(static_cast<int>(size), 0);
+    cmsSaveProfileToMem(profileHandle, result.data(), &size);
+    cmsCloseProfile(profileHandle);
+    return result;
+}
 
 static void snippet01()
 {
@@ -348,6 +372,86 @@ private Q_SLOTS:
         QVERIFY(mySecondColor.hasSameCoordinates(myWidget.d_pointer->m_currentColor));
     }
 
+    void testOutlineColorSpace()
+    {
+        ChromaHueDiagram myWidget {m_rgbColorSpace};
+        myWidget.resize(QSize(400, 400));
+        QVERIFY(myWidget.outlineColorSpace().isNull());
+        QVERIFY(myWidget.d_pointer->outlinePolygon().isEmpty());
+        const QImage withoutOutline = myWidget.grab().toImage();
+
+        myWidget.setOutlineColorSpace(m_rgbColorSpace);
+        QCOMPARE(myWidget.outlineColorSpace(), m_rgbColorSpace);
+        myWidget.setCurrentColor(LchDouble(50, 20, 0));
+        const QPolygonF outline = myWidget.d_pointer->outlinePolygon();
+        QCOMPARE(outline.count(), ChromaHueBoundary::columnCount);
+        const QSharedPointer<const ChromaHueBoundary> boundary = m_rgbColorSpace->chromaHueBoundary(50);
+        for (int column = 0; column < ChromaHueBoundary::columnCount; column += 45) {
+            const QPointF expected = myWidget.d_pointer->widgetCoordinatesFromChromaHue( //
+                boundary->maximumChroma.at(column),
+                ChromaHueBoundary::columnHue(column));
+            QCOMPARE(outline.at(column), expected);
+        }
+        QVERIFY(myWidget.grab().toImage() != withoutOutline);
+
+        // Between the lightness steps, the outline is interpolated.
+        myWidget.setCurrentColor(LchDouble(50.1, 20, 0));
+        const QPolygonF interpolated = myWidget.d_pointer->outlinePolygon();
+        QCOMPARE(interpolated.count(), ChromaHueBoundary::columnCount);
+        const QSharedPointer<const ChromaHueBoundary> upper = m_rgbColorSpace->chromaHueBoundary(50.25);
+        for (int column = 0; column < ChromaHueBoundary::columnCount; column += 45) {
+            const qreal lowerChroma = boundary->maximumChroma.at(column);
+            const qreal upperChroma = upper->maximumChroma.at(column);
+            const QPointF expected = myWidget.d_pointer->widgetCoordinatesFromChromaHue( //
+                lowerChroma + 0.4 * (upperChroma - lowerChroma),
+                ChromaHueBoundary::columnHue(column));
+            QVERIFY(qAbs(interpolated.at(column).x() - expected.x()) < 0.01);
+            QVERIFY(qAbs(interpolated.at(column).y() - expected.y()) < 0.01);
+        }
+
+        // No outline if the gray is out-of-gamut
+        myWidget.setCurrentColor(LchDouble(300, 20, 0));
+        QVERIFY(myWidget.d_pointer->outlinePolygon().isEmpty());
+        myWidget.grab();
+
+        myWidget.setOutlineColorSpace(nullptr);
+        myWidget.setCurrentColor(LchDouble(50, 20, 0));
+        QVERIFY(myWidget.d_pointer->outlinePolygon().isEmpty());
+    }
+
+    void testDisplayProfile()
+    {
+        ChromaHueDiagram myWidget {m_rgbColorSpace};
+        myWidget.resize(QSize(400, 400));
+        myWidget.setCurrentColor(LchDouble(50, 20, 0));
+        QVERIFY(myWidget.displayProfile().isEmpty());
+        const QImage withoutProfile = myWidget.grab().toImage();
+
+        // A display with linear tone curves gets other RGB values
+        // than sRGB.
+        const QByteArray profile = rgbProfileData(1.0);
+        myWidget.setDisplayProfile(profile);
+        QCOMPARE(myWidget.displayProfile(), profile);
+        QVERIFY(myWidget.grab().toImage() != withoutProfile);
+
+        myWidget.setDisplayProfile(QByteArray());
+        QVERIFY(myWidget.displayProfile().isEmpty());
+        QCOMPARE(myWidget.grab().toImage(), withoutProfile);
+    }
+
+    void testWidgetCoordinatesFromChromaHue()
+    {
+        ChromaHueDiagram myWidget {m_rgbColorSpace};
+        myWidget.resize(QSize(400, 400));
+        const LchDouble myColor(50, 30, 120);
+        myWidget.setCurrentColor(myColor);
+        QCOMPARE(myWidget.d_pointer->widgetCoordinatesFromChromaHue(myColor.c, myColor.h), //
+                 myWidget.d_pointer->widgetCoordinatesFromCurrentColor());
+        const QPointF center = myWidget.d_pointer->widgetCoordinatesFromChromaHue(0, 0);
+        QCOMPARE(center.x(), myWidget.d_pointer->diagramOffset());
+        QCOMPARE(center.y(), myWidget.d_pointer->diagramOffset());
+    }
+
     void testSnipped01()
     {
         snippet01();
@@ -206,6 +206,22 @@ private Q_SLOTS:
                  " if the value that was set is the same than before.");
     }
 
+    void testColorModel()
+    {
+        ChromaHueImage test(colorSpace);
+        test.setImageSize(50); // Set a non-zero image size
+        test.setChromaRange(30);
+        test.getImage();
+        test.setColorModel(ColorModel::CielchD50);
+        QVERIFY2(!test.m_image.isNull(), "Setting the same color model should not erease the cache.");
+        test.setColorModel(ColorModel::OklchD65);
+        QVERIFY2(test.m_image.isNull(), "Setting another color model should erease the cache.");
+        const QImage oklchImage = test.getImage();
+        QCOMPARE(oklchImage.size(), QSize(50, 50));
+        // The center (gray axis) is in-gamut.
+        QCOMPARE(oklchImage.pixelColor(25, 25).alpha(), 255);
+    }
+
     void testCornerCases()
     {
         ChromaHueImage test(colorSpace);
@@ -34,6 +34,8 @@
 #include "chromalightnessdiagram_p.h"
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "chromalightnessboundary.h"
+#include "rgbcolorspace.h"
 
 #include <QtTest>
 
@@ -627,6 +629,52 @@ private Q_SLOTS:
         QVERIFY(mySecondColor.hasSameCoordinates(myWidget.currentColor()));
         QVERIFY(mySecondColor.hasSameCoordinates(myWidget.d_pointer->m_currentColor));
     }
+
+    void testOutlineColorSpace()
+    {
+        ChromaLightnessDiagram myWidget {m_rgbColorSpace};
+        myWidget.resize(QSize(400, 400));
+        QVERIFY(myWidget.outlineColorSpace().isNull());
+        QVERIFY(myWidget.d_pointer->outlinePolyline().isEmpty());
+        const QImage withoutOutline = myWidget.grab().toImage();
+
+        myWidget.setOutlineColorSpace(m_rgbColorSpace);
+        QCOMPARE(myWidget.outlineColorSpace(), m_rgbColorSpace);
+        myWidget.setCurrentColor(LchDouble(50, 20, 0));
+        const QPolygonF outline = myWidget.d_pointer->outlinePolyline();
+        const QSharedPointer<const ChromaLightnessBoundary> boundary = m_rgbColorSpace->chromaLightnessBoundary(0);
+        int inGamutRowCount = 0;
+        for (const qreal chroma : boundary->maximumChroma) {
+            if (chroma >= 0) {
+                ++inGamutRowCount;
+            }
+        }
+        // One point per in-gamut row, plus start and end on the gray axis
+        QCOMPARE(outline.count(), inGamutRowCount + 2);
+        const qreal grayAxis = myWidget.d_pointer->leftBorderPhysical();
+        QCOMPARE(outline.first().x(), grayAxis);
+        QCOMPARE(outline.last().x(), grayAxis);
+        // From top (high lightness) to bottom (low lightness)
+        QVERIFY(outline.first().y() < outline.last().y());
+        QVERIFY(myWidget.grab().toImage() != withoutOutline);
+
+        // Between the hue steps, the outline is interpolated. It lies
+        // between the outlines of the neighboring hues.
+        myWidget.setCurrentColor(LchDouble(50, 20, 0.5));
+        const QPolygonF interpolated = myWidget.d_pointer->outlinePolyline();
+        QCOMPARE(interpolated.count(), outline.count());
+        myWidget.setCurrentColor(LchDouble(50, 20, 1));
+        const QPolygonF upperOutline = myWidget.d_pointer->outlinePolyline();
+        for (int i = 0; i < interpolated.count(); ++i) {
+            const qreal minimum = qMin(outline.at(i).x(), upperOutline.at(i).x());
+            const qreal maximum = qMax(outline.at(i).x(), upperOutline.at(i).x());
+            QVERIFY(interpolated.at(i).x() >= minimum - 0.01);
+            QVERIFY(interpolated.at(i).x() <= maximum + 0.01);
+        }
+
+        myWidget.setOutlineColorSpace(nullptr);
+        QVERIFY(myWidget.d_pointer->outlinePolyline().isEmpty());
+    }
 };
 
 } // namespace PerceptualColor
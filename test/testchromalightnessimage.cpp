@@ -32,10 +32,13 @@
 #include "chromalightnessimage.h"
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "diagramimagecache.h"
 #include "helper.h"
 
 #include <QtTest>
 
+#include <lcms2.h>
+
 namespace PerceptualColor
 {
 class TestChromaLightnessImage : public QObject
@@ -154,6 +157,54 @@ private Q_SLOTS:
                  " if the value that was set is the same than before.");
     }
 
+    void testSharedCache()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        ChromaLightnessImage first(colorSpace);
+        first.setImageSize(QSize(60, 40));
+        first.setHue(30);
+        const QImage firstImage = first.getImage();
+        // Another object with the same properties uses the image of the
+        // cache of the color space.
+        ChromaLightnessImage second(colorSpace);
+        second.setImageSize(QSize(60, 40));
+        second.setHue(30);
+        QCOMPARE(second.getImage().cacheKey(), firstImage.cacheKey());
+        // Smaller sizes with the same aspect ratio are derived.
+        second.setImageSize(QSize(30, 20));
+        QCOMPARE(second.getImage().size(), QSize(30, 20));
+        QCOMPARE(colorSpace->diagramImageCache()->m_imageCache.count(), 0);
+        // Exact rendering does not derive, but caches the image for
+        // its own size.
+        second.setExactRendering(true);
+        QCOMPARE(second.getImage().size(), QSize(30, 20));
+        QCOMPARE(colorSpace->diagramImageCache()->m_imageCache.count(), 1);
+        // Other properties do not share the image.
+        second.setImageSize(QSize(60, 40));
+        second.setHue(31);
+        QVERIFY(second.getImage().cacheKey() != firstImage.cacheKey());
+    }
+
+    void testColorModel()
+    {
+        ChromaLightnessImage test(m_rgbColorSpace);
+        test.setImageSize(QSize(50, 25)); // Set a non-zero image size
+        test.setHue(150);
+        const QImage cielchImage = test.getImage();
+        test.setColorModel(ColorModel::CielchD50);
+        QVERIFY2(!test.m_image.isNull(), "Setting the same color model should not erease the cache.");
+        test.setColorModel(ColorModel::OklchD65);
+        QVERIFY2(test.m_image.isNull(), "Setting another color model should erease the cache.");
+        const QImage oklchImage = test.getImage();
+        QCOMPARE(oklchImage.size(), QSize(50, 25));
+        // Pixel at the gray axis at medium lightness is in-gamut
+        // in both models.
+        QVERIFY(oklchImage.pixelColor(0, 12).alpha() == 255);
+        QVERIFY(cielchImage.pixelColor(0, 12).alpha() == 255);
+        // The same hue angle means a different hue in both models.
+        QVERIFY(oklchImage != cielchImage);
+    }
+
     void testSetHue_data()
     {
         QTest::addColumn<qreal>("hue");
@@ -191,6 +242,56 @@ private Q_SLOTS:
         test.setHue(250);
         Q_UNUSED(test.getImage());
     }
+
+    void testGamutMatchesColorSpace()
+    {
+        // Pixels are skipped beyond the estimated gamut boundary. Make
+        // sure that no in-gamut pixel is lost.
+        ChromaLightnessImage test(m_rgbColorSpace);
+        test.setImageSize(QSize(150, 100));
+        test.setBackgroundColor(Qt::transparent);
+        for (const qreal hue : {0.0, 100.0, 250.0, 300.0}) {
+            test.setHue(hue);
+            const QImage image = test.getImage();
+            for (int y = 0; y < image.height(); ++y) {
+                for (int x = 0; x < image.width(); ++x) {
+                    const LchDouble lch(100 - (y + 0.5) * 100.0 / image.height(), (x + 0.5) * 100.0 / image.height(), hue);
+                    QCOMPARE(qAlpha(image.pixel(x, y)) == 255, m_rgbColorSpace->toQColorRgbUnbound(lch).isValid());
+                }
+            }
+        }
+    }
+
+    void testDisplayProfile()
+    {
+        // Raw data of an sRGB profile
+        cmsHPROFILE profileHandle = cmsCreate_sRGBProfile();
+        cmsUInt32Number size = 0;
+        cmsSaveProfileToMem(profileHandle, nullptr, &size);
+        QByteArray profileData(static_cast<int>(size), 0);
+        cmsSaveProfileToMem(profileHandle, profileData.data(), &size);
+        cmsCloseProfile(profileHandle);
+
+        ChromaLightnessImage test(m_rgbColorSpace);
+        test.setImageSize(QSize(50, 50));
+        test.setHue(120);
+        const QImage withoutProfile = test.getImage();
+        test.setDisplayProfile(profileData);
+        const QImage withProfile = test.getImage();
+        // The display profile is sRGB like the color space, so the image
+        // is (nearly) the same.
+        QCOMPARE(withProfile.size(), withoutProfile.size());
+        for (int y = 0; y < withProfile.height(); ++y) {
+            for (int x = 0; x < withProfile.width(); ++x) {
+                const QRgb expected = withoutProfile.pixel(x, y);
+                const QRgb actual = withProfile.pixel(x, y);
+                QCOMPARE(qAlpha(actual), qAlpha(expected));
+                QVERIFY(qAbs(qRed(actual) - qRed(expected)) <= 1);
+                QVERIFY(qAbs(qGreen(actual) - qGreen(expected)) <= 1);
+                QVERIFY(qAbs(qBlue(actual) - qBlue(expected)) <= 1);
+            }
+        }
+    }
 };
 
 } // namespace PerceptualColor
@@ -35,6 +35,7 @@
 
 #include <QPointer>
 #include <QScopedPointer>
+#include <QTemporaryDir>
 #include <QtTest>
 
 #include "PerceptualColor/multispinbox.h"
@@ -1061,6 +1062,29 @@ private Q_SLOTS:
         QCOMPARE(myDialog->d_pointer->m_currentOpaqueColor.toLch().c, 12);
     }
 
+    void testReadOklchNumericValues()
+    {
+        QScopedPointer<ColorDialog> myDialog(new PerceptualColor::ColorDialog(m_srgbBuildinColorSpace));
+        // An in-gamut value, so that no gamut correction happens
+        const QList<double> myValues {60, 10, 150};
+        myDialog->d_pointer->m_oklchSpinBox->setSectionValues(myValues);
+        myDialog->d_pointer->readOklchNumericValues();
+        const LchDouble oklch = myDialog->d_pointer->m_currentOpaqueColor.toOklch();
+        QVERIFY(qAbs(oklch.l - 60) < 0.01);
+        QVERIFY(qAbs(oklch.c - 10) < 0.01);
+        QVERIFY(qAbs(oklch.h - 150) < 0.01);
+    }
+
+    void testUpdateOklch()
+    {
+        QScopedPointer<ColorDialog> myDialog(new PerceptualColor::ColorDialog(m_srgbBuildinColorSpace));
+        myDialog->setCurrentColor(Qt::white);
+        const QList<double> myValues = myDialog->d_pointer->m_oklchSpinBox->sectionValues();
+        QCOMPARE(myValues.count(), 3);
+        QVERIFY(qAbs(myValues.at(0) - 100) < 0.5);
+        QVERIFY(qAbs(myValues.at(1)) < 0.05);
+    }
+
     void testReadHsvNumericValues()
     {
         QScopedPointer<ColorDialog> myDialog(new PerceptualColor::ColorDialog(m_srgbBuildinColorSpace));
@@ -1449,6 +1473,46 @@ private Q_SLOTS:
         QCOMPARE(actualHex, expectedHex);
     }
 
+    void testLoadPalette()
+    {
+        m_perceptualDialog.reset(new PerceptualColor::ColorDialog(m_srgbBuildinColorSpace));
+        const int tabCount = m_perceptualDialog->d_pointer->m_tabWidget->count();
+
+        // Invalid files are refused without changing the dialog.
+        QVERIFY(!m_perceptualDialog->loadPalette(QStringLiteral("/nonexistent/palette.gpl")));
+        QVERIFY(m_perceptualDialog->d_pointer->m_paletteModel.isNull());
+        QCOMPARE(m_perceptualDialog->d_pointer->m_tabWidget->count(), tabCount);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("test.gpl"));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("GIMP Palette\n"
+                   "Name: Test\n"
+                   "255   0   0 Red\n"
+                   "  0   0 255 Blue\n");
+        file.close();
+
+        // A valid palette adds a tab with its colors.
+        QVERIFY(m_perceptualDialog->loadPalette(fileName));
+        QCOMPARE(m_perceptualDialog->d_pointer->m_tabWidget->count(), tabCount + 1);
+        QCOMPARE(m_perceptualDialog->d_pointer->m_paletteModel->rowCount(), 2);
+
+        // Loading again replaces the colors instead of adding another tab.
+        QVERIFY(m_perceptualDialog->loadPalette(fileName));
+        QCOMPARE(m_perceptualDialog->d_pointer->m_tabWidget->count(), tabCount + 1);
+        QCOMPARE(m_perceptualDialog->d_pointer->m_paletteModel->rowCount(), 2);
+
+        // Choosing an entry changes the current color.
+        const QModelIndex blueIndex = m_perceptualDialog->d_pointer->m_paletteModel->index(1);
+        m_perceptualDialog->d_pointer->readPaletteValue(blueIndex);
+        QCOMPARE(m_perceptualDialog->currentColor().name(), QStringLiteral("#0000ff"));
+        const QModelIndex redIndex = m_perceptualDialog->d_pointer->m_paletteModel->index(0);
+        m_perceptualDialog->d_pointer->readPaletteValue(redIndex);
+        QCOMPARE(m_perceptualDialog->currentColor().name(), QStringLiteral("#ff0000"));
+    }
+
     void testSnippet02()
     {
         snippet02();
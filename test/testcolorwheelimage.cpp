@@ -34,6 +34,7 @@
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "lchvalues.h"
 
 class TestColorWheelSnippetClass : public QWidget
 {
@@ -233,6 +234,30 @@ private Q_SLOTS:
                  "null.");
     }
 
+    void testColors()
+    {
+        ColorWheelImage test(colorSpace);
+        test.setImageSize(101);
+        test.setBorder(0);
+        test.setWheelThickness(20);
+        const QImage image = test.getImage();
+        // Pixels in the middle of the wheel, far from the anti-aliased
+        // outlines: On the right is hue 0, on the top hue 90.
+        const QColor right = colorSpace->toQColorRgbUnbound( //
+            LchDouble(LchValues::neutralLightness, LchValues::srgbVersatileChroma, 0));
+        const QColor top = colorSpace->toQColorRgbUnbound( //
+            LchDouble(LchValues::neutralLightness, LchValues::srgbVersatileChroma, 90));
+        const auto isSimilar = [](const QColor &first, const QColor &second) {
+            return (qAbs(first.red() - second.red()) <= 1) //
+                && (qAbs(first.green() - second.green()) <= 1) //
+                && (qAbs(first.blue() - second.blue()) <= 1);
+        };
+        QVERIFY(isSimilar(image.pixelColor(90, 50), right));
+        QVERIFY(isSimilar(image.pixelColor(50, 10), top));
+        // The center is transparent.
+        QCOMPARE(image.pixelColor(50, 50).alpha(), 0);
+    }
+
     void testVeryThickWheel()
     {
         ColorWheelImage test(colorSpace);
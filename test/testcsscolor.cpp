@@ -0,0 +1,326 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "csscolor.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestCssColor : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestCssColor(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    static constexpr double tolerance = 0.001;
+
+    static QString formatted(const CssColor::Value &value, CssColor::Syntax syntax)
+    {
+        char buffer[CssColor::maximumFormattedLength + 1];
+        const int length = CssColor::format(value, syntax, buffer);
+        return QString::fromLatin1(buffer, length);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testParseHex_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::addColumn<int>("red");
+        QTest::addColumn<int>("green");
+        QTest::addColumn<int>("blue");
+        QTest::addColumn<int>("alpha");
+        QTest::newRow("#rgb") << QStringLiteral("#f80") << 255 << 136 << 0 << 255;
+        QTest::newRow("#rgba") << QStringLiteral("#f808") << 255 << 136 << 0 << 136;
+        QTest::newRow("#rrggbb") << QStringLiteral("#1A2b3C") << 26 << 43 << 60 << 255;
+        QTest::newRow("#rrggbbaa") << QStringLiteral("#1a2b3c80") << 26 << 43 << 60 << 128;
+        QTest::newRow("whitespace") << QStringLiteral("  #000000\t") << 0 << 0 << 0 << 255;
+    }
+
+    void testParseHex()
+    {
+        QFETCH(QString, text);
+        QFETCH(int, red);
+        QFETCH(int, green);
+        QFETCH(int, blue);
+        QFETCH(int, alpha);
+        CssColor::Value value;
+        QVERIFY(CssColor::parse(QStringView(text), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Hex);
+        QCOMPARE(qRound(value.rgb.red * 255), red);
+        QCOMPARE(qRound(value.rgb.green * 255), green);
+        QCOMPARE(qRound(value.rgb.blue * 255), blue);
+        QCOMPARE(qRound(value.alpha * 255), alpha);
+    }
+
+    void testParseHexWithoutHash()
+    {
+        CssColor::Value value;
+        QVERIFY(CssColor::parseHex(QStringView(u"1a2b3c"), &value));
+        QCOMPARE(qRound(value.rgb.red * 255), 26);
+        QVERIFY(CssColor::parseHex(QStringView(u"#1a2b3c"), &value));
+        QCOMPARE(qRound(value.rgb.blue * 255), 60);
+        QVERIFY(!CssColor::parseHex(QStringView(u"rgb(0 0 0)"), &value));
+        QVERIFY(!CssColor::parseHex(QStringView(u"1a2b3"), &value));
+        // parse() requires the leading “#”
+        QVERIFY(!CssColor::parse(QStringView(u"1a2b3c"), &value));
+    }
+
+    void testParseHexLikeQColor()
+    {
+        // parseHex() reads the digits like QColor::setNamedColor(), which
+        // the color dialog has used before. 8 digits are #AARRGGBB.
+        const QString texts[] = {QStringLiteral("#123"),
+                                 QStringLiteral("#1a2b3c"),
+                                 QStringLiteral("#801a2b3c"),
+                                 QStringLiteral("#1a02b03c0"),
+                                 QStringLiteral("#1a002b003c00")};
+        for (const QString &text : texts) {
+            CssColor::Value value;
+            QVERIFY2(CssColor::parseHex(QStringView(text), &value), qPrintable(text));
+            QColor expected;
+            expected.setNamedColor(text);
+            QVERIFY(expected.isValid());
+            QCOMPARE(qRound(value.rgb.red * 255), expected.red());
+            QCOMPARE(qRound(value.rgb.green * 255), expected.green());
+            QCOMPARE(qRound(value.rgb.blue * 255), expected.blue());
+            QCOMPARE(qRound(value.alpha * 255), expected.alpha());
+        }
+        CssColor::Value value;
+        QVERIFY(CssColor::parseHex(QStringView(u"#801a2b3c"), &value));
+        QCOMPARE(qRound(value.rgb.red * 255), 0x1a);
+        QCOMPARE(qRound(value.alpha * 255), 0x80);
+        // QColor does not accept 4 digits.
+        QVERIFY(!CssColor::parseHex(QStringView(u"#1234"), &value));
+        // parse() follows CSS instead: 8 digits are #RRGGBBAA.
+        QVERIFY(CssColor::parse(QStringView(u"#801a2b3c"), &value));
+        QCOMPARE(qRound(value.rgb.red * 255), 0x80);
+        QCOMPARE(qRound(value.alpha * 255), 0x3c);
+    }
+
+    void testHugeNumbers()
+    {
+        CssColor::Value value;
+        // Overflow to infinity is rejected.
+        QVERIFY(!CssColor::parse(QStringView(u"lab(1e400 0 0)"), &value));
+        QVERIFY(!CssColor::parse(QStringView(u"lab(-1e400 0 0)"), &value));
+        // Huge finite numbers are clamped.
+        QVERIFY(CssColor::parse(QStringView(u"lab(50 1e300 0)"), &value));
+        QVERIFY(qIsFinite(value.lab.a));
+        QVERIFY(value.lab.a <= 1e9);
+        // The formatter does not overflow.
+        QVERIFY(!formatted(value, CssColor::Syntax::Lab).isEmpty());
+        CssColor::Value invalid;
+        invalid.syntax = CssColor::Syntax::Lab;
+        invalid.lab = cmsCIELab {qInf(), qQNaN(), -1e300};
+        QCOMPARE(formatted(invalid, CssColor::Syntax::Lab), QStringLiteral("lab(0 0 -1000000000)"));
+        invalid.syntax = CssColor::Syntax::Rgb;
+        invalid.rgb = RgbDouble {qInf(), qQNaN(), -qInf()};
+        QCOMPARE(formatted(invalid, CssColor::Syntax::Rgb), QStringLiteral("rgb(0 0 0)"));
+    }
+
+    void testParseFunctions()
+    {
+        CssColor::Value value;
+
+        QVERIFY(CssColor::parse(QStringView(u"rgb(255 0 0 / 50%)"), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Rgb);
+        QCOMPARE(value.rgb.red, 1.0);
+        QCOMPARE(value.rgb.green, 0.0);
+        QCOMPARE(value.alpha, 0.5);
+
+        QVERIFY(CssColor::parse(QStringView(u"RGBA(100%, 50%, 0%, 0.25)"), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Rgb);
+        QCOMPARE(value.rgb.green, 0.5);
+        QCOMPARE(value.alpha, 0.25);
+
+        QVERIFY(CssColor::parse(QStringView(u"hsl(120deg 100% 50%)"), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Hsl);
+        QVERIFY(qAbs(value.rgb.red - 0) < tolerance);
+        QVERIFY(qAbs(value.rgb.green - 1) < tolerance);
+        QVERIFY(qAbs(value.rgb.blue - 0) < tolerance);
+
+        QVERIFY(CssColor::parse(QStringView(u"hsl(0.5turn, 100%, 50%)"), &value));
+        QVERIFY(qAbs(value.rgb.red - 0) < tolerance);
+        QVERIFY(qAbs(value.rgb.green - 1) < tolerance);
+        QVERIFY(qAbs(value.rgb.blue - 1) < tolerance);
+
+        QVERIFY(CssColor::parse(QStringView(u"lab(50% -20 1e1)"), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Lab);
+        QCOMPARE(value.lab.L, 50.0);
+        QCOMPARE(value.lab.a, -20.0);
+        QCOMPARE(value.lab.b, 10.0);
+
+        QVERIFY(CssColor::parse(QStringView(u"lch(50 30 none)"), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Lch);
+        QVERIFY(qAbs(value.lab.a - 30) < tolerance);
+        QVERIFY(qAbs(value.lab.b - 0) < tolerance);
+    }
+
+    void testParseChar()
+    {
+        const char text[] = "lch(50% 100% 90deg / .5)";
+        CssColor::Value value;
+        QVERIFY(CssColor::parse(text, static_cast<int>(qstrlen(text)), &value));
+        QCOMPARE(value.syntax, CssColor::Syntax::Lch);
+        QVERIFY(qAbs(value.lab.L - 50) < tolerance);
+        QVERIFY(qAbs(value.lab.a - 0) < tolerance);
+        QVERIFY(qAbs(value.lab.b - 150) < tolerance);
+        QCOMPARE(value.alpha, 0.5);
+    }
+
+    void testParseInvalid_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::newRow("empty") << QString();
+        QTest::newRow("named color") << QStringLiteral("red");
+        QTest::newRow("five hex digits") << QStringLiteral("#12345");
+        QTest::newRow("nine hex digits") << QStringLiteral("#123456789");
+        QTest::newRow("missing parenthesis") << QStringLiteral("rgb(0 0 0");
+        QTest::newRow("space before parenthesis") << QStringLiteral("rgb (0 0 0)");
+        QTest::newRow("missing component") << QStringLiteral("rgb(0 0)");
+        QTest::newRow("mixed separators") << QStringLiteral("rgb(0, 0 0)");
+        QTest::newRow("angle for rgb") << QStringLiteral("rgb(0deg 0 0)");
+        QTest::newRow("percent for hue") << QStringLiteral("lch(50 30 10%)");
+        QTest::newRow("trailing garbage") << QStringLiteral("#000 x");
+        QTest::newRow("unknown unit") << QStringLiteral("lab(50px 0 0)");
+    }
+
+    void testParseInvalid()
+    {
+        QFETCH(QString, text);
+        CssColor::Value value;
+        value.alpha = 0.75;
+        QVERIFY(!CssColor::parse(QStringView(text), &value));
+        // On failure, the result is not changed.
+        QCOMPARE(value.alpha, 0.75);
+    }
+
+    void testFormat()
+    {
+        CssColor::Value value;
+        value.syntax = CssColor::Syntax::Rgb;
+        value.rgb = RgbDouble {1, 0.5, 0};
+        QCOMPARE(formatted(value, CssColor::Syntax::Hex), QStringLiteral("#FF8000"));
+        QCOMPARE(formatted(value, CssColor::Syntax::Rgb), QStringLiteral("rgb(255 128 0)"));
+        QCOMPARE(formatted(value, CssColor::Syntax::Hsl), QStringLiteral("hsl(30 100% 50%)"));
+        // Lab syntax is not available for RGB-based values.
+        QCOMPARE(formatted(value, CssColor::Syntax::Lab), QString());
+
+        value.alpha = 0.5;
+        QCOMPARE(formatted(value, CssColor::Syntax::Hex), QStringLiteral("#FF800080"));
+        QCOMPARE(formatted(value, CssColor::Syntax::Rgb), QStringLiteral("rgb(255 128 0 / 0.5)"));
+
+        CssColor::Value labValue;
+        labValue.syntax = CssColor::Syntax::Lab;
+        labValue.lab = cmsCIELab {50, -20.125, 0};
+        QCOMPARE(formatted(labValue, CssColor::Syntax::Lab), QStringLiteral("lab(50 -20.13 0)"));
+        QCOMPARE(formatted(labValue, CssColor::Syntax::Lch), QStringLiteral("lch(50 20.13 180)"));
+        QCOMPARE(formatted(labValue, CssColor::Syntax::Hex), QString());
+    }
+
+    void testRoundTrip_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::newRow("hex") << QStringLiteral("#1A2B3C");
+        QTest::newRow("hex with alpha") << QStringLiteral("#1A2B3C4D");
+        QTest::newRow("rgb") << QStringLiteral("rgb(1 2 3 / 0.5)");
+        QTest::newRow("lab") << QStringLiteral("lab(12.5 -3 4.25)");
+        QTest::newRow("lch") << QStringLiteral("lch(12.5 30 40)");
+    }
+
+    void testRoundTrip()
+    {
+        QFETCH(QString, text);
+        CssColor::Value value;
+        QVERIFY(CssColor::parse(QStringView(text), &value));
+        QCOMPARE(formatted(value, value.syntax), text);
+    }
+
+    void testLchaConversion()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        const LchaDouble color(50, 20, 30, 0.5);
+
+        const CssColor::Value lchValue = //
+            CssColor::fromLcha(colorSpace, color, CssColor::Syntax::Lch);
+        QCOMPARE(lchValue.syntax, CssColor::Syntax::Lch);
+        const LchaDouble lchResult = CssColor::toLcha(colorSpace, lchValue);
+        QVERIFY(qAbs(lchResult.l - color.l) < tolerance);
+        QVERIFY(qAbs(lchResult.c - color.c) < tolerance);
+        QVERIFY(qAbs(lchResult.h - color.h) < tolerance);
+        QCOMPARE(lchResult.a, 0.5);
+
+        const CssColor::Value rgbValue = //
+            CssColor::fromLcha(colorSpace, color, CssColor::Syntax::Hex);
+        QVERIFY(rgbValue.isRgbBased());
+        const LchaDouble rgbResult = CssColor::toLcha(colorSpace, rgbValue);
+        // Limited by the 16-bit precision of QColor
+        QVERIFY(qAbs(rgbResult.l - color.l) < 0.1);
+        QVERIFY(qAbs(rgbResult.c - color.c) < 0.1);
+        QVERIFY(qAbs(rgbResult.h - color.h) < 0.1);
+        QCOMPARE(rgbResult.a, 0.5);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestCssColor)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testcsscolor.moc"
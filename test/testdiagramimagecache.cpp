@@ -0,0 +1,163 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "diagramimagecache.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestDiagramImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDiagramImageCache(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief A uniform image.
+     * @param size The size of the image
+     * @returns A uniform image of the given size */
+    static QImage uniformImage(const QSize &size)
+    {
+        QImage result(size, QImage::Format_ARGB32_Premultiplied);
+        result.fill(QColor(10, 100, 200));
+        return result;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testIsDerivable()
+    {
+        QVERIFY(DiagramImageCache::isDerivable(QSize(100, 100), QSize(100, 100)));
+        QVERIFY(DiagramImageCache::isDerivable(QSize(100, 100), QSize(30, 30)));
+        QVERIFY(DiagramImageCache::isDerivable(QSize(300, 200), QSize(100, 67)));
+        QVERIFY(!DiagramImageCache::isDerivable(QSize(100, 100), QSize(101, 101)));
+        QVERIFY(!DiagramImageCache::isDerivable(QSize(300, 200), QSize(100, 100)));
+        QVERIFY(!DiagramImageCache::isDerivable(QSize(), QSize(10, 10)));
+    }
+
+    void testNotScalable()
+    {
+        DiagramImageCache cache;
+        const QString key = QStringLiteral("key");
+        const QImage image = uniformImage(QSize(40, 40));
+        cache.insert(key, image, false);
+        QCOMPARE(cache.m_imageCache.count(), 1);
+        QCOMPARE(cache.m_pyramidCache.count(), 0);
+        QCOMPARE(cache.find(key, QSize(40, 40), false).cacheKey(), image.cacheKey());
+        // Not derived, neither if the request allows it.
+        QVERIFY(cache.find(key, QSize(20, 20), true).isNull());
+        QVERIFY(cache.find(QStringLiteral("other"), QSize(40, 40), false).isNull());
+    }
+
+    void testPyramid()
+    {
+        DiagramImageCache cache;
+        const QString key = QStringLiteral("key");
+        const QImage image = uniformImage(QSize(40, 20));
+        cache.insert(key, image, true);
+        QCOMPARE(cache.m_pyramidCache.count(), 1);
+        QCOMPARE(cache.m_imageCache.count(), 0);
+        // The same size without copy, and without creating the levels
+        QCOMPARE(cache.find(key, QSize(40, 20), true).cacheKey(), image.cacheKey());
+        QVERIFY(cache.m_pyramidCache.value(key)->m_levels.isEmpty());
+        // Smaller sizes are derived…
+        QCOMPARE(cache.find(key, QSize(20, 10), true).size(), QSize(20, 10));
+        QVERIFY(!cache.m_pyramidCache.value(key)->m_levels.isEmpty());
+        // …but only if requested.
+        QVERIFY(cache.find(key, QSize(20, 10), false).isNull());
+        // Other aspect ratios and bigger sizes cannot be derived.
+        QVERIFY(cache.find(key, QSize(20, 20), true).isNull());
+        QVERIFY(cache.find(key, QSize(80, 40), true).isNull());
+
+        // A bigger image replaces the pyramid.
+        cache.insert(key, uniformImage(QSize(80, 40)), true);
+        QCOMPARE(cache.m_pyramidCache.count(), 1);
+        QCOMPARE(cache.m_pyramidCache.value(key)->baseSize(), QSize(80, 40));
+        QCOMPARE(cache.m_imageCache.count(), 0);
+    }
+
+    void testNotDerivableIsCached()
+    {
+        DiagramImageCache cache;
+        const QString key = QStringLiteral("key");
+        cache.insert(key, uniformImage(QSize(80, 40)), true);
+        // A smaller image with another aspect ratio cannot replace the
+        // pyramid, so it is cached for its own size.
+        const QImage square = uniformImage(QSize(30, 30));
+        cache.insert(key, square, true);
+        QCOMPARE(cache.m_pyramidCache.value(key)->baseSize(), QSize(80, 40));
+        QCOMPARE(cache.m_imageCache.count(), 1);
+        QCOMPARE(cache.find(key, QSize(30, 30), true).cacheKey(), square.cacheKey());
+    }
+
+    void testClear()
+    {
+        DiagramImageCache cache;
+        cache.insert(QStringLiteral("a"), uniformImage(QSize(10, 10)), true);
+        cache.insert(QStringLiteral("b"), uniformImage(QSize(10, 10)), false);
+        cache.insert(QStringLiteral("c"), QImage(), false);
+        QCOMPARE(cache.m_pyramidCache.count(), 1);
+        QCOMPARE(cache.m_imageCache.count(), 1);
+        cache.clear();
+        QCOMPARE(cache.m_pyramidCache.count(), 0);
+        QCOMPARE(cache.m_imageCache.count(), 0);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestDiagramImageCache)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testdiagramimagecache.moc"
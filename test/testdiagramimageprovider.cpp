@@ -0,0 +1,323 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/diagramimageprovider.h"
+
+#include "diagramimageprovider_p.h"
+
+#include "diagramimagecache.h"
+
+#include <QQuickTextureFactory>
+#include <QtTest>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @brief The raw data of an ICC profile with sRGB primaries.
+ *
+ * @param gamma The gamma of the tone curves
+ * @returns The raw data of the profile */
+static QByteArray rgbProfileData(double gamma)
+{
+    cmsToneCurve *curve = cmsBuildGamma(nullptr, gamma);
+    cmsToneCurve *curves[3] = {curve, curve, curve};
+    const cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    const cmsCIExyYTRIPLE primaries {{0.64, 0.33, 1}, {0.30, 0.60, 1}, {0.15, 0.06, 1}};
+    cmsHPROFILE profileHandle = cmsCreateRGBProfile(&whitePoint, &primaries, curves);
+    cmsFreeToneCurve(curve);
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profileHandle, nullptr, &size);
+    QByteArray result(static_cast<int>(size), 0);
+    cmsSaveProfileToMem(profileHandle, result.data(), &size);
+    cmsCloseProfile(profileHandle);
+    return result;
+}
+
+class TestDiagramImageProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDiagramImageProvider(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief Requests an image and waits for the response.
+     * @param provider The provider
+     * @param id The image identifier
+     * @param requestedSize The requested size
+     * @returns The finished response */
+    static QSharedPointer<DiagramImageResponse> request(DiagramImageProvider &provider, const QString &id, const QSize &requestedSize)
+    {
+        QSharedPointer<DiagramImageResponse> response( //
+            static_cast<DiagramImageResponse *>(provider.requestImageResponse(id, requestedSize)));
+        provider.d_pointer->m_threadPool.waitForDone();
+        return response;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testDiagramTypes_data()
+    {
+        QTest::addColumn<QString>("id");
+        QTest::addColumn<QSize>("requestedSize");
+        QTest::addColumn<QSize>("expectedSize");
+        QTest::newRow("chromahue") << QStringLiteral("chromahue?lightness=30") << QSize(100, 100) << QSize(100, 100);
+        QTest::newRow("chromahue default size") << QStringLiteral("chromahue") << QSize() << QSize(256, 256);
+        QTest::newRow("chromalightness") << QStringLiteral("chromalightness?hue=120&model=oklch") << QSize(80, 60) << QSize(80, 60);
+        QTest::newRow("colorwheel") << QStringLiteral("colorwheel?thickness=10") << QSize(100, -1) << QSize(100, 100);
+        QTest::newRow("gradient") << QStringLiteral("gradient?first=%23FF0000&second=lch(50%2030%20120)") << QSize(120, 10) << QSize(120, 10);
+    }
+
+    void testDiagramTypes()
+    {
+        QFETCH(QString, id);
+        QFETCH(QSize, requestedSize);
+        QFETCH(QSize, expectedSize);
+        DiagramImageProvider provider(RgbColorSpaceFactory::createSrgb());
+        const auto response = request(provider, id, requestedSize);
+        QCOMPARE(response->errorString(), QString());
+        QCOMPARE(response->m_image.size(), expectedSize);
+        QScopedPointer<QQuickTextureFactory> factory(response->textureFactory());
+        QVERIFY(!factory.isNull());
+    }
+
+    void testUnknownType()
+    {
+        DiagramImageProvider provider(RgbColorSpaceFactory::createSrgb());
+        const auto response = request(provider, QStringLiteral("unknown"), QSize(10, 10));
+        QVERIFY(response->m_image.isNull());
+        QVERIFY(!response->errorString().isEmpty());
+    }
+
+    void testCache()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        const DiagramImageCache *const cache = colorSpace->diagramImageCache();
+        DiagramImageProvider provider(colorSpace);
+        // Colorwheels do not scale because the thickness is measured
+        // in pixels.
+        const QString id = QStringLiteral("colorwheel?thickness=10");
+        const auto first = request(provider, id, QSize(50, 50));
+        QCOMPARE(cache->m_imageCache.count(), 1);
+        const auto second = request(provider, id, QSize(50, 50));
+        QCOMPARE(cache->m_imageCache.count(), 1);
+        // Implicit sharing: The cached image is returned without rendering.
+        QCOMPARE(first->m_image.cacheKey(), second->m_image.cacheKey());
+        request(provider, id, QSize(40, 40));
+        QCOMPARE(cache->m_imageCache.count(), 2);
+        QCOMPARE(cache->m_pyramidCache.count(), 0);
+
+        // Size parameters are not part of the key.
+        using Private = DiagramImageProvider::DiagramImageProviderPrivate;
+        QCOMPARE(Private::cacheKey(QStringLiteral("gradient?first=red&width=30")), //
+                 Private::cacheKey(QStringLiteral("gradient?first=red&height=20")));
+    }
+
+    void testPyramidCache()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        const DiagramImageCache *const cache = colorSpace->diagramImageCache();
+        DiagramImageProvider provider(colorSpace);
+        const QString id = QStringLiteral("chromahue?lightness=70");
+        const auto first = request(provider, id, QSize(50, 50));
+        QCOMPARE(cache->m_pyramidCache.count(), 1);
+        const auto second = request(provider, id, QSize(50, 50));
+        // Implicit sharing: The cached image is returned without rendering.
+        QCOMPARE(first->m_image.cacheKey(), second->m_image.cacheKey());
+
+        // A bigger size is rendered and replaces the pyramid.
+        const auto bigger = request(provider, id, QSize(60, 60));
+        QCOMPARE(cache->m_pyramidCache.count(), 1);
+
+        // A smaller size is derived from the pyramid.
+        const auto derived = request(provider, id, QSize(30, 30));
+        QCOMPARE(derived->m_image.size(), QSize(30, 30));
+        QCOMPARE(cache->m_pyramidCache.count(), 1);
+        QCOMPARE(cache->m_imageCache.count(), 0);
+        // The base size is still available without rendering.
+        QCOMPARE(request(provider, id, QSize(60, 60))->m_image.cacheKey(), //
+                 bigger->m_image.cacheKey());
+
+        // Exact requests are rendered directly. The result is cached
+        // for its own size, because the pyramid is bigger.
+        request(provider, id + QStringLiteral("&exact=1"), QSize(30, 30));
+        QCOMPARE(cache->m_imageCache.count(), 1);
+        QCOMPARE(cache->m_pyramidCache.count(), 1);
+    }
+
+    void testPyramidQuality()
+    {
+        DiagramImageProvider provider(RgbColorSpaceFactory::createSrgb());
+        const QString id = QStringLiteral("chromalightness?hue=200");
+        const QImage exact = request(provider, id + QStringLiteral("&exact=1"), QSize(64, 48))->m_image;
+        request(provider, id, QSize(256, 192));
+        const QImage derived = request(provider, id, QSize(64, 48))->m_image;
+        QCOMPARE(derived.size(), exact.size());
+        QCOMPARE(derived.format(), exact.format());
+        // Apart from the anti-aliasing at the gamut boundary, the
+        // derived image is like a direct rendering.
+        int differentPixels = 0;
+        for (int y = 0; y < exact.height(); ++y) {
+            for (int x = 0; x < exact.width(); ++x) {
+                const QRgb a = exact.pixel(x, y);
+                const QRgb b = derived.pixel(x, y);
+                const int difference = qMax( //
+                    qMax(qAbs(qRed(a) - qRed(b)), qAbs(qGreen(a) - qGreen(b))),
+                    qMax(qAbs(qBlue(a) - qBlue(b)), qAbs(qAlpha(a) - qAlpha(b))));
+                if (difference > 3) {
+                    ++differentPixels;
+                }
+            }
+        }
+        // Only a small part of the pixels is at the boundary.
+        QVERIFY(differentPixels < exact.width() * exact.height() / 8);
+    }
+
+    void testCancel()
+    {
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        DiagramImageProvider provider(colorSpace);
+        // Occupy the only worker thread, so that the request is
+        // canceled before it starts.
+        provider.d_pointer->m_threadPool.setMaxThreadCount(1);
+        provider.d_pointer->m_threadPool.reserveThread();
+        QScopedPointer<QQuickImageResponse> response( //
+            provider.requestImageResponse(QStringLiteral("colorwheel"), QSize(100, 100)));
+        QSignalSpy spy(response.data(), &QQuickImageResponse::finished);
+        response->cancel();
+        provider.d_pointer->m_threadPool.releaseThread();
+        provider.d_pointer->m_threadPool.waitForDone();
+        // A canceled response must nevertheless emit finished().
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(static_cast<DiagramImageResponse *>(response.data())->m_image.isNull());
+        // The canceled image has not been cached.
+        QCOMPARE(colorSpace->diagramImageCache()->m_imageCache.count(), 0);
+    }
+
+    void testCancelDuringRendering()
+    {
+        // The renderers that cache themselves check the cancel flag
+        // while rendering, and do not cache incomplete images.
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        const DiagramImageCache *const cache = colorSpace->diagramImageCache();
+        using Private = DiagramImageProvider::DiagramImageProviderPrivate;
+        std::atomic<bool> cancelFlag {true};
+        QString errorString;
+        QVERIFY(Private::render(colorSpace, QStringLiteral("chromalightness?hue=30"), QSize(50, 50), &errorString, &cancelFlag).isNull());
+        QVERIFY(Private::render(colorSpace, QStringLiteral("chromahue?lightness=30"), QSize(50, 50), &errorString, &cancelFlag).isNull());
+        QCOMPARE(errorString, QString());
+        QCOMPARE(cache->m_imageCache.count(), 0);
+        QCOMPARE(cache->m_pyramidCache.count(), 0);
+        cancelFlag = false;
+        QVERIFY(!Private::render(colorSpace, QStringLiteral("chromalightness?hue=30"), QSize(50, 50), &errorString, &cancelFlag).isNull());
+        QCOMPARE(cache->m_pyramidCache.count(), 1);
+    }
+
+    void testDevicePixelRatio_data()
+    {
+        QTest::addColumn<QString>("id");
+        QTest::newRow("chromahue") << QStringLiteral("chromahue?dpr=2");
+        QTest::newRow("chromalightness") << QStringLiteral("chromalightness?dpr=2");
+        QTest::newRow("colorwheel") << QStringLiteral("colorwheel?dpr=2");
+        QTest::newRow("gradient") << QStringLiteral("gradient?dpr=2");
+    }
+
+    void testDevicePixelRatio()
+    {
+        QFETCH(QString, id);
+        DiagramImageProvider provider(RgbColorSpaceFactory::createSrgb());
+        const auto response = request(provider, id, QSize(40, 40));
+        QCOMPARE(response->m_image.devicePixelRatio(), 2);
+        // The size is measured in physical pixels.
+        QCOMPARE(response->m_image.size(), QSize(40, 40));
+    }
+
+    void testDisplayProfile_data()
+    {
+        QTest::addColumn<QString>("id");
+        QTest::newRow("chromahue") << QStringLiteral("chromahue?lightness=50");
+        QTest::newRow("chromalightness") << QStringLiteral("chromalightness?hue=30");
+        QTest::newRow("colorwheel") << QStringLiteral("colorwheel");
+    }
+
+    void testDisplayProfile()
+    {
+        QFETCH(QString, id);
+        const auto colorSpace = RgbColorSpaceFactory::createSrgb();
+        DiagramImageProvider provider(colorSpace);
+        QVERIFY(provider.displayProfile().isEmpty());
+        const QImage withoutProfile = request(provider, id, QSize(60, 60))->m_image;
+
+        const QByteArray profile = rgbProfileData(1.0);
+        provider.setDisplayProfile(profile);
+        QCOMPARE(provider.displayProfile(), profile);
+        const QImage withProfile = request(provider, id, QSize(60, 60))->m_image;
+        QCOMPARE(withProfile.size(), withoutProfile.size());
+        // Both images share the cache of the color space, but they have
+        // different keys.
+        QVERIFY(withProfile != withoutProfile);
+
+        provider.setDisplayProfile(QByteArray());
+        QCOMPARE(request(provider, id, QSize(60, 60))->m_image, withoutProfile);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestDiagramImageProvider)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testdiagramimageprovider.moc"
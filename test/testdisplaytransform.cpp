@@ -0,0 +1,147 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "displaytransform.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "rgbcolorspace.h"
+
+#include <QtTest>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+/** @brief The raw data of LittleCMS’ built-in sRGB profile. */
+static QByteArray srgbProfileData()
+{
+    cmsHPROFILE profileHandle = cmsCreate_sRGBProfile();
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profileHandle, nullptr, &size);
+    QByteArray result(static_cast<int>(size), 0);
+    cmsSaveProfileToMem(profileHandle, result.data(), &size);
+    cmsCloseProfile(profileHandle);
+    return result;
+}
+
+class TestDisplayTransform : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestDisplayTransform(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testInvalidProfile()
+    {
+        QVERIFY(DisplayTransform::create(QByteArray()).isNull());
+        QVERIFY(DisplayTransform::create(QByteArrayLiteral("no icc profile")).isNull());
+    }
+
+    void testBlackAndWhite()
+    {
+        const QSharedPointer<DisplayTransform> transform = DisplayTransform::create(srgbProfileData());
+        QVERIFY(!transform.isNull());
+        const QRgb white = transform->toRgb(LchDouble(100, 0, 0));
+        QCOMPARE(qAlpha(white), 255);
+        QVERIFY(qRed(white) >= 254);
+        QVERIFY(qGreen(white) >= 254);
+        QVERIFY(qBlue(white) >= 254);
+        const QRgb black = transform->toRgb(LchDouble(0, 0, 0));
+        QCOMPARE(qAlpha(black), 255);
+        QVERIFY(qRed(black) <= 1);
+        QVERIFY(qGreen(black) <= 1);
+        QVERIFY(qBlue(black) <= 1);
+    }
+
+    void testSameAsColorSpace()
+    {
+        // For an sRGB display, the result is the same as the RGB value of
+        // the sRGB color space.
+        QSharedPointer<RgbColorSpace> colorSpace = RgbColorSpaceFactory::createSrgb();
+        const QSharedPointer<DisplayTransform> transform = DisplayTransform::create(srgbProfileData());
+        QVector<cmsCIELab> lab;
+        for (int i = 0; i < 20; ++i) {
+            lab.append(cmsCIELab {20.0 + i * 3, -10.0 + i, 15.0 - i});
+        }
+        QVector<QRgb> rgb(lab.count());
+        transform->toRgb(lab.constData(), rgb.data(), lab.count());
+        for (int i = 0; i < lab.count(); ++i) {
+            const QColor expected = colorSpace->toQColorRgbUnbound(lab.at(i));
+            QVERIFY(expected.isValid());
+            QCOMPARE(qAlpha(rgb.at(i)), 255);
+            QVERIFY(qAbs(qRed(rgb.at(i)) - expected.red()) <= 1);
+            QVERIFY(qAbs(qGreen(rgb.at(i)) - expected.green()) <= 1);
+            QVERIFY(qAbs(qBlue(rgb.at(i)) - expected.blue()) <= 1);
+        }
+    }
+
+    void testCachePerColorSpace()
+    {
+        QSharedPointer<RgbColorSpace> colorSpace = RgbColorSpaceFactory::createSrgb();
+        const QByteArray profile = srgbProfileData();
+        const QSharedPointer<DisplayTransform> first = colorSpace->displayTransform(profile);
+        QVERIFY(!first.isNull());
+        QCOMPARE(colorSpace->displayTransform(profile), first);
+        QVERIFY(colorSpace->displayTransform(QByteArray()).isNull());
+        QVERIFY(colorSpace->displayTransform(QByteArrayLiteral("invalid")).isNull());
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestDisplayTransform)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testdisplaytransform.moc"
@@ -0,0 +1,408 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// This test has no class of its own. It tests the worst-case latency of
+// the gamut functions of RgbColorSpace.
+#include "rgbcolorspace.h"
+#include "rgbcolorspace_p.h"
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QtTest>
+
+#include <functional>
+#include <limits>
+
+#include "PerceptualColor/lchdouble.h"
+
+namespace PerceptualColor
+{
+/** @brief Searches adversarially for the slowest inputs of the gamut
+ * functions.
+ *
+ * The gamut functions have very uneven costs: Colors below the blackpoint
+ * or above the whitepoint take special branches, the bisections need more
+ * steps for bigger chroma values, and the search that adjusts chroma and
+ * lightness has to calculate the gamut boundary of each new hue. Within
+ * interactive paths, each call must nevertheless have a bounded cost.
+ *
+ * Each test calls a function with a grid of adversarial inputs (boundary
+ * hues, extreme lightness, negative chroma, huge values, infinity, NaN),
+ * verifies that it neither throws nor returns invalid values, and reports
+ * the slowest input. To be robust against preemption by the operating
+ * system, the latency of an input is the minimum of some repeated
+ * measurements.
+ *
+ * Wall-clock bounds depend on the machine and its load, so they are only
+ * asserted if the environment variable
+ * <tt>PERCEPTUALCOLOR_LATENCY_BOUNDS</tt> is set to <tt>1</tt>, for example
+ * on a dedicated benchmark machine. The bounds are generous, so that they
+ * also hold for debug builds.
+ *
+ * @note The <tt>throw 0</tt> within the initialization of
+ * @ref RgbColorSpace can only be reached when creating a color space from
+ * a profile without in-gamut gray, not by any query. The queries must
+ * never throw. */
+class TestGamutLatency : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestGamutLatency(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    /** @brief Number of measurements per input */
+    static constexpr int repetitions = 3;
+    /** @brief Upper bound for a call of isInGamut(), in milliseconds */
+    static constexpr qint64 isInGamutBound = 2;
+    /** @brief Upper bound for a call of
+     * nearestInGamutColorByAdjustingChroma(), in milliseconds */
+    static constexpr qint64 chromaBound = 10;
+    /** @brief Upper bound for a call of
+     * nearestInGamutColorByAdjustingChromaLightness() if the gamut boundary
+     * of the hue is yet in the cache, in milliseconds */
+    static constexpr qint64 chromaLightnessBound = 10;
+    /** @brief Upper bound for a call of
+     * nearestInGamutColorByAdjustingChromaLightness() if the gamut boundary
+     * of the hue has to be calculated, in milliseconds */
+    static constexpr qint64 chromaLightnessColdBound = 200;
+
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace = RgbColorSpace::createSrgb();
+
+    /** @brief The result of a search for the slowest input. */
+    struct WorstCase {
+        /** @brief The slowest input */
+        LchDouble input;
+        /** @brief Latency of the slowest input, in nanoseconds */
+        qint64 nanoseconds = -1;
+    };
+
+    /** @brief Adversarial hues.
+     *
+     * @returns Hues at and near the wrap-around, at and near the hues
+     * of the primaries and secondaries, non-integer hues (which are not
+     * in the built-in table of sRGB), huge values, infinity and NaN. */
+    QVector<qreal> adversarialHues() const
+    {
+        constexpr qreal infinity = std::numeric_limits<qreal>::infinity();
+        QVector<qreal> result {-infinity, -1e300, -360, -1e-9, 0, 1e-9, 0.5, 1 - 1e-9, 359.999999, 360, 361, 1e300, infinity, qQNaN()};
+        const QList<QColor> corners {Qt::red, Qt::yellow, Qt::green, Qt::cyan, Qt::blue, Qt::magenta};
+        for (const QColor &corner : corners) {
+            const qreal hue = m_rgbColorSpace->toLch(corner).h;
+            result.append(hue);
+            result.append(hue + 1e-9);
+        }
+        return result;
+    }
+
+    /** @brief Adversarial lightness values.
+     *
+     * @returns Lightness values at and near the blackpoint and the
+     * whitepoint, outside the valid range, huge values, infinity
+     * and NaN. */
+    QVector<qreal> adversarialLightnesses() const
+    {
+        constexpr qreal infinity = std::numeric_limits<qreal>::infinity();
+        const qreal blackpoint = m_rgbColorSpace->d_pointer->m_blackpointL;
+        const qreal whitepoint = m_rgbColorSpace->d_pointer->m_whitepointL;
+        return QVector<qreal> {-infinity,
+                               -1e300,
+                               -1000,
+                               -1,
+                               0,
+                               blackpoint - 1e-9,
+                               blackpoint,
+                               blackpoint + 1e-9,
+                               25,
+                               50,
+                               75,
+                               whitepoint - 1e-9,
+                               whitepoint,
+                               whitepoint + 1e-9,
+                               100,
+                               101,
+                               1000,
+                               1e300,
+                               infinity,
+                               qQNaN()};
+    }
+
+    /** @brief Adversarial chroma values.
+     *
+     * @returns Negative chroma values, chroma values near the gamut
+     * boundary, huge values, infinity and NaN. */
+    QVector<qreal> adversarialChromas() const
+    {
+        constexpr qreal infinity = std::numeric_limits<qreal>::infinity();
+        return QVector<qreal> {-infinity, -1e300, -200, -1, -1e-9, 0, 1e-9, 1, 50, 132, 200, 1e300, infinity, qQNaN()};
+    }
+
+    /** @brief All combinations of the adversarial values. */
+    QVector<LchDouble> adversarialColors() const
+    {
+        QVector<LchDouble> result;
+        const QVector<qreal> hues = adversarialHues();
+        const QVector<qreal> lightnesses = adversarialLightnesses();
+        const QVector<qreal> chromas = adversarialChromas();
+        for (const qreal hue : hues) {
+            for (const qreal lightness : lightnesses) {
+                for (const qreal chroma : chromas) {
+                    result.append(LchDouble(lightness, chroma, hue));
+                }
+            }
+        }
+        return result;
+    }
+
+    /** @brief Measures the latency of a function for each input.
+     *
+     * @param inputs The inputs
+     * @param function The function to measure
+     * @param prepare Called before each measurement, but not measured.
+     * @returns The slowest input. The latency of an input is the minimum
+     * of @ref repetitions measurements. */
+    static WorstCase measure(const QVector<LchDouble> &inputs, //
+                             const std::function<void(const LchDouble &)> &function,
+                             const std::function<void()> &prepare = std::function<void()>())
+    {
+        WorstCase result;
+        QElapsedTimer timer;
+        for (const LchDouble &input : inputs) {
+            qint64 latency = std::numeric_limits<qint64>::max();
+            for (int i = 0; i < repetitions; ++i) {
+                if (prepare) {
+                    prepare();
+                }
+                timer.start();
+                function(input);
+                latency = qMin(latency, timer.nsecsElapsed());
+            }
+            if (latency > result.nanoseconds) {
+                result.nanoseconds = latency;
+                result.input = input;
+            }
+        }
+        return result;
+    }
+
+    /** @brief If the latency bounds are asserted.
+     *
+     * @returns <tt>true</tt> if the environment variable
+     * <tt>PERCEPTUALCOLOR_LATENCY_BOUNDS</tt> is <tt>1</tt>. */
+    static bool areBoundsEnforced()
+    {
+        return qEnvironmentVariableIntValue("PERCEPTUALCOLOR_LATENCY_BOUNDS") == 1;
+    }
+
+    /** @brief Reports the slowest input and verifies the bound.
+     *
+     * @param name The name of the function
+     * @param worstCase The slowest input
+     * @param boundMilliseconds The upper bound. Only verified if
+     * @ref areBoundsEnforced(). */
+    static void report(const char *name, const WorstCase &worstCase, qint64 boundMilliseconds)
+    {
+        qInfo("%s: worst case %.3f ms for L %g, C %g, h %g (bound %lld ms)",
+              name,
+              static_cast<double>(worstCase.nanoseconds) / 1000000,
+              static_cast<double>(worstCase.input.l),
+              static_cast<double>(worstCase.input.c),
+              static_cast<double>(worstCase.input.h),
+              static_cast<long long>(boundMilliseconds));
+        QVERIFY(worstCase.nanoseconds >= 0);
+        if (areBoundsEnforced()) {
+            QVERIFY(worstCase.nanoseconds < boundMilliseconds * 1000000);
+        }
+    }
+
+    /** @brief If a result of a gamut search is usable.
+     *
+     * @param result The result
+     * @returns If all values are finite and chroma is not negative. */
+    static bool isValidResult(const LchDouble &result)
+    {
+        return qIsFinite(result.l) //
+            && qIsFinite(result.c) //
+            && qIsFinite(result.h) //
+            && (result.c >= 0);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testIsInGamut()
+    {
+        const WorstCase worstCase = measure( //
+            adversarialColors(),
+            [this](const LchDouble &color) {
+                try {
+                    m_rgbColorSpace->isInGamut(color);
+                } catch (...) {
+                    QFAIL("isInGamut() has thrown an exception.");
+                }
+            });
+        report("isInGamut", worstCase, isInGamutBound);
+    }
+
+    void testIsInGamutNonFinite()
+    {
+        constexpr qreal infinity = std::numeric_limits<qreal>::infinity();
+        QVERIFY(!m_rgbColorSpace->isInGamut(LchDouble(qQNaN(), 0, 0)));
+        QVERIFY(!m_rgbColorSpace->isInGamut(LchDouble(50, infinity, 0)));
+        QVERIFY(!m_rgbColorSpace->isInGamut(LchDouble(50, 0, qQNaN())));
+        QVERIFY(!m_rgbColorSpace->isInGamut(cmsCIELab {infinity, 0, 0}));
+    }
+
+    void testNearestInGamutColorByAdjustingChroma()
+    {
+        const WorstCase worstCase = measure( //
+            adversarialColors(),
+            [this](const LchDouble &color) {
+                try {
+                    const LchDouble result = m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(color);
+                    QVERIFY2(isValidResult(result), "Invalid result");
+                } catch (...) {
+                    QFAIL("nearestInGamutColorByAdjustingChroma() has thrown an exception.");
+                }
+            });
+        report("nearestInGamutColorByAdjustingChroma", worstCase, chromaBound);
+    }
+
+    void testNearestInGamutColorByAdjustingChromaBatch()
+    {
+        // The batch version bisects in lockstep, so a single slow color
+        // slows down the whole block. The bound is per color.
+        const QVector<LchDouble> colors = adversarialColors();
+        QVector<LchDouble> results(colors.count());
+        QElapsedTimer timer;
+        timer.start();
+        m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(colors.constData(), results.data(), colors.count());
+        const qint64 elapsed = timer.nsecsElapsed();
+        if (areBoundsEnforced()) {
+            QVERIFY(elapsed < chromaBound * 1000000 * colors.count());
+        }
+        for (const LchDouble &result : results) {
+            QVERIFY(isValidResult(result));
+        }
+    }
+
+    void testNearestInGamutColorByAdjustingChromaLightness()
+    {
+        const QVector<LchDouble> colors = adversarialColors();
+        // Fill the cache with the gamut boundaries of all hues.
+        for (const LchDouble &color : colors) {
+            m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+        }
+        const WorstCase worstCase = measure( //
+            colors,
+            [this](const LchDouble &color) {
+                try {
+                    const LchDouble result = m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+                    QVERIFY2(isValidResult(result), "Invalid result");
+                } catch (...) {
+                    QFAIL("nearestInGamutColorByAdjustingChromaLightness() has thrown an exception.");
+                }
+            });
+        report("nearestInGamutColorByAdjustingChromaLightness", worstCase, chromaLightnessBound);
+    }
+
+    void testNearestInGamutColorByAdjustingChromaLightnessCold()
+    {
+        // The most expensive case: The gamut boundary of the hue is not
+        // in the cache. The cost depends on the hue, not on lightness
+        // and chroma.
+        QVector<LchDouble> colors;
+        const QVector<qreal> hues = adversarialHues();
+        for (const qreal hue : hues) {
+            colors.append(LchDouble(50, 1e300, hue));
+        }
+        const WorstCase worstCase = measure( //
+            colors,
+            [this](const LchDouble &color) {
+                const LchDouble result = m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+                QVERIFY2(isValidResult(result), "Invalid result");
+            },
+            [this]() {
+                m_rgbColorSpace->clearCaches();
+            });
+        report("nearestInGamutColorByAdjustingChromaLightness (cold cache)", worstCase, chromaLightnessColdBound);
+    }
+
+    void testClearCaches()
+    {
+        const LchDouble color(50, 1e300, 30);
+        const LchDouble expected = m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+        QVERIFY(!m_rgbColorSpace->chromaLightnessBoundary(30).isNull());
+        m_rgbColorSpace->clearCaches();
+        QVERIFY(m_rgbColorSpace->d_pointer->m_chromaLightnessBoundaryCache.count() == 0);
+        QVERIFY(m_rgbColorSpace->d_pointer->m_chromaHueBoundaryCache.count() == 0);
+        // The results do not change.
+        QVERIFY(m_rgbColorSpace->nearestInGamutColorByAdjustingChromaLightness(color).hasSameCoordinates(expected));
+    }
+
+    void testInfiniteChromaTerminates()
+    {
+        // Without clamping, the bisection would never terminate.
+        constexpr qreal infinity = std::numeric_limits<qreal>::infinity();
+        const LchDouble result = m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(LchDouble(50, infinity, 30));
+        QVERIFY(isValidResult(result));
+        QVERIFY(m_rgbColorSpace->isInGamut(result));
+        QVERIFY(result.c > 0);
+        const LchDouble huge = m_rgbColorSpace->nearestInGamutColorByAdjustingChroma(LchDouble(50, 1e300, 30));
+        QVERIFY(huge.hasSameCoordinates(result));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestGamutLatency)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testgamutlatency.moc"
@@ -0,0 +1,214 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "gamutsolidrenderer.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "rgbcolorspace.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+namespace PerceptualColor
+{
+class TestGamutSolidRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestGamutSolidRenderer(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+    /** @brief Shared renderer, because the construction is expensive. */
+    QSharedPointer<GamutSolidRenderer> m_renderer;
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+        m_renderer.reset(new GamutSolidRenderer(m_rgbColorSpace));
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testGrid()
+    {
+        constexpr int middle = GamutSolidRenderer::gridResolution / 2;
+        constexpr int last = GamutSolidRenderer::gridResolution - 1;
+        // The gray axis is in-gamut.
+        QVERIFY(m_renderer->isVoxelOccupied(middle, middle, middle));
+        QVERIFY(m_renderer->isVoxelOccupied(middle, middle, 1));
+        QVERIFY(m_renderer->isVoxelOccupied(middle, middle, last - 1));
+        // Very high chroma at very high or very low lightness is not.
+        QVERIFY(!m_renderer->isVoxelOccupied(0, 0, 0));
+        QVERIFY(!m_renderer->isVoxelOccupied(last, last, last));
+        // Outside of the grid
+        QVERIFY(!m_renderer->isVoxelOccupied(-1, middle, middle));
+        QVERIFY(!m_renderer->isVoxelOccupied(middle, middle, last + 1));
+        // Each occupied voxel is within an occupied brick.
+        for (int l = 0; l <= last; ++l) {
+            for (int b = 0; b <= last; ++b) {
+                for (int a = 0; a <= last; ++a) {
+                    if (m_renderer->isVoxelOccupied(a, b, l)) {
+                        QVERIFY(m_renderer->isBrickOccupied( //
+                            a / GamutSolidRenderer::brickSize,
+                            b / GamutSolidRenderer::brickSize,
+                            l / GamutSolidRenderer::brickSize));
+                    }
+                }
+            }
+        }
+    }
+
+    void testCuspsAreOccupied()
+    {
+        // The primaries and secondaries are the cusps, where the gamut
+        // is thin. Their voxels must nevertheless be occupied.
+        const QVector<QColor> cusps {Qt::red, Qt::yellow, Qt::green, Qt::cyan, Qt::blue, Qt::magenta, Qt::black, Qt::white};
+        const double chromaVoxelSize = 2 * m_renderer->m_chromaRange / GamutSolidRenderer::gridResolution;
+        const double lightnessVoxelSize = 100.0 / GamutSolidRenderer::gridResolution;
+        for (const QColor &cusp : cusps) {
+            const LchDouble lch = m_rgbColorSpace->toLch(cusp);
+            const cmsCIELCh cmsLch {lch.l, lch.c, lch.h};
+            cmsCIELab lab;
+            cmsLCh2Lab(&lab, &cmsLch);
+            const auto voxel = [](const double coordinate, const double voxelSize) {
+                return qBound(0, //
+                              static_cast<int>(std::floor(coordinate / voxelSize)),
+                              GamutSolidRenderer::gridResolution - 1);
+            };
+            QVERIFY(m_renderer->isVoxelOccupied( //
+                voxel(lab.a + m_renderer->m_chromaRange, chromaVoxelSize),
+                voxel(lab.b + m_renderer->m_chromaRange, chromaVoxelSize),
+                voxel(lab.L, lightnessVoxelSize)));
+        }
+    }
+
+    void testToLab()
+    {
+        const double minimum[3] = {0, 0, 0};
+        const cmsCIELab minimumLab = m_renderer->toLab(minimum);
+        QCOMPARE(minimumLab.L, 0.0);
+        QCOMPARE(minimumLab.a, -m_renderer->m_chromaRange);
+        QCOMPARE(minimumLab.b, -m_renderer->m_chromaRange);
+        const double maximum[3] = {GamutSolidRenderer::gridResolution, //
+                                   GamutSolidRenderer::gridResolution,
+                                   GamutSolidRenderer::gridResolution};
+        const cmsCIELab maximumLab = m_renderer->toLab(maximum);
+        QCOMPARE(maximumLab.L, 100.0);
+        QCOMPARE(maximumLab.a, m_renderer->m_chromaRange);
+        QCOMPARE(maximumLab.b, m_renderer->m_chromaRange);
+    }
+
+    void testRenderSideView()
+    {
+        const QImage image = m_renderer->render(QSize(64, 64), 0, 0, 1);
+        QCOMPARE(image.size(), QSize(64, 64));
+        QCOMPARE(image.format(), QImage::Format_ARGB32_Premultiplied);
+        // The corners are outside of the gamut solid.
+        QCOMPARE(qAlpha(image.pixel(0, 0)), 0);
+        QCOMPARE(qAlpha(image.pixel(63, 63)), 0);
+        // Looking from the positive a axis to the center: The
+        // gamut surface is reddish there.
+        const QRgb center = image.pixel(32, 32);
+        QCOMPARE(qAlpha(center), 255);
+        QVERIFY(qRed(center) > qGreen(center));
+    }
+
+    void testRenderTopView()
+    {
+        const QImage image = m_renderer->render(QSize(64, 64), 0, 90, 1);
+        // Looking from above to the white point
+        const QRgb center = image.pixel(32, 32);
+        QCOMPARE(qAlpha(center), 255);
+        QVERIFY(qRed(center) > 200);
+        QVERIFY(qGreen(center) > 200);
+        QVERIFY(qBlue(center) > 200);
+    }
+
+    void testRenderDeterministic()
+    {
+        // Tiles are rendered in parallel; the result must nevertheless
+        // not depend on the scheduling.
+        const QImage first = m_renderer->render(QSize(100, 80), 123, -30, 1);
+        const QImage second = m_renderer->render(QSize(100, 80), 123, -30, 1);
+        QCOMPARE(first, second);
+    }
+
+    void testPixelStep()
+    {
+        constexpr int step = 4;
+        const QImage image = m_renderer->render(QSize(64, 64), 45, 20, step);
+        QCOMPARE(image.size(), QSize(64, 64));
+        int opaquePixels = 0;
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                // Each block of step × step pixels has a single color.
+                QCOMPARE(image.pixel(x, y), image.pixel(x - x % step, y - y % step));
+                if (qAlpha(image.pixel(x, y)) == 255) {
+                    ++opaquePixels;
+                }
+            }
+        }
+        QVERIFY(opaquePixels > 0);
+    }
+
+    void testEmptySize()
+    {
+        QVERIFY(m_renderer->render(QSize(0, 0), 0, 0, 1).isNull());
+        QVERIFY(m_renderer->render(QSize(-5, 10), 0, 0, 1).isNull());
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestGamutSolidRenderer)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testgamutsolidrenderer.moc"
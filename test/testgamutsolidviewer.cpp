@@ -0,0 +1,196 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/gamutsolidviewer.h"
+// Second, the private implementation.
+#include "gamutsolidviewer_p.h"
+
+#include <QMouseEvent>
+#include <QSignalSpy>
+#include <QtTest>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "helper.h"
+
+namespace PerceptualColor
+{
+class TestGamutSolidViewer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestGamutSolidViewer(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testConstructorDestructor()
+    {
+        GamutSolidViewer temp(m_rgbColorSpace);
+    }
+
+    void testAzimuth()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        QSignalSpy spy(&viewer, &GamutSolidViewer::azimuthChanged);
+        viewer.setAzimuth(10);
+        QCOMPARE(viewer.azimuth(), 10);
+        QCOMPARE(spy.count(), 1);
+        // Same value: No signal
+        viewer.setAzimuth(10);
+        QCOMPARE(spy.count(), 1);
+        // Normalization
+        viewer.setAzimuth(370);
+        QCOMPARE(viewer.azimuth(), 10);
+        QCOMPARE(spy.count(), 1);
+        viewer.setAzimuth(-10);
+        QCOMPARE(viewer.azimuth(), 350);
+        QCOMPARE(spy.count(), 2);
+    }
+
+    void testElevation()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        QSignalSpy spy(&viewer, &GamutSolidViewer::elevationChanged);
+        viewer.setElevation(45);
+        QCOMPARE(viewer.elevation(), 45);
+        QCOMPARE(spy.count(), 1);
+        viewer.setElevation(100);
+        QCOMPARE(viewer.elevation(), 90);
+        viewer.setElevation(-100);
+        QCOMPARE(viewer.elevation(), -90);
+        QCOMPARE(spy.count(), 3);
+    }
+
+    void testKeyboard()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        viewer.setAzimuth(100);
+        viewer.setElevation(0);
+        QTest::keyClick(&viewer, Qt::Key_Right);
+        QCOMPARE(viewer.azimuth(), 100 + singleStepHue);
+        QTest::keyClick(&viewer, Qt::Key_Left);
+        QCOMPARE(viewer.azimuth(), 100);
+        QTest::keyClick(&viewer, Qt::Key_PageUp);
+        QCOMPARE(viewer.azimuth(), 100 + pageStepHue);
+        QTest::keyClick(&viewer, Qt::Key_Up);
+        QCOMPARE(viewer.elevation(), singleStepHue);
+        QTest::keyClick(&viewer, Qt::Key_Down);
+        QCOMPARE(viewer.elevation(), 0);
+    }
+
+    void testMouseDrag()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        viewer.resize(200, 200);
+        viewer.setAzimuth(100);
+        viewer.setElevation(0);
+        const QPoint center(100, 100);
+        QTest::mousePress(&viewer, Qt::LeftButton, Qt::NoModifier, center);
+        // QTest::mouseMove() moves only the cursor without buttons,
+        // so send the event directly.
+        QMouseEvent moveEvent(QEvent::MouseMove, //
+                              center + QPoint(10, 20),
+                              Qt::NoButton,
+                              Qt::LeftButton,
+                              Qt::NoModifier);
+        viewer.mouseMoveEvent(&moveEvent);
+        QVERIFY(viewer.azimuth() != 100);
+        QVERIFY(viewer.elevation() != 0);
+        QTest::mouseRelease(&viewer, Qt::LeftButton, Qt::NoModifier, center + QPoint(10, 20));
+        QVERIFY(!viewer.d_pointer->m_isMouseEventActive);
+    }
+
+    void testProgressiveRefinement()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        viewer.resize(100, 100);
+        // Initially, the view is rendered in full resolution, in
+        // the background.
+        viewer.grab();
+        QTRY_VERIFY(viewer.d_pointer->isImageUpToDate());
+        QCOMPARE(viewer.d_pointer->m_imagePixelStep, 1);
+        QVERIFY(!viewer.d_pointer->m_image.isNull());
+        // During interaction, a preview is requested. Meanwhile, the
+        // last frame is still available.
+        viewer.setAzimuth(viewer.azimuth() + 10);
+        QCOMPARE(viewer.d_pointer->requestedPixelStep(), //
+                 GamutSolidViewer::GamutSolidViewerPrivate::previewPixelStep);
+        viewer.grab();
+        QVERIFY(!viewer.d_pointer->m_image.isNull());
+        // After the interaction, the full resolution follows.
+        QTRY_VERIFY(!viewer.d_pointer->m_refinementTimer.isActive());
+        viewer.grab();
+        QTRY_VERIFY(viewer.d_pointer->isImageUpToDate());
+        QCOMPARE(viewer.d_pointer->m_imagePixelStep, 1);
+        QCOMPARE(viewer.d_pointer->m_imageAzimuth, viewer.azimuth());
+    }
+
+    void testSizeHints()
+    {
+        GamutSolidViewer viewer(m_rgbColorSpace);
+        QVERIFY(viewer.minimumSizeHint().width() > 0);
+        QCOMPARE(viewer.minimumSizeHint().width(), viewer.minimumSizeHint().height());
+        QVERIFY(viewer.sizeHint().width() >= viewer.minimumSizeHint().width());
+        QVERIFY(viewer.sizeHint().height() >= viewer.minimumSizeHint().height());
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestGamutSolidViewer)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testgamutsolidviewer.moc"
@@ -35,6 +35,8 @@
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
 
+Q_DECLARE_METATYPE(PerceptualColor::HueInterpolation)
+
 class TestGradientSnippetClass : public QWidget
 {
     Q_OBJECT
@@ -195,23 +197,173 @@ private Q_SLOTS:
         QCOMPARE(myGradient.m_image.isNull(), true);
     }
 
-    void testUpdateSecondColor()
+    void testUpdateUnwrappedHues()
     {
         GradientImage myGradient(m_rgbColorSpace);
-        myGradient.m_firstColorCorrected = LchaDouble(50, 0, 30, 0.5);
-        myGradient.m_secondColorCorrectedAndAltered = LchaDouble(50, 0, 40, 0.5);
-        myGradient.updateSecondColor();
-        qreal absoluteDifference = qAbs(myGradient.m_firstColorCorrected.h - myGradient.m_secondColorCorrectedAndAltered.h);
+        GradientStop firstStop;
+        firstStop.position = 0;
+        firstStop.color = LchaDouble(50, 0, 30, 0.5);
+        GradientStop secondStop;
+        secondStop.position = 1;
+        secondStop.color = LchaDouble(50, 0, 40, 0.5);
+        myGradient.setStops({firstStop, secondStop});
+        qreal absoluteDifference = qAbs(myGradient.m_unwrappedHues.at(0) - myGradient.m_unwrappedHues.at(1));
         QVERIFY2(absoluteDifference <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
-        myGradient.m_secondColorCorrectedAndAltered = LchaDouble(50, 0, 240, 0.5);
-        myGradient.updateSecondColor();
-        QVERIFY2(qAbs(myGradient.m_firstColorCorrected.h - myGradient.m_secondColorCorrectedAndAltered.h) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
-        myGradient.m_secondColorCorrectedAndAltered = LchaDouble(50, 0, 540, 0.5);
-        myGradient.updateSecondColor();
-        QVERIFY2(qAbs(myGradient.m_firstColorCorrected.h - myGradient.m_secondColorCorrectedAndAltered.h) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
-        myGradient.m_secondColorCorrectedAndAltered = LchaDouble(50, 0, -240, 0.5);
-        myGradient.updateSecondColor();
-        QVERIFY2(qAbs(myGradient.m_firstColorCorrected.h - myGradient.m_secondColorCorrectedAndAltered.h) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
+        secondStop.color = LchaDouble(50, 0, 240, 0.5);
+        myGradient.setStops({firstStop, secondStop});
+        QVERIFY2(qAbs(myGradient.m_unwrappedHues.at(0) - myGradient.m_unwrappedHues.at(1)) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
+        secondStop.color = LchaDouble(50, 0, 540, 0.5);
+        myGradient.setStops({firstStop, secondStop});
+        QVERIFY2(qAbs(myGradient.m_unwrappedHues.at(0) - myGradient.m_unwrappedHues.at(1)) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
+        secondStop.color = LchaDouble(50, 0, -240, 0.5);
+        myGradient.setStops({firstStop, secondStop});
+        QVERIFY2(qAbs(myGradient.m_unwrappedHues.at(0) - myGradient.m_unwrappedHues.at(1)) <= 180, "Verify that the hue difference is 0° ≤ difference ≤ 180°.");
+    }
+
+    void testHueInterpolation_data()
+    {
+        QTest::addColumn<HueInterpolation>("hueInterpolation");
+        QTest::addColumn<qreal>("secondHue");
+        QTest::addColumn<qreal>("expectedDifference");
+        QTest::newRow("shorter 30→40") << HueInterpolation::Shorter << 40. << 10.;
+        QTest::newRow("shorter 30→350") << HueInterpolation::Shorter << 350. << -40.;
+        QTest::newRow("longer 30→40") << HueInterpolation::Longer << 40. << -350.;
+        QTest::newRow("longer 30→350") << HueInterpolation::Longer << 350. << 320.;
+        QTest::newRow("increasing 30→20") << HueInterpolation::Increasing << 20. << 350.;
+        QTest::newRow("increasing 30→40") << HueInterpolation::Increasing << 40. << 10.;
+        QTest::newRow("decreasing 30→40") << HueInterpolation::Decreasing << 40. << -350.;
+        QTest::newRow("decreasing 30→20") << HueInterpolation::Decreasing << 20. << -10.;
+        QTest::newRow("decreasing 30→30") << HueInterpolation::Decreasing << 30. << 0.;
+    }
+
+    void testHueInterpolation()
+    {
+        QFETCH(HueInterpolation, hueInterpolation);
+        QFETCH(qreal, secondHue);
+        QFETCH(qreal, expectedDifference);
+        GradientImage myGradient(m_rgbColorSpace);
+        GradientStop firstStop;
+        firstStop.position = 0;
+        firstStop.color = LchaDouble(50, 10, 30, 1);
+        GradientStop secondStop;
+        secondStop.position = 1;
+        secondStop.color = LchaDouble(50, 10, secondHue, 1);
+        secondStop.hueInterpolation = hueInterpolation;
+        myGradient.setStops({firstStop, secondStop});
+        QCOMPARE(myGradient.m_unwrappedHues.at(1) - myGradient.m_unwrappedHues.at(0), expectedDifference);
+    }
+
+    void testSetStops()
+    {
+        GradientImage myGradient(m_rgbColorSpace);
+        myGradient.setGradientLength(20);
+        myGradient.setGradientThickness(10);
+        myGradient.getImage();
+        QCOMPARE(myGradient.m_image.isNull(), false);
+        QCOMPARE(myGradient.m_ramp.count(), GradientImage::rampResolution);
+        GradientStop stop0;
+        stop0.position = 1;
+        stop0.color = LchaDouble(30, 10, 20, 1);
+        GradientStop stop1;
+        stop1.position = 0;
+        stop1.color = LchaDouble(70, 10, 20, 1);
+        GradientStop stop2;
+        stop2.position = 0.5;
+        stop2.color = LchaDouble(50, -10, 200, 1);
+        myGradient.setStops({stop0, stop1, stop2});
+        QVERIFY2(myGradient.m_image.isNull(), "Setting new stops should erease the image cache.");
+        QVERIFY2(myGradient.m_ramp.isEmpty(), "Setting new stops should erease the ramp cache.");
+        // Sorted by position
+        QCOMPARE(myGradient.stops().count(), 3);
+        QCOMPARE(myGradient.stops().at(0).color.l, 70);
+        QCOMPARE(myGradient.stops().at(1).color.l, 50);
+        QCOMPARE(myGradient.stops().at(2).color.l, 30);
+        // Normalized
+        QCOMPARE(myGradient.stops().at(1).color.c, 10);
+        QCOMPARE(myGradient.stops().at(1).color.h, 20);
+        myGradient.getImage();
+        const int rampCount = myGradient.m_ramp.count();
+        QVERIFY(rampCount >= GradientImage::rampResolution);
+        myGradient.setStops({stop2, stop1, stop0});
+        QVERIFY2(!myGradient.m_image.isNull(),
+                 "Setting the same stops in a different order should not "
+                 "erease the cache.");
+        // Changing the size must not recalculate the ramp.
+        myGradient.setGradientLength(200);
+        QCOMPARE(myGradient.m_ramp.count(), rampCount);
+        QCOMPARE(myGradient.getImage().width(), 200);
+    }
+
+    void testEmptyAndSingleStop()
+    {
+        GradientImage myGradient(m_rgbColorSpace);
+        myGradient.setGradientLength(20);
+        myGradient.setGradientThickness(10);
+        myGradient.setStops({});
+        QCOMPARE(myGradient.colorFromValue(0.5).a, 0);
+        QCOMPARE(myGradient.getImage().isNull(), false);
+        GradientStop stop;
+        stop.position = 0.3;
+        stop.color = LchaDouble(40, 20, 100, 1);
+        myGradient.setStops({stop});
+        QCOMPARE(myGradient.colorFromValue(0).l, 40);
+        QCOMPARE(myGradient.colorFromValue(1).l, 40);
+        QCOMPARE(myGradient.getImage().isNull(), false);
+    }
+
+    void testHardStop()
+    {
+        // Two stops at the same position give a sharp color change
+        // exactly at this position.
+        GradientImage myGradient(m_rgbColorSpace);
+        GradientStop black;
+        black.position = 0;
+        black.color = LchaDouble(0, 0, 0, 1);
+        GradientStop blackEnd = black;
+        blackEnd.position = 0.5;
+        GradientStop white;
+        white.position = 0.5;
+        white.color = LchaDouble(100, 0, 0, 1);
+        GradientStop whiteEnd = white;
+        whiteEnd.position = 1;
+        myGradient.setStops({black, blackEnd, white, whiteEnd});
+        myGradient.setGradientLength(1000);
+        myGradient.setGradientThickness(1);
+        const QImage image = myGradient.getImage();
+        const QRgb blackRgb = m_rgbColorSpace->toQColorRgbBound(black.color).rgba();
+        const QRgb whiteRgb = m_rgbColorSpace->toQColorRgbBound(white.color).rgba();
+        QCOMPARE(image.pixel(0, 0), blackRgb);
+        QCOMPARE(image.pixel(499, 0), blackRgb);
+        QCOMPARE(image.pixel(500, 0), whiteRgb);
+        QCOMPARE(image.pixel(999, 0), whiteRgb);
+    }
+
+    void testTransparentStop()
+    {
+        // Interpolating premultiplied colors: The color of a fully
+        // transparent stop does not bleed into the gradient.
+        GradientImage myGradient(m_rgbColorSpace);
+        GradientStop opaque;
+        opaque.position = 0;
+        opaque.color = LchaDouble(50, 0, 0, 1);
+        GradientStop transparent;
+        transparent.position = 1;
+        transparent.color = LchaDouble(100, 30, 0, 0);
+        myGradient.setStops({opaque, transparent});
+        const LchaDouble middleColor = myGradient.colorFromValue(0.75);
+        QCOMPARE(middleColor.l, 50);
+        QCOMPARE(middleColor.c, 0);
+        QCOMPARE(middleColor.a, 0.25);
+        myGradient.setGradientLength(256);
+        myGradient.setGradientThickness(1);
+        myGradient.getImage();
+        const QRgb opaqueRgb = m_rgbColorSpace->toQColorRgbBound(opaque.color).rgb();
+        for (const auto &entry : qAsConst(myGradient.m_ramp)) {
+            const qreal alpha = qAlpha(entry.color) / 255.0;
+            // Within the rounding tolerance, the premultiplied value is
+            // the opaque gray, scaled by alpha.
+            QVERIFY(qAbs(qRed(entry.color) - qRed(opaqueRgb) * alpha) <= 1);
+        }
     }
 
     void testGetImage()
@@ -228,13 +380,32 @@ private Q_SLOTS:
     void testColorFromValue()
     {
         GradientImage myGradient(m_rgbColorSpace);
-        myGradient.m_firstColorCorrected = LchaDouble(50, 0, 30, 0.5);
-        myGradient.m_secondColorCorrectedAndAltered = LchaDouble(60, 10, 20, 0.4);
+        myGradient.setFirstColor(LchaDouble(50, 0, 30, 0.5));
+        myGradient.setSecondColor(LchaDouble(60, 10, 20, 0.4));
         LchaDouble middleColor = myGradient.colorFromValue(0.5);
-        QCOMPARE(middleColor.l, 55);
-        QCOMPARE(middleColor.c, 5);
+        // Lightness and chroma are interpolated premultiplied with alpha.
+        QVERIFY(qAbs(middleColor.l - (50 * 0.5 + 60 * 0.4) / 2 / 0.45) < 1e-9);
+        QVERIFY(qAbs(middleColor.c - (0 * 0.5 + 10 * 0.4) / 2 / 0.45) < 1e-9);
         QCOMPARE(middleColor.h, 25);
         QCOMPARE(middleColor.a, 0.45);
+
+        // Three stops
+        GradientStop stop0;
+        stop0.position = 0;
+        stop0.color = LchaDouble(0, 0, 0, 1);
+        GradientStop stop1;
+        stop1.position = 0.25;
+        stop1.color = LchaDouble(50, 20, 0, 1);
+        GradientStop stop2;
+        stop2.position = 1;
+        stop2.color = LchaDouble(80, 20, 90, 1);
+        stop2.hueInterpolation = HueInterpolation::Decreasing;
+        myGradient.setStops({stop0, stop1, stop2});
+        QCOMPARE(myGradient.colorFromValue(0.125).l, 25);
+        QCOMPARE(myGradient.colorFromValue(0.25).l, 50);
+        QCOMPARE(myGradient.colorFromValue(0.625).l, 65);
+        // Decreasing from 0° to 90° means going through 315°.
+        QCOMPARE(myGradient.colorFromValue(0.4375).h, -67.5);
     }
 
     void testSetDevicelPixelRatioF()
@@ -143,6 +143,48 @@ private Q_SLOTS:
         QCOMPARE(spySecond.count(), 1);
     }
 
+    void testStops()
+    {
+        GradientSlider testSlider(m_rgbColorSpace, Qt::Horizontal);
+        // By default, there are two stops.
+        QCOMPARE(testSlider.stops().count(), 2);
+        QCOMPARE(testSlider.stops().first().position, 0.0);
+        QCOMPARE(testSlider.stops().last().position, 1.0);
+
+        QVector<GradientStop> stops(3);
+        stops[0].position = 1;
+        stops[0].color = LchaDouble(80, 20, 90, 1);
+        stops[1].position = 0;
+        stops[1].color = LchaDouble(30, 40, 300, 1);
+        stops[2].position = 0.5;
+        stops[2].color = LchaDouble(60, 30, 180, 1);
+        stops[2].hueInterpolation = HueInterpolation::Longer;
+        QSignalSpy spyFirst(&testSlider, &PerceptualColor::GradientSlider::firstColorChanged);
+        QSignalSpy spySecond(&testSlider, &PerceptualColor::GradientSlider::secondColorChanged);
+        testSlider.setStops(stops);
+        // The stops are sorted by position.
+        const QVector<GradientStop> result = testSlider.stops();
+        QCOMPARE(result.count(), 3);
+        QCOMPARE(result.at(1).position, 0.5);
+        QVERIFY(result.at(1).hueInterpolation == HueInterpolation::Longer);
+        QVERIFY(testSlider.firstColor().hasSameCoordinates(stops.at(1).color));
+        QVERIFY(testSlider.secondColor().hasSameCoordinates(stops.at(0).color));
+        QCOMPARE(spyFirst.count(), 1);
+        QCOMPARE(spySecond.count(), 1);
+
+        // The middle stop is kept when the first color changes.
+        testSlider.setFirstColor(LchaDouble(20, 10, 10, 1));
+        QCOMPARE(testSlider.stops().count(), 3);
+        QVERIFY(testSlider.stops().at(1).color.hasSameCoordinates(stops.at(2).color));
+
+        // Empty lists are ignored.
+        testSlider.setStops(QVector<GradientStop>());
+        QCOMPARE(testSlider.stops().count(), 3);
+
+        testSlider.resize(QSize(200, 30));
+        testSlider.grab();
+    }
+
     void testMinimalSizeHint()
     {
         GradientSlider testWidget(m_rgbColorSpace);
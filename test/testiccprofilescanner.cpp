@@ -0,0 +1,150 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "iccprofilescanner.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+class TestIccProfileScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestIccProfileScanner(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    static bool saveProfile(cmsHPROFILE profile, const QString &fileName)
+    {
+        const bool result = cmsSaveProfileToFile(profile, //
+                                                 QFile::encodeName(fileName).constData());
+        cmsCloseProfile(profile);
+        return result;
+    }
+
+    static void writeTextFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        file.open(QIODevice::WriteOnly);
+        file.write("This is not an ICC profile.");
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testDefaultDirectories()
+    {
+        // Should not crash.
+        const QStringList directories = IccProfileScanner::defaultDirectories();
+        for (const QString &directory : directories) {
+            QVERIFY(QFileInfo(directory).isDir());
+        }
+    }
+
+    void testScan()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        QVERIFY(saveProfile(cmsCreate_sRGBProfile(), directory.filePath(QStringLiteral("b-srgb.icc"))));
+        QVERIFY(saveProfile(cmsCreateLab4Profile(nullptr), directory.filePath(QStringLiteral("lab.icc"))));
+        writeTextFile(directory.filePath(QStringLiteral("text.icc")));
+        QDir(directory.path()).mkdir(QStringLiteral("subdirectory"));
+        QVERIFY(saveProfile(cmsCreate_sRGBProfile(), directory.filePath(QStringLiteral("subdirectory/a-srgb.icc"))));
+
+        const QVector<IccProfileInformation> result = IccProfileScanner::scan({directory.path()});
+        // Only the two sRGB profiles are listed, sorted by file name.
+        QCOMPARE(result.count(), 2);
+        QVERIFY(result.at(0).fileName.endsWith(QStringLiteral("b-srgb.icc")));
+        QVERIFY(result.at(1).fileName.endsWith(QStringLiteral("subdirectory/a-srgb.icc")));
+        QVERIFY(!result.at(0).description.isEmpty());
+        QVERIFY(result.at(0).lastModified.isValid());
+    }
+
+    void testCache()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("srgb.icc"));
+        QVERIFY(saveProfile(cmsCreate_sRGBProfile(), fileName));
+        QCOMPARE(IccProfileScanner::scan({directory.path()}).count(), 1);
+        const QString absoluteFileName = QFileInfo(fileName).absoluteFilePath();
+        {
+            QMutexLocker locker(&IccProfileScanner::cacheMutex());
+            QVERIFY(IccProfileScanner::cache().contains(absoluteFileName));
+            // Manipulate the cache entry to see if it is used.
+            IccProfileScanner::cache()[absoluteFileName].information.description = QStringLiteral("cached");
+        }
+        QCOMPARE(IccProfileScanner::scan({directory.path()}).at(0).description, QStringLiteral("cached"));
+        {
+            QMutexLocker locker(&IccProfileScanner::cacheMutex());
+            // Simulate an outdated cache entry.
+            IccProfileScanner::cache()[absoluteFileName].lastModified = QDateTime();
+        }
+        QVERIFY(IccProfileScanner::scan({directory.path()}).at(0).description != QStringLiteral("cached"));
+    }
+
+    void testNonExistingDirectory()
+    {
+        QCOMPARE(IccProfileScanner::scan({QStringLiteral("../testbed/nonexistingname")}).count(), 0);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestIccProfileScanner)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testiccprofilescanner.moc"
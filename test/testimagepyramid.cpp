@@ -0,0 +1,172 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "imagepyramid.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestImagePyramid : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestImagePyramid(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testLevels()
+    {
+        const ImagePyramid pyramid(QImage(QSize(100, 40), QImage::Format_ARGB32_Premultiplied));
+        QCOMPARE(pyramid.baseSize(), QSize(100, 40));
+        // The levels are created lazily.
+        QVERIFY(pyramid.m_levels.isEmpty());
+        const int cost = pyramid.cost();
+        QVERIFY(cost >= 1);
+        QVERIFY(pyramid.m_levels.isEmpty());
+        // 100×40, 50×20, 25×10, 13×5, 7×3, 4×2, 2×1, 1×1
+        QCOMPARE(pyramid.levelCount(), 8);
+        QCOMPARE(pyramid.m_levels.last().size(), QSize(1, 1));
+        // The cost has been calculated in advance.
+        QCOMPARE(pyramid.cost(), cost);
+    }
+
+    void testNullImage()
+    {
+        const ImagePyramid pyramid {QImage()};
+        QCOMPARE(pyramid.levelCount(), 0);
+        QVERIFY(pyramid.scaled(QSize(1, 1)).isNull());
+    }
+
+    void testScaled()
+    {
+        QImage image(QSize(64, 64), QImage::Format_ARGB32_Premultiplied);
+        image.fill(QColor(10, 100, 200));
+        image.setDevicePixelRatio(2);
+        const ImagePyramid pyramid(image);
+        // Same size: The original image itself, without creating the levels
+        QCOMPARE(pyramid.scaled(QSize(64, 64)).cacheKey(), image.cacheKey());
+        QVERIFY(pyramid.m_levels.isEmpty());
+        // Bigger or empty sizes are not possible.
+        QVERIFY(pyramid.scaled(QSize(65, 64)).isNull());
+        QVERIFY(pyramid.scaled(QSize(0, 0)).isNull());
+        // Smaller sizes, also not powers of two
+        for (const QSize &size : {QSize(32, 32), QSize(50, 17), QSize(3, 60), QSize(1, 1)}) {
+            const QImage scaled = pyramid.scaled(size);
+            QCOMPARE(scaled.size(), size);
+            QCOMPARE(scaled.format(), image.format());
+            QCOMPARE(scaled.devicePixelRatio(), 2.0);
+            // A uniform image stays uniform.
+            for (int y = 0; y < size.height(); ++y) {
+                for (int x = 0; x < size.width(); ++x) {
+                    QCOMPARE(scaled.pixel(x, y), qRgb(10, 100, 200));
+                }
+            }
+        }
+        // The first level shares the data with the original image.
+        QCOMPARE(pyramid.m_levels.first().cacheKey(), image.cacheKey());
+    }
+
+    void testPremultipliedAlpha()
+    {
+        // Opaque red and fully transparent black, alternating
+        QImage image(QSize(8, 8), QImage::Format_ARGB32);
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                image.setPixel(x, y, ((x + y) % 2 == 0) ? qRgba(255, 0, 0, 255) : qRgba(0, 0, 0, 0));
+            }
+        }
+        const ImagePyramid pyramid(image);
+        // The first level is premultiplied, but the same size is
+        // returned in the original format.
+        const QImage original = pyramid.scaled(QSize(8, 8));
+        QCOMPARE(original.format(), QImage::Format_ARGB32);
+        QCOMPARE(original, image);
+        const QImage scaled = pyramid.scaled(QSize(4, 4));
+        for (int y = 0; y < scaled.height(); ++y) {
+            for (int x = 0; x < scaled.width(); ++x) {
+                const QRgb pixel = scaled.pixel(x, y);
+                // Half transparent…
+                QVERIFY(qAbs(qAlpha(pixel) - 128) <= 1);
+                // …but still red: The black of the transparent pixels
+                // must not darken the result.
+                QVERIFY(qRed(pixel) >= 250);
+                QCOMPARE(qGreen(pixel), 0);
+                QCOMPARE(qBlue(pixel), 0);
+            }
+        }
+    }
+
+    void testAreaAverage()
+    {
+        // A horizontal gradient from 0 to 255 in steps of 85
+        QImage image(QSize(3, 1), QImage::Format_ARGB32_Premultiplied);
+        image.setPixel(0, 0, qRgb(0, 0, 0));
+        image.setPixel(1, 0, qRgb(85, 85, 85));
+        image.setPixel(2, 0, qRgb(170, 170, 170));
+        const QImage result = ImagePyramid::areaAverage(image, QSize(2, 1));
+        // The first result pixel covers the first source pixel and half
+        // of the second source pixel.
+        QCOMPARE(qRed(result.pixel(0, 0)), qRound((0 + 85 * 0.5) / 1.5));
+        QCOMPARE(qRed(result.pixel(1, 0)), qRound((85 * 0.5 + 170) / 1.5));
+        QCOMPARE(qAlpha(result.pixel(0, 0)), 255);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestImagePyramid)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testimagepyramid.moc"
@@ -31,6 +31,9 @@
 // this forces the header to be self-contained.
 #include "iohandlerfactory.h"
 
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
 #include <QtTest>
 
 #include "lcms2_plugin.h"
@@ -153,6 +156,93 @@ private Q_SLOTS:
         QCOMPARE(closeResult, true);
     }
 
+    void testWriteOnly()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("test.txt"));
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createWriteOnly( //
+            nullptr,
+            fileName);
+        QVERIFY(myHandler != nullptr);
+        QCOMPARE(myHandler->ContextID, nullptr);
+        QCOMPARE(myHandler->UsedSpace, 0);
+
+        QCOMPARE(myHandler->Write(myHandler, 4, "abcd"), true);
+        QCOMPARE(myHandler->UsedSpace, 4);
+        QCOMPARE(myHandler->Tell(myHandler), 4);
+        QCOMPARE(myHandler->Seek(myHandler, 1), true);
+        QCOMPARE(myHandler->Write(myHandler, 1, "x"), true);
+        // Overwriting does not enlarge the file.
+        QCOMPARE(myHandler->UsedSpace, 4);
+        QCOMPARE(myHandler->Seek(myHandler, 4), true);
+        QCOMPARE(myHandler->Write(myHandler, 2, "ef"), true);
+        QCOMPARE(myHandler->UsedSpace, 6);
+        // Nothing is visible before closing the handler.
+        QCOMPARE(QFile::exists(fileName), false);
+
+        QCOMPARE(myHandler->Close(myHandler), true);
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArrayLiteral("axcdef"));
+    }
+
+    void testCancelWriting()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("test.txt"));
+        QFile oldFile(fileName);
+        QVERIFY(oldFile.open(QIODevice::WriteOnly));
+        oldFile.write("old");
+        oldFile.close();
+
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createWriteOnly( //
+            nullptr,
+            fileName);
+        QVERIFY(myHandler != nullptr);
+        QCOMPARE(myHandler->Write(myHandler, 3, "new"), true);
+        IOHandlerFactory::cancelWriting(myHandler);
+        QCOMPARE(myHandler->Close(myHandler), false);
+
+        // The old file is left untouched, and no temporary file remains.
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArrayLiteral("old"));
+        QCOMPARE(QDir(directory.path()).entryList(QDir::Files).count(), 1);
+    }
+
+    void testWriteProfile()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("srgb.icc"));
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createWriteOnly( //
+            nullptr,
+            fileName);
+        QVERIFY(myHandler != nullptr);
+        cmsHPROFILE srgb = cmsCreate_sRGBProfile();
+        QVERIFY(cmsSaveProfileToIOhandler(srgb, myHandler) > 0);
+        cmsCloseProfile(srgb);
+        QCOMPARE(cmsCloseIOhandler(myHandler), true);
+
+        // Read the profile again
+        myHandler = IOHandlerFactory::createReadOnly(nullptr, fileName);
+        QVERIFY(myHandler != nullptr);
+        cmsHPROFILE profile = cmsOpenProfileFromIOhandlerTHR(nullptr, myHandler);
+        QVERIFY(profile != nullptr);
+        QCOMPARE(cmsGetColorSpace(profile), cmsSigRgbData);
+        cmsCloseProfile(profile);
+    }
+
+    void testWriteOnlyInvalidFileName()
+    {
+        cmsIOHANDLER *myHandler = IOHandlerFactory::createWriteOnly( //
+            nullptr,
+            QStringLiteral("../testbed/nonexistingdirectory/file.icc"));
+        QVERIFY(myHandler == nullptr);
+    }
+
     void testNonExisting()
     {
         cmsIOHANDLER *myHandler = IOHandlerFactory::createReadOnly( //
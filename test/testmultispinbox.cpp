@@ -448,6 +448,63 @@ private Q_SLOTS:
         QVERIFY(myMulti.sizeHint().width() > referenceWidth);
     }
 
+    void testSizeHintCache()
+    {
+        PerceptualColor::MultiSpinBox myMulti;
+        QList<MultiSpinBoxSectionConfiguration> config;
+        MultiSpinBoxSectionConfiguration section;
+        section.setMinimum(1);
+        section.setMaximum(9);
+        section.setPrefix(QStringLiteral(u"abcdefghij"));
+        section.setSuffix(QStringLiteral(u"abcdefghij"));
+        config.append(section);
+        myMulti.setSectionConfigurations(config);
+        const QSize referenceSize = myMulti.sizeHint();
+        QVERIFY(myMulti.d_pointer->m_sizeHintCache.isValid());
+        // Calling again gives the same (cached) result.
+        QCOMPARE(myMulti.sizeHint(), referenceSize);
+
+        // A bigger font has to invalidate the cache.
+        QFont myFont = myMulti.font();
+        myFont.setPointSizeF(myFont.pointSizeF() * 3);
+        myMulti.setFont(myFont);
+        QVERIFY(myMulti.sizeHint().width() > referenceSize.width());
+
+        // A changed configuration has to invalidate the cache.
+        const int bigFontWidth = myMulti.sizeHint().width();
+        section.setSuffix(QStringLiteral(u"abcdefghijabcdefghij"));
+        config.clear();
+        config.append(section);
+        myMulti.setSectionConfigurations(config);
+        QVERIFY(myMulti.sizeHint().width() > bigFontWidth);
+
+        // A changed locale has to invalidate the cache.
+        myMulti.sizeHint();
+        myMulti.setLocale(QLocale(QLocale::Language::Bengali, QLocale::Country::Bangladesh));
+        QVERIFY(!myMulti.d_pointer->m_sizeHintCache.isValid());
+    }
+
+    void testSizeHintCacheButtonSymbolsAndFrame()
+    {
+        // Neither setButtonSymbols() nor setFrame() sends an event, but
+        // both change the size hint. The result has to be identical to
+        // the result of a widget that has never cached anything.
+        PerceptualColor::MultiSpinBox myMulti;
+        myMulti.sizeHint();
+        myMulti.setButtonSymbols(QAbstractSpinBox::ButtonSymbols::NoButtons);
+        PerceptualColor::MultiSpinBox referenceNoButtons;
+        referenceNoButtons.setButtonSymbols(QAbstractSpinBox::ButtonSymbols::NoButtons);
+        QCOMPARE(myMulti.sizeHint(), referenceNoButtons.sizeHint());
+        QCOMPARE(myMulti.minimumSizeHint(), referenceNoButtons.minimumSizeHint());
+
+        myMulti.setFrame(false);
+        PerceptualColor::MultiSpinBox referenceNoFrame;
+        referenceNoFrame.setButtonSymbols(QAbstractSpinBox::ButtonSymbols::NoButtons);
+        referenceNoFrame.setFrame(false);
+        QCOMPARE(myMulti.sizeHint(), referenceNoFrame.sizeHint());
+        QCOMPARE(myMulti.minimumSizeHint(), referenceNoFrame.minimumSizeHint());
+    }
+
     void testUpdatePrefixValueSuffixText()
     {
         PerceptualColor::MultiSpinBox myMulti;
@@ -0,0 +1,295 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "oklab.h"
+
+#include "helper.h"
+#include "oklabsrgbgamuttable.h"
+
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestOkLab : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestOkLab(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    static constexpr double tolerance = 0.01;
+
+    static bool isNear(const cmsCIELab &first, const cmsCIELab &second)
+    {
+        return qAbs(first.L - second.L) < tolerance //
+            && qAbs(first.a - second.a) < tolerance //
+            && qAbs(first.b - second.b) < tolerance;
+    }
+
+    // Maximum in-gamut chroma, found by a fine bisection. Returns the
+    // lower end of the bisection interval, which is surely in-gamut.
+    static qreal inGamutChroma(qreal lightness, qreal hue)
+    {
+        LchDouble candidate;
+        candidate.l = lightness;
+        candidate.c = 0;
+        candidate.h = hue;
+        if (!OkLab::isInSrgbGamut(OkLab::fromOklch(candidate))) {
+            return 0;
+        }
+        qreal lower = 0;
+        qreal upper = 50;
+        while (upper - lower > 0.0001) {
+            candidate.c = (lower + upper) / 2;
+            if (OkLab::isInSrgbGamut(OkLab::fromOklch(candidate))) {
+                lower = candidate.c;
+            } else {
+                upper = candidate.c;
+            }
+        }
+        return lower;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testReferenceValues()
+    {
+        // Reference values from https://bottosson.github.io/posts/oklab/
+        // (scaled by 100)
+        const RgbDouble red {1, 0, 0};
+        const cmsCIELab redOklab = OkLab::fromLinearSrgb(red);
+        QVERIFY(qAbs(redOklab.L - 62.796) < tolerance);
+        QVERIFY(qAbs(redOklab.a - 22.486) < tolerance);
+        QVERIFY(qAbs(redOklab.b - 12.585) < tolerance);
+
+        const RgbDouble white {1, 1, 1};
+        const cmsCIELab whiteOklab = OkLab::fromLinearSrgb(white);
+        QVERIFY(qAbs(whiteOklab.L - 100) < tolerance);
+        QVERIFY(qAbs(whiteOklab.a) < tolerance);
+        QVERIFY(qAbs(whiteOklab.b) < tolerance);
+    }
+
+    void testLinearSrgbRoundTrip()
+    {
+        const RgbDouble original {0.2, 0.5, 0.8};
+        const RgbDouble result = OkLab::toLinearSrgb(OkLab::fromLinearSrgb(original));
+        QVERIFY(qAbs(result.red - original.red) < 0.0001);
+        QVERIFY(qAbs(result.green - original.green) < 0.0001);
+        QVERIFY(qAbs(result.blue - original.blue) < 0.0001);
+    }
+
+    void testCielabRoundTrip()
+    {
+        cmsCIELab cielab;
+        cielab.L = 50;
+        cielab.a = 20;
+        cielab.b = -30;
+        const cmsCIELab result = OkLab::toCielabD50(OkLab::fromCielabD50(cielab));
+        QVERIFY(isNear(result, cielab));
+
+        // D50 white in CIELab is D65 white in Oklab.
+        cmsCIELab white;
+        white.L = 100;
+        white.a = 0;
+        white.b = 0;
+        const cmsCIELab whiteOklab = OkLab::fromCielabD50(white);
+        QVERIFY(qAbs(whiteOklab.L - 100) < tolerance);
+        QVERIFY(qAbs(whiteOklab.a) < tolerance);
+        QVERIFY(qAbs(whiteOklab.b) < tolerance);
+    }
+
+    void testOklchRoundTrip()
+    {
+        LchDouble oklch;
+        oklch.l = 60;
+        oklch.c = 10;
+        oklch.h = 200;
+        const LchDouble result = OkLab::toOklch(OkLab::fromOklch(oklch));
+        QVERIFY(qAbs(result.l - oklch.l) < tolerance);
+        QVERIFY(qAbs(result.c - oklch.c) < tolerance);
+        QVERIFY(qAbs(result.h - oklch.h) < tolerance);
+    }
+
+    void testBatchMatchesScalar()
+    {
+        const RgbDouble input[3] {{0, 0, 0}, {0.1, 0.7, 0.3}, {1, 1, 0}};
+        cmsCIELab output[3];
+        OkLab::fromLinearSrgb(input, output, 3);
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY(isNear(output[i], OkLab::fromLinearSrgb(input[i])));
+        }
+    }
+
+    void testCompanding()
+    {
+        const RgbDouble srgb {0.0, 0.5, 1.0};
+        const RgbDouble result = OkLab::linearSrgbToSrgb(OkLab::srgbToLinearSrgb(srgb));
+        QVERIFY(qAbs(result.red - srgb.red) < 0.0001);
+        QVERIFY(qAbs(result.green - srgb.green) < 0.0001);
+        QVERIFY(qAbs(result.blue - srgb.blue) < 0.0001);
+        QVERIFY(qAbs(OkLab::srgbInverseCompanding(0.5) - 0.214) < 0.001);
+    }
+
+    void testIsInSrgbGamut()
+    {
+        cmsCIELab gray;
+        gray.L = 50;
+        gray.a = 0;
+        gray.b = 0;
+        QVERIFY(OkLab::isInSrgbGamut(gray));
+        cmsCIELab white;
+        white.L = 100;
+        white.a = 0;
+        white.b = 0;
+        QVERIFY(OkLab::isInSrgbGamut(white));
+        cmsCIELab tooChromatic;
+        tooChromatic.L = 50;
+        tooChromatic.a = 40;
+        tooChromatic.b = 0;
+        QVERIFY(!OkLab::isInSrgbGamut(tooChromatic));
+    }
+
+    void testMaximumSrgbChroma()
+    {
+        // sRGB red has Oklch lightness 62.796, chroma 25.768 and
+        // hue 29.23 (scaled).
+        const qreal limit = OkLabSrgbGamutTable::maximumChroma(62.796, 29.23);
+        QVERIFY(limit >= 25.768 - tolerance);
+        QVERIFY(limit < 40);
+        // Black and white have no chroma at all.
+        QVERIFY(OkLabSrgbGamutTable::maximumChroma(0, 100) < 1);
+        // Out-of-range values should not crash.
+        Q_UNUSED(OkLabSrgbGamutTable::maximumChroma(-10, -500));
+        Q_UNUSED(OkLabSrgbGamutTable::maximumChroma(200, 1000));
+    }
+
+    void testMaximumSrgbChromaAtCusps()
+    {
+        // The primaries and secondaries of sRGB are the cusps of the
+        // gamut. They are not on the grid of the gamut table, and the
+        // boundary has its peaks here.
+        const QVector<RgbDouble> cusps{
+            {1, 0, 0}, // red
+            {1, 1, 0}, // yellow
+            {0, 1, 0}, // green
+            {0, 1, 1}, // cyan
+            {0, 0, 1}, // blue
+            {1, 0, 1} // magenta
+        };
+        for (const RgbDouble &cusp : cusps) {
+            const LchDouble oklch = OkLab::toOklch(OkLab::fromLinearSrgb(cusp));
+            QVERIFY(OkLabSrgbGamutTable::maximumChroma(oklch.l, oklch.h) >= oklch.c);
+        }
+    }
+
+    void testMaximumSrgbChromaSweep()
+    {
+        // Fractional steps, so that (nearly) no sample is on the grid
+        // of the gamut table.
+        for (qreal lightness = 0.25; lightness < 100; lightness += 0.731) {
+            for (qreal hue = 0.17; hue < 360; hue += 0.613) {
+                const qreal limit = OkLabSrgbGamutTable::maximumChroma(lightness, hue);
+                if (limit < inGamutChroma(lightness, hue)) {
+                    QFAIL(qPrintable(QStringLiteral("Limit too small at lightness %1 and hue %2").arg(lightness).arg(hue)));
+                }
+            }
+        }
+    }
+
+    void testOklchToSrgb()
+    {
+        LchDouble oklch[2];
+        oklch[0].l = 50;
+        oklch[0].c = 0;
+        oklch[0].h = 0;
+        oklch[1].l = 50;
+        oklch[1].c = 45;
+        oklch[1].h = 0;
+        RgbDouble srgb[2];
+        bool inGamut[2];
+        OkLab::oklchToSrgb(oklch, srgb, inGamut, 2);
+        QCOMPARE(inGamut[0], true);
+        QCOMPARE(inGamut[1], false);
+        // Gray has equal channels.
+        QVERIFY(qAbs(srgb[0].red - srgb[0].green) < 0.0001);
+        QVERIFY(qAbs(srgb[0].green - srgb[0].blue) < 0.0001);
+        // Out-of-gamut values are clipped.
+        QVERIFY(isInRange<double>(0, srgb[1].red, 1));
+        QVERIFY(isInRange<double>(0, srgb[1].green, 1));
+        QVERIFY(isInRange<double>(0, srgb[1].blue, 1));
+    }
+
+    void testOklabToSrgb()
+    {
+        cmsCIELab oklab[2];
+        oklab[0] = OkLab::fromOklch(LchDouble(50, 0, 0));
+        oklab[1] = OkLab::fromOklch(LchDouble(50, 45, 0));
+        RgbDouble srgb[2];
+        bool inGamut[2];
+        OkLab::oklabToSrgb(oklab, srgb, inGamut, 2);
+        QCOMPARE(inGamut[0], OkLab::isInSrgbGamut(oklab[0]));
+        QCOMPARE(inGamut[1], OkLab::isInSrgbGamut(oklab[1]));
+        const RgbDouble expected = OkLab::linearSrgbToSrgb(OkLab::toLinearSrgb(oklab[0]));
+        QCOMPARE(srgb[0].red, expected.red);
+        QCOMPARE(srgb[0].green, expected.green);
+        QCOMPARE(srgb[0].blue, expected.blue);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestOkLab)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testoklab.moc"
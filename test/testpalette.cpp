@@ -0,0 +1,217 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "palette.h"
+
+#include <QDataStream>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+
+namespace PerceptualColor
+{
+class TestPalette : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestPalette(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+    static bool read(const QSharedPointer<RgbColorSpace> &colorSpace, const QByteArray &data, Palette *result)
+    {
+        return Palette::readFromData(colorSpace, data.constData(), data.size(), result);
+    }
+
+    static void writeAseColor(QDataStream &stream, const QString &name, const char *model, const QVector<float> &channels)
+    {
+        QByteArray block;
+        QDataStream blockStream(&block, QIODevice::WriteOnly);
+        blockStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        blockStream << static_cast<quint16>(name.size() + 1);
+        for (const QChar &character : name) {
+            blockStream << static_cast<quint16>(character.unicode());
+        }
+        blockStream << static_cast<quint16>(0);
+        blockStream.writeRawData(model, 4);
+        for (float channel : channels) {
+            blockStream << channel;
+        }
+        blockStream << static_cast<quint16>(2); // Color type: normal
+        stream << static_cast<quint16>(0x0001);
+        stream << static_cast<quint32>(block.size());
+        stream.writeRawData(block.constData(), block.size());
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testGpl()
+    {
+        const QByteArray data = //
+            "GIMP Palette\n"
+            "Name: Test palette\n"
+            "Columns: 4\n"
+            "# Comment\n"
+            "255   0   0\tRed\r\n"
+            "  0   0   0\n"
+            "invalid line\n"
+            "255 255 255 Snow white\n";
+        Palette palette;
+        QVERIFY(read(m_rgbColorSpace, data, &palette));
+        QCOMPARE(palette.title(), QStringLiteral("Test palette"));
+        QCOMPARE(palette.count(), 3);
+        QCOMPARE(palette.name(0), QStringLiteral("Red"));
+        QCOMPARE(palette.name(1), QString());
+        QCOMPARE(palette.name(2), QStringLiteral("Snow white"));
+        const LchDouble red = m_rgbColorSpace->toLch(QColor(255, 0, 0));
+        QVERIFY(qAbs(palette.color(0).l - red.l) < 0.1);
+        QVERIFY(qAbs(palette.color(0).c - red.c) < 0.1);
+        QCOMPARE(palette.color(0).a, 1.0);
+        QVERIFY(palette.color(1).l < 1);
+        QVERIFY(palette.color(2).l > 99);
+    }
+
+    void testCss()
+    {
+        const QByteArray data = //
+            ":root {\n"
+            "  /* --commented: #000; */\n"
+            "  --accent: #FF0000;\n"
+            "  --shadow: rgb(0 0 0 / 50%);\n"
+            "  --spacing: 4px;\n"
+            "  --vivid: lch(50 200 30)\n"
+            "}\n"
+            "a { color: var(--accent); }\n";
+        Palette palette;
+        QVERIFY(read(m_rgbColorSpace, data, &palette));
+        QCOMPARE(palette.count(), 3);
+        QCOMPARE(palette.name(0), QStringLiteral("accent"));
+        QCOMPARE(palette.name(1), QStringLiteral("shadow"));
+        QCOMPARE(palette.name(2), QStringLiteral("vivid"));
+        QCOMPARE(palette.color(1).a, 0.5);
+        // Out-of-gamut colors are moved into the gamut.
+        const LchaDouble vivid = palette.color(2);
+        QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(vivid.l, vivid.c, vivid.h)));
+        QVERIFY(qAbs(vivid.l - 50) < 0.1);
+        QVERIFY(qAbs(vivid.h - 30) < 0.1);
+        QVERIFY(vivid.c < 200);
+    }
+
+    void testAse()
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.writeRawData("ASEF", 4);
+        stream << static_cast<quint16>(1) << static_cast<quint16>(0);
+        stream << static_cast<quint32>(4);
+        writeAseColor(stream, QStringLiteral("Grün"), "RGB ", {0, 1, 0});
+        writeAseColor(stream, QStringLiteral("Print"), "CMYK", {0, 0, 0, 1});
+        writeAseColor(stream, QStringLiteral("Lab"), "LAB ", {0.5f, 10, -10});
+        writeAseColor(stream, QString(), "Gray", {0.5f});
+        Palette palette;
+        QVERIFY(read(m_rgbColorSpace, data, &palette));
+        // The CMYK entry is skipped.
+        QCOMPARE(palette.count(), 3);
+        QCOMPARE(palette.name(0), QStringLiteral("Grün"));
+        QCOMPARE(palette.name(1), QStringLiteral("Lab"));
+        QCOMPARE(palette.name(2), QString());
+        QVERIFY(qAbs(palette.color(1).l - 50) < 0.01);
+        QVERIFY(qAbs(palette.color(2).c) < 0.5);
+
+        // Truncated data is rejected.
+        QVERIFY(!read(m_rgbColorSpace, data.left(data.size() - 3), &palette));
+    }
+
+    void testInvalid()
+    {
+        Palette palette;
+        QVERIFY(!read(m_rgbColorSpace, QByteArray(), &palette));
+        QVERIFY(!read(m_rgbColorSpace, QByteArray("no colors here"), &palette));
+        QVERIFY(!read(m_rgbColorSpace, QByteArray("ASEF\x00\x01"), &palette));
+        QVERIFY(!Palette::readFromFile(m_rgbColorSpace, QStringLiteral("/nonexistent/file.gpl"), &palette));
+    }
+
+    void testReadFromFile()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString fileName = directory.filePath(QStringLiteral("test.gpl"));
+        QByteArray data = "GIMP Palette\n";
+        for (int i = 0; i < 1000; ++i) {
+            data += QByteArray::number(i % 256) + " 128 64 Color " + QByteArray::number(i) + "\n";
+        }
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        file.close();
+
+        Palette palette;
+        QVERIFY(Palette::readFromFile(m_rgbColorSpace, fileName, &palette));
+        QCOMPARE(palette.count(), 1000);
+        QCOMPARE(palette.name(999), QStringLiteral("Color 999"));
+        for (int i = 0; i < palette.count(); ++i) {
+            const LchaDouble color = palette.color(i);
+            QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(color.l, color.c, color.h)));
+        }
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestPalette)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testpalette.moc"
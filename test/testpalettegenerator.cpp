@@ -0,0 +1,319 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "PerceptualColor/palettegenerator.h"
+
+#include <QElapsedTimer>
+#include <QtTest>
+
+#include <functional>
+#include <limits>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "helper.h"
+#include "lchvalues.h"
+#include "rgbcolorspace.h"
+
+static void snippet01()
+{
+    //! [PaletteGenerator Ramps]
+    const QSharedPointer<PerceptualColor::RgbColorSpace> colorSpace = PerceptualColor::RgbColorSpaceFactory::createSrgb();
+    // Ten steps from light to dark for a blue and an orange hue:
+    const QVector<qreal> hues{250, 60};
+    const QVector<QVector<PerceptualColor::LchDouble>> ramps = PerceptualColor::PaletteGenerator::lightnessRamps(colorSpace, hues, 95, 5, 10);
+    //! [PaletteGenerator Ramps]
+    QCOMPARE(ramps.count(), 2);
+    QCOMPARE(ramps.at(0).count(), 10);
+}
+
+namespace PerceptualColor
+{
+class TestPaletteGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestPaletteGenerator(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+    // Tolerance when comparing with the scalar gamut search
+    static constexpr qreal chromaTolerance = 0.01;
+
+    // Checks that the chroma of the color is the highest in-gamut chroma
+    // (or the requested chroma).
+    void verifyMaximumChroma(const LchDouble &color, qreal requestedChroma)
+    {
+        const LchDouble expected = m_rgbColorSpace->nearestInGamutColorByAdjustingChroma( //
+            LchDouble(color.l, requestedChroma, color.h));
+        QVERIFY(m_rgbColorSpace->isInGamut(color));
+        QVERIFY2(qAbs(color.c - expected.c) <= chromaTolerance,
+                 qPrintable(QStringLiteral("L %1 C %2 h %3: expected C %4") //
+                                .arg(color.l)
+                                .arg(color.c)
+                                .arg(color.h)
+                                .arg(expected.c)));
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testSnippet01()
+    {
+        snippet01();
+    }
+
+    void testLightnessRamp()
+    {
+        const QVector<LchDouble> ramp = PaletteGenerator::lightnessRamp(m_rgbColorSpace, 250, 95, 5, 10);
+        QCOMPARE(ramp.count(), 10);
+        for (int i = 0; i < ramp.count(); ++i) {
+            QVERIFY(qAbs(ramp.at(i).l - (95 - i * 10)) < 0.000001);
+            QVERIFY(qAbs(ramp.at(i).h - 250) < 0.000001);
+            verifyMaximumChroma(ramp.at(i), LchValues::humanMaximumChroma);
+        }
+    }
+
+    void testLightnessRampManyHues()
+    {
+        // Also hues that are not in the gamut table, and hues near the
+        // sharp corners of the sRGB gamut.
+        for (qreal hue = 0; hue < 360; hue += 7.3) {
+            const QVector<LchDouble> ramp = PaletteGenerator::lightnessRamp(m_rgbColorSpace, hue, 97, 3, 25);
+            QCOMPARE(ramp.count(), 25);
+            for (const LchDouble &color : ramp) {
+                verifyMaximumChroma(color, LchValues::humanMaximumChroma);
+            }
+        }
+    }
+
+    void testLightnessRampEdgeCases()
+    {
+        QVERIFY(PaletteGenerator::lightnessRamp(m_rgbColorSpace, 0, 100, 0, 0).isEmpty());
+        QVERIFY(PaletteGenerator::lightnessRamp(m_rgbColorSpace, 0, 100, 0, -5).isEmpty());
+        const QVector<LchDouble> single = PaletteGenerator::lightnessRamp(m_rgbColorSpace, 0, 60, 0, 1);
+        QCOMPARE(single.count(), 1);
+        QCOMPARE(single.first().l, static_cast<qreal>(60));
+        // Out-of-range lightnesses are moved to the gray axis.
+        const QVector<LchDouble> extreme = PaletteGenerator::lightnessRamp(m_rgbColorSpace, 0, 150, -50, 3);
+        QCOMPARE(extreme.count(), 3);
+        for (const LchDouble &color : extreme) {
+            QVERIFY(m_rgbColorSpace->isInGamut(color));
+        }
+        QCOMPARE(extreme.first().c, static_cast<qreal>(0));
+        QCOMPARE(extreme.last().c, static_cast<qreal>(0));
+        // Absurd values do not hang.
+        PaletteGenerator::lightnessRamp(m_rgbColorSpace, qQNaN(), 100, 0, 3);
+        PaletteGenerator::lightnessRamp(m_rgbColorSpace, 0, qInf(), 0, 3);
+    }
+
+    void testLightnessRamps()
+    {
+        const QVector<qreal> hues {0, 30, 60, 90, 120, 150, 180, 210, 240, 270, 300, 330};
+        const QVector<QVector<LchDouble>> ramps = PaletteGenerator::lightnessRamps(m_rgbColorSpace, hues, 95, 5, 10);
+        QCOMPARE(ramps.count(), hues.count());
+        for (int i = 0; i < hues.count(); ++i) {
+            const QVector<LchDouble> expected = PaletteGenerator::lightnessRamp(m_rgbColorSpace, hues.at(i), 95, 5, 10);
+            QCOMPARE(ramps.at(i).count(), expected.count());
+            for (int j = 0; j < expected.count(); ++j) {
+                QVERIFY(ramps.at(i).at(j).hasSameCoordinates(expected.at(j)));
+            }
+        }
+        QVERIFY(PaletteGenerator::lightnessRamps(m_rgbColorSpace, QVector<qreal>(), 95, 5, 10).isEmpty());
+    }
+
+    void testHueSet()
+    {
+        const QVector<LchDouble> hues = PaletteGenerator::hueSet(m_rgbColorSpace, 60, LchValues::humanMaximumChroma, 15, 12);
+        QCOMPARE(hues.count(), 12);
+        for (int i = 0; i < hues.count(); ++i) {
+            QVERIFY(qAbs(hues.at(i).h - (15 + i * 30)) < 0.000001);
+            QCOMPARE(hues.at(i).l, static_cast<qreal>(60));
+            verifyMaximumChroma(hues.at(i), LchValues::humanMaximumChroma);
+        }
+    }
+
+    void testHueSetRequestedChroma()
+    {
+        // A small chroma is in-gamut for all hues and is not changed.
+        const QVector<LchDouble> gray = PaletteGenerator::hueSet(m_rgbColorSpace, 50, 10, 0, 36);
+        for (const LchDouble &color : gray) {
+            QCOMPARE(color.c, static_cast<qreal>(10));
+        }
+        // A medium chroma is in-gamut only for some hues.
+        const QVector<LchDouble> medium = PaletteGenerator::hueSet(m_rgbColorSpace, 50, 50, 0, 360);
+        bool hasReducedChroma = false;
+        for (const LchDouble &color : medium) {
+            verifyMaximumChroma(color, 50);
+            if (color.c < 50) {
+                hasReducedChroma = true;
+            }
+        }
+        QVERIFY(hasReducedChroma);
+    }
+
+    void testHueSetEdgeCases()
+    {
+        QVERIFY(PaletteGenerator::hueSet(m_rgbColorSpace, 50, 50, 0, 0).isEmpty());
+        // No in-gamut colors at this lightness
+        const QVector<LchDouble> tooLight = PaletteGenerator::hueSet(m_rgbColorSpace, 150, 50, 0, 4);
+        QCOMPARE(tooLight.count(), 4);
+        for (const LchDouble &color : tooLight) {
+            QVERIFY(m_rgbColorSpace->isInGamut(color));
+            QCOMPARE(color.c, static_cast<qreal>(0));
+        }
+        // Absurd values do not hang.
+        PaletteGenerator::hueSet(m_rgbColorSpace, qQNaN(), 50, 0, 4);
+        PaletteGenerator::hueSet(m_rgbColorSpace, 50, qInf(), qQNaN(), 4);
+    }
+
+    void testCachedBoundary()
+    {
+        // Lightnesses that are not in the cache use the direct path.
+        // After the boundary has been cached, they use the boundary path.
+        // Both give the same results. (For the built-in sRGB profile,
+        // the boundaries of the hues might come from the gamut table
+        // even if they are not cached.)
+        constexpr qreal hue = 123.45;
+        constexpr qreal lightness = 56.78;
+        QVERIFY(m_rgbColorSpace->cachedChromaHueBoundary(lightness).isNull());
+        const QVector<LchDouble> coldRamp = PaletteGenerator::lightnessRamp(m_rgbColorSpace, hue, 95, 5, 10);
+        const QVector<LchDouble> coldHues = PaletteGenerator::hueSet(m_rgbColorSpace, lightness, LchValues::humanMaximumChroma, 0, 36);
+        // The generator does not calculate boundaries itself.
+        QVERIFY(m_rgbColorSpace->cachedChromaHueBoundary(lightness).isNull());
+
+        m_rgbColorSpace->chromaLightnessBoundary(hue);
+        QVERIFY(!m_rgbColorSpace->cachedChromaLightnessBoundary(hue).isNull());
+        QCOMPARE(m_rgbColorSpace->cachedChromaHueBoundary(lightness), m_rgbColorSpace->chromaHueBoundary(lightness));
+        const QVector<LchDouble> warmRamp = PaletteGenerator::lightnessRamp(m_rgbColorSpace, hue, 95, 5, 10);
+        const QVector<LchDouble> warmHues = PaletteGenerator::hueSet(m_rgbColorSpace, lightness, LchValues::humanMaximumChroma, 0, 36);
+        for (int i = 0; i < coldRamp.count(); ++i) {
+            QVERIFY(qAbs(coldRamp.at(i).c - warmRamp.at(i).c) <= chromaTolerance);
+            verifyMaximumChroma(warmRamp.at(i), LchValues::humanMaximumChroma);
+        }
+        for (int i = 0; i < coldHues.count(); ++i) {
+            QVERIFY(qAbs(coldHues.at(i).c - warmHues.at(i).c) <= chromaTolerance);
+            verifyMaximumChroma(warmHues.at(i), LchValues::humanMaximumChroma);
+        }
+    }
+
+    void testDesignSystemSpeed()
+    {
+        // A design system with 36 hues and 12 steps per ramp, plus
+        // hue sets at each of the 12 lightnesses. With the boundaries
+        // cached, the generator must not be slower than correcting
+        // the same colors directly with the batch search. The margin
+        // is generous, because the time measurement is noisy.
+        constexpr int hueCount = 36;
+        constexpr int stepCount = 12;
+        QVector<qreal> hues;
+        for (int i = 0; i < hueCount; ++i) {
+            hues.append(i * 10);
+            m_rgbColorSpace->chromaLightnessBoundary(hues.last());
+        }
+        QVector<qreal> lightnesses;
+        for (int i = 0; i < stepCount; ++i) {
+            lightnesses.append(96 - i * 8);
+            m_rgbColorSpace->chromaHueBoundary(lightnesses.last());
+        }
+
+        const auto withBoundaries = [&]() {
+            for (const qreal hue : hues) {
+                PaletteGenerator::lightnessRamp(m_rgbColorSpace, hue, 96, 8, stepCount);
+            }
+            for (const qreal lightness : lightnesses) {
+                PaletteGenerator::hueSet(m_rgbColorSpace, lightness, LchValues::humanMaximumChroma, 0, hueCount);
+            }
+        };
+        const auto direct = [&]() {
+            for (const qreal hue : hues) {
+                QVector<LchDouble> colors;
+                for (const qreal lightness : lightnesses) {
+                    colors.append(LchDouble(lightness, LchValues::humanMaximumChroma, hue));
+                }
+                PaletteGenerator::reduceChroma(*m_rgbColorSpace, colors);
+            }
+            for (const qreal lightness : lightnesses) {
+                QVector<LchDouble> colors;
+                for (const qreal hue : hues) {
+                    colors.append(LchDouble(lightness, LchValues::humanMaximumChroma, hue));
+                }
+                PaletteGenerator::reduceChroma(*m_rgbColorSpace, colors);
+            }
+        };
+        // The fastest of some runs is the least noisy measurement.
+        const auto fastest = [](const std::function<void()> &function) {
+            qint64 result = std::numeric_limits<qint64>::max();
+            for (int run = 0; run < 5; ++run) {
+                QElapsedTimer timer;
+                timer.start();
+                function();
+                result = qMin(result, timer.nsecsElapsed());
+            }
+            return result;
+        };
+        const qint64 directNanoseconds = fastest(direct);
+        const qint64 boundaryNanoseconds = fastest(withBoundaries);
+        QVERIFY2(boundaryNanoseconds <= directNanoseconds * 3 / 2,
+                 qPrintable(QStringLiteral("With boundaries: %1 ns, direct: %2 ns") //
+                                .arg(boundaryNanoseconds)
+                                .arg(directNanoseconds)));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestPaletteGenerator)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testpalettegenerator.moc"
@@ -0,0 +1,114 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "palettemodel.h"
+
+#include <QtTest>
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "palette.h"
+
+namespace PerceptualColor
+{
+class TestPaletteModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestPaletteModel(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testConstructor()
+    {
+        PaletteModel model(m_rgbColorSpace);
+        QCOMPARE(model.rowCount(), 0);
+    }
+
+    void testData()
+    {
+        const QByteArray data = //
+            "GIMP Palette\n"
+            "255 0 0 Red\n"
+            "0 0 255\n";
+        Palette palette;
+        QVERIFY(Palette::readFromData(m_rgbColorSpace, data.constData(), data.size(), &palette));
+
+        PaletteModel model(m_rgbColorSpace);
+        QSignalSpy spy(&model, &QAbstractItemModel::modelReset);
+        model.setPalette(palette);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.palette().count(), 2);
+
+        QCOMPARE(model.data(model.index(0)).toString(), QStringLiteral("Red"));
+        QCOMPARE(model.data(model.index(1)).toString(), QStringLiteral("#0000FF"));
+        const QColor red = model.data(model.index(0), Qt::DecorationRole).value<QColor>();
+        QCOMPARE(red.red(), 255);
+        QCOMPARE(red.green(), 0);
+        QVERIFY(model.data(model.index(0), Qt::ToolTipRole).toString().startsWith(QStringLiteral("lch(")));
+        const LchaDouble lcha = model.data(model.index(0), PaletteModel::lchaRole).value<LchaDouble>();
+        QCOMPARE(lcha.l, palette.color(0).l);
+        QVERIFY(!model.data(model.index(2)).isValid());
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestPaletteModel)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testpalettemodel.moc"
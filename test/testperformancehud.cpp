@@ -0,0 +1,175 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "performancehud.h"
+
+#include <QtTest>
+
+#include "PerceptualColor/colorwheel.h"
+#include "PerceptualColor/gradientslider.h"
+#include "rgbcolorspace.h"
+
+namespace PerceptualColor
+{
+class TestPerformanceHud : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestPerformanceHud(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpace::createSrgb();
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+        PerformanceHud::setEnabled(false);
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+        PerformanceHud::setEnabled(false);
+    }
+
+    void testSetEnabled()
+    {
+        PerformanceHud::setEnabled(true);
+        QVERIFY(PerformanceHud::isEnabled());
+        PerformanceHud::setEnabled(false);
+        QVERIFY(!PerformanceHud::isEnabled());
+    }
+
+    void testDisabled()
+    {
+        ColorWheel myWheel(m_rgbColorSpace);
+        myWheel.resize(200, 200);
+        myWheel.grab();
+        QVERIFY(PerformanceHud::of(&myWheel) == nullptr);
+    }
+
+    void testDisabledPaintingUnchanged()
+    {
+        ColorWheel myWheel(m_rgbColorSpace);
+        myWheel.resize(200, 200);
+        const QImage withoutHud = myWheel.grab().toImage();
+        PerformanceHud::setEnabled(true);
+        const QImage withHud = myWheel.grab().toImage();
+        PerformanceHud::setEnabled(false);
+        const QImage afterHud = myWheel.grab().toImage();
+        QVERIFY(withoutHud != withHud);
+        QCOMPARE(afterHud, withoutHud);
+    }
+
+    void testPaintStatistics()
+    {
+        PerformanceHud::setEnabled(true);
+        ColorWheel myWheel(m_rgbColorSpace);
+        myWheel.resize(200, 200);
+        myWheel.grab();
+        PerformanceHud *hud = PerformanceHud::of(&myWheel);
+        QVERIFY(hud != nullptr);
+        QCOMPARE(hud->m_frameCount, 1);
+        QCOMPARE(hud->m_lastImageCount, 1);
+        // The first image has to be rendered.
+        QVERIFY(!hud->m_lastImageIsCacheHit);
+        myWheel.grab();
+        QCOMPARE(hud->m_frameCount, 2);
+        // Nothing has changed, so the image comes from the cache.
+        QVERIFY(hud->m_lastImageIsCacheHit);
+    }
+
+    void testAverage()
+    {
+        PerformanceHud hud;
+        for (int i = 0; i < PerformanceHud::averageFrameCount + 5; ++i) {
+            hud.beginPaint();
+            hud.endPaint(nullptr);
+        }
+        QCOMPARE(hud.m_frameCount, PerformanceHud::averageFrameCount + 5);
+        QCOMPARE(hud.m_frameTimes.count(), PerformanceHud::averageFrameCount);
+    }
+
+    void testCoalescedEvents()
+    {
+        PerformanceHud hud;
+        QMouseEvent move(QEvent::MouseMove, //
+                         QPointF(1, 1),
+                         Qt::NoButton,
+                         Qt::NoButton,
+                         Qt::NoModifier);
+        QEvent other(QEvent::ToolTip);
+        hud.countEvent(&move);
+        hud.countEvent(&move);
+        hud.countEvent(&other);
+        hud.beginPaint();
+        hud.endPaint(nullptr);
+        QCOMPARE(hud.m_lastCoalescedEventCount, 2);
+        QVERIFY(hud.text().contains(QStringLiteral("coalesced events 2")));
+        hud.beginPaint();
+        hud.endPaint(nullptr);
+        QCOMPARE(hud.m_lastCoalescedEventCount, 0);
+    }
+
+    void testGradientSlider()
+    {
+        PerformanceHud::setEnabled(true);
+        GradientSlider mySlider(m_rgbColorSpace);
+        mySlider.resize(200, 30);
+        mySlider.grab();
+        PerformanceHud *hud = PerformanceHud::of(&mySlider);
+        QVERIFY(hud != nullptr);
+        QCOMPARE(hud->m_lastImageCount, 1);
+        QVERIFY(hud->text().contains(QStringLiteral("paint")));
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestPerformanceHud)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testperformancehud.moc"
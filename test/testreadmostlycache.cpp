@@ -0,0 +1,201 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "readmostlycache.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QtConcurrent>
+#include <QtTest>
+
+#include <atomic>
+
+namespace PerceptualColor
+{
+class TestReadMostlyCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestReadMostlyCache(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testConstructor()
+    {
+        ReadMostlyCache<int, QString> cache(10);
+        QCOMPARE(cache.count(), 0);
+        QCOMPARE(cache.totalCost(), 0);
+        QCOMPARE(cache.maximumCost(), 10);
+    }
+
+    void testInsert()
+    {
+        ReadMostlyCache<int, QString> cache;
+        QVERIFY(cache.insert(1, QStringLiteral("one")));
+        QVERIFY(cache.insert(2, QStringLiteral("two")));
+        QCOMPARE(cache.count(), 2);
+        QCOMPARE(cache.value(1), QStringLiteral("one"));
+        QCOMPARE(cache.value(2), QStringLiteral("two"));
+        QCOMPARE(cache.value(3), QString());
+        QCOMPARE(cache.value(3, QStringLiteral("default")), QStringLiteral("default"));
+        // Replace
+        QVERIFY(cache.insert(1, QStringLiteral("uno")));
+        QCOMPARE(cache.count(), 2);
+        QCOMPARE(cache.value(1), QStringLiteral("uno"));
+        QCOMPARE(cache.totalCost(), 2);
+    }
+
+    void testFind()
+    {
+        ReadMostlyCache<int, QSharedPointer<int>> cache;
+        // Also nullptr values can be cached.
+        cache.insert(1, nullptr);
+        QSharedPointer<int> value(new int(5));
+        QVERIFY(cache.find(1, &value));
+        QVERIFY(value.isNull());
+        value.reset(new int(5));
+        QVERIFY(!cache.find(2, &value));
+        QCOMPARE(*value, 5);
+    }
+
+    void testCost()
+    {
+        ReadMostlyCache<int, int> cache(10);
+        QVERIFY(cache.insert(1, 1, 4));
+        QVERIFY(cache.insert(2, 2, 4));
+        QCOMPARE(cache.totalCost(), 8);
+        // The oldest entry is removed to make room.
+        QVERIFY(cache.insert(3, 3, 4));
+        QCOMPARE(cache.count(), 2);
+        QCOMPARE(cache.totalCost(), 8);
+        QCOMPARE(cache.value(1, -1), -1);
+        QCOMPARE(cache.value(2, -1), 2);
+        QCOMPARE(cache.value(3, -1), 3);
+        // Too expensive entries are not inserted, but replace
+        // nevertheless an existing entry.
+        QVERIFY(!cache.insert(2, 20, 11));
+        QCOMPARE(cache.value(2, -1), -1);
+        QCOMPARE(cache.count(), 1);
+        QCOMPARE(cache.totalCost(), 4);
+    }
+
+    void testInsertIf()
+    {
+        ReadMostlyCache<int, int> cache;
+        const auto isBigger = [](const int existing) {
+            return existing < 10;
+        };
+        // Without an existing entry, the predicate is not asked.
+        QVERIFY(cache.insertIf(1, 20, 1, isBigger));
+        QCOMPARE(cache.value(1), 20);
+        QVERIFY(!cache.insertIf(1, 30, 1, isBigger));
+        QCOMPARE(cache.value(1), 20);
+        cache.insert(1, 5);
+        QVERIFY(cache.insertIf(1, 30, 1, isBigger));
+        QCOMPARE(cache.value(1), 30);
+    }
+
+    void testClear()
+    {
+        ReadMostlyCache<int, int> cache;
+        cache.insert(1, 1);
+        cache.insert(2, 2);
+        cache.clear();
+        QCOMPARE(cache.count(), 0);
+        QCOMPARE(cache.totalCost(), 0);
+        QCOMPARE(cache.value(1, -1), -1);
+    }
+
+    void testConcurrentReadersAndWriters()
+    {
+        // Readers and writers run at the same time. Each value is the
+        // square of its key, so readers can verify what they see.
+        const int keyCount = 64;
+        ReadMostlyCache<int, QSharedPointer<const int>> cache(keyCount / 2);
+        std::atomic<bool> isWriting {true};
+        std::atomic<int> errorCount {0};
+        QVector<int> readers {0, 1, 2, 3};
+        QFuture<void> writer = QtConcurrent::run([&cache, &isWriting, keyCount]() {
+            for (int round = 0; round < 200; ++round) {
+                for (int key = 0; key < keyCount; ++key) {
+                    cache.insert(key, QSharedPointer<const int>(new int(key * key)));
+                }
+            }
+            isWriting = false;
+        });
+        QtConcurrent::blockingMap(readers, [&cache, &isWriting, &errorCount, keyCount](const int reader) {
+            int key = reader;
+            while (isWriting) {
+                const QSharedPointer<const int> value = cache.value(key);
+                if (!value.isNull() && (*value != key * key)) {
+                    ++errorCount;
+                }
+                if (cache.totalCost() > cache.maximumCost()) {
+                    ++errorCount;
+                }
+                key = (key + 7) % keyCount;
+            }
+        });
+        writer.waitForFinished();
+        QCOMPARE(errorCount.load(), 0);
+        QCOMPARE(cache.count(), keyCount / 2);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestReadMostlyCache)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testreadmostlycache.moc"
@@ -33,12 +33,45 @@
 // Second, the private implementation.
 #include "rgbcolorspace_p.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtMath>
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "chromahueboundary.h"
+#include "chromalightnessboundary.h"
+#include "displaytransform.h"
+#include "helper.h"
+
+#include <limits>
+
+#include <lcms2.h>
 
 namespace PerceptualColor
 {
+/** @brief The raw data of an ICC profile with sRGB primaries.
+ *
+ * @param gamma The gamma of the tone curves
+ * @returns The raw data of the profile */
+static QByteArray rgbProfileData(double gamma)
+{
+    cmsToneCurve *curve = cmsBuildGamma(nullptr, gamma);
+    cmsToneCurve *curves[3] = {curve, curve, curve};
+    const cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    const cmsCIExyYTRIPLE primaries {{0.64, 0.33, 1}, {0.30, 0.60, 1}, {0.15, 0.06, 1}};
+    cmsHPROFILE profileHandle = cmsCreateRGBProfile(&whitePoint, &primaries, curves);
+    cmsFreeToneCurve(curve);
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profileHandle, nullptr, &size);
+    QByteArray result(static_cast<int>(size), 0);
+    cmsSaveProfileToMem(profileHandle, result.data(), &size);
+    cmsCloseProfile(profileHandle);
+    return result;
+}
+
 class TestRgbColorSpace : public QObject
 {
     Q_OBJECT
@@ -70,6 +103,90 @@ private Q_SLOTS:
         // Called after every test function
     }
 
+    void testDeviceLinkCache()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        const QString profileFileName = directory.filePath(QStringLiteral("srgb.icc"));
+        cmsHPROFILE srgb = cmsCreate_sRGBProfile();
+        QVERIFY(cmsSaveProfileToFile(srgb, QFile::encodeName(profileFileName).constData()));
+        cmsCloseProfile(srgb);
+        const QString cacheDirectory = directory.filePath(QStringLiteral("cache"));
+
+        // Disabled by default
+        QVERIFY(RgbColorSpace::deviceLinkCacheDirectory().isEmpty());
+        auto uncached = RgbColorSpace::createFromFile(profileFileName);
+        QVERIFY(!uncached.isNull());
+        QVERIFY(RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheFileName(profileFileName).isEmpty());
+
+        RgbColorSpace::setDeviceLinkCacheDirectory(cacheDirectory);
+        QCOMPARE(RgbColorSpace::deviceLinkCacheDirectory(), cacheDirectory);
+        // First run: Creates the device link
+        auto first = RgbColorSpace::createFromFile(profileFileName);
+        QVERIFY(!first.isNull());
+        const QString cacheFileName = //
+            RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheFileName(profileFileName);
+        QVERIFY(!cacheFileName.isEmpty());
+        QCOMPARE(QDir(cacheDirectory).entryList(QDir::Files), //
+                 QStringList {QFileInfo(cacheFileName).fileName()});
+        // Second run: Uses the device link instead of replacing it.
+        const QDateTime oldTime = QDateTime::currentDateTime().addDays(-1);
+        {
+            QFile cacheFile(cacheFileName);
+            QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+            QVERIFY(cacheFile.setFileTime(oldTime, QFileDevice::FileModificationTime));
+        }
+        auto second = RgbColorSpace::createFromFile(profileFileName);
+        QVERIFY(!second.isNull());
+        QCOMPARE(QFileInfo(cacheFileName).lastModified().toSecsSinceEpoch(), //
+                 oldTime.toSecsSinceEpoch());
+        // Both transforms give (almost) the same result.
+        const LchDouble color {50, 30, 120};
+        const QColor firstColor = first->toQColorRgbBound(color);
+        const QColor secondColor = second->toQColorRgbBound(color);
+        QVERIFY(qAbs(firstColor.red() - secondColor.red()) <= 1);
+        QVERIFY(qAbs(firstColor.green() - secondColor.green()) <= 1);
+        QVERIFY(qAbs(firstColor.blue() - secondColor.blue()) <= 1);
+        // The built-in sRGB profile does not use the cache.
+        auto builtIn = RgbColorSpace::createSrgb();
+        QVERIFY(!builtIn.isNull());
+        QCOMPARE(QDir(cacheDirectory).entryList(QDir::Files).count(), 1);
+
+        // A modified source profile does not use the outdated device
+        // link, even if it keeps its path and its modification time.
+        const QDateTime profileTime = QFileInfo(profileFileName).lastModified();
+        cmsToneCurve *linearCurve = cmsBuildGamma(nullptr, 1.0);
+        cmsToneCurve *curves[3] = {linearCurve, linearCurve, linearCurve};
+        const cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+        const cmsCIExyYTRIPLE primaries {{0.64, 0.33, 1}, {0.30, 0.60, 1}, {0.15, 0.06, 1}};
+        cmsHPROFILE linearSrgb = cmsCreateRGBProfile(&whitePoint, &primaries, curves);
+        cmsFreeToneCurve(linearCurve);
+        QVERIFY(cmsSaveProfileToFile(linearSrgb, QFile::encodeName(profileFileName).constData()));
+        cmsCloseProfile(linearSrgb);
+        {
+            QFile profileFile(profileFileName);
+            QVERIFY(profileFile.open(QIODevice::ReadWrite));
+            QVERIFY(profileFile.setFileTime(profileTime, QFileDevice::FileModificationTime));
+        }
+        QCOMPARE(RgbColorSpace::RgbColorSpacePrivate::deviceLinkCacheFileName(profileFileName), cacheFileName);
+        auto modified = RgbColorSpace::createFromFile(profileFileName);
+        QVERIFY(!modified.isNull());
+        // The outdated device link has been replaced.
+        QVERIFY(QFileInfo(cacheFileName).lastModified().toSecsSinceEpoch() != oldTime.toSecsSinceEpoch());
+        QCOMPARE(QDir(cacheDirectory).entryList(QDir::Files).count(), 1);
+        // The new device link is used.
+        auto modifiedCached = RgbColorSpace::createFromFile(profileFileName);
+        QVERIFY(!modifiedCached.isNull());
+        const QColor modifiedColor = modified->toQColorRgbBound(color);
+        const QColor modifiedCachedColor = modifiedCached->toQColorRgbBound(color);
+        QVERIFY(modifiedColor != firstColor);
+        QVERIFY(qAbs(modifiedColor.red() - modifiedCachedColor.red()) <= 1);
+        QVERIFY(qAbs(modifiedColor.green() - modifiedCachedColor.green()) <= 1);
+        QVERIFY(qAbs(modifiedColor.blue() - modifiedCachedColor.blue()) <= 1);
+
+        RgbColorSpace::setDeviceLinkCacheDirectory(QString());
+    }
+
     void testNearestInGamutColorByAdjustingChromaLightness()
     {
         QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
@@ -97,6 +214,298 @@ private Q_SLOTS:
         QCOMPARE(nearestInGamutColor.c, 0);
         QCOMPARE(nearestInGamutColor.h, 10);
     }
+
+    void testNearestInGamutColorByAdjustingChromaPrecision()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        const LchDouble outOfGamut(50, 200, 30);
+        const LchDouble precise = myColorSpace->nearestInGamutColorByAdjustingChroma(outOfGamut);
+        QVERIFY(myColorSpace->isInGamut(precise));
+
+        // A coarse precision still returns an in-gamut color, and its
+        // chroma is within the tolerance.
+        const LchDouble coarse = myColorSpace->nearestInGamutColorByAdjustingChroma(outOfGamut, 0.5);
+        QVERIFY(myColorSpace->isInGamut(coarse));
+        QVERIFY(coarse.c <= precise.c + gamutPrecision);
+        QVERIFY(precise.c - coarse.c <= 0.5 + gamutPrecision);
+        QCOMPARE(coarse.l, precise.l);
+        QCOMPARE(coarse.h, precise.h);
+
+        // Precision values below gamutPrecision are treated as gamutPrecision.
+        const LchDouble tooFine = myColorSpace->nearestInGamutColorByAdjustingChroma(outOfGamut, 0);
+        QCOMPARE(tooFine.c, precise.c);
+
+        // In-gamut colors are not changed, regardless of the precision.
+        const LchDouble inGamut(50, 20, 10);
+        QVERIFY(myColorSpace->nearestInGamutColorByAdjustingChroma(inGamut, 5).hasSameCoordinates(inGamut));
+    }
+
+    void testNearestInGamutColorByAdjustingChromaBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        // More colors than the threshold for multi-threading, including
+        // in-gamut colors, out-of-gamut colors, negative chroma and
+        // lightness values outside the gray axis.
+        QVector<LchDouble> colors;
+        for (int i = 0; i < 1500; ++i) {
+            colors.append(LchDouble((i * 7) % 110 - 5, (i * 13) % 180 - 20, (i * 31) % 360));
+        }
+        QVector<LchDouble> results(colors.count());
+        myColorSpace->nearestInGamutColorByAdjustingChroma(colors.constData(), results.data(), colors.count());
+        for (int i = 0; i < colors.count(); ++i) {
+            const LchDouble expected = myColorSpace->nearestInGamutColorByAdjustingChroma(colors.at(i));
+            QVERIFY(results.at(i).hasSameCoordinates(expected));
+        }
+
+        // In-place operation on a small input
+        QVector<LchDouble> inPlace = colors.mid(0, 10);
+        myColorSpace->nearestInGamutColorByAdjustingChroma(inPlace.constData(), inPlace.data(), inPlace.count(), 0.5);
+        for (int i = 0; i < inPlace.count(); ++i) {
+            const LchDouble expected = myColorSpace->nearestInGamutColorByAdjustingChroma(colors.at(i), 0.5);
+            QVERIFY(inPlace.at(i).hasSameCoordinates(expected));
+        }
+
+        // Empty input
+        myColorSpace->nearestInGamutColorByAdjustingChroma(nullptr, nullptr, 0);
+    }
+
+    void testNearestInGamutColorByAdjustingChromaLightnessBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        QVector<LchDouble> colors;
+        for (int i = 0; i < 40; ++i) {
+            colors.append(LchDouble((i * 7) % 100, 20 + (i * 13) % 150, (i % 4) * 90));
+        }
+        colors.append(LchDouble(50, -20, 10));
+        QVector<LchDouble> results(colors.count());
+        myColorSpace->nearestInGamutColorByAdjustingChromaLightness(colors.constData(), results.data(), colors.count());
+        for (int i = 0; i < colors.count(); ++i) {
+            QVERIFY(myColorSpace->isInGamut(results.at(i)));
+            QCOMPARE(results.at(i).h, colors.at(i).h);
+            const LchDouble expected = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(colors.at(i));
+            QVERIFY(results.at(i).hasSameCoordinates(expected));
+            // Out-of-gamut colors are moved at least as near as the
+            // chroma-only search does.
+            const LchDouble chromaOnly = myColorSpace->nearestInGamutColorByAdjustingChroma(colors.at(i));
+            if (!myColorSpace->isInGamut(colors.at(i)) && isInRange<qreal>(1, colors.at(i).l, 99)) {
+                const qreal distance = qSqrt(qPow(results.at(i).l - colors.at(i).l, 2) + qPow(results.at(i).c - colors.at(i).c, 2));
+                const qreal chromaOnlyDistance = qAbs(chromaOnly.c - colors.at(i).c);
+                // Tolerance: One row of the boundary
+                QVERIFY(distance <= chromaOnlyDistance + 100.0 / (ChromaLightnessBoundary::rowCount - 1));
+            }
+        }
+        // Negative chroma is put to 0.
+        QCOMPARE(results.last().c, 0);
+        QCOMPARE(results.last().l, 50);
+    }
+
+    void testChromaLightnessBoundary()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QSharedPointer<const ChromaLightnessBoundary> boundary = myColorSpace->chromaLightnessBoundary(250);
+        QCOMPARE(boundary->maximumChroma.count(), ChromaLightnessBoundary::rowCount);
+        // Cached, also for a non-normalized hue
+        QCOMPARE(myColorSpace->chromaLightnessBoundary(250), boundary);
+        QCOMPARE(myColorSpace->chromaLightnessBoundary(610), boundary);
+        for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+            const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+            const qreal maximumChroma = boundary->maximumChroma.at(row);
+            if (maximumChroma < 0) {
+                // Rows at the very end of the gray axis might be
+                // out-of-gamut because of rounding errors.
+                QVERIFY(!myColorSpace->isInGamut(LchDouble(lightness, 0, 250)));
+                QVERIFY(!isInRange<qreal>(1, lightness, 99));
+                continue;
+            }
+            QVERIFY(myColorSpace->isInGamut(LchDouble(lightness, maximumChroma, 250)));
+            QVERIFY(!myColorSpace->isInGamut(LchDouble(lightness, maximumChroma + 0.01, 250)));
+            QVERIFY(boundary->maximumChromaEstimate(lightness) >= maximumChroma);
+        }
+    }
+
+    void testChromaLightnessBoundaryContiguousRows()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        // The gamut of sRGB has no gaps within the rows.
+        const QSharedPointer<const ChromaLightnessBoundary> boundary = myColorSpace->chromaLightnessBoundary(250.5);
+        QVERIFY(boundary->hasContiguousRows);
+        QVERIFY(myColorSpace->d_pointer->hasContiguousRows(*boundary));
+        // A boundary that does not match the gamut
+        QSharedPointer<ChromaLightnessBoundary> wrongBoundary(new ChromaLightnessBoundary(*boundary));
+        wrongBoundary->maximumChroma.fill(-1);
+        QVERIFY(!myColorSpace->d_pointer->hasContiguousRows(*wrongBoundary));
+        wrongBoundary->hasContiguousRows = false;
+        QCOMPARE(wrongBoundary->maximumChromaEstimate(50), std::numeric_limits<qreal>::infinity());
+
+        // If the rows have gaps, the nearest-in-gamut search
+        // falls back to exactly tested points.
+        myColorSpace->d_pointer->m_chromaLightnessBoundaryCache.insert(wrongBoundary->hue, wrongBoundary, 1);
+        QVERIFY(myColorSpace->chromaLightnessBoundary(250.5) == wrongBoundary);
+        for (int i = 0; i < 10; ++i) {
+            const LchDouble color((i * 11) % 100, 50 + (i * 17) % 100, 250.5);
+            const LchDouble result = myColorSpace->nearestInGamutColorByAdjustingChromaLightness(color);
+            QVERIFY(myColorSpace->isInGamut(result));
+            QCOMPARE(result.h, color.h);
+            const LchDouble chromaOnly = myColorSpace->nearestInGamutColorByAdjustingChroma(color);
+            if (!myColorSpace->isInGamut(color) && isInRange<qreal>(1, color.l, 99)) {
+                const qreal distance = qSqrt(qPow(result.l - color.l, 2) + qPow(result.c - color.c, 2));
+                const qreal chromaOnlyDistance = qAbs(chromaOnly.c - color.c);
+                // Tolerance: One cell of the grid
+                QVERIFY(distance <= chromaOnlyDistance + 1);
+            }
+        }
+    }
+
+    void testChromaHueBoundary()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const QSharedPointer<const ChromaHueBoundary> boundary = myColorSpace->chromaHueBoundary(60);
+        QCOMPARE(boundary->maximumChroma.count(), ChromaHueBoundary::columnCount);
+        QCOMPARE(boundary->lightness, static_cast<qreal>(60));
+        // Cached
+        QCOMPARE(myColorSpace->chromaHueBoundary(60), boundary);
+        for (int column = 0; column < ChromaHueBoundary::columnCount; ++column) {
+            const qreal hue = ChromaHueBoundary::columnHue(column);
+            QVERIFY(isInRange<qreal>(0, hue, 360));
+            QVERIFY(hue < 360);
+            const qreal maximumChroma = boundary->maximumChroma.at(column);
+            QVERIFY(myColorSpace->isInGamut(LchDouble(60, maximumChroma, hue)));
+            QVERIFY(!myColorSpace->isInGamut(LchDouble(60, maximumChroma + 0.01, hue)));
+        }
+        // Beyond the whitepoint, there is no in-gamut range.
+        const QSharedPointer<const ChromaHueBoundary> outOfGamut = myColorSpace->chromaHueBoundary(150);
+        QCOMPARE(outOfGamut->maximumChroma.count(), ChromaHueBoundary::columnCount);
+        for (const qreal maximumChroma : outOfGamut->maximumChroma) {
+            QVERIFY(maximumChroma < 0);
+        }
+        // Absurd values do not hang.
+        myColorSpace->chromaHueBoundary(qInf());
+        myColorSpace->chromaHueBoundary(qQNaN());
+    }
+
+    void testGrayAxisBoundary()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+        const qreal blackpoint = myColorSpace->d_pointer->m_blackpointL;
+        const qreal whitepoint = myColorSpace->d_pointer->m_whitepointL;
+        QVERIFY(myColorSpace->isInGamut(LchDouble(blackpoint, 0, 0)));
+        QVERIFY(myColorSpace->isInGamut(LchDouble(whitepoint, 0, 0)));
+        // sRGB reaches from black to white.
+        QVERIFY(blackpoint < 0.1);
+        QVERIFY(whitepoint > 99.9);
+    }
+
+    void testToCielabBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        QVector<RgbDouble> rgb;
+        for (int i = 0; i < 300; ++i) {
+            rgb.append(RgbDouble {(i % 7) / 6.0, (i % 11) / 10.0, (i % 13) / 12.0});
+        }
+        QVector<cmsCIELab> lab(rgb.count());
+        myColorSpace->toCielab(rgb.constData(), lab.data(), rgb.count());
+
+        for (int i = 0; i < rgb.count(); ++i) {
+            const cmsCIELCh lch = toCmsCieLch(myColorSpace->toLch( //
+                QColor::fromRgbF(rgb.at(i).red, rgb.at(i).green, rgb.at(i).blue)));
+            cmsCIELab expected;
+            cmsLCh2Lab(&expected, &lch);
+            // Limited by the 16-bit precision of QColor
+            QVERIFY(qAbs(lab.at(i).L - expected.L) < 0.01);
+            QVERIFY(qAbs(lab.at(i).a - expected.a) < 0.01);
+            QVERIFY(qAbs(lab.at(i).b - expected.b) < 0.01);
+        }
+
+        // A count of zero must not touch the buffers.
+        myColorSpace->toCielab(nullptr, nullptr, 0);
+    }
+
+    void testToLchBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        // More colors than fit into a single block
+        QVector<RgbDouble> rgb;
+        for (int i = 0; i < 600; ++i) {
+            rgb.append(RgbDouble {(i % 7) / 6.0, (i % 11) / 10.0, (i % 13) / 12.0});
+        }
+        QVector<LchDouble> lch(rgb.count());
+        myColorSpace->toLch(rgb.constData(), lch.data(), rgb.count());
+
+        for (int i = 0; i < rgb.count(); ++i) {
+            const LchDouble expected = myColorSpace->toLch( //
+                QColor::fromRgbF(rgb.at(i).red, rgb.at(i).green, rgb.at(i).blue));
+            // Limited by the 16-bit precision of QColor
+            QVERIFY(qAbs(lch.at(i).l - expected.l) < 0.01);
+            QVERIFY(qAbs(lch.at(i).c - expected.c) < 0.01);
+        }
+    }
+
+    void testToRgbUnboundBatch()
+    {
+        QSharedPointer<PerceptualColor::RgbColorSpace> myColorSpace =
+            // Create sRGB which is pretty much standard.
+            PerceptualColor::RgbColorSpaceFactory::createSrgb();
+
+        QVector<cmsCIELab> lab;
+        for (int i = 0; i < 300; ++i) {
+            lab.append(cmsCIELab {static_cast<double>(i % 101), (i % 17) * 10.0 - 80, (i % 19) * 10.0 - 90});
+        }
+        QVector<RgbDouble> rgb(lab.count());
+        QVector<bool> inGamut(lab.count());
+        myColorSpace->toRgbUnbound(lab.constData(), rgb.data(), inGamut.data(), lab.count());
+
+        for (int i = 0; i < lab.count(); ++i) {
+            const QColor expected = myColorSpace->toQColorRgbUnbound(lab.at(i));
+            QCOMPARE(inGamut.at(i), expected.isValid());
+            if (inGamut.at(i)) {
+                QCOMPARE(QColor::fromRgbF(rgb.at(i).red, rgb.at(i).green, rgb.at(i).blue), expected);
+            }
+        }
+    }
+
+    void testDisplayTransformCacheIsBounded()
+    {
+        QSharedPointer<RgbColorSpace> colorSpace = RgbColorSpaceFactory::createSrgb();
+        constexpr int cacheSize = RgbColorSpace::RgbColorSpacePrivate::displayTransformCacheSize;
+        const QByteArray firstProfile = rgbProfileData(1.0);
+        const QSharedPointer<DisplayTransform> first = colorSpace->displayTransform(firstProfile);
+        QVERIFY(!first.isNull());
+        for (int i = 1; i < cacheSize + 4; ++i) {
+            QVERIFY(!colorSpace->displayTransform(rgbProfileData(1.0 + i * 0.1)).isNull());
+            QVERIFY(colorSpace->d_pointer->m_displayTransforms.count() <= cacheSize);
+        }
+        QCOMPARE(colorSpace->d_pointer->m_displayTransforms.count(), cacheSize);
+        // The oldest transform has been removed from the cache, but it
+        // is still usable for who holds a reference to it.
+        QCOMPARE(qRed(first->toRgb(LchDouble(100, 0, 0))), 255);
+        const QSharedPointer<DisplayTransform> again = colorSpace->displayTransform(firstProfile);
+        QVERIFY(again != first);
+        QCOMPARE(again->profileHash(), first->profileHash());
+        QVERIFY(again->profileHash() != colorSpace->displayTransform(rgbProfileData(1.1))->profileHash());
+    }
 };
 
 } // namespace PerceptualColor
@@ -31,6 +31,7 @@
 // this forces the header to be self-contained.
 #include "PerceptualColor/rgbcolorspacefactory.h"
 
+#include <QTemporaryDir>
 #include <QtTest>
 
 #include "PerceptualColor/chromahuediagram.h"
@@ -103,6 +104,16 @@ private Q_SLOTS:
         QCOMPARE(temp->profileInfoDescription(), QStringLiteral("sRGB color space"));
     }
 
+    void testSetDeviceLinkCacheDirectory()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        RgbColorSpaceFactory::setDeviceLinkCacheDirectory(directory.path());
+        QCOMPARE(RgbColorSpace::deviceLinkCacheDirectory(), directory.path());
+        RgbColorSpaceFactory::setDeviceLinkCacheDirectory(QString());
+        QVERIFY(RgbColorSpace::deviceLinkCacheDirectory().isEmpty());
+    }
+
     void testSnipped01()
     {
         snippet01();
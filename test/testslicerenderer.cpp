@@ -0,0 +1,316 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "slicerenderer.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "displaytransform.h"
+#include "oklab.h"
+#include "rgbcolorspace.h"
+
+#include <QtTest>
+
+#include <lcms2.h>
+
+namespace PerceptualColor
+{
+class TestSliceRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSliceRenderer(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+    /** @brief Paints a slice on a transparent image. */
+    QImage paint(const SliceRenderer::Plane &plane, const QSize &size, const DisplayTransform *displayTransform = nullptr) const
+    {
+        QImage result(size, QImage::Format_ARGB32_Premultiplied);
+        result.fill(Qt::transparent);
+        SliceRenderer::paintGamut(&result, plane, *m_rgbColorSpace, displayTransform);
+        return result;
+    }
+
+    /** @brief Tests that exactly the in-gamut pixels are painted. */
+    void verifyGamut(const SliceRenderer::Plane &plane, const QImage &image) const
+    {
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                const cmsCIELab lab = plane.labAt(x + 0.5, y + 0.5);
+                bool expected;
+                if (plane.colorModel == ColorModel::OklchD65) {
+                    expected = OkLab::isInSrgbGamut(lab);
+                } else {
+                    expected = m_rgbColorSpace->isInGamut(lab);
+                }
+                cmsCIELCh lch;
+                cmsLab2LCh(&lch, &lab);
+                if (lch.C > plane.maximumChroma) {
+                    expected = false;
+                }
+                if (!plane.isWithinRing(x + 0.5, y + 0.5)) {
+                    expected = false;
+                }
+                QCOMPARE(qAlpha(image.pixel(x, y)) == 255, expected);
+            }
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testConstantHue()
+    {
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantHue(ColorModel::CielchD50, 120, 1);
+        QVERIFY(plane.hasConstantHue());
+        const cmsCIELab topLeft = plane.labAt(0, 0);
+        QCOMPARE(topLeft.L, 100.);
+        QCOMPARE(topLeft.a, 0.);
+        QCOMPARE(topLeft.b, 0.);
+        const QImage image = paint(plane, QSize(150, 100));
+        verifyGamut(plane, image);
+        // Gray is in-gamut.
+        QCOMPARE(qAlpha(image.pixel(0, 50)), 255);
+    }
+
+    void testConstantLightness()
+    {
+        SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantLightness(ColorModel::CielchD50, 50, -100, 100, 2);
+        QVERIFY(!plane.hasConstantHue());
+        const cmsCIELab center = plane.labAt(50, 50);
+        QCOMPARE(center.L, 50.);
+        QCOMPARE(center.a, 0.);
+        QCOMPARE(center.b, 0.);
+        verifyGamut(plane, paint(plane, QSize(100, 100)));
+        // Limit the chroma.
+        plane.maximumChroma = 30;
+        const QImage image = paint(plane, QSize(100, 100));
+        verifyGamut(plane, image);
+        QCOMPARE(qAlpha(image.pixel(50, 50)), 255);
+    }
+
+    void testConstantChroma()
+    {
+        // Hue from 0 to 360 along the x axis, lightness from 100 to 0
+        // along the y axis.
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantChroma(ColorModel::CielchD50, 30, 360.0 / 90, 100.0 / 50);
+        QVERIFY(!plane.hasConstantHue());
+        const QImage image = paint(plane, QSize(90, 50));
+        verifyGamut(plane, image);
+        // Some hues have chroma 30 at medium lightness within sRGB,
+        // but nothing is in-gamut at the top and the bottom.
+        QVERIFY(qAlpha(image.pixel(10, 25)) == 255);
+        QCOMPARE(qAlpha(image.pixel(10, 0)), 0);
+        QCOMPARE(qAlpha(image.pixel(10, 49)), 0);
+    }
+
+    void testHueWheel()
+    {
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::hueWheel(ColorModel::CielchD50, 50, 30, 50, 50, 30, 45);
+        QVERIFY(!plane.hasConstantHue());
+        // Hue 0 to the right
+        cmsCIELCh lch;
+        cmsCIELab lab = plane.labAt(90, 50);
+        cmsLab2LCh(&lch, &lab);
+        QVERIFY(qAbs(lch.L - 50) < 0.001);
+        QVERIFY(qAbs(lch.C - 30) < 0.001);
+        QVERIFY(qAbs(lch.h - 0) < 0.001);
+        // Hue 90 upwards
+        lab = plane.labAt(50, 10);
+        cmsLab2LCh(&lch, &lab);
+        QVERIFY(qAbs(lch.h - 90) < 0.001);
+        QVERIFY(plane.isWithinRing(90, 50));
+        QVERIFY(!plane.isWithinRing(50, 50));
+        QVERIFY(!plane.isWithinRing(0, 0));
+        const QImage image = paint(plane, QSize(100, 100));
+        verifyGamut(plane, image);
+        QCOMPARE(qAlpha(image.pixel(50, 50)), 0);
+        QCOMPARE(qAlpha(image.pixel(89, 50)), 255);
+    }
+
+    void testTiltedPlane()
+    {
+        // A plane that crosses the gray axis, tilted against all axes.
+        SliceRenderer::Plane plane;
+        plane.origin[0] = 90;
+        plane.origin[1] = -60;
+        plane.origin[2] = -40;
+        plane.xAxis[0] = -0.3;
+        plane.xAxis[1] = 1;
+        plane.xAxis[2] = 0.5;
+        plane.yAxis[0] = -0.5;
+        plane.yAxis[1] = 0.2;
+        plane.yAxis[2] = 0.6;
+        verifyGamut(plane, paint(plane, QSize(120, 80)));
+    }
+
+    void testOklch()
+    {
+        // Within sRGB, Oklch uses the closed-form fast path with the
+        // sRGB gamut table.
+        const SliceRenderer::Plane hue = //
+            SliceRenderer::Plane::constantHue(ColorModel::OklchD65, 250, 0.5);
+        verifyGamut(hue, paint(hue, QSize(100, 200)));
+        const SliceRenderer::Plane chroma = //
+            SliceRenderer::Plane::constantChroma(ColorModel::OklchD65, 10, 4, 2);
+        verifyGamut(chroma, paint(chroma, QSize(90, 50)));
+        // The colors are the same as those of the single conversions.
+        const QImage image = paint(hue, QSize(100, 200));
+        for (int y = 0; y < image.height(); y += 7) {
+            for (int x = 0; x < image.width(); x += 3) {
+                if (qAlpha(image.pixel(x, y)) != 255) {
+                    continue;
+                }
+                const RgbDouble rgb = OkLab::linearSrgbToSrgb( //
+                    OkLab::toLinearSrgb(hue.labAt(x + 0.5, y + 0.5)));
+                const QColor expected = QColor::fromRgbF(rgb.red, rgb.green, rgb.blue);
+                QCOMPARE(image.pixel(x, y), expected.rgb());
+            }
+        }
+    }
+
+    void testColors()
+    {
+        // The colors are the same as those of the single conversions.
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantLightness(ColorModel::CielchD50, 60, -80, 80, 4);
+        const QImage image = paint(plane, QSize(40, 40));
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                const QColor expected = m_rgbColorSpace->toQColorRgbUnbound(plane.labAt(x + 0.5, y + 0.5));
+                if (expected.isValid()) {
+                    QCOMPARE(image.pixel(x, y), expected.rgb());
+                } else {
+                    QCOMPARE(image.pixel(x, y), qRgba(0, 0, 0, 0));
+                }
+            }
+        }
+    }
+
+    void testDisplayTransform()
+    {
+        // Raw data of an sRGB profile
+        cmsHPROFILE profileHandle = cmsCreate_sRGBProfile();
+        cmsUInt32Number size = 0;
+        cmsSaveProfileToMem(profileHandle, nullptr, &size);
+        QByteArray profileData(static_cast<int>(size), 0);
+        cmsSaveProfileToMem(profileHandle, profileData.data(), &size);
+        cmsCloseProfile(profileHandle);
+        const QSharedPointer<DisplayTransform> transform = //
+            m_rgbColorSpace->displayTransform(profileData);
+        QVERIFY(!transform.isNull());
+
+        for (const ColorModel model : {ColorModel::CielchD50, ColorModel::OklchD65}) {
+            const SliceRenderer::Plane plane = //
+                SliceRenderer::Plane::constantHue(model, 40, 2);
+            const QImage withoutProfile = paint(plane, QSize(50, 50));
+            const QImage withProfile = paint(plane, QSize(50, 50), transform.data());
+            // The display profile is sRGB like the color space, so the
+            // image is (nearly) the same. The closed-form Oklab conversion
+            // might differ a little bit from LittleCMS.
+            const int tolerance = (model == ColorModel::OklchD65) ? 2 : 1;
+            for (int y = 0; y < withProfile.height(); ++y) {
+                for (int x = 0; x < withProfile.width(); ++x) {
+                    const QRgb expected = withoutProfile.pixel(x, y);
+                    const QRgb actual = withProfile.pixel(x, y);
+                    QCOMPARE(qAlpha(actual), qAlpha(expected));
+                    QVERIFY(qAbs(qRed(actual) - qRed(expected)) <= tolerance);
+                    QVERIFY(qAbs(qGreen(actual) - qGreen(expected)) <= tolerance);
+                    QVERIFY(qAbs(qBlue(actual) - qBlue(expected)) <= tolerance);
+                }
+            }
+        }
+    }
+
+    void testEmptyImage()
+    {
+        // Make sure that this does not crash.
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantHue(ColorModel::CielchD50, 0, 1);
+        QImage image;
+        SliceRenderer::paintGamut(&image, plane, *m_rgbColorSpace, nullptr);
+        QVERIFY(image.isNull());
+        SliceRenderer::paintGamut(nullptr, plane, *m_rgbColorSpace, nullptr);
+    }
+
+    void testCancel()
+    {
+        const SliceRenderer::Plane plane = //
+            SliceRenderer::Plane::constantHue(ColorModel::CielchD50, 0, 1);
+        QImage image(50, 100, QImage::Format_ARGB32_Premultiplied);
+        std::atomic<bool> cancelFlag {true};
+        image.fill(Qt::transparent);
+        QCOMPARE(SliceRenderer::paintGamut(&image, plane, *m_rgbColorSpace, nullptr, &cancelFlag), false);
+        // No row has been painted.
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                QCOMPARE(qAlpha(image.pixel(x, y)), 0);
+            }
+        }
+        cancelFlag = false;
+        QCOMPARE(SliceRenderer::paintGamut(&image, plane, *m_rgbColorSpace, nullptr, &cancelFlag), true);
+        QCOMPARE(qAlpha(image.pixel(0, 50)), 255);
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestSliceRenderer)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testslicerenderer.moc"
@@ -0,0 +1,201 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+// First included header is the public header of the class we are testing;
+// this forces the header to be self-contained.
+#include "srgbgamuttable.h"
+
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "chromalightnessboundary.h"
+#include "helper.h"
+#include "lchvalues.h"
+#include "polarpointf.h"
+#include "rgbcolorspace.h"
+
+#include <QtMath>
+#include <QtTest>
+
+namespace PerceptualColor
+{
+class TestSrgbGamutTable : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSrgbGamutTable(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    QSharedPointer<PerceptualColor::RgbColorSpace> m_rgbColorSpace = RgbColorSpaceFactory::createSrgb();
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Called before the first test function is executed
+    }
+
+    void cleanupTestCase()
+    {
+        // Called after the last test function was executed
+    }
+
+    void init()
+    {
+        // Called before each test function is executed
+    }
+
+    void cleanup()
+    {
+        // Called after every test function
+    }
+
+    void testGrayAxis()
+    {
+        QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(SrgbGamutTable::blackpointL, 0, 0)));
+        QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(SrgbGamutTable::whitepointL, 0, 0)));
+        // sRGB reaches from black to white.
+        QVERIFY(SrgbGamutTable::blackpointL < 0.1);
+        QVERIFY(SrgbGamutTable::whitepointL > 99.9);
+    }
+
+    void testContainsHue()
+    {
+        QVERIFY(SrgbGamutTable::containsHue(0));
+        QVERIFY(SrgbGamutTable::containsHue(1));
+        QVERIFY(SrgbGamutTable::containsHue(359));
+        QVERIFY(SrgbGamutTable::containsHue(360));
+        QVERIFY(SrgbGamutTable::containsHue(-1));
+        QVERIFY(!SrgbGamutTable::containsHue(0.5));
+        QVERIFY(!SrgbGamutTable::containsHue(359.9));
+        QVERIFY(!SrgbGamutTable::containsHue(qQNaN()));
+        QVERIFY(!SrgbGamutTable::chromaLightnessBoundary(0.5).isNull());
+        QVERIFY(SrgbGamutTable::chromaLightnessBoundary(qQNaN()).isNull());
+        QVERIFY(SrgbGamutTable::chromaLightnessBoundary(qInf()).isNull());
+    }
+
+    void testChromaLightnessBoundary_data()
+    {
+        QTest::addColumn<qreal>("hue");
+        QTest::newRow("0") << 0.;
+        QTest::newRow("90") << 90.;
+        QTest::newRow("250") << 250.;
+        QTest::newRow("359") << 359.;
+        QTest::newRow("360") << 360.;
+    }
+
+    void testChromaLightnessBoundary()
+    {
+        QFETCH(qreal, hue);
+        const QSharedPointer<const ChromaLightnessBoundary> boundary = //
+            SrgbGamutTable::chromaLightnessBoundary(hue);
+        QVERIFY(!boundary.isNull());
+        QCOMPARE(boundary->hue, PolarPointF::normalizedAngleDegree(hue));
+        QCOMPARE(boundary->maximumChroma.count(), ChromaLightnessBoundary::rowCount);
+        for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+            const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+            const qreal maximumChroma = boundary->maximumChroma.at(row);
+            if (maximumChroma < 0) {
+                // Rows at the very end of the gray axis might be
+                // out-of-gamut because of rounding errors.
+                QVERIFY(!m_rgbColorSpace->isInGamut(LchDouble(lightness, 0, hue)));
+                QVERIFY(!isInRange<qreal>(1, lightness, 99));
+                continue;
+            }
+            QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(lightness, maximumChroma, hue)));
+            QVERIFY(!m_rgbColorSpace->isInGamut(LchDouble(lightness, maximumChroma + 0.01, hue)));
+        }
+    }
+
+    void testInterpolatedHue_data()
+    {
+        QTest::addColumn<qreal>("hue");
+        QTest::newRow("0.5") << 0.5;
+        QTest::newRow("123.45") << 123.45;
+        QTest::newRow("264.7") << 264.7;
+        QTest::newRow("359.9") << 359.9;
+    }
+
+    void testInterpolatedHue()
+    {
+        QFETCH(qreal, hue);
+        const QSharedPointer<const ChromaLightnessBoundary> boundary = //
+            SrgbGamutTable::chromaLightnessBoundary(hue);
+        const QSharedPointer<const ChromaLightnessBoundary> lower = //
+            SrgbGamutTable::chromaLightnessBoundary(qFloor(hue));
+        const QSharedPointer<const ChromaLightnessBoundary> upper = //
+            SrgbGamutTable::chromaLightnessBoundary(qCeil(hue));
+        QVERIFY(!boundary.isNull());
+        QCOMPARE(boundary->hue, hue);
+        QCOMPARE(boundary->maximumChroma.count(), ChromaLightnessBoundary::rowCount);
+        for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+            // The maximum of both neighbors
+            const qreal expected = qMax(lower->maximumChroma.at(row), upper->maximumChroma.at(row));
+            QCOMPARE(boundary->maximumChroma.at(row), expected);
+            // The estimate covers the exact boundary.
+            const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+            if (!m_rgbColorSpace->isInGamut(LchDouble(lightness, 0, hue))) {
+                continue;
+            }
+            const LchDouble exact = m_rgbColorSpace->nearestInGamutColorByAdjustingChroma( //
+                LchDouble(lightness, LchValues::humanMaximumChroma, hue));
+            QVERIFY(boundary->maximumChromaEstimate(lightness) >= exact.c);
+        }
+    }
+
+    void testUsedByColorSpace()
+    {
+        const QSharedPointer<const ChromaLightnessBoundary> expected = //
+            SrgbGamutTable::chromaLightnessBoundary(120);
+        const QSharedPointer<const ChromaLightnessBoundary> actual = //
+            m_rgbColorSpace->chromaLightnessBoundary(120);
+        QCOMPARE(actual->maximumChroma, expected->maximumChroma);
+        // Fractional hues are calculated exactly.
+        const QSharedPointer<const ChromaLightnessBoundary> estimate = //
+            SrgbGamutTable::chromaLightnessBoundary(120.5);
+        const QSharedPointer<const ChromaLightnessBoundary> exact = //
+            m_rgbColorSpace->chromaLightnessBoundary(120.5);
+        for (int row = 0; row < ChromaLightnessBoundary::rowCount; ++row) {
+            const qreal lightness = ChromaLightnessBoundary::rowLightness(row);
+            const qreal maximumChroma = exact->maximumChroma.at(row);
+            if (maximumChroma >= 0) {
+                QVERIFY(m_rgbColorSpace->isInGamut(LchDouble(lightness, maximumChroma, 120.5)));
+            }
+            QVERIFY(maximumChroma <= estimate->maximumChromaEstimate(lightness));
+        }
+    }
+};
+
+} // namespace PerceptualColor
+
+QTEST_MAIN(PerceptualColor::TestSrgbGamutTable)
+
+// The following “include” is necessary because we do not use a header file:
+#include "testsrgbgamuttable.moc"
@@ -36,8 +36,32 @@
 #include <QtTest>
 
 #include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/colorwheel.h"
+#include "chromalightnessdiagram.h"
 #include "rgbcolorspace.h"
 
+#include <lcms2.h>
+
+/** @brief The raw data of an ICC profile with sRGB primaries.
+ *
+ * @param gamma The gamma of the tone curves
+ * @returns The raw data of the profile */
+static QByteArray rgbProfileData(double gamma)
+{
+    cmsToneCurve *curve = cmsBuildGamma(nullptr, gamma);
+    cmsToneCurve *curves[3] = {curve, curve, curve};
+    const cmsCIExyY whitePoint {0.3127, 0.3290, 1};
+    const cmsCIExyYTRIPLE primaries {{0.64, 0.33, 1}, {0.30, 0.60, 1}, {0.15, 0.06, 1}};
+    cmsHPROFILE profileHandle = cmsCreateRGBProfile(&whitePoint, &primaries, curves);
+    cmsFreeToneCurve(curve);
+    cmsUInt32Number size = 0;
+    cmsSaveProfileToMem(profileHandle, nullptr, &size);
+    QByteArray result(static_cast<int>(size), 0);
+    cmsSaveProfileToMem(profileHandle, result.data(), &size);
+    cmsCloseProfile(profileHandle);
+    return result;
+}
+
 namespace PerceptualColor
 {
 class TestWheelColorPicker : public QObject
@@ -238,6 +262,25 @@ private Q_SLOTS:
         // the new hue. Test if they have been corrected:
         QVERIFY(m_rgbColorSpace->isInGamut(myWidget.currentColor()));
     }
+
+    void testDisplayProfile()
+    {
+        WheelColorPicker myWidget {m_rgbColorSpace};
+        myWidget.resize(QSize(400, 400));
+        QVERIFY(myWidget.displayProfile().isEmpty());
+        const QImage withoutProfile = myWidget.grab().toImage();
+
+        const QByteArray profile = rgbProfileData(1.0);
+        myWidget.setDisplayProfile(profile);
+        QCOMPARE(myWidget.displayProfile(), profile);
+        QCOMPARE(myWidget.d_pointer->m_colorWheel->displayProfile(), profile);
+        QCOMPARE(myWidget.d_pointer->m_chromaLightnessDiagram->displayProfile(), profile);
+        QVERIFY(myWidget.grab().toImage() != withoutProfile);
+
+        myWidget.setDisplayProfile(QByteArray());
+        QVERIFY(myWidget.d_pointer->m_colorWheel->displayProfile().isEmpty());
+        QVERIFY(myWidget.d_pointer->m_chromaLightnessDiagram->displayProfile().isEmpty());
+    }
 };
 
 } // namespace PerceptualColor
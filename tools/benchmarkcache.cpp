@@ -0,0 +1,197 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "readmostlycache.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <atomic>
+
+using namespace PerceptualColor;
+
+// This tool measures how the lookups of a shared cache scale with the
+// number of reading threads, for the lock-free ReadMostlyCache and, for
+// comparison, for a QHash protected by a QMutex and by a QReadWriteLock.
+//
+// Each reading thread does the same number of lookups. Optionally, a
+// writer thread inserts new entries all the time. The result is the total
+// number of lookups per microsecond, printed as a tab-separated table.
+
+namespace
+{
+/** @brief Number of keys in the cache */
+constexpr int keyCount = 64;
+
+/** @brief Number of lookups per reading thread */
+constexpr int lookupCount = 2000000;
+
+/** @brief The value type of the caches, like the gamut boundaries. */
+using Value = QSharedPointer<const int>;
+
+/** @brief A QHash protected by a QMutex */
+class MutexCache
+{
+public:
+    Value value(int key)
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_hash.value(key);
+    }
+    void insert(int key, const Value &value)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hash.insert(key, value);
+    }
+
+private:
+    QHash<int, Value> m_hash;
+    QMutex m_mutex;
+};
+
+/** @brief A QHash protected by a QReadWriteLock */
+class ReadWriteLockCache
+{
+public:
+    Value value(int key)
+    {
+        QReadLocker locker(&m_lock);
+        return m_hash.value(key);
+    }
+    void insert(int key, const Value &value)
+    {
+        QWriteLocker locker(&m_lock);
+        m_hash.insert(key, value);
+    }
+
+private:
+    QHash<int, Value> m_hash;
+    QReadWriteLock m_lock;
+};
+
+/** @brief Measures the throughput of a cache.
+ *
+ * @param cache The cache
+ * @param threadCount Number of reading threads
+ * @param withWriter If a writer thread inserts entries concurrently
+ * @returns Lookups per microsecond */
+template<typename Cache> double measure(Cache &cache, int threadCount, bool withWriter)
+{
+    for (int key = 0; key < keyCount; ++key) {
+        cache.insert(key, Value(new int(key)));
+    }
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount + 1);
+    std::atomic<int> readyCount {0};
+    std::atomic<bool> isStarted {false};
+    std::atomic<bool> isRunning {true};
+    std::atomic<int> checksum {0};
+    QFuture<void> writer;
+    if (withWriter) {
+        writer = QtConcurrent::run(&pool, [&cache, &isRunning]() {
+            int key = 0;
+            while (isRunning) {
+                cache.insert(key, Value(new int(key)));
+                key = (key + 1) % keyCount;
+                QThread::usleep(100);
+            }
+        });
+    }
+    QVector<QFuture<void>> readers;
+    QElapsedTimer timer;
+    for (int thread = 0; thread < threadCount; ++thread) {
+        readers.append(QtConcurrent::run(&pool, [&cache, &readyCount, &isStarted, &checksum, thread]() {
+            // Start all readers at the same time.
+            ++readyCount;
+            while (!isStarted) {
+                QThread::yieldCurrentThread();
+            }
+            int sum = 0;
+            int key = thread;
+            for (int i = 0; i < lookupCount; ++i) {
+                const Value value = cache.value(key);
+                sum += *value;
+                key = (key + 7) % keyCount;
+            }
+            checksum += sum;
+        }));
+    }
+    while (readyCount < threadCount) {
+        QThread::yieldCurrentThread();
+    }
+    timer.start();
+    isStarted = true;
+    for (QFuture<void> &reader : readers) {
+        reader.waitForFinished();
+    }
+    const qint64 elapsed = qMax<qint64>(1, timer.nsecsElapsed());
+    isRunning = false;
+    writer.waitForFinished();
+    pool.waitForDone();
+    return static_cast<double>(lookupCount) * threadCount / (static_cast<double>(elapsed) / 1000);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const int maximumThreadCount = qMax(8, QThread::idealThreadCount());
+    for (const bool withWriter : {false, true}) {
+        out << (withWriter ? "With a concurrent writer" : "Without writer") //
+            << " (lookups per microsecond)\n";
+        out << "threads\treadmostlycache\tmutex\treadwritelock\n";
+        for (int threadCount = 1; threadCount <= maximumThreadCount; threadCount *= 2) {
+            ReadMostlyCache<int, Value> readMostlyCache;
+            MutexCache mutexCache;
+            ReadWriteLockCache readWriteLockCache;
+            out << threadCount //
+                << "\t" << measure(readMostlyCache, threadCount, withWriter) //
+                << "\t" << measure(mutexCache, threadCount, withWriter) //
+                << "\t" << measure(readWriteLockCache, threadCount, withWriter) //
+                << "\n";
+            out.flush();
+        }
+        out << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,529 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/chromahuediagram.h"
+#include "PerceptualColor/colordialog.h"
+#include "PerceptualColor/colorpatch.h"
+#include "PerceptualColor/colorwheel.h"
+#include "PerceptualColor/gradientslider.h"
+#include "PerceptualColor/lchadouble.h"
+#include "PerceptualColor/lchdouble.h"
+#include "PerceptualColor/rgbcolorspacefactory.h"
+#include "PerceptualColor/wheelcolorpicker.h"
+#include "chromalightnessdiagram.h"
+#include "rgbcolorspace.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QImage>
+#include <QMouseEvent>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTextStream>
+#include <QVector>
+#include <QtMath>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace PerceptualColor;
+
+// This tool measures the memory footprint of the widgets of this library.
+//
+// Every heap allocation of the process is counted: The replaceable global
+// operator new/delete is replaced, and on glibc also the malloc family is
+// interposed (QImage allocates its pixel buffer with malloc, so this is
+// where the big caches live). For each component, the allocation count,
+// the retained bytes and the peak bytes are reported, both for the
+// creation (construction, resize, first paint) and for a scripted
+// interaction.
+//
+// Without arguments, the tool runs itself once for each device pixel
+// ratio (via QT_SCALE_FACTOR) and prints a tab-separated table. With the
+// argument “--child” it measures only in the current process.
+
+namespace
+{
+/** @brief Number of allocations since program start. */
+std::atomic<quint64> allocationCount {0};
+/** @brief Currently allocated bytes. */
+std::atomic<qint64> currentBytes {0};
+/** @brief Highest value of @ref currentBytes since the last reset. */
+std::atomic<qint64> peakBytes {0};
+
+void recordAllocation(qint64 size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const qint64 newCurrent = currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    qint64 oldPeak = peakBytes.load(std::memory_order_relaxed);
+    while (newCurrent > oldPeak && !peakBytes.compare_exchange_weak(oldPeak, newCurrent, std::memory_order_relaxed)) {
+    }
+}
+
+void recordDeallocation(qint64 size)
+{
+    currentBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+// The malloc family is interposed. The actual allocation is delegated to
+// glibc’s internal entry points. The size is taken from
+// malloc_usable_size(), so it contains the allocator’s rounding.
+extern "C" {
+void *__libc_malloc(size_t size) noexcept;
+void *__libc_calloc(size_t count, size_t size) noexcept;
+void *__libc_realloc(void *pointer, size_t size) noexcept;
+void *__libc_memalign(size_t alignment, size_t size) noexcept;
+void __libc_free(void *pointer) noexcept;
+
+void *malloc(size_t size) noexcept
+{
+    void *result = __libc_malloc(size);
+    if (result != nullptr) {
+        recordAllocation(static_cast<qint64>(malloc_usable_size(result)));
+    }
+    return result;
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    void *result = __libc_calloc(count, size);
+    if (result != nullptr) {
+        recordAllocation(static_cast<qint64>(malloc_usable_size(result)));
+    }
+    return result;
+}
+
+void *realloc(void *pointer, size_t size) noexcept
+{
+    const qint64 oldSize = static_cast<qint64>(malloc_usable_size(pointer));
+    void *result = __libc_realloc(pointer, size);
+    if (result == nullptr) {
+        if (size == 0) {
+            // The old block has been freed.
+            recordDeallocation(oldSize);
+        }
+        return result;
+    }
+    recordDeallocation(oldSize);
+    recordAllocation(static_cast<qint64>(malloc_usable_size(result)));
+    return result;
+}
+
+void *memalign(size_t alignment, size_t size) noexcept
+{
+    void *result = __libc_memalign(alignment, size);
+    if (result != nullptr) {
+        recordAllocation(static_cast<qint64>(malloc_usable_size(result)));
+    }
+    return result;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) noexcept
+{
+    void *result = memalign(alignment, size);
+    if (result == nullptr) {
+        return ENOMEM;
+    }
+    *pointer = result;
+    return 0;
+}
+
+void free(void *pointer) noexcept
+{
+    if (pointer != nullptr) {
+        recordDeallocation(static_cast<qint64>(malloc_usable_size(pointer)));
+    }
+    __libc_free(pointer);
+}
+}
+
+// Operator new uses the interposed malloc, which counts already.
+void *operator new(std::size_t size)
+{
+    void *result = std::malloc((size == 0) ? 1 : size);
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+#else
+
+// Without malloc interposition, only operator new is counted. The size
+// of each block is stored in front of the block.
+namespace
+{
+constexpr std::size_t headerSize = alignof(std::max_align_t);
+}
+
+void *operator new(std::size_t size)
+{
+    void *block = std::malloc(headerSize + size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *static_cast<std::size_t *>(block) = size;
+    recordAllocation(static_cast<qint64>(size));
+    return static_cast<char *>(block) + headerSize;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer == nullptr) {
+        return;
+    }
+    void *block = static_cast<char *>(pointer) - headerSize;
+    recordDeallocation(static_cast<qint64>(*static_cast<std::size_t *>(block)));
+    std::free(block);
+}
+
+#endif
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+namespace
+{
+/** @brief Allocation statistics of a code section. */
+struct Measurement {
+    /** @brief Number of allocations. */
+    quint64 allocations;
+    /** @brief Bytes that are still allocated at the end of the section. */
+    qint64 retainedBytes;
+    /** @brief Highest number of additional bytes during the section. */
+    qint64 peakBytes;
+};
+
+/** @brief Measures the allocations of a code section. */
+Measurement measure(const std::function<void()> &section)
+{
+    const quint64 allocationsBefore = allocationCount.load();
+    const qint64 bytesBefore = currentBytes.load();
+    peakBytes.store(bytesBefore);
+    section();
+    Measurement result;
+    result.allocations = allocationCount.load() - allocationsBefore;
+    result.retainedBytes = currentBytes.load() - bytesBefore;
+    result.peakBytes = peakBytes.load() - bytesBefore;
+    return result;
+}
+
+/** @brief A component of the library that is measured. */
+struct Component {
+    /** @brief Name of the component in the report. */
+    QString name;
+    /** @brief Creates the widget. */
+    std::function<QWidget *()> create;
+    /** @brief Changes the widget for the given step of the scripted
+     * interaction. */
+    std::function<void(QWidget *, int)> interact;
+    /** @brief Widget sizes to measure. */
+    QVector<QSize> sizes;
+};
+
+/** @brief Number of steps of the scripted interaction. */
+constexpr int interactionSteps = 60;
+
+/** @brief Paints the widget into a given buffer.
+ *
+ * Painting is where the widgets of this library create their image
+ * caches. */
+void paint(QWidget *widget, QImage *buffer)
+{
+    buffer->fill(Qt::transparent);
+    widget->render(buffer);
+}
+
+/** @brief Sends a synthetic mouse event.
+ *
+ * One step of a circular drag around the widget center. The first step
+ * presses, the last step releases the left mouse button. */
+void dragStep(QWidget *widget, int step)
+{
+    const qreal angle = 2 * M_PI * step / interactionSteps;
+    const qreal radius = qMin(widget->width(), widget->height()) * 0.3;
+    const QPointF position(widget->width() / 2.0 + radius * qCos(angle), //
+                           widget->height() / 2.0 + radius * qSin(angle));
+    QEvent::Type type = QEvent::MouseMove;
+    Qt::MouseButtons buttons = Qt::LeftButton;
+    if (step == 0) {
+        type = QEvent::MouseButtonPress;
+    } else if (step == interactionSteps - 1) {
+        type = QEvent::MouseButtonRelease;
+        buttons = Qt::NoButton;
+    }
+    QMouseEvent event(type, position, Qt::LeftButton, buttons, Qt::NoModifier);
+    QCoreApplication::sendEvent(widget, &event);
+}
+
+/** @brief A color for the given step of the scripted interaction. */
+LchDouble lchForStep(int step)
+{
+    return LchDouble(30 + (step % 7) * 8, 10 + (step % 5) * 6, step * 360.0 / interactionSteps);
+}
+
+void printRow(QTextStream &out, const QString &component, const QString &phase, const QSize &size, qreal devicePixelRatio, const Measurement &measurement)
+{
+    out << component << '\t' << phase << '\t' << size.width() << 'x' << size.height() << '\t' << devicePixelRatio << '\t' << measurement.allocations << '\t'
+        << measurement.retainedBytes << '\t' << measurement.peakBytes << '\n';
+}
+
+void printHeader(QTextStream &out)
+{
+    out << "component\tphase\tsize\tdpr\tallocations\tretainedBytes\tpeakBytes\n";
+}
+
+/** @brief Measures all components within the current process. */
+int runMeasurements()
+{
+    QTextStream out(stdout);
+    printHeader(out);
+
+    QSharedPointer<RgbColorSpace> colorSpace;
+    const Measurement colorSpaceMeasurement = measure([&colorSpace]() {
+        colorSpace = RgbColorSpaceFactory::createSrgb();
+    });
+    printRow(out, QStringLiteral("RgbColorSpace(sRGB)"), QStringLiteral("creation"), QSize(), 1, colorSpaceMeasurement);
+
+    const QVector<QSize> squareSizes {QSize(250, 250), QSize(500, 500), QSize(1000, 1000)};
+    QVector<Component> components;
+    components.append(Component {QStringLiteral("ChromaHueDiagram"),
+                                 [&colorSpace]() {
+                                     return new ChromaHueDiagram(colorSpace);
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     dragStep(widget, step);
+                                     if (step % 10 == 0) {
+                                         static_cast<ChromaHueDiagram *>(widget)->setCurrentColor(lchForStep(step));
+                                     }
+                                 },
+                                 squareSizes});
+    components.append(Component {QStringLiteral("ChromaLightnessDiagram"),
+                                 [&colorSpace]() {
+                                     return new ChromaLightnessDiagram(colorSpace);
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     dragStep(widget, step);
+                                     if (step % 10 == 0) {
+                                         // Changing the hue invalidates the image cache.
+                                         static_cast<ChromaLightnessDiagram *>(widget)->setCurrentColor(lchForStep(step));
+                                     }
+                                 },
+                                 squareSizes});
+    components.append(Component {QStringLiteral("ColorWheel"),
+                                 [&colorSpace]() {
+                                     return new ColorWheel(colorSpace);
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     dragStep(widget, step);
+                                 },
+                                 squareSizes});
+    components.append(Component {QStringLiteral("WheelColorPicker"),
+                                 [&colorSpace]() {
+                                     return new WheelColorPicker(colorSpace);
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     static_cast<WheelColorPicker *>(widget)->setCurrentColor(lchForStep(step));
+                                 },
+                                 squareSizes});
+    components.append(Component {QStringLiteral("GradientSlider"),
+                                 [&colorSpace]() {
+                                     return new GradientSlider(colorSpace, Qt::Horizontal);
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     auto slider = static_cast<GradientSlider *>(widget);
+                                     slider->setValue(static_cast<qreal>(step) / interactionSteps);
+                                     if (step % 10 == 0) {
+                                         const LchDouble lch = lchForStep(step);
+                                         slider->setSecondColor(LchaDouble(lch.l, lch.c, lch.h, 1));
+                                     }
+                                 },
+                                 {QSize(250, 30), QSize(500, 30), QSize(1000, 30)}});
+    components.append(Component {QStringLiteral("ColorPatch"),
+                                 []() {
+                                     return new ColorPatch();
+                                 },
+                                 [](QWidget *widget, int step) {
+                                     static_cast<ColorPatch *>(widget)->setColor(QColor::fromHsv(step * 359 / interactionSteps, 200, 200, 128));
+                                 },
+                                 {QSize(50, 50), QSize(100, 100), QSize(200, 200)}});
+    // The dialog is measured at multiples of its size hint.
+    QSize dialogSize;
+    {
+        ColorDialog sizeProbe(colorSpace);
+        dialogSize = sizeProbe.sizeHint();
+    }
+    components.append(Component {QStringLiteral("ColorDialog"),
+                                 [&colorSpace]() {
+                                     return new ColorDialog(colorSpace);
+                                 },
+                                 [&colorSpace](QWidget *widget, int step) {
+                                     auto dialog = static_cast<ColorDialog *>(widget);
+                                     dialog->setCurrentColor(colorSpace->toQColorRgbBound(lchForStep(step)));
+                                     if (step == interactionSteps / 2) {
+                                         dialog->setLayoutDimensions(ColorDialog::DialogLayoutDimensions::expanded);
+                                     }
+                                 },
+                                 {dialogSize, dialogSize * 1.5, dialogSize * 2}});
+
+    for (const Component &component : qAsConst(components)) {
+        // Warm-up: One-time initializations (fonts, styles, static
+        // tables) should not be attributed to the first measured size.
+        // The caches of the color space (boundaries and the shared
+        // diagram images) are cleared, so that the warm-up does not
+        // depend on which components ran before.
+        colorSpace->clearCaches();
+        {
+            QScopedPointer<QWidget> warmUp(component.create());
+            warmUp->resize(component.sizes.first());
+            QImage buffer(warmUp->size() * warmUp->devicePixelRatioF(), QImage::Format_ARGB32_Premultiplied);
+            buffer.setDevicePixelRatio(warmUp->devicePixelRatioF());
+            paint(warmUp.data(), &buffer);
+        }
+        for (const QSize &size : qAsConst(component.sizes)) {
+            QWidget *widget = nullptr;
+            const qreal devicePixelRatio = qApp->devicePixelRatio();
+            // The paint buffer is allocated outside of the measurement.
+            QImage buffer(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+            buffer.setDevicePixelRatio(devicePixelRatio);
+            // Each measurement starts with empty caches of the color
+            // space. Otherwise, the shared diagram image cache would serve
+            // images that the warm-up, a previous size or a previous
+            // component has rendered, and their memory would not be
+            // attributed to this component. Clearing happens outside
+            // of the measurement, so the freed memory is not subtracted.
+            colorSpace->clearCaches();
+            const Measurement creation = measure([&]() {
+                widget = component.create();
+                widget->resize(size);
+                paint(widget, &buffer);
+            });
+            printRow(out, component.name, QStringLiteral("creation"), size, devicePixelRatio, creation);
+            const Measurement interaction = measure([&]() {
+                for (int step = 0; step < interactionSteps; ++step) {
+                    component.interact(widget, step);
+                    paint(widget, &buffer);
+                }
+            });
+            printRow(out, component.name, QStringLiteral("interaction"), size, devicePixelRatio, interaction);
+            const Measurement destruction = measure([&widget]() {
+                delete widget;
+            });
+            printRow(out, component.name, QStringLiteral("destruction"), size, devicePixelRatio, destruction);
+        }
+        out.flush();
+    }
+    return 0;
+}
+
+} // namespace
+
+// Measures allocation counts, retained bytes and peak bytes of the
+// widgets of this library and prints a tab-separated report.
+int main(int argc, char *argv[])
+{
+    bool isChild = false;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--child") == 0) {
+            isChild = true;
+        }
+    }
+
+    if (isChild) {
+        // The scale factor is given by the parent process via the
+        // environment variable QT_SCALE_FACTOR.
+        QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+        QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
+        QApplication app(argc, argv);
+        return runMeasurements();
+    }
+
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const QVector<qreal> devicePixelRatios {1, 1.5, 2};
+    for (const qreal devicePixelRatio : devicePixelRatios) {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert(QStringLiteral("QT_SCALE_FACTOR"), QString::number(devicePixelRatio));
+        if (!environment.contains(QStringLiteral("QT_QPA_PLATFORM"))) {
+            // Measure without a real display, so that results are
+            // comparable between machines.
+            environment.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+        }
+        QProcess child;
+        child.setProcessEnvironment(environment);
+        child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        child.start(QCoreApplication::applicationFilePath(), {QStringLiteral("--child")});
+        if (!child.waitForFinished(-1) || (child.exitCode() != 0)) {
+            qCritical() << "Measurement failed for device pixel ratio" << devicePixelRatio;
+            return 1;
+        }
+        out << QString::fromUtf8(child.readAllStandardOutput());
+        out.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/lchdouble.h"
+#include "oklab.h"
+#include "oklabsrgbgamuttable.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QtGlobal>
+
+#include <cmath>
+#include <limits>
+
+using namespace PerceptualColor;
+
+// This tool generates an upper limit of the sRGB gamut in Oklch (see
+// OkLabSrgbGamutTable). It is run by the build system, and writes a C++
+// source file that is compiled into the library.
+//
+// The gamut is tested exactly like the library does at runtime: With the
+// closed-form conversions of OkLab.
+//
+// Usage: generateoklabsrgbgamuttable <output file>
+
+namespace
+{
+/** @brief Upper limit of the chroma search, measured in (scaled) Oklch
+ * chroma.
+ *
+ * The most chromatic sRGB colors have an Oklch chroma of about
+ * <tt>32</tt>, so this is a safe upper limit. */
+constexpr double chromaSearchLimit = 50;
+
+/** @brief Precision of the bisections, measured in (scaled) Oklch chroma.
+ *
+ * The table uses the upper end of the bisection interval, so a coarse
+ * precision makes the table larger, but never too small. */
+constexpr double precision = 0.01;
+
+/** @brief Number of samples per cell side. */
+constexpr int subdivision = 4;
+
+/** @brief Upper limit of the in-gamut chroma at a single point.
+ *
+ * @param lightness The (scaled) Oklch lightness
+ * @param hue The Oklch hue
+ * @returns The upper end of a bisection with the precision
+ * @ref precision. */
+double chromaUpperLimit(double lightness, double hue)
+{
+    LchDouble candidate;
+    candidate.l = lightness;
+    candidate.c = 0;
+    candidate.h = hue;
+    if (!OkLab::isInSrgbGamut(OkLab::fromOklch(candidate))) {
+        // Not even the gray axis is in-gamut at this lightness.
+        return 0;
+    }
+    double lowerChroma = 0;
+    double upperChroma = chromaSearchLimit;
+    while (upperChroma - lowerChroma > precision) {
+        candidate.c = (lowerChroma + upperChroma) / 2;
+        if (OkLab::isInSrgbGamut(OkLab::fromOklch(candidate))) {
+            lowerChroma = candidate.c;
+        } else {
+            upperChroma = candidate.c;
+        }
+    }
+    return upperChroma;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        QTextStream(stderr) << "Usage: generateoklabsrgbgamuttable <output file>\n";
+        return 1;
+    }
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream(stderr) << "Unable to open " << file.fileName() << "\n";
+        return 1;
+    }
+
+    constexpr int lightnessCount = OkLabSrgbGamutTable::lightnessCount;
+    constexpr int hueCount = OkLabSrgbGamutTable::hueCount;
+    constexpr int sampleRowCount = lightnessCount * subdivision + 1;
+    constexpr int sampleColumnCount = hueCount * subdivision;
+    constexpr double lightnessSampleStep = //
+        static_cast<double>(OkLabSrgbGamutTable::lightnessStep) / subdivision;
+    constexpr double hueSampleStep = //
+        static_cast<double>(OkLabSrgbGamutTable::hueStep) / subdivision;
+    QVector<double> samples(sampleRowCount * sampleColumnCount);
+    for (int row = 0; row < sampleRowCount; ++row) {
+        for (int column = 0; column < sampleColumnCount; ++column) {
+            samples[row * sampleColumnCount + column] = //
+                chromaUpperLimit(row * lightnessSampleStep, column * hueSampleStep);
+        }
+    }
+    const auto sample = [&samples](const int row, const int column) {
+        // The hue axis wraps around.
+        return samples.at(row * sampleColumnCount + column % sampleColumnCount);
+    };
+
+    QTextStream out(&file);
+    // Nine significant digits are enough to restore each float exactly.
+    out.setRealNumberPrecision(9);
+    out << "// Generated by generateoklabsrgbgamuttable. Do not edit.\n\n"
+        << "#include \"oklabsrgbgamuttable.h\"\n\n"
+        << "namespace PerceptualColor\n{\n"
+        << "const float OkLabSrgbGamutTable::upperChromaLimit[OkLabSrgbGamutTable::lightnessCount * OkLabSrgbGamutTable::hueCount] = {\n";
+    for (int lightnessIndex = 0; lightnessIndex < lightnessCount; ++lightnessIndex) {
+        out << "    // Lightness " << lightnessIndex * OkLabSrgbGamutTable::lightnessStep << "\n   ";
+        for (int hueIndex = 0; hueIndex < hueCount; ++hueIndex) {
+            const int firstRow = lightnessIndex * subdivision;
+            const int firstColumn = hueIndex * subdivision;
+            double maximum = 0;
+            double margin = 0;
+            for (int row = firstRow; row <= firstRow + subdivision; ++row) {
+                for (int column = firstColumn; column <= firstColumn + subdivision; ++column) {
+                    const double value = sample(row, column);
+                    maximum = qMax(maximum, value);
+                    // Between two neighbouring samples, the boundary can
+                    // rise at most as much as its slope allows.
+                    if (row < firstRow + subdivision) {
+                        margin = qMax(margin, qAbs(sample(row + 1, column) - value));
+                    }
+                    if (column < firstColumn + subdivision) {
+                        margin = qMax(margin, qAbs(sample(row, column + 1) - value));
+                    }
+                }
+            }
+            // Round up when converting to float.
+            const float value = std::nextafter(static_cast<float>(maximum + margin), std::numeric_limits<float>::max());
+            out << " " << value << ",";
+            if ((hueIndex % 8 == 7) && (hueIndex + 1 < hueCount)) {
+                out << "\n   ";
+            }
+        }
+        out << "\n";
+    }
+    out << "};\n"
+        << "} // namespace PerceptualColor\n";
+
+    return 0;
+}
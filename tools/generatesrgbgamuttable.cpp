@@ -0,0 +1,216 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "PerceptualColor/lchdouble.h"
+#include "chromalightnessboundary.h"
+#include "gamutbisection.h"
+#include "helper.h"
+#include "lchvalues.h"
+#include "srgbgamuttable.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QtMath>
+
+#include <lcms2.h>
+
+using namespace PerceptualColor;
+
+// This tool generates the gamut boundary of the built-in sRGB profile
+// (see SrgbGamutTable). It is run by the build system, and writes a C++
+// source file that is compiled into the library.
+//
+// The gamut is tested exactly like RgbColorSpace does: With the same
+// transform from Lab to floating point RGB, and with the same bisections
+// (see GamutBisection).
+//
+// Usage: generatesrgbgamuttable <output file>
+
+namespace
+{
+/** @brief Transform from Lab to floating point sRGB */
+cmsHTRANSFORM transformHandle = nullptr;
+
+/** @brief If LCh values are within the sRGB gamut.
+ *
+ * Like RgbColorSpace::RgbColorSpacePrivate::isInGamutBlock()
+ *
+ * @param lch Pointer to the LCh values
+ * @param inGamut Pointer to the buffer for the results
+ * @param count Number of values. Must not be bigger than
+ * GamutBisection::blockSize. */
+void isInGamutBlock(const LchDouble *lch, bool *inGamut, int count)
+{
+    cmsCIELab lab[GamutBisection::blockSize];
+    double rgb[GamutBisection::blockSize][3];
+    for (int i = 0; i < count; ++i) {
+        const cmsCIELCh cmsLch {lch[i].l, lch[i].c, lch[i].h};
+        cmsLCh2Lab(&lab[i], &cmsLch);
+    }
+    cmsDoTransform(transformHandle, lab, rgb, static_cast<cmsUInt32Number>(count));
+    for (int i = 0; i < count; ++i) {
+        inGamut[i] = isInRange<double>(0, rgb[i][0], 1) //
+            && isInRange<double>(0, rgb[i][1], 1) //
+            && isInRange<double>(0, rgb[i][2], 1);
+    }
+}
+
+/** @brief If a gray is within the sRGB gamut.
+ *
+ * @param lightness Lightness
+ * @returns If the gray is within the sRGB gamut. */
+bool isGrayInGamut(qreal lightness)
+{
+    LchDouble gray;
+    gray.l = lightness;
+    gray.c = 0;
+    gray.h = 0;
+    bool result;
+    isInGamutBlock(&gray, &result, 1);
+    return result;
+}
+
+/** @brief Calculates the maximum in-gamut chroma for all rows of a hue.
+ *
+ * Like RgbColorSpace::RgbColorSpacePrivate::calculateChromaLightnessBoundary()
+ *
+ * @param hue Hue
+ * @param blackpointL The darkest in-gamut point on the L* axis
+ * @param whitepointL The lightest in-gamut point on the L* axis
+ * @returns For each row, the maximum in-gamut chroma, or a negative value
+ * if the gray of this row is out-of-gamut. */
+QVector<qreal> maximumChroma(qreal hue, qreal blackpointL, qreal whitepointL)
+{
+    constexpr int rowCount = ChromaLightnessBoundary::rowCount;
+    QVector<qreal> result(rowCount, -1);
+    LchDouble colors[GamutBisection::blockSize];
+    bool inGamut[GamutBisection::blockSize];
+    int rows[GamutBisection::blockSize];
+    for (int start = 0; start < rowCount; start += GamutBisection::blockSize) {
+        const int blockCount = qMin(GamutBisection::blockSize, rowCount - start);
+        for (int j = 0; j < blockCount; ++j) {
+            colors[j].l = ChromaLightnessBoundary::rowLightness(start + j);
+            colors[j].c = LchValues::humanMaximumChroma;
+            colors[j].h = hue;
+        }
+        isInGamutBlock(colors, inGamut, blockCount);
+        // Rows with an out-of-gamut gray have no in-gamut range. Rows
+        // that are in-gamut even at the maximum chroma need no search.
+        int pendingCount = 0;
+        for (int j = 0; j < blockCount; ++j) {
+            if (!isInRange<qreal>(blackpointL, colors[j].l, whitepointL) || !isGrayInGamut(colors[j].l)) {
+                continue;
+            }
+            if (inGamut[j]) {
+                result[start + j] = colors[j].c;
+                continue;
+            }
+            colors[pendingCount] = colors[j];
+            rows[pendingCount] = start + j;
+            ++pendingCount;
+        }
+        GamutBisection::maximumChroma(isInGamutBlock, colors, pendingCount, gamutPrecision);
+        for (int j = 0; j < pendingCount; ++j) {
+            result[rows[j]] = colors[j].c;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        QTextStream(stderr) << "Usage: generatesrgbgamuttable <output file>\n";
+        return 1;
+    }
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream(stderr) << "Unable to open " << file.fileName() << "\n";
+        return 1;
+    }
+
+    // The same profiles and flags as RgbColorSpace::createSrgb()
+    cmsHPROFILE labProfileHandle = cmsCreateLab4Profile(nullptr);
+    cmsHPROFILE srgbProfileHandle = cmsCreate_sRGBProfile();
+    transformHandle = cmsCreateTransform(labProfileHandle, // input profile handle
+                                         TYPE_Lab_DBL, // input buffer format
+                                         srgbProfileHandle, // output profile handle
+                                         TYPE_RGB_DBL, // output buffer format
+                                         INTENT_ABSOLUTE_COLORIMETRIC, // rendering intent
+                                         cmsFLAGS_NOCACHE // flags
+    );
+    cmsCloseProfile(labProfileHandle);
+    cmsCloseProfile(srgbProfileHandle);
+    if (transformHandle == nullptr) {
+        QTextStream(stderr) << "Unable to create the transform.\n";
+        return 1;
+    }
+
+    // Like RgbColorSpace, which starts the search at the middle gray.
+    const double blackpointL = GamutBisection::grayAxisBoundary(isGrayInGamut, 50, 0, gamutPrecision);
+    const double whitepointL = GamutBisection::grayAxisBoundary(isGrayInGamut, 50, 100, gamutPrecision);
+
+    QTextStream out(&file);
+    out.setRealNumberPrecision(17);
+    out << "// Generated by generatesrgbgamuttable. Do not edit.\n\n"
+        << "#include \"srgbgamuttable.h\"\n\n"
+        << "namespace PerceptualColor\n{\n"
+        << "const double SrgbGamutTable::blackpointL = " << blackpointL << ";\n"
+        << "const double SrgbGamutTable::whitepointL = " << whitepointL << ";\n"
+        << "const quint16 SrgbGamutTable::maximumChroma[SrgbGamutTable::hueCount * SrgbGamutTable::rowCount] = {\n";
+    for (int hueIndex = 0; hueIndex < SrgbGamutTable::hueCount; ++hueIndex) {
+        const double hue = hueIndex * SrgbGamutTable::hueStep;
+        const QVector<qreal> chromas = maximumChroma(hue, blackpointL, whitepointL);
+        out << "    // Hue " << hue << "\n   ";
+        for (int row = 0; row < SrgbGamutTable::rowCount; ++row) {
+            int value = SrgbGamutTable::outOfGamut;
+            if (chromas.at(row) >= 0) {
+                // Round down, so that the value stays in-gamut.
+                value = qFloor(chromas.at(row) * SrgbGamutTable::chromaScale);
+                if (value >= SrgbGamutTable::outOfGamut) {
+                    QTextStream(stderr) << "Chroma exceeds the range of the table.\n";
+                    return 1;
+                }
+            }
+            out << " " << value << ",";
+            if ((row % 16 == 15) && (row + 1 < SrgbGamutTable::rowCount)) {
+                out << "\n   ";
+            }
+        }
+        out << "\n";
+    }
+    out << "};\n"
+        << "} // namespace PerceptualColor\n";
+
+    cmsDeleteTransform(transformHandle);
+    return 0;
+}
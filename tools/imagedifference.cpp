@@ -0,0 +1,417 @@
+﻿// SPDX-License-Identifier: MIT
+/*
+ * Copyright (c) 2020 Lukas Sommer sommerluk@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PerceptualColor/perceptualcolorglobal.h"
+#include "perceptualcolorinternal.h"
+
+#include "rgbcolorspace.h"
+#include "rgbdouble.h"
+
+#include <QCommandLineParser>
+#include <QColor>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+#include <lcms2.h>
+
+using namespace PerceptualColor;
+
+// This tool compares two images perceptually. Both images are converted
+// from their RGB color space (given as ICC profile; sRGB by default) to
+// CIELab, and for each pixel the color difference ΔE is calculated. The
+// result is a heat-map image and the summary statistics mean, 95th
+// percentile and maximum, printed as a tab-separated table.
+//
+// The conversion is done in parallel in horizontal tiles, using the batch
+// conversion of RgbColorSpace. If both arguments are directories, all
+// images with the same file name are compared, and the next pair of images
+// is loaded while the current pair is compared. This makes the tool
+// suitable for large batches of screenshots.
+//
+// The alpha channel is ignored.
+
+namespace
+{
+/** @brief Number of rows of a tile that is converted at once. */
+constexpr int tileHeight = 32;
+
+/** @brief Function that calculates the color difference ΔE. */
+using DeltaEFunction = double (*)(const cmsCIELab &first, const cmsCIELab &second);
+
+/** @brief ΔE following CIEDE2000. */
+double deltaE2000(const cmsCIELab &first, const cmsCIELab &second)
+{
+    return cmsCIE2000DeltaE(&first, &second, 1, 1, 1);
+}
+
+/** @brief ΔE following CIE76, the euclidean distance in CIELab. */
+double deltaE76(const cmsCIELab &first, const cmsCIELab &second)
+{
+    return cmsDeltaE(&first, &second);
+}
+
+/** @brief Summary statistics of the color difference of an image pair. */
+struct Statistics {
+    /** @brief Arithmetic mean of ΔE */
+    double mean = 0;
+    /** @brief 95th percentile of ΔE */
+    double p95 = 0;
+    /** @brief Maximum of ΔE */
+    double maximum = 0;
+};
+
+/** @brief Palette of the heat-map.
+ *
+ * Index <tt>0</tt> (no difference) is black. Higher indices go from dark
+ * blue over cyan, green and yellow to red, while getting brighter.
+ *
+ * @returns 256 colors */
+QVector<QRgb> heatMapPalette()
+{
+    QVector<QRgb> palette(256);
+    palette[0] = qRgb(0, 0, 0);
+    for (int i = 1; i < palette.count(); ++i) {
+        const double t = i / 255.0;
+        palette[i] = QColor::fromHsvF((1 - t) * 240 / 360, 1, qMin(1.0, 0.3 + t * 1.4)).rgb();
+    }
+    return palette;
+}
+
+/** @brief Compares two images.
+ *
+ * @param before The first image
+ * @param beforeColorSpace The color space of the first image
+ * @param after The second image, with the same size as the first one
+ * @param afterColorSpace The color space of the second image
+ * @param deltaE The formula for ΔE
+ * @param range The ΔE that is shown as the maximum of the heat-map
+ * @param heatMap If not <tt>nullptr</tt>, receives the heat-map.
+ * @returns The statistics */
+Statistics compare(const QImage &before,
+                   const RgbColorSpace &beforeColorSpace,
+                   const QImage &after,
+                   const RgbColorSpace &afterColorSpace,
+                   DeltaEFunction deltaE,
+                   double range,
+                   QImage *heatMap)
+{
+    Statistics result;
+    const QImage beforeRgb = before.convertToFormat(QImage::Format_RGB32);
+    const QImage afterRgb = after.convertToFormat(QImage::Format_RGB32);
+    const int width = beforeRgb.width();
+    const int height = beforeRgb.height();
+    const int pixelCount = width * height;
+    if (pixelCount <= 0) {
+        return result;
+    }
+
+    static const QVector<QRgb> palette = heatMapPalette();
+    uchar *heatMapBits = nullptr;
+    int heatMapBytesPerLine = 0;
+    if (heatMap != nullptr) {
+        *heatMap = QImage(width, height, QImage::Format_RGB32);
+        // Detach before the parallel part, so that the threads can write
+        // to different lines of the same buffer.
+        heatMapBits = heatMap->bits();
+        heatMapBytesPerLine = heatMap->bytesPerLine();
+    }
+
+    const int tileCount = (height + tileHeight - 1) / tileHeight;
+    QVector<int> tiles(tileCount);
+    for (int i = 0; i < tileCount; ++i) {
+        tiles[i] = i;
+    }
+    QVector<float> differences(pixelCount);
+    QVector<double> tileSums(tileCount, 0);
+    QVector<double> tileMaxima(tileCount, 0);
+    float *differencesData = differences.data();
+    double *tileSumsData = tileSums.data();
+    double *tileMaximaData = tileMaxima.data();
+    const auto convertTile = [&](const int tile) {
+        QVector<RgbDouble> beforeLine(width);
+        QVector<RgbDouble> afterLine(width);
+        QVector<cmsCIELab> beforeLab(width);
+        QVector<cmsCIELab> afterLab(width);
+        double sum = 0;
+        double maximum = 0;
+        const int lastLine = qMin(height, (tile + 1) * tileHeight);
+        for (int y = tile * tileHeight; y < lastLine; ++y) {
+            const QRgb *beforeScanLine = reinterpret_cast<const QRgb *>(beforeRgb.constScanLine(y));
+            const QRgb *afterScanLine = reinterpret_cast<const QRgb *>(afterRgb.constScanLine(y));
+            for (int x = 0; x < width; ++x) {
+                beforeLine[x] = RgbDouble {qRed(beforeScanLine[x]) / 255.0, //
+                                           qGreen(beforeScanLine[x]) / 255.0,
+                                           qBlue(beforeScanLine[x]) / 255.0};
+                afterLine[x] = RgbDouble {qRed(afterScanLine[x]) / 255.0, //
+                                          qGreen(afterScanLine[x]) / 255.0,
+                                          qBlue(afterScanLine[x]) / 255.0};
+            }
+            beforeColorSpace.toCielab(beforeLine.constData(), beforeLab.data(), width);
+            afterColorSpace.toCielab(afterLine.constData(), afterLab.data(), width);
+            float *differenceLine = differencesData + y * width;
+            QRgb *heatMapLine = (heatMapBits == nullptr) //
+                ? nullptr
+                : reinterpret_cast<QRgb *>(heatMapBits + y * heatMapBytesPerLine);
+            for (int x = 0; x < width; ++x) {
+                const double difference = deltaE(beforeLab.at(x), afterLab.at(x));
+                differenceLine[x] = static_cast<float>(difference);
+                sum += difference;
+                maximum = qMax(maximum, difference);
+                if (heatMapLine != nullptr) {
+                    const int index = qBound(0, qRound(difference / range * 255), 255);
+                    heatMapLine[x] = palette.at(index);
+                }
+            }
+        }
+        tileSumsData[tile] = sum;
+        tileMaximaData[tile] = maximum;
+    };
+    QtConcurrent::blockingMap(tiles, convertTile);
+
+    double sum = 0;
+    for (int i = 0; i < tileCount; ++i) {
+        sum += tileSums.at(i);
+        result.maximum = qMax(result.maximum, tileMaxima.at(i));
+    }
+    result.mean = sum / pixelCount;
+    // The nearest-rank percentile. The order of the differences is not
+    // needed anymore, so they can be partially sorted in place.
+    const int rank = qBound(0, static_cast<int>(std::ceil(0.95 * pixelCount)) - 1, pixelCount - 1);
+    std::nth_element(differences.begin(), differences.begin() + rank, differences.end());
+    result.p95 = differences.at(rank);
+    return result;
+}
+
+/** @brief Provides the color spaces, each profile is loaded only once. */
+class ColorSpaces
+{
+public:
+    /** @brief The color space of a profile.
+     *
+     * @param fileName File name of an ICC profile. If empty, sRGB.
+     * @returns The color space, or <tt>nullptr</tt> if the profile could
+     * not be loaded. */
+    QSharedPointer<RgbColorSpace> get(const QString &fileName)
+    {
+        if (!m_hash.contains(fileName)) {
+            m_hash.insert(fileName,
+                          fileName.isEmpty() //
+                              ? RgbColorSpace::createSrgb()
+                              : RgbColorSpace::createFromFile(fileName));
+        }
+        return m_hash.value(fileName);
+    }
+
+private:
+    QHash<QString, QSharedPointer<RgbColorSpace>> m_hash;
+};
+
+/** @brief Loads an image pair. Can be called in a separate thread. */
+QPair<QImage, QImage> loadPair(const QString &before, const QString &after)
+{
+    return qMakePair(QImage(before), QImage(after));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("imagedifference"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral( //
+        "Compares two images perceptually and reports the color difference ΔE. "
+        "If both arguments are directories, all images with the same "
+        "file name are compared."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("before"), //
+                                 QStringLiteral("The first image or directory."));
+    parser.addPositionalArgument(QStringLiteral("after"), //
+                                 QStringLiteral("The second image or directory."));
+    const QCommandLineOption profileOption( //
+        QStringLiteral("profile"),
+        QStringLiteral("ICC profile of both images. Default: sRGB."),
+        QStringLiteral("file"));
+    const QCommandLineOption beforeProfileOption( //
+        QStringLiteral("before-profile"),
+        QStringLiteral("ICC profile of the first image."),
+        QStringLiteral("file"));
+    const QCommandLineOption afterProfileOption( //
+        QStringLiteral("after-profile"),
+        QStringLiteral("ICC profile of the second image."),
+        QStringLiteral("file"));
+    const QCommandLineOption heatMapOption( //
+        QStringLiteral("heatmap"),
+        QStringLiteral("Writes the heat-map to this file, or for directories "
+                       "to this directory."),
+        QStringLiteral("path"));
+    const QCommandLineOption rangeOption( //
+        QStringLiteral("range"),
+        QStringLiteral("ΔE that is shown with the strongest color in the "
+                       "heat-map. Default: 10."),
+        QStringLiteral("deltaE"),
+        QStringLiteral("10"));
+    const QCommandLineOption formulaOption( //
+        QStringLiteral("formula"),
+        QStringLiteral("ΔE formula: ciede2000 or cie76. Default: ciede2000."),
+        QStringLiteral("formula"),
+        QStringLiteral("ciede2000"));
+    parser.addOption(profileOption);
+    parser.addOption(beforeProfileOption);
+    parser.addOption(afterProfileOption);
+    parser.addOption(heatMapOption);
+    parser.addOption(rangeOption);
+    parser.addOption(formulaOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.count() != 2) {
+        parser.showHelp(1);
+    }
+
+    DeltaEFunction deltaE = nullptr;
+    const QString formula = parser.value(formulaOption);
+    if (formula == QStringLiteral("ciede2000")) {
+        deltaE = deltaE2000;
+    } else if (formula == QStringLiteral("cie76")) {
+        deltaE = deltaE76;
+    } else {
+        err << "Unknown formula: " << formula << "\n";
+        return 1;
+    }
+    bool isRangeValid = false;
+    const double range = parser.value(rangeOption).toDouble(&isRangeValid);
+    if (!isRangeValid || range <= 0) {
+        err << "Invalid range: " << parser.value(rangeOption) << "\n";
+        return 1;
+    }
+
+    const QString profile = parser.value(profileOption);
+    const QString beforeProfile = parser.isSet(beforeProfileOption) //
+        ? parser.value(beforeProfileOption)
+        : profile;
+    const QString afterProfile = parser.isSet(afterProfileOption) //
+        ? parser.value(afterProfileOption)
+        : profile;
+    ColorSpaces colorSpaces;
+    const QSharedPointer<RgbColorSpace> beforeColorSpace = colorSpaces.get(beforeProfile);
+    const QSharedPointer<RgbColorSpace> afterColorSpace = colorSpaces.get(afterProfile);
+    if (beforeColorSpace.isNull() || afterColorSpace.isNull()) {
+        err << "Could not load the ICC profile.\n";
+        return 1;
+    }
+
+    // Build the list of image pairs.
+    struct Job {
+        QString name;
+        QString before;
+        QString after;
+        QString heatMap;
+    };
+    QVector<Job> jobs;
+    const QFileInfo beforeInfo(arguments.at(0));
+    const QFileInfo afterInfo(arguments.at(1));
+    const QString heatMapPath = parser.value(heatMapOption);
+    if (beforeInfo.isDir() && afterInfo.isDir()) {
+        const QDir beforeDir(beforeInfo.filePath());
+        const QDir afterDir(afterInfo.filePath());
+        const QDir heatMapDir(heatMapPath);
+        if (!heatMapPath.isEmpty() && !heatMapDir.mkpath(QStringLiteral("."))) {
+            err << "Could not create the directory " << heatMapPath << "\n";
+            return 1;
+        }
+        const QStringList names = beforeDir.entryList(QDir::Files, QDir::Name);
+        for (const QString &name : names) {
+            jobs.append(Job {name,
+                             beforeDir.filePath(name),
+                             afterDir.filePath(name),
+                             heatMapPath.isEmpty() //
+                                 ? QString()
+                                 : heatMapDir.filePath(QFileInfo(name).completeBaseName() + QStringLiteral(".png"))});
+        }
+    } else {
+        jobs.append(Job {beforeInfo.fileName(), beforeInfo.filePath(), afterInfo.filePath(), heatMapPath});
+    }
+
+    int failureCount = 0;
+    out << "image\tmean\tp95\tmax\n";
+    QFuture<QPair<QImage, QImage>> nextPair;
+    if (!jobs.isEmpty()) {
+        nextPair = QtConcurrent::run(loadPair, jobs.at(0).before, jobs.at(0).after);
+    }
+    for (int i = 0; i < jobs.count(); ++i) {
+        const Job &job = jobs.at(i);
+        const QPair<QImage, QImage> pair = nextPair.result();
+        // Load the next pair while the current one is compared.
+        if (i + 1 < jobs.count()) {
+            nextPair = QtConcurrent::run(loadPair, jobs.at(i + 1).before, jobs.at(i + 1).after);
+        }
+        if (pair.first.isNull() || pair.second.isNull()) {
+            err << job.name << ": Could not load the images.\n";
+            ++failureCount;
+            continue;
+        }
+        if (pair.first.size() != pair.second.size()) {
+            err << job.name << ": The images have different sizes.\n";
+            ++failureCount;
+            continue;
+        }
+        QImage heatMap;
+        const Statistics statistics = compare(pair.first,
+                                              *beforeColorSpace,
+                                              pair.second,
+                                              *afterColorSpace,
+                                              deltaE,
+                                              range,
+                                              job.heatMap.isEmpty() ? nullptr : &heatMap);
+        if (!job.heatMap.isEmpty() && !heatMap.save(job.heatMap)) {
+            err << job.name << ": Could not write " << job.heatMap << "\n";
+            ++failureCount;
+        }
+        out << job.name //
+            << "\t" << QString::number(statistics.mean, 'f', 3) //
+            << "\t" << QString::number(statistics.p95, 'f', 3) //
+            << "\t" << QString::number(statistics.maximum, 'f', 3) //
+            << "\n";
+    }
+    out.flush();
+    return (failureCount > 0) ? 1 : 0;
+}